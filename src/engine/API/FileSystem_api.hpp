@@ -62,10 +62,17 @@ typedef struct pack_s {
     uint64 hashSize; // hash table size (power of 2)
     fileInPack_t **hashTable; // hash table
     fileInPack_t *buildBuffer; // buffer with the filenames etc.
+    struct pakMapping_s *mapping; // nullptr unless the pk3 is memory mapped
 } pack_t;
 
 #define MAX_FOUND_FILES 0x1000
 
+// called with the contents of a file read by AsyncReadFile, buffer is nullptr
+// and len -1 if the file wasn't found. The buffer is freed when the
+// completion callback returns
+typedef void (*asyncFileFunc_t)(pointer qpath, void *buffer, sint len,
+                                void *userData);
+
 // idFileSystem
 class idFileSystem {
 public:
@@ -136,6 +143,9 @@ public:
                                        pointer filename) = 0;
     virtual void FilenameCompletion(pointer dir, pointer ext, bool stripExt,
                                     void(*callback)(pointer s)) = 0;
+    virtual void AsyncReadFile(pointer qpath, asyncFileFunc_t decode,
+                               asyncFileFunc_t complete, void *userData) = 0;
+    virtual void FinishAsyncReads(bool wait) = 0;
 };
 
 extern idFileSystem *fileSystem;
@@ -37,6 +37,24 @@ typedef enum {
     TAG_STATIC
 } memtag_t;
 
+// build with ALLOC_PROFILE to count zone and hunk allocations by the
+// source line they are made from, see the allocsites command. Only the
+// inline wrappers below change, the virtual *Site entry points are the
+// same in every build so modules and engine can be configured apart
+#ifdef ALLOC_PROFILE
+#define ALLOC_SITE_DECL , pointer file = __builtin_FILE(), sint line = __builtin_LINE()
+#define ALLOC_SITE_ARGS , file, line
+#else
+#define ALLOC_SITE_DECL
+#define ALLOC_SITE_ARGS , nullptr, 0
+#endif
+
+// position in the calling thread's scratch arena, see idScratchScope
+typedef struct {
+    void *chunk;
+    uint64 used;
+} scratchMark_t;
+
 //
 // idMemorySystem
 //
@@ -44,9 +62,10 @@ class idMemorySystem {
 public:
     virtual void Free(void *ptr) = 0;
     virtual void FreeTags(memtag_t tag) = 0;
-    virtual void *Malloc(uint64 size) = 0;
-    virtual void *TagMalloc(uint64 size, memtag_t tag) = 0;
-    virtual void *SMalloc(uint64 size) = 0;
+    virtual void *MallocSite(uint64 size, pointer file, sint line) = 0;
+    virtual void *TagMallocSite(uint64 size, memtag_t tag, pointer file,
+                                sint line) = 0;
+    virtual void *SMallocSite(uint64 size, pointer file, sint line) = 0;
     virtual void CheckHeap(void) = 0;
     virtual bool CheckMark(void) = 0;
     virtual void TouchMemory(void) = 0;
@@ -57,16 +76,68 @@ public:
     virtual void SetMark(void) = 0;
     virtual void ClearToMark(void) = 0;
     virtual void Clear(void) = 0;
-    virtual void *Alloc(uint64 size, ha_pref preference) = 0;
-    virtual void *AllocateTempMemory(uint64 size) = 0;
+    virtual void *AllocSite(uint64 size, ha_pref preference, pointer file,
+                            sint line) = 0;
+    virtual void *AllocateTempMemorySite(uint64 size, pointer file,
+                                         sint line) = 0;
     virtual void FreeTempMemory(void *buf) = 0;
     virtual void ClearTempMemory(void) = 0;
     virtual valueType *CopyString(pointer in) = 0;
     virtual void GetHunkInfo(sint *hunkused, sint *hunkexpected) = 0;
     virtual void ReleaseMemory(void) = 0;
     virtual void FrameReset(void) = 0;
+    virtual void *ScratchAlloc(uint64 size) = 0;
+    virtual scratchMark_t ScratchMark(void) = 0;
+    virtual void ScratchRestore(scratchMark_t mark) = 0;
+
+    void *Malloc(uint64 size ALLOC_SITE_DECL) {
+        return MallocSite(size ALLOC_SITE_ARGS);
+    }
+
+    void *TagMalloc(uint64 size, memtag_t tag ALLOC_SITE_DECL) {
+        return TagMallocSite(size, tag ALLOC_SITE_ARGS);
+    }
+
+    void *SMalloc(uint64 size ALLOC_SITE_DECL) {
+        return SMallocSite(size ALLOC_SITE_ARGS);
+    }
+
+    void *Alloc(uint64 size, ha_pref preference ALLOC_SITE_DECL) {
+        return AllocSite(size, preference ALLOC_SITE_ARGS);
+    }
+
+    void *AllocateTempMemory(uint64 size ALLOC_SITE_DECL) {
+        return AllocateTempMemorySite(size ALLOC_SITE_ARGS);
+    }
 };
 
 extern idMemorySystem *memorySystem;
 
+//
+// idScratchScope
+//
+// Remembers where the calling thread's scratch arena stands and gives back
+// everything allocated from it since when the scope ends.  Scratch memory
+// is 16 byte aligned, not cleared and only valid on the thread that got it.
+//
+class idScratchScope {
+public:
+    idScratchScope(void) : mark(memorySystem->ScratchMark()) {
+    }
+
+    ~idScratchScope(void) {
+        memorySystem->ScratchRestore(mark);
+    }
+
+    void *Alloc(uint64 size) {
+        return memorySystem->ScratchAlloc(size);
+    }
+
+private:
+    idScratchScope(const idScratchScope &);
+    idScratchScope &operator=(const idScratchScope &);
+
+    scratchMark_t mark;
+};
+
 #endif //!__MEMORY_API_HPP__
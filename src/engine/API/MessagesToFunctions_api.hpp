@@ -69,6 +69,8 @@ public:
     // sets data buffer as MSG_Init does prior to do the copy
     virtual void Copy(msg_t *buf, uchar8 *data, sint length, msg_t *src) = 0;
     virtual void WriteBits(msg_t *msg, sint value, sint bits) = 0;
+    virtual void WriteBitStream(msg_t *msg, const uchar8 *data,
+                                sint numBits) = 0;
 #if !defined(_DEBUG)
     virtual void WriteByte(msg_t *sb, sint c) = 0;
     virtual void WriteShort(msg_t *sb, sint c) = 0;
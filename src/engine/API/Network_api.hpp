@@ -61,6 +61,9 @@ public:
     virtual void Sleep(sint msec) = 0;
     virtual void Restart_f(void) = 0;
     virtual sint ConnectTCP(valueType *s_host_port) = 0;
+    virtual void BeginPacketBatch(void) = 0;
+    virtual void FlushPacketBatch(void) = 0;
+    virtual void SleepUsec(sint64 usec) = 0;
 };
 
 extern idNetworkSystem *networkSystem;
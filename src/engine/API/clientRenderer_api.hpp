@@ -40,6 +40,7 @@ public:
     virtual void RefTagFree(void) = 0;
     virtual sint ScaledMilliseconds(void) = 0;
     virtual void ShutdownRef(void) = 0;
+    virtual void LoadingProgress(pointer label, sint done, sint total) = 0;
 };
 
 extern idClientRendererSystemAPI *clientRendererSystem;
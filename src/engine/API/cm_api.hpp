@@ -78,6 +78,17 @@ enum traceType_t {
     TT_NUM_TRACE_TYPES
 };
 
+// one sweep of a BoxTraceBatch, same parameters as BoxTrace
+typedef struct traceRequest_s {
+    vec3_t start;
+    vec3_t end;
+    vec3_t mins;
+    vec3_t maxs;
+    clipHandle_t model;
+    sint brushmask;
+    traceType_t type;
+} traceRequest_t;
+
 //
 // idCollisionModelManager
 //
@@ -138,6 +149,23 @@ public:
     virtual sint BoxOnPlaneSide(vec3_t emins, vec3_t emaxs,
                                 cplane_t *plane) = 0;
     virtual bool IsBSPSupported(const sint version, const bool dropError) = 0;
+
+    // re-entrant TempBoxModel + TransformedBoxTrace, the temp box and its
+    // contents are passed in instead of being kept in shared state, so
+    // traces may be issued from several threads at once
+    virtual void TempBoxTrace(trace_t *results, const vec3_t start,
+                              const vec3_t end, const vec3_t mins, const vec3_t maxs,
+                              const vec3_t boxMins, const vec3_t boxMaxs, sint boxContents,
+                              bool capsule, sint brushmask, const vec3_t origin,
+                              traceType_t type) = 0;
+
+    // BoxTrace for every request, results[i] answers requests[i]
+    virtual void BoxTraceBatch(const traceRequest_t *requests, trace_t *results,
+                               sint count) = 0;
+
+    // re-entrant TempBoxModel + TransformedPointContents, boxes don't rotate
+    virtual sint TempBoxPointContents(const vec3_t p, const vec3_t boxMins,
+                                      const vec3_t boxMaxs, sint boxContents, const vec3_t origin) = 0;
 };
 
 extern idCollisionModelManager *collisionModelManager;
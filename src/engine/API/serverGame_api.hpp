@@ -91,8 +91,7 @@ typedef struct gentity_s gentity_t;
 #define MAX_ENT_CLUSTERS    16
 
 typedef struct svEntity_s {
-    struct worldSector_s *worldSector;
-    struct svEntity_s *nextEntityInWorldSector;
+    sint            worldNode;      // leaf in the world AABB tree, -1 if not linked
 
     entityState_t   baseline;   // for delta compression of initial sighting
     sint            numClusters;    // if -1, use headnode instead
@@ -101,8 +100,6 @@ typedef struct svEntity_s {
     lastCluster;    // if all the clusters don't fit in clusternums
     sint            areanum, areanum2;
     sint
-    snapshotCounter;    // used to prevent double adding from portal views
-    sint
     originCluster;  // Gordon: calced upon linking, for origin only bmodel vis checks
 } svEntity_t;
 
@@ -125,6 +125,8 @@ void trap_TraceCapsule(trace_t *results, const vec3_t start,
 void trap_TraceCapsuleNoEnts(trace_t *results, const vec3_t start,
                              const vec3_t mins, const vec3_t maxs, const vec3_t end, sint passEntityNum,
                              sint contentmask);
+void trap_CM_BoxTraceBatch(const traceRequest_t *requests, trace_t *results,
+                           sint count);
 sint trap_PointContents(const vec3_t point, sint passEntityNum);
 void trap_SetBrushModel(gentity_t *ent, pointer name);
 bool trap_InPVS(const vec3_t p1, const vec3_t p2);
@@ -906,10 +906,10 @@ redump:
                     soundSystem->Update();
 
                     if(developer->integer) {
-                        common->Printf("S_Update: Setting rawend to %i\n", s_soundtime);
+                        common->Printf("S_Update: Setting rawend to %i\n", s_soundtime.load());
                     }
 
-                    s_rawend = s_soundtime;         //DAJ added
+                    s_rawend = s_soundtime.load();         //DAJ added
                 }
 
                 ssize = clientCinemaLocal.RllDecodeStereoToStereo(framedata, sbuf,
@@ -1325,11 +1325,11 @@ sint idClientCinemaSystemLocal::PlayCinematic(pointer arg, sint x, sint y,
         clientConsoleSystem->Close();
 
         if(developer->integer) {
-            common->Printf("Setting rawend to %i\n", s_soundtime);
+            common->Printf("Setting rawend to %i\n", s_soundtime.load());
         }
 
         if(!cinTable[currentHandle].silent) {
-            s_rawend = s_soundtime;
+            s_rawend = s_soundtime.load();
         }
 
         return currentHandle;
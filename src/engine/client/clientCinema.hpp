@@ -59,7 +59,7 @@
 
 #define MAX_VIDEO_HANDLES   16
 
-extern sint s_soundtime;
+extern std::atomic<sint> s_soundtime;
 
 #define CIN_STREAM 0    //DAJ const for the sound stream used for cinematics
 
@@ -194,7 +194,7 @@ void idClientNetChanSystemLocal::Netchan_Transmit(netchan_t *chan,
     networkChainSystem->Transmit(chan, msg->cursize, msg->data);
 }
 
-extern sint      oldsize;
+extern thread_local sint oldsize;
 sint             newsize = 0;
 
 /*
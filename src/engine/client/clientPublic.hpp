@@ -406,6 +406,7 @@ typedef struct {
     consoleShader2;                                                 // NERVE - SMF - merged from WolfSP
     bool        useLegacyConsoleFont;
     fontInfo_t      consoleFont;
+    valueType       loadingProgress[MAX_QPATH];       // drawn under the loading screen
     // www downloading
     // in the static stuff since this may have to survive server disconnects
     // if new stuff gets added, idClientDownloadSystemLocal::ClearStaticDownload code needs to be updated for clear up
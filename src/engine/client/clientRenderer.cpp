@@ -160,6 +160,43 @@ sint idClientRendererSystemLocal::ScaledMilliseconds(void) {
 #endif
 }
 
+/*
+============
+idClientRendererSystemLocal::LoadingProgress
+
+Shows how far the renderer got with a long registration step on the
+loading screen, done == total takes it down again
+============
+*/
+void idClientRendererSystemLocal::LoadingProgress(pointer label, sint done,
+        sint total) {
+    static sint lastUpdate;
+    sint now;
+
+    if(done >= total) {
+        cls.loadingProgress[0] = '\0';
+        return;
+    }
+
+    Q_vsprintf_s(cls.loadingProgress, sizeof(cls.loadingProgress),
+                 sizeof(cls.loadingProgress), "%s %d/%d", label, done, total);
+
+    if(cls.state != CA_LOADING && cls.state != CA_PRIMED) {
+        return;
+    }
+
+    // redrawing costs a frame, so don't do it for every step
+    now = idsystem->Milliseconds();
+
+    if(done && now - lastUpdate < 100) {
+        return;
+    }
+
+    lastUpdate = now;
+
+    clientScreenSystem->UpdateScreen();
+}
+
 /*
 ====================
 idClientMainSystemLocal::InitExportTable
@@ -45,6 +45,7 @@ public:
     virtual void RefTagFree(void);
     virtual sint ScaledMilliseconds(void);
     virtual void ShutdownRef(void);
+    virtual void LoadingProgress(pointer label, sint done, sint total);
 
     static void InitRenderer(void);
     static void InitRef(void);
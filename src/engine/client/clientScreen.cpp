@@ -817,6 +817,22 @@ void idClientScreenSystemLocal::DrawDemoRecording(void) {
                                         fileSystem->FTell(clc.demofile)));
 }
 
+/*
+=================
+idClientScreenSystemLocal::DrawLoadingProgress
+=================
+*/
+void idClientScreenSystemLocal::DrawLoadingProgress(void) {
+    if(!cls.loadingProgress[0]) {
+        return;
+    }
+
+    DrawSmallStringExt(SMALLCHAR_WIDTH,
+                       cls.glconfig.vidHeight - SMALLCHAR_HEIGHT * 2, cls.loadingProgress,
+                       g_color_table[ColorIndex(COLOR_WHITE)], true, false);
+    renderSystem->SetColor(nullptr);
+}
+
 /*
 ==============
 idClientScreenSystemLocal::DebugGraph
@@ -951,6 +967,8 @@ void idClientScreenSystemLocal::DrawScreenField(stereoFrame_t
                 // flash away too briefly on local or lan games
                 uiManager->Refresh(cls.realtime);
                 uiManager->DrawConnectScreen(true);
+
+                DrawLoadingProgress();
                 break;
 
             case CA_ACTIVE:
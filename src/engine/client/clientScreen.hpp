@@ -65,6 +65,7 @@ public:
                                float32 *setColor, bool forceColor, bool noColorEscape);
     virtual sint Strlen(pointer str);
     virtual void DrawDemoRecording(void);
+    virtual void DrawLoadingProgress(void);
     virtual void DebugGraph(float32 value, sint color);
     virtual void DrawDebugGraph(void);
     virtual void Init(void);
@@ -86,8 +86,9 @@ sint bspVersion;
 #define LL( x ) x = LittleLong( x )
 
 clipMap_t       cm;
-sint             c_pointcontents, c_traces, c_brush_traces, c_patch_traces,
+std::atomic<sint> c_pointcontents, c_traces, c_brush_traces, c_patch_traces,
                  c_trisoup_traces;
+std::atomic<sint> c_trace_batches, c_batch_traces;
 
 uchar8           *cmod_base;
 
@@ -98,6 +99,7 @@ cbrush_t       *box_brush;
 
 
 void            CM_InitBoxHull(void);
+static void     CM_SetupBoxHullSides(cbrushside_t *sides, cplane_t *planes);
 void            CM_FloodAreaConnections(void);
 
 
@@ -615,6 +617,47 @@ void CMod_LoadBrushes(lump_t *l) {
 
 }
 
+/*
+=================
+CMod_PackBrushPlanes
+
+Copies the side planes of every brush into groups of four normals and
+dists, the layout the SIMD plane tests in cm_trace.cpp load from
+=================
+*/
+void CMod_PackBrushPlanes(void) {
+    sint             i, j, numGroups;
+    cbrush_t       *b;
+    cplane_t       *plane;
+    float32          *out, *group;
+
+    numGroups = 0;
+
+    for(i = 0, b = cm.brushes; i < cm.numBrushes; i++, b++) {
+        numGroups += (b->numsides + 3) >> 2;
+    }
+
+    // hunk memory is zeroed, so the unused lanes of the last group are too
+    out = static_cast<float32 *>(memorySystem->Alloc(Q_max(numGroups,
+                                 1) * BRUSH_PLANE_GROUP_FLOATS * sizeof(float32), h_high));
+
+    for(i = 0, b = cm.brushes; i < cm.numBrushes; i++, b++) {
+        b->planeGroups = out;
+
+        for(j = 0; j < b->numsides; j++) {
+            plane = b->sides[j].plane;
+            group = out + (j >> 2) * BRUSH_PLANE_GROUP_FLOATS + (j & 3);
+
+            group[0] = plane->normal[0];
+            group[4] = plane->normal[1];
+            group[8] = plane->normal[2];
+            group[12] = plane->dist;
+        }
+
+        out += ((b->numsides + 3) >> 2) * BRUSH_PLANE_GROUP_FLOATS;
+    }
+}
+
 /*
 =================
 CMod_LoadLeafs
@@ -1307,6 +1350,7 @@ void idCollisionModelManagerLocal::LoadMap(pointer name, bool clientload,
     CMod_LoadPlanes(&header.lumps[LUMP_PLANES]);
     CMod_LoadBrushSides(&header.lumps[LUMP_BRUSHSIDES]);
     CMod_LoadBrushes(&header.lumps[LUMP_BRUSHES]);
+    CMod_PackBrushPlanes();
     CMod_LoadSubmodels(&header.lumps[LUMP_MODELS]);
     CMod_LoadNodes(&header.lumps[LUMP_NODES]);
     CMod_LoadEntityString(&header.lumps[LUMP_ENTITIES]);
@@ -1449,10 +1493,6 @@ can just be stored out and get a proper clipping hull structure.
 ===================
 */
 void CM_InitBoxHull(void) {
-    sint             i, side;
-    cplane_t       *p;
-    cbrushside_t   *s;
-
     box_planes = &cm.planes[cm.numPlanes];
 
     box_brush = &cm.brushes[cm.numBrushes];
@@ -1469,22 +1509,37 @@ void CM_InitBoxHull(void) {
     box_model.leaf.firstLeafBrush = cm.numLeafBrushes;
     cm.leafbrushes[cm.numLeafBrushes] = cm.numBrushes;
 
+    CM_SetupBoxHullSides(box_brush->sides, box_planes);
+}
+
+/*
+===================
+CM_SetupBoxHullSides
+
+Points the six box sides at their axial planes
+===================
+*/
+static void CM_SetupBoxHullSides(cbrushside_t *sides, cplane_t *planes) {
+    sint             i, side;
+    cplane_t       *p;
+    cbrushside_t   *s;
+
     for(i = 0; i < 6; i++) {
         side = i & 1;
 
         // brush sides
-        s = &cm.brushsides[cm.numBrushSides + i];
-        s->plane = cm.planes + (cm.numPlanes + i * 2 + side);
+        s = &sides[i];
+        s->plane = planes + (i * 2 + side);
         s->surfaceFlags = 0;
 
         // planes
-        p = &box_planes[i * 2];
+        p = &planes[i * 2];
         p->type = static_cast<uchar8>(i >> 1);
         p->signbits = 0;
         VectorClear(p->normal);
         p->normal[i >> 1] = 1;
 
-        p = &box_planes[i * 2 + 1];
+        p = &planes[i * 2 + 1];
         p->type = static_cast<uchar8>(3 + (i >> 1));
         p->signbits = 0;
         VectorClear(p->normal);
@@ -1494,6 +1549,88 @@ void CM_InitBoxHull(void) {
     }
 }
 
+/*
+===================
+CM_SetBoxHullBounds
+
+Moves the box planes, edges and bounds of a box brush to mins/maxs
+===================
+*/
+static void CM_SetBoxHullBounds(cbrush_t *brush, cplane_t *planes,
+                                const vec3_t mins, const vec3_t maxs) {
+    planes[0].dist = maxs[0];
+    planes[1].dist = -maxs[0];
+    planes[2].dist = mins[0];
+    planes[3].dist = -mins[0];
+    planes[4].dist = maxs[1];
+    planes[5].dist = -maxs[1];
+    planes[6].dist = mins[1];
+    planes[7].dist = -mins[1];
+    planes[8].dist = maxs[2];
+    planes[9].dist = -maxs[2];
+    planes[10].dist = mins[2];
+    planes[11].dist = -mins[2];
+
+    // First side
+    VectorSet(brush->edges[0].p0, mins[0], mins[1], mins[2]);
+    VectorSet(brush->edges[0].p1, mins[0], maxs[1], mins[2]);
+    VectorSet(brush->edges[1].p0, mins[0], maxs[1], mins[2]);
+    VectorSet(brush->edges[1].p1, mins[0], maxs[1], maxs[2]);
+    VectorSet(brush->edges[2].p0, mins[0], maxs[1], maxs[2]);
+    VectorSet(brush->edges[2].p1, mins[0], mins[1], maxs[2]);
+    VectorSet(brush->edges[3].p0, mins[0], mins[1], maxs[2]);
+    VectorSet(brush->edges[3].p1, mins[0], mins[1], mins[2]);
+
+    // Opposite side
+    VectorSet(brush->edges[4].p0, maxs[0], mins[1], mins[2]);
+    VectorSet(brush->edges[4].p1, maxs[0], maxs[1], mins[2]);
+    VectorSet(brush->edges[5].p0, maxs[0], maxs[1], mins[2]);
+    VectorSet(brush->edges[5].p1, maxs[0], maxs[1], maxs[2]);
+    VectorSet(brush->edges[6].p0, maxs[0], maxs[1], maxs[2]);
+    VectorSet(brush->edges[6].p1, maxs[0], mins[1], maxs[2]);
+    VectorSet(brush->edges[7].p0, maxs[0], mins[1], maxs[2]);
+    VectorSet(brush->edges[7].p1, maxs[0], mins[1], mins[2]);
+
+    // Connecting edges
+    VectorSet(brush->edges[8].p0, mins[0], mins[1], mins[2]);
+    VectorSet(brush->edges[8].p1, maxs[0], mins[1], mins[2]);
+    VectorSet(brush->edges[9].p0, mins[0], maxs[1], mins[2]);
+    VectorSet(brush->edges[9].p1, maxs[0], maxs[1], mins[2]);
+    VectorSet(brush->edges[10].p0, mins[0], maxs[1], maxs[2]);
+    VectorSet(brush->edges[10].p1, maxs[0], maxs[1], maxs[2]);
+    VectorSet(brush->edges[11].p0, mins[0], mins[1], maxs[2]);
+    VectorSet(brush->edges[11].p1, maxs[0], mins[1], maxs[2]);
+
+    VectorCopy(mins, brush->bounds[0]);
+    VectorCopy(maxs, brush->bounds[1]);
+}
+
+/*
+===================
+CM_InitTraceBoxHull
+
+Builds a private copy of the temp box model on the caller's stack. The leaf
+still references the box brush slot, traces resolve it to hull->brush.
+===================
+*/
+void CM_InitTraceBoxHull(cboxHull_t *hull, const vec3_t mins,
+                         const vec3_t maxs, sint contents) {
+    ::memset(hull, 0, sizeof(*hull));
+
+    VectorCopy(mins, hull->model.mins);
+    VectorCopy(maxs, hull->model.maxs);
+    hull->model.leaf = box_model.leaf;
+
+    hull->brush.numsides = 6;
+    hull->brush.sides = hull->sides;
+    hull->brush.contents = contents;
+    hull->brush.edges = hull->edges;
+    hull->brush.numEdges = 12;
+
+    CM_SetupBoxHullSides(hull->sides, hull->planes);
+    CM_SetBoxHullBounds(&hull->brush, hull->planes, mins, maxs);
+}
+
 /*
 ===================
 idCollisionModelManagerLocal::TempBoxModel
@@ -1513,51 +1650,7 @@ clipHandle_t idCollisionModelManagerLocal::TempBoxModel(const vec3_t mins,
         return CAPSULE_MODEL_HANDLE;
     }
 
-    box_planes[0].dist = maxs[0];
-    box_planes[1].dist = -maxs[0];
-    box_planes[2].dist = mins[0];
-    box_planes[3].dist = -mins[0];
-    box_planes[4].dist = maxs[1];
-    box_planes[5].dist = -maxs[1];
-    box_planes[6].dist = mins[1];
-    box_planes[7].dist = -mins[1];
-    box_planes[8].dist = maxs[2];
-    box_planes[9].dist = -maxs[2];
-    box_planes[10].dist = mins[2];
-    box_planes[11].dist = -mins[2];
-
-    // First side
-    VectorSet(box_brush->edges[0].p0, mins[0], mins[1], mins[2]);
-    VectorSet(box_brush->edges[0].p1, mins[0], maxs[1], mins[2]);
-    VectorSet(box_brush->edges[1].p0, mins[0], maxs[1], mins[2]);
-    VectorSet(box_brush->edges[1].p1, mins[0], maxs[1], maxs[2]);
-    VectorSet(box_brush->edges[2].p0, mins[0], maxs[1], maxs[2]);
-    VectorSet(box_brush->edges[2].p1, mins[0], mins[1], maxs[2]);
-    VectorSet(box_brush->edges[3].p0, mins[0], mins[1], maxs[2]);
-    VectorSet(box_brush->edges[3].p1, mins[0], mins[1], mins[2]);
-
-    // Opposite side
-    VectorSet(box_brush->edges[4].p0, maxs[0], mins[1], mins[2]);
-    VectorSet(box_brush->edges[4].p1, maxs[0], maxs[1], mins[2]);
-    VectorSet(box_brush->edges[5].p0, maxs[0], maxs[1], mins[2]);
-    VectorSet(box_brush->edges[5].p1, maxs[0], maxs[1], maxs[2]);
-    VectorSet(box_brush->edges[6].p0, maxs[0], maxs[1], maxs[2]);
-    VectorSet(box_brush->edges[6].p1, maxs[0], mins[1], maxs[2]);
-    VectorSet(box_brush->edges[7].p0, maxs[0], mins[1], maxs[2]);
-    VectorSet(box_brush->edges[7].p1, maxs[0], mins[1], mins[2]);
-
-    // Connecting edges
-    VectorSet(box_brush->edges[8].p0, mins[0], mins[1], mins[2]);
-    VectorSet(box_brush->edges[8].p1, maxs[0], mins[1], mins[2]);
-    VectorSet(box_brush->edges[9].p0, mins[0], maxs[1], mins[2]);
-    VectorSet(box_brush->edges[9].p1, maxs[0], maxs[1], mins[2]);
-    VectorSet(box_brush->edges[10].p0, mins[0], maxs[1], maxs[2]);
-    VectorSet(box_brush->edges[10].p1, maxs[0], maxs[1], maxs[2]);
-    VectorSet(box_brush->edges[11].p0, mins[0], mins[1], maxs[2]);
-    VectorSet(box_brush->edges[11].p1, maxs[0], mins[1], maxs[2]);
-
-    VectorCopy(mins, box_brush->bounds[0]);
-    VectorCopy(maxs, box_brush->bounds[1]);
+    CM_SetBoxHullBounds(box_brush, box_planes, mins, maxs);
 
     return BOX_MODEL_HANDLE;
 }
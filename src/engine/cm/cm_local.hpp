@@ -46,6 +46,14 @@
 // enable to make the collision detection a bunch faster
 #define MRE_OPTIMIZE
 
+// brush planes are also kept in groups of four for the SIMD plane tests
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define CM_SIMD_PLANES
+#endif
+
+// floats per group of four brush planes: x[4] y[4] z[4] dist[4]
+#define BRUSH_PLANE_GROUP_FLOATS    16
+
 typedef struct cbrushedge_s {
     vec3_t          p0;
     vec3_t          p1;
@@ -87,8 +95,7 @@ typedef struct {
     vec3_t          bounds[2];
     sint             numsides;
     cbrushside_t   *sides;
-    sint             checkcount;    // to avoid repeated testings
-    bool            collided;   // marker for optimisation
+    float32        *planeGroups;    // side planes packed by CMod_PackBrushPlanes, nullptr for box brushes
     cbrushedge_t   *edges;
     sint             numEdges;
     bool            physicsprocessed;
@@ -133,8 +140,6 @@ typedef struct {
     sint             numSurfaces;
     cSurface_t     **surfaces;                  // non-patches will be nullptr
     sint             floodvalid;
-    sint
-    checkcount;                    // incremented on each trace
     bool        perPolyCollision;
 } clipMap_t;
 
@@ -144,9 +149,53 @@ typedef struct {
 #define SURFACE_CLIP_EPSILON    ( 0.125f )
 
 extern clipMap_t cm;
-extern sint      c_pointcontents;
-extern sint      c_traces, c_brush_traces, c_patch_traces,
+extern std::atomic<sint> c_pointcontents;
+extern std::atomic<sint> c_traces, c_brush_traces, c_patch_traces,
        c_trisoup_traces;
+extern std::atomic<sint> c_trace_batches, c_batch_traces;
+
+// temp box hull owned by a single trace, so that box traces don't have to
+// go through the shared box_model / box_brush of TempBoxModel
+typedef struct {
+    cmodel_t        model;
+    cbrush_t        brush;
+    cbrushside_t    sides[6];
+    cplane_t        planes[12];
+    cbrushedge_t    edges[12];
+} cboxHull_t;
+
+void            CM_InitTraceBoxHull(cboxHull_t *hull, const vec3_t mins,
+                                    const vec3_t maxs, sint contents);
+
+// brushes and surfaces already tested by the current trace, stamped with a
+// per-thread generation instead of a global checkcount so that traces can
+// run concurrently. A brush stamped with generation | 1 was also collided
+// against, which replaces the old cbrush_t::collided marker
+typedef struct {
+    uint32         *brushes;    // [cm.numBrushes + 1], last one is the box brush
+    uint32         *surfaces;   // [cm.numSurfaces]
+    uint32          generation; // always even
+} cmVisits_t;
+
+void            CM_BeginVisits(cmVisits_t *visits);
+
+inline bool CM_VisitBrush(cmVisits_t *visits, sint brushnum) {
+    if((visits->brushes[brushnum] & ~1u) == visits->generation) {
+        return false;   // already checked this brush in another leaf
+    }
+
+    visits->brushes[brushnum] = visits->generation;
+    return true;
+}
+
+inline bool CM_VisitSurface(cmVisits_t *visits, sint surfacenum) {
+    if(visits->surfaces[surfacenum] == visits->generation) {
+        return false;   // already checked this surface in another leaf
+    }
+
+    visits->surfaces[surfacenum] = visits->generation;
+    return true;
+}
 
 // cm_test.c
 
@@ -188,6 +237,9 @@ typedef struct {
     biSphere_t      biSphere;
     bool
     testLateralCollision;   // whether or not to test for lateral collision
+    bool            brushCollided;          // set by CM_TraceThroughBrush
+    cmVisits_t      visits;                 // brushes/surfaces already tested
+    const cboxHull_t *boxHull;              // per-trace temp box, or nullptr
 #ifdef MRE_OPTIMIZE
     cplane_t        tracePlane1;
     cplane_t        tracePlane2;
@@ -205,6 +257,7 @@ typedef struct leafList_s {
     vec3_t          bounds[2];
     sint
     lastLeaf;  // for overflows where each leaf can't be stored individually
+    cmVisits_t      visits;     // used by CM_StoreBrushes
     void (*storeLeafs)(struct leafList_s *ll, sint nodenum);
 } leafList_t;
 
@@ -306,6 +359,19 @@ public:
     virtual sint BoxOnPlaneSide(vec3_t emins, vec3_t emaxs, cplane_t *plane);
 
     virtual bool IsBSPSupported(const sint version, const bool dropError);
+
+    virtual void TempBoxTrace(trace_t *results, const vec3_t start,
+                              const vec3_t end, const vec3_t mins, const vec3_t maxs,
+                              const vec3_t boxMins, const vec3_t boxMaxs, sint boxContents,
+                              bool capsule, sint brushmask, const vec3_t origin,
+                              traceType_t type);
+    virtual void BoxTraceBatch(const traceRequest_t *requests, trace_t *results,
+                               sint count);
+    virtual sint TempBoxPointContents(const vec3_t p, const vec3_t boxMins,
+                                      const vec3_t boxMaxs, sint boxContents, const vec3_t origin);
+
+    static void TraceRecord_f(void);
+    static void TraceBench_f(void);
 };
 
 extern idCollisionModelManagerLocal collisionModelManagerLocal;
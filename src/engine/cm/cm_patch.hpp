@@ -107,7 +107,6 @@ typedef struct cSurfaceCollide_s {
 } cSurfaceCollide_t;
 
 typedef struct {
-    sint             checkcount;    // to avoid repeated testings
     sint             surfaceFlags;
     sint             contents;
     cSurfaceCollide_t *sc;
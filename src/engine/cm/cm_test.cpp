@@ -132,12 +132,10 @@ void CM_StoreBrushes(leafList_t *ll, sint nodenum) {
         brushnum = cm.leafbrushes[leaf->firstLeafBrush + k];
         b = &cm.brushes[brushnum];
 
-        if(b->checkcount == cm.checkcount) {
-            continue; // already checked this brush in another leaf
+        if(!CM_VisitBrush(&ll->visits, brushnum)) {
+            continue;
         }
 
-        b->checkcount = cm.checkcount;
-
         for(i = 0; i < 3; i++) {
             if(b->bounds[0][i] >= ll->bounds[1][i] ||
                     b->bounds[1][i] <= ll->bounds[0][i]) {
@@ -215,8 +213,6 @@ sint idCollisionModelManagerLocal::BoxLeafnums(const vec3_t mins,
         const vec3_t maxs, sint *list, sint listsize, sint *lastLeaf) {
     leafList_t ll;
 
-    cm.checkcount++;
-
     VectorCopy(mins, ll.bounds[0]);
     VectorCopy(maxs, ll.bounds[1]);
     ll.count = 0;
@@ -241,7 +237,7 @@ sint CM_BoxBrushes(const vec3_t mins, const vec3_t maxs, cbrush_t **list,
                    sint listsize) {
     leafList_t      ll;
 
-    cm.checkcount++;
+    CM_BeginVisits(&ll.visits);
 
     VectorCopy(mins, ll.bounds[0]);
     VectorCopy(maxs, ll.bounds[1]);
@@ -349,6 +345,36 @@ sint idCollisionModelManagerLocal::TransformedPointContents(const vec3_t p,
     return collisionModelManager->PointContents(p_l, model);
 }
 
+/*
+==================
+idCollisionModelManagerLocal::TempBoxPointContents
+
+PointContents of a temp box at origin without building the shared box
+model, so it may be called from any thread. Matches the plane tests of
+PointContents against the box brush.
+==================
+*/
+sint idCollisionModelManagerLocal::TempBoxPointContents(const vec3_t p,
+        const vec3_t boxMins, const vec3_t boxMaxs, sint boxContents,
+        const vec3_t origin) {
+    sint             i;
+    vec3_t          p_l;
+
+    if(!cm.numNodes) { // map not loaded
+        return 0;
+    }
+
+    VectorSubtract(p, origin, p_l);
+
+    for(i = 0; i < 3; i++) {
+        if(p_l[i] > boxMaxs[i] || p_l[i] < boxMins[i]) {
+            return 0;
+        }
+    }
+
+    return boxContents;
+}
+
 
 
 /*
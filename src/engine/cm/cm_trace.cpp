@@ -181,6 +181,344 @@ float32 SquareRootFloat(float32 number) {
 }
 
 
+/*
+===============================================================================
+
+VISITED SETS
+
+===============================================================================
+*/
+
+typedef struct cmVisitStorage_s {
+    uint32         *brushes;
+    uint32         *surfaces;
+    sint             numBrushes;
+    sint             numSurfaces;
+    uint32          generation;
+
+    ~cmVisitStorage_s(void) {
+        ::free(brushes);
+        ::free(surfaces);
+    }
+} cmVisitStorage_t;
+
+// every thread that traces gets its own stamps, nothing here is shared
+static thread_local cmVisitStorage_t cm_visitStorage;
+
+/*
+================
+CM_GrowVisitStamps
+================
+*/
+static uint32 *CM_GrowVisitStamps(uint32 *stamps, sint *size, sint needed) {
+    if(needed <= *size) {
+        return stamps;
+    }
+
+    stamps = static_cast<uint32 *>(::realloc(stamps,
+                                   needed * sizeof(uint32)));
+
+    if(!stamps) {
+        common->Error(ERR_FATAL, "CM_BeginVisits: failed on %i stamps",
+                      needed);
+    }
+
+    // stale stamps are always older than the current generation, so only
+    // the new tail needs clearing
+    ::memset(stamps + *size, 0, (needed - *size) * sizeof(uint32));
+    *size = needed;
+
+    return stamps;
+}
+
+/*
+================
+CM_BeginVisits
+
+Starts a new visited set for one trace on the calling thread
+================
+*/
+void CM_BeginVisits(cmVisits_t *visits) {
+    cmVisitStorage_t *vs = &cm_visitStorage;
+
+    // one extra brush slot for the temp box brush
+    vs->brushes = CM_GrowVisitStamps(vs->brushes, &vs->numBrushes,
+                                     cm.numBrushes + 1);
+    vs->surfaces = CM_GrowVisitStamps(vs->surfaces, &vs->numSurfaces,
+                                      cm.numSurfaces + 1);
+
+    // generations step by two, the low bit marks collided brushes
+    vs->generation += 2;
+
+    if(!vs->generation) {
+        ::memset(vs->brushes, 0, vs->numBrushes * sizeof(uint32));
+        ::memset(vs->surfaces, 0, vs->numSurfaces * sizeof(uint32));
+        vs->generation = 2;
+    }
+
+    visits->brushes = vs->brushes;
+    visits->surfaces = vs->surfaces;
+    visits->generation = vs->generation;
+}
+
+/*
+================
+CM_LeafBrush
+
+Resolves a leaf brush number, the temp box slot maps to the trace's own box
+================
+*/
+static cbrush_t *CM_LeafBrush(const traceWork_t *tw, sint brushnum) {
+    if(tw->boxHull && brushnum == cm.numBrushes) {
+        return const_cast<cbrush_t *>(&tw->boxHull->brush);
+    }
+
+    return &cm.brushes[brushnum];
+}
+
+/*
+================
+CM_TraceModel
+
+Like CM_ClipHandleToModel, but box and capsule handles resolve to the
+trace's own box when it has one
+================
+*/
+static cmodel_t *CM_TraceModel(const traceWork_t *tw, clipHandle_t model) {
+    if(tw->boxHull && (model == BOX_MODEL_HANDLE ||
+                       model == CAPSULE_MODEL_HANDLE)) {
+        return const_cast<cmodel_t *>(&tw->boxHull->model);
+    }
+
+    return CM_ClipHandleToModel(model);
+}
+
+/*
+===============================================================================
+
+BRUSH PLANE DISTANCES
+
+The plane loops of CM_TestBoxInBrush and CM_TraceThroughBrush first get
+the float32 part of every plane distance for a block of sides, four planes
+at a time from the packed brush planes when SIMD is available. Every lane
+does the same float32 operations in the same order as the scalar code, so
+both paths give bit for bit identical traces. The float64 math and the
+early outs stay in the plane loops.
+
+===============================================================================
+*/
+
+#define BRUSH_PLANE_BLOCK       32      // sides handled per distance pass
+
+enum brushPlaneMode_t {
+    BPM_AABB,       // box offsets picked by the plane signbits
+    BPM_CAPSULE,    // closest capsule sphere, expanded by its radius
+    BPM_BISPHERE    // start/end spheres of differing radius
+};
+
+typedef struct {
+    // d1 = start[i] - startDist[i], d2 = end[i] - endDist[i], in float64
+    float32           start[BRUSH_PLANE_BLOCK];
+    float32           end[BRUSH_PLANE_BLOCK];
+    float32           startDist[BRUSH_PLANE_BLOCK];
+    float32           endDist[BRUSH_PLANE_BLOCK];
+} brushPlaneDists_t;
+
+// tracebench flips this to time and check the scalar path
+static bool cm_scalarPlanes = false;
+
+/*
+================
+CM_BrushPlaneDistancesScalar
+================
+*/
+static void CM_BrushPlaneDistancesScalar(const traceWork_t *tw,
+        const cbrush_t *brush, sint first, sint count, brushPlaneMode_t mode,
+        brushPlaneDists_t *out) {
+    sint             i;
+    const cplane_t *plane;
+    vec3_t          startp, endp;
+    float32           t;
+
+    for(i = 0; i < count; i++) {
+        plane = brush->sides[first + i].plane;
+
+        if(mode == BPM_BISPHERE) {
+            // adjust the plane distance apropriately for radius
+            out->start[i] = DotProduct(tw->start,
+                                       plane->normal) - (plane->dist + tw->biSphere.startRadius);
+            out->end[i] = DotProduct(tw->end,
+                                     plane->normal) - (plane->dist + tw->biSphere.endRadius);
+            out->startDist[i] = out->endDist[i] = 0;
+        } else if(mode == BPM_CAPSULE) {
+            // find the closest point on the capsule to the plane
+            t = DotProduct(plane->normal, tw->sphere.offset);
+
+            if(t > 0) {
+                VectorSubtract(tw->start, tw->sphere.offset, startp);
+                VectorSubtract(tw->end, tw->sphere.offset, endp);
+            } else {
+                VectorAdd(tw->start, tw->sphere.offset, startp);
+                VectorAdd(tw->end, tw->sphere.offset, endp);
+            }
+
+            // adjust the plane distance appropriately for radius
+            out->start[i] = DotProduct(startp, plane->normal);
+            out->end[i] = DotProduct(endp, plane->normal);
+            out->startDist[i] = out->endDist[i] = plane->dist + tw->sphere.radius;
+        } else {
+            // adjust the plane distance appropriately for mins/maxs
+            out->start[i] = DotProduct(tw->start, plane->normal);
+            out->end[i] = DotProduct(tw->end, plane->normal);
+            out->startDist[i] = out->endDist[i] = plane->dist -
+                                                  DotProduct(tw->offsets[plane->signbits], plane->normal);
+        }
+    }
+}
+
+#ifdef CM_SIMD_PLANES
+/*
+================
+CM_BrushPlaneDistancesSSE
+================
+*/
+static void CM_BrushPlaneDistancesSSE(const traceWork_t *tw,
+                                      const cbrush_t *brush, sint first, sint count, brushPlaneMode_t mode,
+                                      brushPlaneDists_t *out) {
+    sint             i;
+    const float32    *group;
+    __m128          zero, nx, ny, nz, dist, t, mask, a, b, c1, c2;
+    __m128          sx, sy, sz, ex, ey, ez, ox, oy, oz;
+    __m128          minx, miny, minz, maxx, maxy, maxz, r1, r2;
+    __m128          psx, psy, psz, pex, pey, pez, msx, msy, msz, mex, mey, mez;
+
+    zero = _mm_setzero_ps();
+
+    sx = _mm_set1_ps(tw->start[0]);
+    sy = _mm_set1_ps(tw->start[1]);
+    sz = _mm_set1_ps(tw->start[2]);
+    ex = _mm_set1_ps(tw->end[0]);
+    ey = _mm_set1_ps(tw->end[1]);
+    ez = _mm_set1_ps(tw->end[2]);
+
+    // per mode constants, the scalar path computes these per plane with
+    // the same float32 operations
+    minx = miny = minz = maxx = maxy = maxz = r1 = r2 = zero;
+    psx = psy = psz = pex = pey = pez = msx = msy = msz = mex = mey = mez = zero;
+    ox = oy = oz = zero;
+
+    if(mode == BPM_BISPHERE) {
+        r1 = _mm_set1_ps(tw->biSphere.startRadius);
+        r2 = _mm_set1_ps(tw->biSphere.endRadius);
+    } else if(mode == BPM_CAPSULE) {
+        ox = _mm_set1_ps(tw->sphere.offset[0]);
+        oy = _mm_set1_ps(tw->sphere.offset[1]);
+        oz = _mm_set1_ps(tw->sphere.offset[2]);
+        r1 = _mm_set1_ps(tw->sphere.radius);
+
+        msx = _mm_set1_ps(tw->start[0] - tw->sphere.offset[0]);
+        msy = _mm_set1_ps(tw->start[1] - tw->sphere.offset[1]);
+        msz = _mm_set1_ps(tw->start[2] - tw->sphere.offset[2]);
+        mex = _mm_set1_ps(tw->end[0] - tw->sphere.offset[0]);
+        mey = _mm_set1_ps(tw->end[1] - tw->sphere.offset[1]);
+        mez = _mm_set1_ps(tw->end[2] - tw->sphere.offset[2]);
+        psx = _mm_set1_ps(tw->start[0] + tw->sphere.offset[0]);
+        psy = _mm_set1_ps(tw->start[1] + tw->sphere.offset[1]);
+        psz = _mm_set1_ps(tw->start[2] + tw->sphere.offset[2]);
+        pex = _mm_set1_ps(tw->end[0] + tw->sphere.offset[0]);
+        pey = _mm_set1_ps(tw->end[1] + tw->sphere.offset[1]);
+        pez = _mm_set1_ps(tw->end[2] + tw->sphere.offset[2]);
+    } else {
+        // offsets[signbits][k] is size[1][k] where the normal is negative
+        minx = _mm_set1_ps(tw->size[0][0]);
+        miny = _mm_set1_ps(tw->size[0][1]);
+        minz = _mm_set1_ps(tw->size[0][2]);
+        maxx = _mm_set1_ps(tw->size[1][0]);
+        maxy = _mm_set1_ps(tw->size[1][1]);
+        maxz = _mm_set1_ps(tw->size[1][2]);
+    }
+
+    // first is always a multiple of four, see BRUSH_PLANE_BLOCK
+    group = brush->planeGroups + (first >> 2) * BRUSH_PLANE_GROUP_FLOATS;
+
+    for(i = 0; i < count; i += 4, group += BRUSH_PLANE_GROUP_FLOATS) {
+        nx = _mm_loadu_ps(group);
+        ny = _mm_loadu_ps(group + 4);
+        nz = _mm_loadu_ps(group + 8);
+        dist = _mm_loadu_ps(group + 12);
+
+        if(mode == BPM_BISPHERE) {
+            a = _mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, nx), _mm_mul_ps(sy, ny)),
+                           _mm_mul_ps(sz, nz));
+            b = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, nx), _mm_mul_ps(ey, ny)),
+                           _mm_mul_ps(ez, nz));
+            a = _mm_sub_ps(a, _mm_add_ps(dist, r1));
+            b = _mm_sub_ps(b, _mm_add_ps(dist, r2));
+            c1 = c2 = zero;
+        } else if(mode == BPM_CAPSULE) {
+            t = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, ox), _mm_mul_ps(ny, oy)),
+                           _mm_mul_ps(nz, oz));
+            mask = _mm_cmpgt_ps(t, zero);
+
+            // pick start - offset where t > 0, start + offset elsewhere
+            a = _mm_add_ps(_mm_add_ps(
+                               _mm_mul_ps(_mm_or_ps(_mm_and_ps(mask, msx), _mm_andnot_ps(mask, psx)), nx),
+                               _mm_mul_ps(_mm_or_ps(_mm_and_ps(mask, msy), _mm_andnot_ps(mask, psy)), ny)),
+                           _mm_mul_ps(_mm_or_ps(_mm_and_ps(mask, msz), _mm_andnot_ps(mask, psz)), nz));
+            b = _mm_add_ps(_mm_add_ps(
+                               _mm_mul_ps(_mm_or_ps(_mm_and_ps(mask, mex), _mm_andnot_ps(mask, pex)), nx),
+                               _mm_mul_ps(_mm_or_ps(_mm_and_ps(mask, mey), _mm_andnot_ps(mask, pey)), ny)),
+                           _mm_mul_ps(_mm_or_ps(_mm_and_ps(mask, mez), _mm_andnot_ps(mask, pez)), nz));
+            c1 = c2 = _mm_add_ps(dist, r1);
+        } else {
+            a = _mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, nx), _mm_mul_ps(sy, ny)),
+                           _mm_mul_ps(sz, nz));
+            b = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, nx), _mm_mul_ps(ey, ny)),
+                           _mm_mul_ps(ez, nz));
+
+            mask = _mm_cmplt_ps(nx, zero);
+            t = _mm_mul_ps(_mm_or_ps(_mm_and_ps(mask, maxx), _mm_andnot_ps(mask, minx)),
+                           nx);
+            mask = _mm_cmplt_ps(ny, zero);
+            t = _mm_add_ps(t, _mm_mul_ps(_mm_or_ps(_mm_and_ps(mask, maxy),
+                                                   _mm_andnot_ps(mask, miny)), ny));
+            mask = _mm_cmplt_ps(nz, zero);
+            t = _mm_add_ps(t, _mm_mul_ps(_mm_or_ps(_mm_and_ps(mask, maxz),
+                                                   _mm_andnot_ps(mask, minz)), nz));
+            c1 = c2 = _mm_sub_ps(dist, t);
+        }
+
+        // the block arrays are padded to whole groups
+        _mm_storeu_ps(out->start + i, a);
+        _mm_storeu_ps(out->end + i, b);
+        _mm_storeu_ps(out->startDist + i, c1);
+        _mm_storeu_ps(out->endDist + i, c2);
+    }
+}
+#endif
+
+/*
+================
+CM_BrushPlaneDistances
+
+Fills out for sides [first, first + count) of the brush
+================
+*/
+static ID_INLINE void CM_BrushPlaneDistances(const traceWork_t *tw,
+        const cbrush_t *brush, sint first, sint count, brushPlaneMode_t mode,
+        brushPlaneDists_t *out) {
+#ifdef CM_SIMD_PLANES
+
+    if(brush->planeGroups && !cm_scalarPlanes) {
+        CM_BrushPlaneDistancesSSE(tw, brush, first, count, mode, out);
+        return;
+    }
+
+#endif
+
+    CM_BrushPlaneDistancesScalar(tw, brush, first, count, mode, out);
+}
+
 /*
 ===============================================================================
 
@@ -195,11 +533,9 @@ CM_TestBoxInBrush
 ================
 */
 static void CM_TestBoxInBrush(traceWork_t *tw, cbrush_t *brush) {
-    sint             i;
-    cplane_t       *plane;
-    float64           dist, d1, t;
-    cbrushside_t   *side;
-    vec3_t          startp;
+    sint             i, j, count;
+    float64           d1;
+    brushPlaneDists_t pd;
 
     if(!brush->numsides) {
         return;
@@ -215,43 +551,20 @@ static void CM_TestBoxInBrush(traceWork_t *tw, cbrush_t *brush) {
         return;
     }
 
-    if(tw->type == TT_CAPSULE) {
-        // the first six planes are the axial planes, so we only
-        // need to test the remainder
-        for(i = 6; i < brush->numsides; i++) {
-            side = brush->sides + i;
-            plane = side->plane;
-
-            // adjust the plane distance apropriately for radius
-            dist = plane->dist + tw->sphere.radius;
-            // find the closest point on the capsule to the plane
-            t = DotProduct(plane->normal, tw->sphere.offset);
-
-            if(t > 0) {
-                VectorSubtract(tw->start, tw->sphere.offset, startp);
-            } else {
-                VectorAdd(tw->start, tw->sphere.offset, startp);
-            }
-
-            d1 = DotProduct(startp, plane->normal) - dist;
+    // the first six planes are the axial planes, so we only
+    // need to test the remainder
+    for(i = 0; i < brush->numsides; i += BRUSH_PLANE_BLOCK) {
+        count = Q_min(brush->numsides - i, BRUSH_PLANE_BLOCK);
 
-            // if completely in front of face, no intersection
-            if(d1 > 0) {
-                return;
-            }
+        if(i + count <= 6) {
+            continue;
         }
-    } else {
-        // the first six planes are the axial planes, so we only
-        // need to test the remainder
-        for(i = 6; i < brush->numsides; i++) {
-            side = brush->sides + i;
-            plane = side->plane;
 
-            // adjust the plane distance apropriately for mins/maxs
-            dist = plane->dist - DotProduct(tw->offsets[plane->signbits],
-                                            plane->normal);
+        CM_BrushPlaneDistances(tw, brush, i, count,
+                               tw->type == TT_CAPSULE ? BPM_CAPSULE : BPM_AABB, &pd);
 
-            d1 = DotProduct(tw->start, plane->normal) - dist;
+        for(j = i < 6 ? 6 - i : 0; j < count; j++) {
+            d1 = static_cast<float64>(pd.start[j]) - pd.startDist[j];
 
             // if completely in front of face, no intersection
             if(d1 > 0) {
@@ -368,20 +681,19 @@ CM_TestInLeaf
 ================
 */
 void CM_TestInLeaf(traceWork_t *tw, cLeaf_t *leaf) {
-    sint             k, brushnum;
+    sint             k, brushnum, surfacenum;
     cbrush_t       *b;
     cSurface_t     *surface;
 
     // test box position against all brushes in the leaf
     for(k = 0; k < leaf->numLeafBrushes; k++) {
         brushnum = cm.leafbrushes[leaf->firstLeafBrush + k];
-        b = &cm.brushes[brushnum];
 
-        if(b->checkcount == cm.checkcount) {
-            continue; // already checked this brush in another leaf
+        if(!CM_VisitBrush(&tw->visits, brushnum)) {
+            continue;
         }
 
-        b->checkcount = cm.checkcount;
+        b = CM_LeafBrush(tw, brushnum);
 
         if(!(b->contents & tw->contents)) {
             continue;
@@ -396,18 +708,17 @@ void CM_TestInLeaf(traceWork_t *tw, cLeaf_t *leaf) {
 
     // test against all surfaces
     for(k = 0; k < leaf->numLeafSurfaces; k++) {
-        surface = cm.surfaces[cm.leafsurfaces[leaf->firstLeafSurface + k]];
+        surfacenum = cm.leafsurfaces[leaf->firstLeafSurface + k];
+        surface = cm.surfaces[surfacenum];
 
         if(!surface) {
             continue;
         }
 
-        if(surface->checkcount == cm.checkcount) {
-            continue; // already checked this surface in another leaf
+        if(!CM_VisitSurface(&tw->visits, surfacenum)) {
+            continue;
         }
 
-        surface->checkcount = cm.checkcount;
-
         if(!(surface->contents & tw->contents)) {
             continue;
         }
@@ -451,8 +762,11 @@ void CM_TestCapsuleInCapsule(traceWork_t *tw, clipHandle_t model) {
     vec3_t          mins, maxs, top, bottom, p1, p2, tmp, offset,
                     symetricSize[2];
     float32           radius, halfwidth, halfheight, offs, r;
+    cmodel_t       *cmod;
 
-    collisionModelManagerLocal.ModelBounds(model, mins, maxs);
+    cmod = CM_TraceModel(tw, model);
+    VectorCopy(cmod->mins, mins);
+    VectorCopy(cmod->maxs, maxs);
 
     VectorAdd(tw->start, tw->sphere.offset, top);
     VectorSubtract(tw->start, tw->sphere.offset, bottom);
@@ -526,12 +840,15 @@ bounding box inside capsule check
 */
 void CM_TestBoundingBoxInCapsule(traceWork_t *tw, clipHandle_t model) {
     vec3_t          mins, maxs, offset, size[2];
-    clipHandle_t    h;
+    cboxHull_t      hull;
+    const cboxHull_t *boxHull;
     cmodel_t       *cmod;
     sint             i;
 
     // mins maxs of the capsule
-    collisionModelManagerLocal.ModelBounds(model, mins, maxs);
+    cmod = CM_TraceModel(tw, model);
+    VectorCopy(cmod->mins, mins);
+    VectorCopy(cmod->maxs, maxs);
 
     // offset for capsule center
     for(i = 0; i < 3; i++) {
@@ -549,11 +866,14 @@ void CM_TestBoundingBoxInCapsule(traceWork_t *tw, clipHandle_t model) {
     VectorSet(tw->sphere.offset, 0, 0, size[1][2] - tw->sphere.radius);
 
     // replace the capsule with the bounding box
-    h = collisionModelManagerLocal.TempBoxModel(tw->size[0], tw->size[1],
-            false);
+    CM_InitTraceBoxHull(&hull, tw->size[0], tw->size[1],
+                        CM_LeafBrush(tw, cm.numBrushes)->contents);
+
     // calculate collision
-    cmod = CM_ClipHandleToModel(h);
-    CM_TestInLeaf(tw, &cmod->leaf);
+    boxHull = tw->boxHull;
+    tw->boxHull = &hull;
+    CM_TestInLeaf(tw, &hull.model.leaf);
+    tw->boxHull = boxHull;
 }
 
 /*
@@ -582,12 +902,8 @@ void CM_PositionTest(traceWork_t *tw) {
     ll.lastLeaf = 0;
     ll.overflowed = false;
 
-    cm.checkcount++;
-
     CM_BoxLeafnums_r(&ll, 0);
 
-    cm.checkcount++;
-
     // test the contents of the leafs
     for(i = 0; i < ll.count; i++) {
         CM_TestInLeaf(tw, &cm.leafs[leafs[i]]);
@@ -616,8 +932,8 @@ CM_TracePointThroughSurfaceCollide
 */
 void CM_TracePointThroughSurfaceCollide(traceWork_t *tw,
                                         const cSurfaceCollide_t *sc) {
-    static bool     frontFacing[SHADER_MAX_TRIANGLES];
-    static float32    intersection[SHADER_MAX_TRIANGLES];
+    static thread_local bool     frontFacing[SHADER_MAX_TRIANGLES];
+    static thread_local float32    intersection[SHADER_MAX_TRIANGLES];
     float32           intersect, offset, d1, d2;
     const cPlane_t *planes;
     const cFacet_t *facet;
@@ -1062,12 +1378,13 @@ CM_TraceThroughBrush
 ================
 */
 void CM_TraceThroughBrush(traceWork_t *tw, cbrush_t *brush) {
-    sint             i;
-    cplane_t       *plane, *clipplane;
-    float64           dist, enterFrac, leaveFrac, d1, d2, f, t;
+    sint             i, j, count;
+    cplane_t       *clipplane;
+    float64           enterFrac, leaveFrac, d1, d2, f;
     bool        getout, startout;
-    cbrushside_t   *side, *leadside;
-    vec3_t          startp, endp;
+    cbrushside_t   *leadside;
+    brushPlaneMode_t mode;
+    brushPlaneDists_t pd;
 
     enterFrac = -1.0;
     leaveFrac = 1.0;
@@ -1085,94 +1402,26 @@ void CM_TraceThroughBrush(traceWork_t *tw, cbrush_t *brush) {
     leadside = nullptr;
 
     if(tw->type == TT_BISPHERE) {
-        //
-        // compare the trace against all planes of the brush
-        // find the latest time the trace crosses a plane towards the interior
-        // and the earliest time the trace crosses a plane towards the exterior
-        //
-        for(i = 0; i < brush->numsides; i++) {
-            side = brush->sides + i;
-            plane = side->plane;
-
-            // adjust the plane distance apropriately for radius
-            d1 = DotProduct(tw->start,
-                            plane->normal) - (plane->dist + tw->biSphere.startRadius);
-            d2 = DotProduct(tw->end,
-                            plane->normal) - (plane->dist + tw->biSphere.endRadius);
-
-            if(d2 > 0) {
-                getout = true;  // endpoint is not in solid
-            }
-
-            if(d1 > 0) {
-                startout = true;
-            }
-
-            // if completely in front of face, no intersection with the entire brush
-            if(d1 > 0 && (d2 >= SURFACE_CLIP_EPSILON || d2 >= d1)) {
-                return;
-            }
-
-            // if it doesn't cross the plane, the plane isn't relevent
-            if(d1 <= 0 && d2 <= 0) {
-                continue;
-            }
-
-            brush->collided = true;
-
-            // crosses face
-            if(d1 > d2) {
-                // enter
-                f = (d1 - SURFACE_CLIP_EPSILON) / (d1 - d2);
-
-                if(f < 0) {
-                    f = 0;
-                }
-
-                if(f > enterFrac) {
-                    enterFrac = f;
-                    clipplane = plane;
-                    leadside = side;
-                }
-            } else {
-                // leave
-                f = (d1 + SURFACE_CLIP_EPSILON) / (d1 - d2);
-
-                if(f > 1) {
-                    f = 1;
-                }
-
-                if(f < leaveFrac) {
-                    leaveFrac = f;
-                }
-            }
-        }
+        mode = BPM_BISPHERE;
     } else if(tw->type == TT_CAPSULE) {
-        //
-        // compare the trace against all planes of the brush
-        // find the latest time the trace crosses a plane towards the interior
-        // and the earliest time the trace crosses a plane towards the exterior
-        //
-        for(i = 0; i < brush->numsides; i++) {
-            side = brush->sides + i;
-            plane = side->plane;
-
-            // adjust the plane distance appropriately for radius
-            dist = plane->dist + tw->sphere.radius;
+        mode = BPM_CAPSULE;
+    } else {
+        mode = BPM_AABB;
+    }
 
-            // find the closest point on the capsule to the plane
-            t = DotProduct(plane->normal, tw->sphere.offset);
+    //
+    // compare the trace against all planes of the brush
+    // find the latest time the trace crosses a plane towards the interior
+    // and the earliest time the trace crosses a plane towards the exterior
+    //
+    for(i = 0; i < brush->numsides; i += BRUSH_PLANE_BLOCK) {
+        count = Q_min(brush->numsides - i, BRUSH_PLANE_BLOCK);
 
-            if(t > 0) {
-                VectorSubtract(tw->start, tw->sphere.offset, startp);
-                VectorSubtract(tw->end, tw->sphere.offset, endp);
-            } else {
-                VectorAdd(tw->start, tw->sphere.offset, startp);
-                VectorAdd(tw->end, tw->sphere.offset, endp);
-            }
+        CM_BrushPlaneDistances(tw, brush, i, count, mode, &pd);
 
-            d1 = DotProduct(startp, plane->normal) - dist;
-            d2 = DotProduct(endp, plane->normal) - dist;
+        for(j = 0; j < count; j++) {
+            d1 = static_cast<float64>(pd.start[j]) - pd.startDist[j];
+            d2 = static_cast<float64>(pd.end[j]) - pd.endDist[j];
 
             if(d2 > 0) {
                 getout = true;  // endpoint is not in solid
@@ -1192,7 +1441,7 @@ void CM_TraceThroughBrush(traceWork_t *tw, cbrush_t *brush) {
                 continue;
             }
 
-            brush->collided = true;
+            tw->brushCollided = true;
 
             // crosses face
             if(d1 > d2) { // enter
@@ -1204,8 +1453,8 @@ void CM_TraceThroughBrush(traceWork_t *tw, cbrush_t *brush) {
 
                 if(f > enterFrac) {
                     enterFrac = f;
-                    clipplane = plane;
-                    leadside = side;
+                    leadside = brush->sides + i + j;
+                    clipplane = leadside->plane;
                 }
             } else { // leave
                 f = (d1 + SURFACE_CLIP_EPSILON) / (d1 - d2);
@@ -1219,106 +1468,44 @@ void CM_TraceThroughBrush(traceWork_t *tw, cbrush_t *brush) {
                 }
             }
         }
-    } else {
-        //
-        // compare the trace against all planes of the brush
-        // find the latest time the trace crosses a plane towards the interior
-        // and the earliest time the trace crosses a plane towards the exterior
-        //
-        for(i = 0; i < brush->numsides; i++) {
-            side = brush->sides + i;
-            plane = side->plane;
+    }
 
-            // adjust the plane distance appropriately for mins/maxs
-            dist = plane->dist - DotProduct(tw->offsets[plane->signbits],
-                                            plane->normal);
+    //
+    // all planes have been checked, and the trace was not
+    // completely outside the brush
+    //
+    if(!startout) { // original point was inside brush
+        tw->trace.startsolid = true;
+
+        if(!getout) {
+            tw->trace.allsolid = true;
+            tw->trace.fraction = 0;
+            tw->trace.contents = brush->contents;
+        }
 
-            d1 = DotProduct(tw->start, plane->normal) - dist;
-            d2 = DotProduct(tw->end, plane->normal) - dist;
+        return;
+    }
 
-            if(d2 > 0) {
-                getout = true;  // endpoint is not in solid
+    if(enterFrac < leaveFrac) {
+        if(enterFrac > -1 && enterFrac < tw->trace.fraction) {
+            if(enterFrac < 0) {
+                enterFrac = 0;
             }
 
-            if(d1 > 0) {
-                startout = true;
-            }
+            tw->trace.fraction = enterFrac;
 
-            // if completely in front of face, no intersection with the entire brush
-            if(d1 > 0 && (d2 >= SURFACE_CLIP_EPSILON || d2 >= d1)) {
-                return;
+            if(clipplane != nullptr) {
+                tw->trace.plane = *clipplane;
             }
 
-            // if it doesn't cross the plane, the plane isn't relevant
-            if(d1 <= 0 && d2 <= 0) {
-                continue;
+            if(leadside != nullptr) {
+                tw->trace.surfaceFlags = leadside->surfaceFlags;
             }
 
-            brush->collided = true;
-
-            // crosses face
-            if(d1 > d2) { // enter
-                f = (d1 - SURFACE_CLIP_EPSILON) / (d1 - d2);
-
-                if(f < 0) {
-                    f = 0;
-                }
-
-                if(f > enterFrac) {
-                    enterFrac = f;
-                    clipplane = plane;
-                    leadside = side;
-                }
-            } else { // leave
-                f = (d1 + SURFACE_CLIP_EPSILON) / (d1 - d2);
-
-                if(f > 1) {
-                    f = 1;
-                }
-
-                if(f < leaveFrac) {
-                    leaveFrac = f;
-                }
-            }
-        }
-    }
-
-    //
-    // all planes have been checked, and the trace was not
-    // completely outside the brush
-    //
-    if(!startout) { // original point was inside brush
-        tw->trace.startsolid = true;
-
-        if(!getout) {
-            tw->trace.allsolid = true;
-            tw->trace.fraction = 0;
-            tw->trace.contents = brush->contents;
-        }
-
-        return;
-    }
-
-    if(enterFrac < leaveFrac) {
-        if(enterFrac > -1 && enterFrac < tw->trace.fraction) {
-            if(enterFrac < 0) {
-                enterFrac = 0;
-            }
-
-            tw->trace.fraction = enterFrac;
-
-            if(clipplane != nullptr) {
-                tw->trace.plane = *clipplane;
-            }
-
-            if(leadside != nullptr) {
-                tw->trace.surfaceFlags = leadside->surfaceFlags;
-            }
-
-            tw->trace.contents = brush->contents;
-        }
-    }
-}
+            tw->trace.contents = brush->contents;
+        }
+    }
+}
 
 /*
 ================
@@ -1412,7 +1599,7 @@ CM_TraceThroughLeaf
 ================
 */
 void CM_TraceThroughLeaf(traceWork_t *tw, cLeaf_t *leaf) {
-    sint             k, brushnum;
+    sint             k, brushnum, surfacenum;
     cbrush_t       *brush;
     cSurface_t     *surface;
     float32 fraction;
@@ -1421,20 +1608,16 @@ void CM_TraceThroughLeaf(traceWork_t *tw, cLeaf_t *leaf) {
     for(k = 0; k < leaf->numLeafBrushes; k++) {
         brushnum = cm.leafbrushes[leaf->firstLeafBrush + k];
 
-        brush = &cm.brushes[brushnum];
-
-        if(brush->checkcount == cm.checkcount) {
-            continue; // already checked this brush in another leaf
+        if(!CM_VisitBrush(&tw->visits, brushnum)) {
+            continue;
         }
 
-        brush->checkcount = cm.checkcount;
+        brush = CM_LeafBrush(tw, brushnum);
 
         if(!(brush->contents & tw->contents)) {
             continue;
         }
 
-        brush->collided = false;
-
         if(!CM_BoundsIntersect(tw->bounds[0], tw->bounds[1], brush->bounds[0],
                                brush->bounds[1])) {
             continue;
@@ -1452,8 +1635,13 @@ void CM_TraceThroughLeaf(traceWork_t *tw, cLeaf_t *leaf) {
 
         fraction = tw->trace.fraction;
 
+        tw->brushCollided = false;
         CM_TraceThroughBrush(tw, brush);
 
+        if(tw->brushCollided) {
+            tw->visits.brushes[brushnum] = tw->visits.generation | 1;
+        }
+
         if(!tw->trace.fraction) {
             tw->trace.lateralFraction = 0.0f;
             return;
@@ -1474,22 +1662,17 @@ void CM_TraceThroughLeaf(traceWork_t *tw, cLeaf_t *leaf) {
 #endif
 
         for(k = 0; k < leaf->numLeafSurfaces; k++) {
-            if(!(cm.surfaces[cm.leafsurfaces[leaf->firstLeafSurface + k]])) {
-                continue;
-            }
-
-            surface = cm.surfaces[cm.leafsurfaces[leaf->firstLeafSurface + k]];
+            surfacenum = cm.leafsurfaces[leaf->firstLeafSurface + k];
+            surface = cm.surfaces[surfacenum];
 
             if(!surface) {
                 continue;
             }
 
-            if(surface->checkcount == cm.checkcount) {
-                continue; // already checked this surface in another leaf
+            if(!CM_VisitSurface(&tw->visits, surfacenum)) {
+                continue;
             }
 
-            surface->checkcount = cm.checkcount;
-
             if(!(surface->contents & tw->contents)) {
                 continue;
             }
@@ -1529,13 +1712,13 @@ void CM_TraceThroughLeaf(traceWork_t *tw, cLeaf_t *leaf) {
         for(k = 0; k < leaf->numLeafBrushes; k++) {
             brushnum = cm.leafbrushes[leaf->firstLeafBrush + k];
 
-            brush = &cm.brushes[brushnum];
-
             // This brush never collided, so don't bother
-            if(!brush->collided) {
+            if(tw->visits.brushes[brushnum] != (tw->visits.generation | 1)) {
                 continue;
             }
 
+            brush = CM_LeafBrush(tw, brushnum);
+
             if(!(brush->contents & tw->contents)) {
                 continue;
             }
@@ -1778,8 +1961,11 @@ void CM_TraceCapsuleThroughCapsule(traceWork_t *tw, clipHandle_t model) {
     vec3_t          mins, maxs, top, bottom, starttop, startbottom, endtop,
                     endbottom, offset, symetricSize[2];
     float32           radius, halfwidth, halfheight, offs, h;
+    cmodel_t       *cmod;
 
-    collisionModelManagerLocal.ModelBounds(model, mins, maxs);
+    cmod = CM_TraceModel(tw, model);
+    VectorCopy(cmod->mins, mins);
+    VectorCopy(cmod->maxs, maxs);
 
     // test trace bounds vs. capsule bounds
     if(tw->bounds[0][0] > maxs[0] + RADIUS_EPSILON ||
@@ -1842,12 +2028,15 @@ bounding box vs. capsule collision
 void CM_TraceBoundingBoxThroughCapsule(traceWork_t *tw,
                                        clipHandle_t model) {
     vec3_t          mins, maxs, offset, size[2];
-    clipHandle_t    h;
+    cboxHull_t      hull;
+    const cboxHull_t *boxHull;
     cmodel_t       *cmod;
     sint             i;
 
     // mins maxs of the capsule
-    collisionModelManagerLocal.ModelBounds(model, mins, maxs);
+    cmod = CM_TraceModel(tw, model);
+    VectorCopy(cmod->mins, mins);
+    VectorCopy(cmod->maxs, maxs);
 
     // offset for capsule center
     for(i = 0; i < 3; i++) {
@@ -1865,12 +2054,14 @@ void CM_TraceBoundingBoxThroughCapsule(traceWork_t *tw,
     VectorSet(tw->sphere.offset, 0, 0, size[1][2] - tw->sphere.radius);
 
     // replace the capsule with the bounding box
-    h = collisionModelManagerLocal.TempBoxModel(tw->size[0], tw->size[1],
-            false);
+    CM_InitTraceBoxHull(&hull, tw->size[0], tw->size[1],
+                        CM_LeafBrush(tw, cm.numBrushes)->contents);
 
     // calculate collision
-    cmod = CM_ClipHandleToModel(h);
-    CM_TraceThroughLeaf(tw, &cmod->leaf);
+    boxHull = tw->boxHull;
+    tw->boxHull = &hull;
+    CM_TraceThroughLeaf(tw, &hull.model.leaf);
+    tw->boxHull = boxHull;
 }
 
 //=========================================================================================
@@ -1992,11 +2183,15 @@ static void CM_TraceThroughTree(traceWork_t *tw, sint num, float32 p1f,
 /*
 ==================
 CM_Trace
+
+Sweeps through the world start at headNode, which must be a node every
+part of the sweep stays on one side of all the way down from the root
 ==================
 */
 static void CM_Trace(trace_t *results, const vec3_t start,
                      const vec3_t end, const vec3_t mins, const vec3_t maxs, clipHandle_t model,
-                     const vec3_t origin, sint brushmask, traceType_t type, sphere_t *sphere) {
+                     const vec3_t origin, sint brushmask, traceType_t type, sphere_t *sphere,
+                     const cboxHull_t *boxHull, sint headNode) {
     sint             i;
     traceWork_t     tw;
     vec3_t          offset;
@@ -2004,10 +2199,7 @@ static void CM_Trace(trace_t *results, const vec3_t start,
     bool            positionTest;
     vec3_t          dir;
     float32             dist;
-
-    cmod = CM_ClipHandleToModel(model);
-
-    cm.checkcount++;            // for multi-check avoidance
+    idProfileScope  profile("CM_Trace");
 
     c_traces++;                 // for statistics, may be zeroed
 
@@ -2017,6 +2209,9 @@ static void CM_Trace(trace_t *results, const vec3_t start,
         1;      // assume it goes the entire distance until shown otherwise
     VectorCopy(origin, tw.modelOrigin);
     tw.type = type;
+    tw.boxHull = boxHull;
+
+    cmod = CM_TraceModel(&tw, model);
 
     if(!cm.numNodes) {
         *results = tw.trace;
@@ -2024,6 +2219,8 @@ static void CM_Trace(trace_t *results, const vec3_t start,
         return; // map not loaded, shouldn't happen
     }
 
+    CM_BeginVisits(&tw.visits);    // for multi-check avoidance
+
     // allow nullptr to be passed in for 0,0,0
     if(!mins) {
         mins = vec3_origin;
@@ -2198,7 +2395,7 @@ static void CM_Trace(trace_t *results, const vec3_t start,
                     CM_TraceThroughLeaf(&tw, &cmod->leaf);
                 }
         } else {
-            CM_TraceThroughTree(&tw, 0, 0, 1, tw.start, tw.end);
+            CM_TraceThroughTree(&tw, headNode, 0, 1, tw.start, tw.end);
         }
     }
 
@@ -2218,6 +2415,303 @@ static void CM_Trace(trace_t *results, const vec3_t start,
     *results = tw.trace;
 }
 
+/*
+===============================================================================
+
+TRACE RECORDING
+
+tracerecord captures the BoxTrace calls made against the loaded map and
+tracebench replays them through the SIMD and the scalar brush plane tests,
+checking that every trace_t comes out bit for bit the same
+
+===============================================================================
+*/
+
+#define TRACE_RECORD_IDENT      ( ( 'R' << 24 ) + ( 'T' << 16 ) + ( 'M' << 8 ) + 'C' )
+#define TRACE_RECORD_VERSION    1
+#define MAX_TRACE_RECORDS       262144
+
+typedef struct {
+    sint             ident;
+    sint             version;
+    valueType       map[MAX_QPATH];
+    sint             numBrushes;     // a recording only replays on its own map
+    sint             numRequests;
+} traceRecordHeader_t;
+
+static std::atomic<bool> cm_traceRecording;
+static std::mutex cm_traceRecordLock;
+static traceRequest_t *cm_traceRecords;
+static sint cm_numTraceRecords;
+static valueType cm_traceRecordPath[MAX_QPATH];
+
+/*
+==================
+CM_RecordTrace
+==================
+*/
+static void CM_RecordTrace(const vec3_t start, const vec3_t end,
+                           const vec3_t mins, const vec3_t maxs, clipHandle_t model, sint brushmask,
+                           traceType_t type) {
+    traceRequest_t *r;
+
+    // temp boxes depend on state that isn't recorded
+    if(model < 0 || model >= cm.numSubModels) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(cm_traceRecordLock);
+
+    if(!cm_traceRecording || cm_numTraceRecords >= MAX_TRACE_RECORDS) {
+        return;
+    }
+
+    r = &cm_traceRecords[cm_numTraceRecords++];
+    VectorCopy(start, r->start);
+    VectorCopy(end, r->end);
+    VectorCopy(mins ? mins : vec3_origin, r->mins);
+    VectorCopy(maxs ? maxs : vec3_origin, r->maxs);
+    r->model = model;
+    r->brushmask = brushmask;
+    r->type = type;
+}
+
+/*
+==================
+idCollisionModelManagerLocal::TraceRecord_f
+
+tracerecord <file> starts recording, tracerecord without arguments
+writes the recorded traces out
+==================
+*/
+void idCollisionModelManagerLocal::TraceRecord_f(void) {
+    traceRecordHeader_t header;
+    uchar8          *buffer;
+    sint             size;
+
+    if(cmdSystem->Argc() > 1) {
+        if(cm_traceRecording) {
+            common->Printf("tracerecord: already recording to %s\n",
+                           cm_traceRecordPath);
+            return;
+        }
+
+        if(!cm.numNodes) {
+            common->Printf("tracerecord: no map loaded\n");
+            return;
+        }
+
+        cm_traceRecords = static_cast<traceRequest_t *>(::malloc(
+                              MAX_TRACE_RECORDS * sizeof(traceRequest_t)));
+
+        if(!cm_traceRecords) {
+            common->Printf("tracerecord: out of memory\n");
+            return;
+        }
+
+        Q_strncpyz(cm_traceRecordPath, cmdSystem->Argv(1),
+                   sizeof(cm_traceRecordPath));
+        COM_DefaultExtension(cm_traceRecordPath, sizeof(cm_traceRecordPath),
+                             ".traces");
+        cm_numTraceRecords = 0;
+        cm_traceRecording = true;
+
+        common->Printf("recording traces to %s\n", cm_traceRecordPath);
+        return;
+    }
+
+    if(!cm_traceRecording) {
+        common->Printf("usage: tracerecord <file>, tracerecord again to stop\n");
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(cm_traceRecordLock);
+        cm_traceRecording = false;
+    }
+
+    ::memset(&header, 0, sizeof(header));
+    header.ident = LittleLong(TRACE_RECORD_IDENT);
+    header.version = LittleLong(TRACE_RECORD_VERSION);
+    Q_strncpyz(header.map, cm.name, sizeof(header.map));
+    header.numBrushes = LittleLong(cm.numBrushes);
+    header.numRequests = LittleLong(cm_numTraceRecords);
+
+    size = sizeof(header) + cm_numTraceRecords * sizeof(traceRequest_t);
+    buffer = static_cast<uchar8 *>(::malloc(size));
+
+    if(buffer) {
+        ::memcpy(buffer, &header, sizeof(header));
+        ::memcpy(buffer + sizeof(header), cm_traceRecords,
+                 cm_numTraceRecords * sizeof(traceRequest_t));
+        fileSystem->WriteFile(cm_traceRecordPath, buffer, size);
+        ::free(buffer);
+
+        common->Printf("wrote %i traces to %s\n", cm_numTraceRecords,
+                       cm_traceRecordPath);
+    } else {
+        common->Printf("tracerecord: out of memory\n");
+    }
+
+    ::free(cm_traceRecords);
+    cm_traceRecords = nullptr;
+    cm_numTraceRecords = 0;
+}
+
+/*
+==================
+CM_ReplayTraces
+==================
+*/
+static sint CM_ReplayTraces(const traceRequest_t *requests, trace_t *results,
+                            sint count, sint iterations, bool scalar) {
+    sint             i, j, start;
+    const traceRequest_t *r;
+
+    cm_scalarPlanes = scalar;
+    start = idsystem->Milliseconds();
+
+    for(i = 0; i < iterations; i++) {
+        for(j = 0, r = requests; j < count; j++, r++) {
+            CM_Trace(&results[j], r->start, r->end, r->mins, r->maxs, r->model,
+                     vec3_origin, r->brushmask, r->type, nullptr, nullptr, 0);
+        }
+    }
+
+    cm_scalarPlanes = false;
+
+    return Q_max(idsystem->Milliseconds() - start, 1);
+}
+
+/*
+==================
+CM_TracesMatch
+
+Field by field, the padding of the malloced results is never written
+==================
+*/
+static bool CM_TracesMatch(const trace_t *a, const trace_t *b) {
+    return a->allsolid == b->allsolid && a->startsolid == b->startsolid &&
+           a->fraction == b->fraction && VectorCompare(a->endpos, b->endpos) &&
+           VectorCompare(a->plane.normal, b->plane.normal) &&
+           a->plane.dist == b->plane.dist && a->plane.type == b->plane.type &&
+           a->plane.signbits == b->plane.signbits &&
+           a->surfaceFlags == b->surfaceFlags &&
+           a->contents == b->contents && a->entityNum == b->entityNum &&
+           a->lateralFraction == b->lateralFraction;
+}
+
+/*
+==================
+idCollisionModelManagerLocal::TraceBench_f
+
+tracebench <file>
+Replays a tracerecord capture on the same map with the scalar and the
+SIMD brush plane tests, checks the results match and prints the timings
+==================
+*/
+void idCollisionModelManagerLocal::TraceBench_f(void) {
+    traceRecordHeader_t *header;
+    traceRequest_t  *requests;
+    trace_t         *scalarResults, *simdResults;
+    valueType        path[MAX_QPATH];
+    void            *buffer;
+    sint             i, length, count, iterations, mismatches, scalarTime,
+                     simdTime;
+
+    if(cmdSystem->Argc() < 2) {
+        common->Printf("usage: tracebench <file>\n");
+        return;
+    }
+
+    if(cm_traceRecording) {
+        common->Printf("tracebench: stop tracerecord first\n");
+        return;
+    }
+
+    Q_strncpyz(path, cmdSystem->Argv(1), sizeof(path));
+    COM_DefaultExtension(path, sizeof(path), ".traces");
+
+    length = fileSystem->ReadFile(path, &buffer);
+
+    if(length < static_cast<sint>(sizeof(traceRecordHeader_t)) || !buffer) {
+        common->Printf("tracebench: couldn't load %s\n", path);
+        return;
+    }
+
+    header = static_cast<traceRecordHeader_t *>(buffer);
+    count = LittleLong(header->numRequests);
+
+    if(LittleLong(header->ident) != TRACE_RECORD_IDENT ||
+            LittleLong(header->version) != TRACE_RECORD_VERSION || count < 0 ||
+            length < static_cast<sint>(sizeof(*header) + count * sizeof(
+                                           traceRequest_t))) {
+        common->Printf("tracebench: %s is not a trace recording\n", path);
+        fileSystem->FreeFile(buffer);
+        return;
+    }
+
+    if(Q_stricmp(header->map, cm.name) ||
+            LittleLong(header->numBrushes) != cm.numBrushes) {
+        common->Printf("tracebench: %s was recorded on %s, load that map first\n",
+                       path, header->map);
+        fileSystem->FreeFile(buffer);
+        return;
+    }
+
+    requests = reinterpret_cast<traceRequest_t *>(header + 1);
+    scalarResults = static_cast<trace_t *>(::malloc(Q_max(count,
+                                           1) * sizeof(trace_t)));
+    simdResults = static_cast<trace_t *>(::malloc(Q_max(count,
+                                         1) * sizeof(trace_t)));
+
+    if(!scalarResults || !simdResults) {
+        common->Printf("tracebench: out of memory\n");
+        ::free(simdResults);
+        ::free(scalarResults);
+        fileSystem->FreeFile(buffer);
+        return;
+    }
+
+    for(i = 0; i < count; i++) {
+        if(requests[i].model < 0 || requests[i].model >= cm.numSubModels) {
+            common->Printf("tracebench: bad model in trace %i\n", i);
+            count = 0;
+            break;
+        }
+    }
+
+    // one pass each to compare, then enough passes for stable timings
+    CM_ReplayTraces(requests, scalarResults, count, 1, true);
+    CM_ReplayTraces(requests, simdResults, count, 1, false);
+
+    mismatches = 0;
+
+    for(i = 0; i < count; i++) {
+        if(!CM_TracesMatch(&scalarResults[i], &simdResults[i])) {
+            if(!mismatches) {
+                common->Printf("tracebench: trace %i differs, fraction %f vs %f\n", i,
+                               scalarResults[i].fraction, simdResults[i].fraction);
+            }
+
+            mismatches++;
+        }
+    }
+
+    iterations = count ? Q_max(1, 1000000 / count) : 0;
+    scalarTime = CM_ReplayTraces(requests, scalarResults, count, iterations,
+                                 true);
+    simdTime = CM_ReplayTraces(requests, simdResults, count, iterations, false);
+
+    common->Printf("%i traces x %i: scalar %i msec, simd %i msec (%.2fx), %i mismatches\n",
+                   count, iterations, scalarTime, simdTime,
+                   static_cast<float32>(scalarTime) / simdTime, mismatches);
+
+    ::free(simdResults);
+    ::free(scalarResults);
+    fileSystem->FreeFile(buffer);
+}
+
 /*
 ==================
 idCollisionModelManagerLocal::BoxTrace
@@ -2226,22 +2720,26 @@ idCollisionModelManagerLocal::BoxTrace
 void idCollisionModelManagerLocal::BoxTrace(trace_t *results,
         const vec3_t start, const vec3_t end, const vec3_t mins, const vec3_t maxs,
         clipHandle_t model, sint brushmask, traceType_t type) {
+    if(cm_traceRecording) {
+        CM_RecordTrace(start, end, mins, maxs, model, brushmask, type);
+    }
+
     CM_Trace(results, start, end, mins, maxs, model, vec3_origin, brushmask,
-             type, nullptr);
+             type, nullptr, nullptr, 0);
 }
 
 /*
 ==================
-idCollisionModelManagerLocal::TransformedBoxTrace
+CM_TransformedBoxTrace
 
 Handles offseting and rotation of the end points for moving and
 rotating entities
 ==================
 */
-void idCollisionModelManagerLocal::TransformedBoxTrace(trace_t *results,
-        const vec3_t start, const vec3_t end, const vec3_t mins, const vec3_t maxs,
-        clipHandle_t model, sint brushmask, const vec3_t origin,
-        const vec3_t angles, traceType_t type) {
+static void CM_TransformedBoxTrace(trace_t *results, const vec3_t start,
+                                   const vec3_t end, const vec3_t mins, const vec3_t maxs,
+                                   clipHandle_t model, sint brushmask, const vec3_t origin,
+                                   const vec3_t angles, traceType_t type, const cboxHull_t *boxHull) {
     trace_t         trace;
     vec3_t          start_l, end_l;
     vec3_t          startRotated, endRotated;
@@ -2335,7 +2833,7 @@ void idCollisionModelManagerLocal::TransformedBoxTrace(trace_t *results,
 
     // sweep the box through the model
     CM_Trace(&trace, startRotated, endRotated, symetricSize[0],
-             symetricSize[1], model, origin, brushmask, type, &sphere);
+             symetricSize[1], model, origin, brushmask, type, &sphere, boxHull, 0);
 
     // if the bmodel was rotated and there was a collision
     if(rotated && trace.fraction != 1.0) {
@@ -2353,6 +2851,308 @@ void idCollisionModelManagerLocal::TransformedBoxTrace(trace_t *results,
     *results = trace;
 }
 
+/*
+==================
+idCollisionModelManagerLocal::TransformedBoxTrace
+==================
+*/
+void idCollisionModelManagerLocal::TransformedBoxTrace(trace_t *results,
+        const vec3_t start, const vec3_t end, const vec3_t mins, const vec3_t maxs,
+        clipHandle_t model, sint brushmask, const vec3_t origin,
+        const vec3_t angles, traceType_t type) {
+    CM_TransformedBoxTrace(results, start, end, mins, maxs, model, brushmask,
+                           origin, angles, type, nullptr);
+}
+
+/*
+==================
+CM_SetupTempBoxTrace
+
+The part of CM_TransformedBoxTrace and CM_Trace the temp box sweeps need:
+the moving box made symmetric around its center and the sweep moved into
+the space of the box. Returns true for a position test.
+==================
+*/
+static bool CM_SetupTempBoxTrace(const vec3_t start, const vec3_t end,
+                                 const vec3_t mins, const vec3_t maxs, const vec3_t origin,
+                                 vec3_t twStart, vec3_t twEnd, vec3_t size[2], sphere_t *sphere) {
+    sint             i;
+    vec3_t          offset, symetricSize[2], startRotated, endRotated;
+    float32           halfwidth, halfheight;
+
+    if(!mins) {
+        mins = vec3_origin;
+    }
+
+    if(!maxs) {
+        maxs = vec3_origin;
+    }
+
+    for(i = 0; i < 3; i++) {
+        offset[i] = (mins[i] + maxs[i]) * 0.5f;
+        symetricSize[0][i] = mins[i] - offset[i];
+        symetricSize[1][i] = maxs[i] - offset[i];
+        startRotated[i] = (start[i] + offset[i]) - origin[i];
+        endRotated[i] = (end[i] + offset[i]) - origin[i];
+    }
+
+    halfwidth = symetricSize[1][0];
+    halfheight = symetricSize[1][2];
+
+    sphere->use = false;
+    sphere->radius = (halfwidth > halfheight) ? halfheight : halfwidth;
+    sphere->halfheight = halfheight;
+    VectorSet(sphere->offset, 0, 0, halfheight - sphere->radius);
+
+    // CM_Trace centers the (already symmetric) size once more
+    for(i = 0; i < 3; i++) {
+        offset[i] = (symetricSize[0][i] + symetricSize[1][i]) * 0.5f;
+        size[0][i] = symetricSize[0][i] - offset[i];
+        size[1][i] = symetricSize[1][i] - offset[i];
+        twStart[i] = startRotated[i] + offset[i];
+        twEnd[i] = endRotated[i] + offset[i];
+    }
+
+    return startRotated[0] == endRotated[0] && startRotated[1] == endRotated[1] &&
+           startRotated[2] == endRotated[2];
+}
+
+/*
+==================
+CM_TraceTempBox
+
+Analytic sweep of an axis aligned box against an axis aligned temp box.
+Tests the six box planes in the order and with the float32/float64 math
+of CM_TraceThroughBrush and CM_TestBoxInBrush, without building the box
+brush or walking its leaf, so the trace_t comes out the same.
+==================
+*/
+static void CM_TraceTempBox(trace_t *results, const vec3_t start,
+                            const vec3_t end, const vec3_t mins, const vec3_t maxs,
+                            const vec3_t boxMins, const vec3_t boxMaxs, sint boxContents,
+                            sint brushmask, const vec3_t origin) {
+    sint             i, axis, leadside;
+    vec3_t          twStart, twEnd, size[2];
+    float32           sign, planeDist, startDist, endDist;
+    float64           enterFrac, leaveFrac, d1, d2, f;
+    bool            getout, startout;
+    sphere_t        sphere;
+    trace_t         trace;
+
+    c_traces++;
+
+    ::memset(&trace, 0, sizeof(trace));
+    trace.fraction = 1;
+
+    if(cm.numNodes && (boxContents & brushmask)) {
+        if(CM_SetupTempBoxTrace(start, end, mins, maxs, origin, twStart, twEnd,
+                                size, &sphere)) {
+            // position test, only the brush bounds matter for a box
+            for(i = 0; i < 3; i++) {
+                if(twStart[i] + size[0][i] > boxMaxs[i] ||
+                        twStart[i] + size[1][i] < boxMins[i]) {
+                    break;
+                }
+            }
+
+            if(i == 3) {
+                trace.startsolid = trace.allsolid = true;
+                trace.fraction = 0;
+                trace.contents = boxContents;
+            }
+        } else {
+            c_brush_traces++;
+
+            enterFrac = -1.0;
+            leaveFrac = 1.0;
+            leadside = -1;
+            getout = startout = false;
+
+            // sides alternate +axis / -axis, see CM_SetupBoxHullSides
+            for(i = 0; i < 6; i++) {
+                axis = i >> 1;
+
+                if(i & 1) {
+                    sign = -1.0f;
+                    planeDist = -boxMins[axis];
+                    startDist = planeDist - (size[1][axis] * sign);
+                } else {
+                    sign = 1.0f;
+                    planeDist = boxMaxs[axis];
+                    startDist = planeDist - (size[0][axis] * sign);
+                }
+
+                endDist = startDist;
+
+                d1 = static_cast<float64>(twStart[axis] * sign) - startDist;
+                d2 = static_cast<float64>(twEnd[axis] * sign) - endDist;
+
+                if(d2 > 0) {
+                    getout = true;  // endpoint is not in solid
+                }
+
+                if(d1 > 0) {
+                    startout = true;
+                }
+
+                // if completely in front of face, no intersection with the entire brush
+                if(d1 > 0 && (d2 >= SURFACE_CLIP_EPSILON || d2 >= d1)) {
+                    break;
+                }
+
+                // if it doesn't cross the plane, the plane isn't relevant
+                if(d1 <= 0 && d2 <= 0) {
+                    continue;
+                }
+
+                if(d1 > d2) { // enter
+                    f = (d1 - SURFACE_CLIP_EPSILON) / (d1 - d2);
+
+                    if(f < 0) {
+                        f = 0;
+                    }
+
+                    if(f > enterFrac) {
+                        enterFrac = f;
+                        leadside = i;
+                    }
+                } else { // leave
+                    f = (d1 + SURFACE_CLIP_EPSILON) / (d1 - d2);
+
+                    if(f > 1) {
+                        f = 1;
+                    }
+
+                    if(f < leaveFrac) {
+                        leaveFrac = f;
+                    }
+                }
+            }
+
+            if(i < 6) {
+                // in front of a face
+            } else if(!startout) { // original point was inside brush
+                trace.startsolid = true;
+
+                if(!getout) {
+                    trace.allsolid = true;
+                    trace.fraction = 0;
+                    trace.contents = boxContents;
+                }
+            } else if(enterFrac < leaveFrac && enterFrac > -1 && enterFrac < 1) {
+                if(enterFrac < 0) {
+                    enterFrac = 0;
+                }
+
+                trace.fraction = enterFrac;
+                trace.contents = boxContents;
+
+                if(leadside != -1) {
+                    axis = leadside >> 1;
+
+                    if(leadside & 1) {
+                        trace.plane.normal[axis] = -1;
+                        trace.plane.dist = -boxMins[axis];
+                        trace.plane.type = static_cast<uchar8>(3 + axis);
+                        trace.plane.signbits = static_cast<uchar8>(1 << axis);
+                    } else {
+                        trace.plane.normal[axis] = 1;
+                        trace.plane.dist = boxMaxs[axis];
+                        trace.plane.type = static_cast<uchar8>(axis);
+                    }
+                }
+            }
+        }
+    }
+
+    VectorLerp(start, end, trace.fraction, trace.endpos);
+
+    *results = trace;
+}
+
+/*
+==================
+CM_TraceTempCapsule
+
+Capsule sweep against a temp capsule. Fills in only what the analytic
+capsule vs. capsule tests read instead of the full CM_Trace setup.
+==================
+*/
+static void CM_TraceTempCapsule(trace_t *results, const vec3_t start,
+                                const vec3_t end, const vec3_t mins, const vec3_t maxs,
+                                const cboxHull_t *hull, const vec3_t origin) {
+    traceWork_t     tw;
+    bool            positionTest;
+
+    c_traces++;
+
+    ::memset(&tw, 0, sizeof(tw));
+    tw.trace.fraction = 1;
+    VectorCopy(origin, tw.modelOrigin);
+    tw.type = TT_CAPSULE;
+    tw.boxHull = hull;
+
+    if(cm.numNodes) {
+        positionTest = CM_SetupTempBoxTrace(start, end, mins, maxs, origin,
+                                            tw.start, tw.end, tw.size, &tw.sphere);
+
+        if(positionTest) {
+            CM_CalcTraceBounds(&tw, false);
+            CM_TestCapsuleInCapsule(&tw, CAPSULE_MODEL_HANDLE);
+        } else {
+            VectorSubtract(tw.end, tw.start, tw.dir);
+            CM_CalcTraceBounds(&tw, true);
+            CM_TraceCapsuleThroughCapsule(&tw, CAPSULE_MODEL_HANDLE);
+        }
+    }
+
+    VectorLerp(start, end, tw.trace.fraction, tw.trace.endpos);
+
+    *results = tw.trace;
+}
+
+/*
+==================
+idCollisionModelManagerLocal::TempBoxTrace
+
+Re-entrant TempBoxModel + SetTempBoxModelContents + TransformedBoxTrace.
+The box lives on this call's stack instead of the shared box model, so
+this may be issued from any thread. Boxes don't rotate. Box vs. box and
+capsule vs. capsule are swept analytically.
+==================
+*/
+void idCollisionModelManagerLocal::TempBoxTrace(trace_t *results,
+        const vec3_t start, const vec3_t end, const vec3_t mins, const vec3_t maxs,
+        const vec3_t boxMins, const vec3_t boxMaxs, sint boxContents, bool capsule,
+        sint brushmask, const vec3_t origin, traceType_t type) {
+    cboxHull_t      hull;
+
+#if !defined(ALWAYS_BBOX_VS_BBOX) && !defined(ALWAYS_CAPSULE_VS_CAPSULE)
+
+    if(!capsule && type == TT_AABB) {
+        CM_TraceTempBox(results, start, end, mins, maxs, boxMins, boxMaxs,
+                        boxContents, brushmask, origin);
+        return;
+    }
+
+#endif
+
+    CM_InitTraceBoxHull(&hull, boxMins, boxMaxs, boxContents);
+
+#if !defined(ALWAYS_BBOX_VS_BBOX) && !defined(ALWAYS_CAPSULE_VS_CAPSULE)
+
+    if(capsule && type == TT_CAPSULE) {
+        CM_TraceTempCapsule(results, start, end, mins, maxs, &hull, origin);
+        return;
+    }
+
+#endif
+
+    CM_TransformedBoxTrace(results, start, end, mins, maxs,
+                           capsule ? CAPSULE_MODEL_HANDLE : BOX_MODEL_HANDLE, brushmask, origin,
+                           vec3_origin, type, &hull);
+}
+
 /*
 ==================
 idCollisionModelManagerLocal::BiSphereTrace
@@ -2368,8 +3168,6 @@ void idCollisionModelManagerLocal::BiSphereTrace(trace_t *results,
 
     cmod = CM_ClipHandleToModel(model);
 
-    cm.checkcount++;            // for multi-check avoidance
-
     c_traces++;                 // for statistics, may be zeroed
 
     // fill in a default trace
@@ -2387,6 +3185,8 @@ void idCollisionModelManagerLocal::BiSphereTrace(trace_t *results,
         return;                 // map not loaded, shouldn't happen
     }
 
+    CM_BeginVisits(&tw.visits);    // for multi-check avoidance
+
     // set basic parms
     tw.contents = mask;
 
@@ -2474,6 +3274,279 @@ void idCollisionModelManagerLocal::TransformedBiSphereTrace(
     *results = trace;
 }
 
+/*
+===============================================================================
+
+BATCHED TRACES
+
+===============================================================================
+*/
+
+#define TRACE_BATCH_GROUP       16      // requests sharing one tree descent
+#define TRACE_BATCH_MIN_THREADED 64     // smaller batches stay on the caller
+
+typedef struct {
+    uint32          key;        // morton code of the sweep center
+    sint             index;      // into the request array
+} traceBatchEntry_t;
+
+typedef struct {
+    const traceRequest_t *requests;
+    trace_t        *results;
+    const traceBatchEntry_t *order;
+    sint             count;
+} traceBatch_t;
+
+typedef struct traceBatchStorage_s {
+    traceBatchEntry_t *entries;
+    sint             numEntries;
+
+    ~traceBatchStorage_s(void) {
+        ::free(entries);
+    }
+} traceBatchStorage_t;
+
+static thread_local traceBatchStorage_t cm_traceBatchStorage;
+
+/*
+==================
+CM_SpreadBits
+
+Spreads the low 10 bits of v three bits apart
+==================
+*/
+static uint32 CM_SpreadBits(uint32 v) {
+    v &= 0x3ff;
+    v = (v | (v << 16)) & 0x030000ff;
+    v = (v | (v << 8)) & 0x0300f00f;
+    v = (v | (v << 4)) & 0x030c30c3;
+    v = (v | (v << 2)) & 0x09249249;
+
+    return v;
+}
+
+/*
+==================
+CM_TraceBatchKey
+
+Morton code of the middle of the sweep inside the world bounds, so that
+sorting by it puts traces through the same part of the tree next to
+each other
+==================
+*/
+static uint32 CM_TraceBatchKey(const traceRequest_t *request) {
+    const cmodel_t *world = &cm.cmodels[0];
+    uint32          q[3];
+    float32           f, size;
+    sint             i;
+
+    for(i = 0; i < 3; i++) {
+        size = world->maxs[i] - world->mins[i];
+        f = (request->start[i] + request->end[i]) * 0.5f - world->mins[i];
+        f = size > 0 ? f * 1023.0f / size : 0;
+
+        q[i] = f <= 0 ? 0 : (f >= 1023.0f ? 1023 : static_cast<uint32>(f));
+    }
+
+    return CM_SpreadBits(q[0]) | (CM_SpreadBits(q[1]) << 1) |
+           (CM_SpreadBits(q[2]) << 2);
+}
+
+/*
+==================
+CM_TraceBatchHeadNode
+
+Walks down from the root for as long as every sweep of the group falls
+entirely on the same side of the node plane, using the same tests as
+CM_TraceThroughTree. Each of those sweeps would have followed exactly
+this path on its own, so the descent is done once for the whole group.
+==================
+*/
+static sint CM_TraceBatchHeadNode(const traceRequest_t *requests,
+                                  const traceBatchEntry_t *order, sint count) {
+    vec3_t          p1[TRACE_BATCH_GROUP], p2[TRACE_BATCH_GROUP],
+                    extents[TRACE_BATCH_GROUP];
+    float32           maxOffset[TRACE_BATCH_GROUP], offset, t1, t2, o;
+    const traceRequest_t *r;
+    const cNode_t  *node;
+    const cplane_t *plane;
+    sint             i, j, num, side, s;
+
+    for(i = 0; i < count; i++) {
+        r = &requests[order[i].index];
+
+        // only plain sweeps through the world walk the tree
+        if(r->model || VectorCompare(r->start, r->end)) {
+            return 0;
+        }
+
+        // same symmetric box CM_Trace builds
+        for(j = 0; j < 3; j++) {
+            o = (r->mins[j] + r->maxs[j]) * 0.5f;
+            extents[i][j] = r->maxs[j] - o;
+            p1[i][j] = r->start[j] + o;
+            p2[i][j] = r->end[j] + o;
+        }
+
+        maxOffset[i] = extents[i][0] + extents[i][1] + extents[i][2];
+    }
+
+    num = 0;
+
+    while(num >= 0) {
+        node = cm.nodes + num;
+        plane = node->plane;
+        side = -1;
+
+        for(i = 0; i < count; i++) {
+            if(plane->type < 3) {
+                t1 = p1[i][plane->type] - plane->dist;
+                t2 = p2[i][plane->type] - plane->dist;
+                offset = extents[i][plane->type];
+            } else {
+                t1 = DotProduct(plane->normal, p1[i]) - plane->dist;
+                t2 = DotProduct(plane->normal, p2[i]) - plane->dist;
+                offset = maxOffset[i];
+            }
+
+            if(t1 >= offset + 1 && t2 >= offset + 1) {
+                s = 0;
+            } else if(t1 < -offset - 1 && t2 < -offset - 1) {
+                s = 1;
+            } else {
+                return num;
+            }
+
+            if(side >= 0 && s != side) {
+                return num;
+            }
+
+            side = s;
+        }
+
+        num = node->children[side];
+    }
+
+    return num;
+}
+
+/*
+==================
+CM_TraceBatchGroup
+==================
+*/
+static void CM_TraceBatchGroup(void *data, sint jobNum) {
+    traceBatch_t   *batch = static_cast<traceBatch_t *>(data);
+    const traceBatchEntry_t *order = batch->order + jobNum * TRACE_BATCH_GROUP;
+    const traceRequest_t *r;
+    sint             i, count, headNode;
+
+    count = batch->count - jobNum * TRACE_BATCH_GROUP;
+
+    if(count > TRACE_BATCH_GROUP) {
+        count = TRACE_BATCH_GROUP;
+    }
+
+    headNode = CM_TraceBatchHeadNode(batch->requests, order, count);
+
+    for(i = 0; i < count; i++) {
+        r = &batch->requests[order[i].index];
+
+        CM_Trace(&batch->results[order[i].index], r->start, r->end, r->mins,
+                 r->maxs, r->model, vec3_origin, r->brushmask, r->type, nullptr,
+                 nullptr, headNode);
+    }
+}
+
+/*
+==================
+CM_CompareTraceBatchEntries
+==================
+*/
+static bool CM_CompareTraceBatchEntries(const traceBatchEntry_t &a,
+                                        const traceBatchEntry_t &b) {
+    return a.key < b.key;
+}
+
+/*
+==================
+idCollisionModelManagerLocal::BoxTraceBatch
+
+Same results as calling BoxTrace on every request. The requests are sorted
+spatially, groups of neighbouring sweeps share the descent from the root
+of the tree and with cm_traceThreads > 1 large batches are spread over the
+job pool. Must not be called from inside a parallel job.
+==================
+*/
+void idCollisionModelManagerLocal::BoxTraceBatch(const traceRequest_t
+        *requests, trace_t *results, sint count) {
+    traceBatchStorage_t *storage = &cm_traceBatchStorage;
+    traceBatch_t    batch;
+    sint             i, numGroups, numThreads;
+
+    if(count <= 0) {
+        return;
+    }
+
+    c_trace_batches++;
+    c_batch_traces += count;
+
+    if(!cm.numNodes) {
+        for(i = 0; i < count; i++) {
+            BoxTrace(&results[i], requests[i].start, requests[i].end,
+                     requests[i].mins, requests[i].maxs, requests[i].model,
+                     requests[i].brushmask, requests[i].type);
+        }
+
+        return;
+    }
+
+    if(storage->numEntries < count) {
+        traceBatchEntry_t *entries = static_cast<traceBatchEntry_t *>(::realloc(
+                                         storage->entries, count * sizeof(traceBatchEntry_t)));
+
+        if(!entries) {
+            common->Error(ERR_FATAL,
+                          "idCollisionModelManagerLocal::BoxTraceBatch: failed on %i requests",
+                          count);
+        }
+
+        storage->entries = entries;
+        storage->numEntries = count;
+    }
+
+    for(i = 0; i < count; i++) {
+        // bad handles have to error out here, not in a job
+        CM_ClipHandleToModel(requests[i].model);
+
+        storage->entries[i].key = CM_TraceBatchKey(&requests[i]);
+        storage->entries[i].index = i;
+    }
+
+    std::sort(storage->entries, storage->entries + count,
+              CM_CompareTraceBatchEntries);
+
+    batch.requests = requests;
+    batch.results = results;
+    batch.order = storage->entries;
+    batch.count = count;
+
+    numGroups = (count + TRACE_BATCH_GROUP - 1) / TRACE_BATCH_GROUP;
+
+#ifndef BSPC
+    numThreads = count >= TRACE_BATCH_MIN_THREADED ? cm_traceThreads->integer :
+                 1;
+
+    parallelJobSystem->Run(CM_TraceBatchGroup, &batch, numGroups,
+                           numThreads);
+#else
+
+    for(i = 0; i < numGroups; i++) {
+        CM_TraceBatchGroup(&batch, i);
+    }
+#endif
+}
+
 /*
 =======================================================================
 DEBUGGING
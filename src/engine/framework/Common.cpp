@@ -60,7 +60,7 @@ sint com_numConsoleLines;
 valueType *com_consoleLines[MAX_CONSOLE_LINES];
 
 // com_speeds times
-sint time_game;
+sint time_game;     // usec
 sint time_frontend; // renderer frontend time
 sint time_backend;  // renderer backend time
 
@@ -1097,23 +1097,23 @@ idCommonLocal::RunAndTimeServerPacket
 =================
 */
 void idCommonLocal::RunAndTimeServerPacket(netadr_t *evFrom, msg_t *buf) {
-    sint             t1, t2, msec;
+    sint64 t1, t2;
+    idProfileScope profile("SV_PacketEvent");
 
     t1 = 0;
 
     if(com_speeds->integer) {
-        t1 = idsystem->Milliseconds();
+        t1 = profilerSystem->Microseconds();
     }
 
     serverMainSystem->PacketEvent(*evFrom, buf);
 
     if(com_speeds->integer) {
-        t2 = idsystem->Milliseconds();
-        msec = t2 - t1;
+        t2 = profilerSystem->Microseconds();
 
         if(com_speeds->integer == 3) {
-            commonLocal.Printf("idServerMainSystemLocal::PacketEvent time: %i\n",
-                               msec);
+            commonLocal.Printf("idServerMainSystemLocal::PacketEvent time: %.3f\n",
+                               (t2 - t1) * 0.001);
         }
     }
 }
@@ -1689,6 +1689,8 @@ void idCommonLocal::Init(valueType *commandLine) {
 
     com_hunkusedvalue = 0;
 
+    profilerSystem->Init();
+
     if(developer && developer->integer) {
         cmdSystem->AddCommand("error", &idCommonLocal::Error_f,
                               "Just throw a fatal error to test error shutdown procedures");
@@ -1696,6 +1698,14 @@ void idCommonLocal::Init(valueType *commandLine) {
                               "A way to force a bus error for development reasons");
         cmdSystem->AddCommand("freeze", &idCommonLocal::Freeze_f,
                               "Just freeze in place for a given number of seconds to test error recovery");
+        cmdSystem->AddCommand("huffbench", &idHuffmanSystemLocal::Benchmark_f,
+                              "Checks the message huffman coder against the bitwise reference and prints its throughput, optionally over a given file");
+        cmdSystem->AddCommand("tracerecord",
+                              &idCollisionModelManagerLocal::TraceRecord_f,
+                              "Records the box traces made against the current map to a file, run again to stop");
+        cmdSystem->AddCommand("tracebench",
+                              &idCollisionModelManagerLocal::TraceBench_f,
+                              "Replays recorded traces with the scalar and SIMD brush plane tests, checks they match and prints the timings");
     }
 
     cmdSystem->AddCommand("quit", &idCommonLocal::Quit_f,
@@ -1908,11 +1918,11 @@ void idCommonLocal::Frame(void) {
     sint msec, minMsec;
     static sint      lastTime;
     sint key;
-    sint timeBeforeFirstEvents;
-    sint timeBeforeServer;
-    sint timeBeforeEvents;
-    sint timeBeforeClient;
-    sint timeAfter;
+    sint64 timeBeforeFirstEvents;
+    sint64 timeBeforeServer;
+    sint64 timeBeforeEvents;
+    sint64 timeBeforeClient;
+    sint64 timeAfter;
     static sint watchdogTime = 0;
     static bool watchWarn = false;
 
@@ -1943,7 +1953,7 @@ void idCommonLocal::Frame(void) {
     // main event loop
     //
     if(com_speeds->integer) {
-        timeBeforeFirstEvents = idsystem->Milliseconds();
+        timeBeforeFirstEvents = profilerSystem->Microseconds();
     }
 
     // we may want to spin here if things are going too fast
@@ -1964,9 +1974,9 @@ void idCommonLocal::Frame(void) {
     do {
         sint timeRemaining = minMsec - msec;
 
-        // The existing idSystemLocal::Sleep implementations aren't really
-        // precise enough to be of use beyond 100fps
-        // FIXME: implement a more precise sleep (RDTSC or something)
+        // idSystemLocal::Sleep isn't precise enough to be of use beyond
+        // 100fps. A dedicated server never waits here, its frames wait in
+        // the network reactor until the usec deadline of the next one
         if(timeRemaining >= 10) {
             idsystem->Sleep(timeRemaining);
         }
@@ -1983,6 +1993,9 @@ void idCommonLocal::Frame(void) {
     cmdBufferSystem->Execute();
     cmdDelaySystem->Frame();
 
+    // deliver the files that finished loading in the background
+    fileSystem->FinishAsyncReads(false);
+
     lastTime = com_frameTime;
 
     // mess with msec if needed
@@ -1993,7 +2006,7 @@ void idCommonLocal::Frame(void) {
     // server side
     //
     if(com_speeds->integer) {
-        timeBeforeServer = idsystem->Milliseconds();
+        timeBeforeServer = profilerSystem->Microseconds();
     }
 
     serverMainSystem->Frame(msec);
@@ -2028,7 +2041,7 @@ void idCommonLocal::Frame(void) {
         // without a frame of latency
         //
         if(com_speeds->integer) {
-            timeBeforeEvents = idsystem->Milliseconds();
+            timeBeforeEvents = profilerSystem->Microseconds();
         }
 
         EventLoop();
@@ -2038,7 +2051,7 @@ void idCommonLocal::Frame(void) {
         // client side
         //
         if(com_speeds->integer) {
-            timeBeforeClient = idsystem->Milliseconds();
+            timeBeforeClient = profilerSystem->Microseconds();
         }
 
 #if !defined (DEDICATED) && !defined (UPDATE_SERVER)
@@ -2046,10 +2059,10 @@ void idCommonLocal::Frame(void) {
 #endif
 
         if(com_speeds->integer) {
-            timeAfter = idsystem->Milliseconds();
+            timeAfter = profilerSystem->Microseconds();
         }
     } else {
-        timeAfter = idsystem->Milliseconds();
+        timeAfter = profilerSystem->Microseconds();
     }
 
     //
@@ -2085,7 +2098,12 @@ void idCommonLocal::Frame(void) {
     // report timing information
     //
     if(com_speeds->integer) {
-        sint             all, sv, sev, cev, cl;
+        sint64           all, sv, sev, cev, cl;
+
+        // a dedicated server never sets the client times
+        if(dedicated->integer) {
+            timeBeforeEvents = timeBeforeClient = timeAfter;
+        }
 
         all = timeAfter - timeBeforeServer;
         sv = timeBeforeEvents - timeBeforeServer;
@@ -2093,11 +2111,11 @@ void idCommonLocal::Frame(void) {
         cev = timeBeforeClient - timeBeforeEvents;
         cl = timeAfter - timeBeforeClient;
         sv -= time_game;
-        cl -= time_frontend + time_backend;
+        cl -= (time_frontend + time_backend) * 1000;
 
-        Printf("frame:%i all:%3i sv:%3i sev:%3i cev:%3i cl:%3i gm:%3i rf:%3i bk:%3i\n",
-               com_frameNumber, all, sv, sev, cev, cl, time_game, time_frontend,
-               time_backend);
+        Printf("frame:%i all:%6.2f sv:%6.2f sev:%6.2f cev:%6.2f cl:%6.2f gm:%6.2f rf:%3i bk:%3i\n",
+               com_frameNumber, all * 0.001, sv * 0.001, sev * 0.001, cev * 0.001,
+               cl * 0.001, time_game * 0.001, time_frontend, time_backend);
     }
 
     //
@@ -2105,20 +2123,29 @@ void idCommonLocal::Frame(void) {
     //
     if(com_showtrace->integer) {
 
-        extern sint c_traces, c_brush_traces, c_patch_traces, c_trisoup_traces;
-        extern sint c_pointcontents;
+        extern std::atomic<sint> c_traces, c_brush_traces, c_patch_traces,
+               c_trisoup_traces;
+        extern std::atomic<sint> c_pointcontents;
+        extern std::atomic<sint> c_trace_batches, c_batch_traces;
 
-        Printf("%4i traces  (%ib %ip %it) %4i points\n", c_traces, c_brush_traces,
-               c_patch_traces, c_trisoup_traces, c_pointcontents);
+        Printf("%4i traces  (%ib %ip %it) %4i points  %4i batched in %i batches\n",
+               c_traces.load(), c_brush_traces.load(), c_patch_traces.load(),
+               c_trisoup_traces.load(), c_pointcontents.load(), c_batch_traces.load(),
+               c_trace_batches.load());
         c_traces = 0;
         c_brush_traces = 0;
         c_patch_traces = 0;
         c_trisoup_traces = 0;
         c_pointcontents = 0;
+        c_trace_batches = 0;
+        c_batch_traces = 0;
     }
 
     com_frameNumber++;
 
+    // fold the zones the threads finished into the profile
+    profilerSystem->EndFrame();
+
     //reset the frame memory stack
     memorySystem->FrameReset();
 }
@@ -2133,6 +2160,9 @@ void idCommonLocal::Shutdown(bool badProfile) {
 
     networkSystem->Shutdown();
 
+    parallelJobSystem->Shutdown();
+    profilerSystem->Shutdown();
+
     collisionModelManager->ClearMap();
 
     if(com_logfile) {
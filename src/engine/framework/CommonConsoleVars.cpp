@@ -202,9 +202,12 @@ convar_t *cm_playerCurveClip;
 convar_t *cm_optimize;
 convar_t *cm_showCurves;
 convar_t *cm_showTriangles;
+convar_t *cm_traceThreads;
 #endif
 
 convar_t *fs_debug;
+convar_t *fs_mmap;
+convar_t *fs_asyncThreads;
 convar_t *fs_homepath;
 convar_t *fs_basepath;
 convar_t *fs_libpath;
@@ -244,6 +247,7 @@ convar_t *showpackets;
 convar_t *showdrop;
 convar_t *net_qport;
 convar_t *net_dropsim;
+convar_t *net_batchIO;
 convar_t *in_keyboardDebug = nullptr;
 convar_t *in_mouse = nullptr;
 convar_t *in_nograb;
@@ -268,6 +272,7 @@ convar_t *com_ignorecrash =
 convar_t *com_pid;      // bani - process id
 
 convar_t *com_speeds;
+convar_t *com_profile;
 convar_t *developer;
 convar_t *dedicated;
 convar_t *timescale;
@@ -357,6 +362,8 @@ convar_t *g_gameType;
 convar_t *g_reloading;
 
 convar_t *sv_showAverageBPS;    // NERVE - SMF - net debugging
+convar_t *sv_snapshotThreads;
+convar_t *sv_deltaCache;
 
 convar_t *sv_wwwDownload;   // server does a www dl redirect
 convar_t *sv_wwwBaseURL;    // base URL for redirect
@@ -413,6 +420,9 @@ convar_t *s_testsound;
 convar_t *s_khz;
 convar_t *s_show;
 convar_t *s_mixahead;
+convar_t *s_mixSIMD;
+convar_t *s_mixThread;
+convar_t *s_streamSize;
 convar_t *s_mixPreStep; //Dushan - not used
 convar_t *s_musicVolume;
 convar_t *s_separation; //Dushan - not used
@@ -758,10 +768,16 @@ void idCommonLocal::InitCommonConsoleVars(void) {
                                     "Showing curved surfaces");
     cm_showTriangles = cvarSystem->Get("cm_showTriangles", "0", CVAR_CHEAT,
                                        "Showing triangles in the surfaces");
+    cm_traceThreads = cvarSystem->Get("cm_traceThreads", "0", CVAR_ARCHIVE,
+                                      "Number of threads used to run large batched traces. 0 or 1 runs them on the calling thread.");
 #endif
 
     fs_debug = cvarSystem->Get("fs_debug", "0", 0,
                                "enables the display of file system messages to the console.");
+    fs_mmap = cvarSystem->Get("fs_mmap", "1", CVAR_ARCHIVE,
+                              "Memory map pk3 files instead of reading them with stdio. Takes effect on fs_restart.");
+    fs_asyncThreads = cvarSystem->Get("fs_asyncThreads", "-1", CVAR_ARCHIVE,
+                                      "Number of threads reading and decoding files for asynchronous loads. -1 uses one per core, 0 reads them on the main thread.");
     fs_copyfiles = cvarSystem->Get("fs_copyfiles", "0", CVAR_INIT,
                                    "Relic/obsolete.!");
     fs_basepath = cvarSystem->Get("fs_basepath",
@@ -863,6 +879,9 @@ void idCommonLocal::InitCommonConsoleVars(void) {
 
     net_dropsim = cvarSystem->Get("net_dropsim", "", CVAR_TEMP, "");
 
+    net_batchIO = cvarSystem->Get("net_batchIO", "1", CVAR_ARCHIVE,
+                                  "Receive and send several packets per syscall where the platform supports it (recvmmsg/sendmmsg). 0=disables;1=enables.");
+
     in_joystickNo = cvarSystem->Get("in_joystickNo", "0", CVAR_ARCHIVE,
                                     "Check whether a user has changed the joystick number");
 
@@ -932,7 +951,9 @@ void idCommonLocal::InitCommonConsoleVars(void) {
     com_dropsim = cvarSystem->Get("com_dropsim", "0", CVAR_CHEAT,
                                   "For testing simulates packet loss during communication drops");
     com_speeds = cvarSystem->Get("com_speeds", "0", 0,
-                                 "Toggle display of frame counter, all, sv, cl, gm, rf, and bk whatever they are");
+                                 "Prints the frame number and the msec spent in the whole frame (all), server (sv), server events (sev), client events (cev), client (cl), game (gm), renderer frontend (rf) and backend (bk)");
+    com_profile = cvarSystem->Get("com_profile", "0", 0,
+                                  "Records the profile zones of every thread for the profile and profile_trace commands");
     com_timedemo = cvarSystem->Get("timedemo", "0", CVAR_CHEAT,
                                    "When set to 1 times a demo and returns frames per second like a benchmark");
     com_cameraMode = cvarSystem->Get("com_cameraMode", "0", CVAR_CHEAT,
@@ -1128,6 +1149,13 @@ void idCommonLocal::InitCommonConsoleVars(void) {
     sv_showAverageBPS = cvarSystem->Get("sv_showAverageBPS", "0", 0,
                                         "BSP Network debugging");  // NERVE - SMF - net debugging
 
+    sv_snapshotThreads = cvarSystem->Get("sv_snapshotThreads", "0",
+                                         CVAR_ARCHIVE,
+                                         "Number of threads used to build and delta encode client snapshots. 0 or 1 builds them on the main thread.");
+
+    sv_deltaCache = cvarSystem->Get("sv_deltaCache", "1", 0,
+                                    "Reuse entity delta encodings between clients that get the same entity change in a frame.");
+
     sv_cs_ServerType = cvarSystem->Get("sv_cs_ServerType", "0", 0,
                                        "Setup server type for the community server. 0: public, 1: public-registered, 2: private.");
     sv_cs_Salt = cvarSystem->Get("sv_cs_Salt", "12345", 0,
@@ -1258,6 +1286,12 @@ void idCommonLocal::InitCommonConsoleVars(void) {
                             "Set the sampling frequency of sounds lower=performance higher=quality");
     s_mixahead = cvarSystem->Get("s_mixahead", "0.2", CVAR_ARCHIVE,
                                  "Set delay before mixing sound samples.");
+    s_mixSIMD = cvarSystem->Get("s_mixSIMD", "1", CVAR_ARCHIVE,
+                                "Toggle mixing sounds with the SSE2/AVX2 kernels when the CPU has them.");
+    s_mixThread = cvarSystem->Get("s_mixThread", "0", CVAR_ARCHIVE | CVAR_LATCH,
+                                  "Toggle mixing sounds on their own thread, so long client frames don't starve the sound buffer (needs snd_restart).");
+    s_streamSize = cvarSystem->Get("s_streamSize", "512", CVAR_ARCHIVE,
+                                   "Decoded size in KB above which a sound is streamed from disk while it plays instead of being kept in memory, 0 keeps every sound in memory.");
 
     s_mixPreStep = cvarSystem->Get("s_mixPreStep", "0.05", CVAR_ARCHIVE,
                                    "Set the prefetching of sound on sound cards that have that power");
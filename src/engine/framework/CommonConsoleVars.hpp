@@ -148,6 +148,7 @@ extern convar_t *cm_forceTriangles;
 extern convar_t *cm_optimize;
 extern convar_t *cm_showCurves;
 extern convar_t *cm_showTriangles;
+extern convar_t *cm_traceThreads;
 #endif
 
 extern convar_t *cl_shownet;
@@ -165,6 +166,7 @@ extern convar_t *com_pid;      //bani
 extern convar_t *developer;
 extern convar_t *dedicated;
 extern convar_t *com_speeds;
+extern convar_t *com_profile;
 extern convar_t *timescale;
 extern convar_t *sv_running;
 extern convar_t *cl_running;
@@ -229,6 +231,8 @@ extern convar_t *sv_allowAnonymous;
 extern convar_t *sv_lanForceRate;
 extern convar_t *sv_onlyVisibleClients;
 extern convar_t *sv_showAverageBPS;    // NERVE - SMF - net debugging
+extern convar_t *sv_snapshotThreads;
+extern convar_t *sv_deltaCache;
 
 extern convar_t *sv_requireValidGuid;
 
@@ -312,6 +316,9 @@ extern convar_t *s_nosound;
 extern convar_t *s_khz;
 extern convar_t *s_show;
 extern convar_t *s_mixahead;
+extern convar_t *s_mixSIMD;
+extern convar_t *s_mixThread;
+extern convar_t *s_streamSize;
 
 extern convar_t *s_testsound;
 extern convar_t *s_separation;
@@ -328,6 +335,7 @@ extern convar_t *com_recommended;
 extern convar_t *com_highSettings;
 extern convar_t *net_qport;
 extern convar_t *net_dropsim;
+extern convar_t *net_batchIO;
 extern convar_t *fixedtime;
 extern convar_t *s_mixPreStep;
 extern convar_t *in_nograb;
@@ -370,6 +378,8 @@ extern convar_t *cl_forceavidemo;
 extern convar_t *cl_autoupdate;
 extern convar_t *fs_homepath;
 extern convar_t *fs_debug;
+extern convar_t *fs_mmap;
+extern convar_t *fs_asyncThreads;
 extern convar_t *fs_restrict;
 extern convar_t *fs_basegame;
 extern convar_t *fs_game;
@@ -222,6 +222,29 @@ static sint fs_packFiles; // total number of files in packs
 static sint fs_fakeChkSum;
 static sint fs_checksumFeed;
 
+static fileIndexEntry_t *fs_fileIndex; // see idFileSystemLocal::BuildFileIndex
+static uint64 fs_fileIndexSize;
+static sint fs_fileIndexCount;
+
+static dirCacheEntry_t *fs_dirCacheDirs; // see idFileSystemLocal::ListDirCache
+static dirCacheEntry_t *fs_dirCacheFiles;
+static valueType *fs_dirCacheNames;
+static sint fs_numDirCacheDirs;
+static sint fs_numDirCacheFiles;
+static sint fs_dirCacheNamesUsed;
+
+static fileView_t fs_fileViews[MAX_FILE_VIEWS]; // see idFileSystemLocal::ReadMappedFile
+
+// see idFileSystemLocal::AsyncReadFile
+static asyncRead_t fs_asyncReads[MAX_ASYNC_READS]; // delivered in issue order
+static sint fs_asyncHead, fs_asyncTail;
+static std::queue<asyncRead_t *> fs_asyncQueue;
+static std::thread fs_asyncReadThreads[MAX_ASYNC_THREADS];
+static sint fs_numAsyncThreads;
+static bool fs_asyncStop;
+static std::mutex fs_asyncMutex;
+static std::condition_variable fs_asyncWake, fs_asyncDone;
+
 idFileSystemLocal fileSystemLocal;
 idFileSystem *fileSystem = &fileSystemLocal;
 
@@ -490,6 +513,9 @@ sint idFileSystemLocal::CreatePath(pointer OSPath_) {
         }
     }
 
+    // the caller is about to create a file
+    ClearDirCache();
+
     return false;
 }
 
@@ -841,6 +867,8 @@ void idFileSystemLocal::SV_Rename(pointer from, pointer to) {
                        to_ospath);
     }
 
+    ClearDirCache();
+
     if(rename(from_ospath, to_ospath)) {
         // Failed, try copying it and deleting the original
         FSCopyFile(from_ospath, to_ospath);
@@ -872,6 +900,8 @@ void idFileSystemLocal::Rename(pointer from, pointer to) {
                        to_ospath);
     }
 
+    ClearDirCache();
+
     if(rename(from_ospath, to_ospath)) {
         // Failed, try copying it and deleting the original
         FSCopyFile(from_ospath, to_ospath);
@@ -1173,6 +1203,519 @@ valueType *idFileSystemLocal::ShiftStr(pointer string, sint shift) {
     return buf;
 }
 
+/*
+===========
+idFileSystemLocal::HashPath
+
+Hash of a whole qpath that ignores case and separator distinctions the
+same way FilenameCompare does. Never returns 0, that marks a free slot.
+===========
+*/
+uint32 idFileSystemLocal::HashPath(pointer name, uint32 seed) {
+    uint32 hash;
+    sint c;
+
+    hash = 2166136261u ^ seed;
+
+    while((c = static_cast<uchar8>(*name++)) != '\0') {
+        if(c >= 'A' && c <= 'Z') {
+            c += ('a' - 'A');
+        }
+
+        if(c == '\\' || c == ':') {
+            c = '/';
+        }
+
+        hash = (hash ^ c) * 16777619u;
+    }
+
+    return hash ? hash : 1;
+}
+
+/*
+===========
+idFileSystemLocal::FindFileIndexSlot
+
+Returns the slot of filename in the pak file index, or the free slot
+where it would go.
+===========
+*/
+fileIndexEntry_t *idFileSystemLocal::FindFileIndexSlot(pointer filename,
+        uint32 hash) {
+    fileIndexEntry_t *entry;
+    uint64 i;
+
+    for(i = hash & (fs_fileIndexSize - 1); ; i = (i + 1) & (fs_fileIndexSize - 1)) {
+        entry = &fs_fileIndex[i];
+
+        if(!entry->hash) {
+            return entry;
+        }
+
+        if(entry->hash == hash &&
+                !fileSystemLocal.FilenameCompare(entry->pakFile->name, filename)) {
+            return entry;
+        }
+    }
+}
+
+/*
+===========
+idFileSystemLocal::BuildFileIndex
+
+Indexes every file in the pure paks, so that FOpenFileRead doesn't have
+to look through each pak in turn. Has to be rebuilt whenever the search
+paths or the pure list change.
+===========
+*/
+void idFileSystemLocal::BuildFileIndex(void) {
+    searchpath_t *search;
+    fileIndexEntry_t *entry;
+    fileInPack_t *pakFile;
+    uint32 hash;
+    uint64 count;
+    sint i, order;
+
+    ClearFileIndex();
+
+    count = 0;
+
+    for(search = fs_searchpaths; search; search = search->next) {
+        if(search->pack && PakIsPure(search->pack)) {
+            count += search->pack->numfiles;
+        }
+    }
+
+    // keep the load factor under two thirds
+    fs_fileIndexSize = 1024;
+
+    while(fs_fileIndexSize < count + count / 2) {
+        fs_fileIndexSize <<= 1;
+    }
+
+    fs_fileIndex = static_cast<fileIndexEntry_t *>(memorySystem->Malloc(
+                       fs_fileIndexSize * sizeof(fileIndexEntry_t)));
+    ::memset(fs_fileIndex, 0, fs_fileIndexSize * sizeof(fileIndexEntry_t));
+
+    for(search = fs_searchpaths, order = 0; search;
+            search = search->next, order++) {
+        if(!search->pack || !PakIsPure(search->pack)) {
+            continue;
+        }
+
+        for(i = 0; i < search->pack->numfiles; i++) {
+            pakFile = &search->pack->buildBuffer[i];
+            hash = HashPath(pakFile->name, 0);
+            entry = FindFileIndexSlot(pakFile->name, hash);
+
+            // an earlier search path already has it
+            if(entry->hash) {
+                continue;
+            }
+
+            entry->hash = hash;
+            entry->order = order;
+            entry->pack = search->pack;
+            entry->pakFile = pakFile;
+            fs_fileIndexCount++;
+        }
+    }
+}
+
+/*
+===========
+idFileSystemLocal::ClearFileIndex
+===========
+*/
+void idFileSystemLocal::ClearFileIndex(void) {
+    if(fs_fileIndex) {
+        memorySystem->Free(fs_fileIndex);
+    }
+
+    fs_fileIndex = nullptr;
+    fs_fileIndexSize = 0;
+    fs_fileIndexCount = 0;
+
+    ClearDirCache();
+}
+
+/*
+===========
+idFileSystemLocal::FindDirCacheSlot
+
+Returns the slot of name in one of the directory cache tables, or the
+free slot where it would go. Returns nullptr if the table is full.
+===========
+*/
+dirCacheEntry_t *idFileSystemLocal::FindDirCacheSlot(
+    dirCacheEntry_t *table, sint size, directory_t *dir, pointer name,
+    uint32 hash) {
+    dirCacheEntry_t *entry;
+    sint i, probes;
+
+    for(i = hash & (size - 1), probes = 0; probes < size;
+            i = (i + 1) & (size - 1), probes++) {
+        entry = &table[i];
+
+        if(!entry->hash) {
+            return entry;
+        }
+
+        if(entry->hash == hash && entry->dir == dir &&
+                !fileSystemLocal.FilenameCompare(entry->name, name)) {
+            return entry;
+        }
+    }
+
+    return nullptr;
+}
+
+/*
+===========
+idFileSystemLocal::ListDirCache
+
+Lists subdir of a directory search path into the cache, or returns the
+listing made before. Returns nullptr if the cache is full.
+===========
+*/
+dirCacheEntry_t *idFileSystemLocal::ListDirCache(directory_t *dir,
+        pointer subdir) {
+    dirCacheEntry_t *entry, *fileEntry;
+    valueType *ospath, **list;
+    valueType name[MAX_ZPATH];
+    uint32 hash, dirSeed;
+    sint i, numFiles, len;
+
+    if(!fs_dirCacheDirs) {
+        fs_dirCacheDirs = static_cast<dirCacheEntry_t *>(memorySystem->Malloc(
+                              DIR_CACHE_DIRS * sizeof(dirCacheEntry_t)));
+        fs_dirCacheFiles = static_cast<dirCacheEntry_t *>(memorySystem->Malloc(
+                               DIR_CACHE_FILES * sizeof(dirCacheEntry_t)));
+        fs_dirCacheNames = static_cast<valueType *>(memorySystem->Malloc(
+                               DIR_CACHE_NAMES));
+        ClearDirCache();
+    }
+
+    dirSeed = static_cast<uint32>(reinterpret_cast<uintptr_t>(dir) >> 4);
+    hash = HashPath(subdir, dirSeed);
+    entry = FindDirCacheSlot(fs_dirCacheDirs, DIR_CACHE_DIRS, dir, subdir,
+                             hash);
+
+    if(entry && entry->hash) {
+        return entry;
+    }
+
+    len = strlen(subdir) + 1;
+
+    if(!entry || fs_numDirCacheDirs >= DIR_CACHE_DIRS / 2 ||
+            fs_dirCacheNamesUsed + len > DIR_CACHE_NAMES) {
+        return nullptr;
+    }
+
+    entry->hash = hash;
+    entry->dir = dir;
+    entry->name = fs_dirCacheNames + fs_dirCacheNamesUsed;
+    entry->complete = true;
+    ::memcpy(entry->name, subdir, len);
+    fs_dirCacheNamesUsed += len;
+    fs_numDirCacheDirs++;
+
+    ospath = fileSystemLocal.BuildOSPath(dir->path, dir->gamedir, subdir);
+    list = idsystem->ListFiles(ospath, "", nullptr, &numFiles, false);
+
+    // a truncated listing can't tell that a file is missing
+    if(numFiles >= MAX_FOUND_FILES - 1 ||
+            fs_numDirCacheFiles + numFiles > DIR_CACHE_FILES / 2) {
+        entry->complete = false;
+    }
+
+    for(i = 0; i < numFiles && entry->complete; i++) {
+        if(subdir[0]) {
+            Q_vsprintf_s(name, sizeof(name), sizeof(name), "%s/%s", subdir, list[i]);
+        } else {
+            Q_strncpyz(name, list[i], sizeof(name));
+        }
+
+        len = strlen(name) + 1;
+
+        if(fs_dirCacheNamesUsed + len > DIR_CACHE_NAMES) {
+            entry->complete = false;
+            break;
+        }
+
+        hash = HashPath(name, dirSeed);
+        fileEntry = FindDirCacheSlot(fs_dirCacheFiles, DIR_CACHE_FILES, dir, name,
+                                     hash);
+
+        if(fileEntry->hash) {
+            continue;
+        }
+
+        fileEntry->hash = hash;
+        fileEntry->dir = dir;
+        fileEntry->name = fs_dirCacheNames + fs_dirCacheNamesUsed;
+        fileEntry->complete = true;
+        ::memcpy(fileEntry->name, name, len);
+        fs_dirCacheNamesUsed += len;
+        fs_numDirCacheFiles++;
+    }
+
+    if(list) {
+        idsystem->FreeFileList(list);
+    }
+
+    return entry;
+}
+
+/*
+===========
+idFileSystemLocal::DirCacheHasFile
+
+Returns false if the cached listing shows that filename isn't in the
+directory search path. A true result still has to be confirmed by
+opening the file.
+===========
+*/
+bool idFileSystemLocal::DirCacheHasFile(directory_t *dir,
+                                        pointer filename) {
+    dirCacheEntry_t *entry;
+    valueType subdir[MAX_ZPATH];
+    pointer s, slash;
+    uint32 hash;
+
+    slash = nullptr;
+
+    for(s = filename; *s; s++) {
+        if(*s == '/' || *s == '\\') {
+            slash = s;
+        }
+    }
+
+    if(slash) {
+        if(slash - filename >= static_cast<sint>(sizeof(subdir))) {
+            return true;
+        }
+
+        Q_strncpyz(subdir, filename, slash - filename + 1);
+    } else {
+        subdir[0] = '\0';
+    }
+
+    entry = ListDirCache(dir, subdir);
+
+    if(!entry || !entry->complete) {
+        return true;
+    }
+
+    hash = HashPath(filename, static_cast<uint32>(reinterpret_cast<uintptr_t>
+                    (dir) >> 4));
+    entry = FindDirCacheSlot(fs_dirCacheFiles, DIR_CACHE_FILES, dir, filename,
+                             hash);
+
+    return entry && entry->hash;
+}
+
+/*
+===========
+idFileSystemLocal::ClearDirCache
+
+Forgets the directory listings. Called whenever the file system creates
+a file, files added by other programs show up after an fs_restart.
+===========
+*/
+void idFileSystemLocal::ClearDirCache(void) {
+    if(fs_dirCacheDirs) {
+        ::memset(fs_dirCacheDirs, 0, DIR_CACHE_DIRS * sizeof(dirCacheEntry_t));
+        ::memset(fs_dirCacheFiles, 0, DIR_CACHE_FILES * sizeof(dirCacheEntry_t));
+    }
+
+    fs_numDirCacheDirs = 0;
+    fs_numDirCacheFiles = 0;
+    fs_dirCacheNamesUsed = 0;
+}
+
+/*
+===========
+idFileSystemLocal::OpenFileInPack
+===========
+*/
+sint idFileSystemLocal::OpenFileInPack(pointer filename, fileHandle_t *file,
+                                       bool uniqueFILE, pack_t *pak, fileInPack_t *pakFile) {
+    sint l;
+
+    // mark the pak as having been referenced and mark specifics on cgame and ui
+    // shaders, txt, arena files  by themselves do not count as a reference as
+    // these are loaded from all pk3s
+    // from every pk3 file..
+    l = strlen(filename);
+
+    if(!(pak->referenced & FS_GENERAL_REF)) {
+        if(!fileSystemLocal.IsExt(filename, ".shader", l) &&
+                !fileSystemLocal.IsExt(filename, ".mtr", l) &&
+                !fileSystemLocal.IsExt(filename, ".txt", l) &&
+                !fileSystemLocal.IsExt(filename, ".ttf", l) &&
+                !fileSystemLocal.IsExt(filename, ".otf", l) &&
+                !fileSystemLocal.IsExt(filename, ".cfg", l) &&
+                !fileSystemLocal.IsExt(filename, ".config", l) &&
+                strstr(filename, "levelshots") == nullptr &&
+                !fileSystemLocal.IsExt(filename, ".bot", l) &&
+                !fileSystemLocal.IsExt(filename, ".arena", l) &&
+                !fileSystemLocal.IsExt(filename, ".menu", l)) {
+            // hack to work around issue of com_logfile set and this being first thing logged
+            fsh[*file].handleFiles.file.z = (unzFile) - 1;
+
+            if(developer->integer) {
+                common->Printf("Referencing %s due to file %s opened\n", pak->pakFilename,
+                               filename);
+            }
+
+            fsh[*file].handleFiles.file.z = (unzFile)0;
+            pak->referenced |= FS_GENERAL_REF;
+        }
+    }
+
+    // for OS client/server interoperability, we expect binaries for .so and .dll to be in the same pk3
+    // so that when we reference the DLL files on any platform, this covers everyone else
+
+    // cgame dll
+    if(!(pak->referenced & FS_CGAME_REF) &&
+            !Q_stricmp(filename, idsystem->GetDLLName("cgame"))) {
+        pak->referenced |= FS_CGAME_REF;
+    }
+
+    // gui dll
+    if(!(pak->referenced & FS_UI_REF) &&
+            !Q_stricmp(filename, idsystem->GetDLLName("gui"))) {
+        pak->referenced |= FS_UI_REF;
+    }
+
+    if(uniqueFILE) {
+        // open a new file on the pakfile
+        fsh[*file].handleFiles.file.z = OpenPakFile(pak->pakFilename,
+                                        pak->mapping);
+
+        if(fsh[*file].handleFiles.file.z == nullptr) {
+            common->Error(ERR_FATAL, "Couldn't reopen %s", pak->pakFilename);
+        }
+    } else {
+        fsh[*file].handleFiles.file.z = pak->handle;
+    }
+
+    Q_strncpyz(fsh[*file].name, filename, sizeof(fsh[*file].name));
+    fsh[*file].zipFile = true;
+    fsh[*file].pack = pak;
+
+    // set the file position in the zip file (also sets the current file info)
+    unzSetOffset(fsh[*file].handleFiles.file.z, pakFile->pos);
+
+    // open the file in the zip
+    unzOpenCurrentFile(fsh[*file].handleFiles.file.z);
+    fsh[*file].zipFilePos = pakFile->pos;
+
+    if(fs_debug->integer) {
+        common->Printf("idFileSystemLocal::FOpenFileRead: %s (found in '%s')\n",
+                       filename, pak->pakFilename);
+    }
+
+    // Arnout: let's make this thing work from pakfiles as well
+    // FIXME: doing this seems to break things?
+    /*if ( fs_copyfiles->integer && fs_buildpath->string[0] && Q_stricmpn( fs_buildpath->string, pak->pakFilename, strlen(fs_buildpath->string) ) ) {
+        valueType           copypath[MAX_OSPATH];
+        fileHandle_t    f;
+        uchar8          *srcData;
+        sint                len = zfi->cur_file_info.uncompressed_size;
+
+        Q_strncpyz( copypath, BuildOSPath( fs_buildpath->string, fs_buildgame->string, filename ), sizeof(copypath) );
+        netpath = BuildOSPath( fs_basepath->string, fs_gamedir, filename );
+
+        f = FOpenFileWrite( filename );
+        if ( !f ) {
+            common->Printf( "idFileSystemLocal::FOpenFileRead Failed to open %s for copying\n", filename );
+        } else {
+            srcData = memorySystem->AllocateTempMemory( len) ;
+            Read( srcData, len, *file );
+            Write( srcData, len, f );
+            FCloseFile( f );
+            memorySystem->FreeTempMemory( srcData );
+
+            if (rename( netpath, copypath )) {
+                // Failed, try copying it and deleting the original
+                CopyFile ( netpath, copypath );
+                Remove ( netpath );
+            }
+        }
+    }*/
+
+    return pakFile->len;
+}
+
+/*
+===========
+idFileSystemLocal::OpenFileInDir
+
+Returns -1 if the file can't be read from this directory.
+===========
+*/
+sint idFileSystemLocal::OpenFileInDir(pointer filename, fileHandle_t *file,
+                                      directory_t *dir) {
+    valueType *netpath;
+    sint l;
+
+    // if we are running restricted, or if the filesystem is configured for pure (fs_numServerPaks)
+    // the only files we will allow to come from the directory are .cfg files
+    l = strlen(filename);
+
+    if(fs_restrict->integer || fs_numServerPaks) {
+
+        if(!fileSystemLocal.IsExt(filename, ".cfg", l)     // for config files
+                && !fileSystemLocal.IsExt(filename, ".ttf", l)
+                && !fileSystemLocal.IsExt(filename, ".otf", l)
+                && !fileSystemLocal.IsExt(filename, ".menu", l)    // menu files
+                && !fileSystemLocal.IsExt(filename, ".game", l)    // menu files
+                //&& !fileSystemLocal.IsExt( filename, demoExt, l )  // menu files
+                && !fileSystemLocal.IsExt(filename, ".dat", l)    // for journal files
+                && !fileSystemLocal.IsExt(filename, "bots.txt", l)
+                && !fileSystemLocal.IsExt(filename, ".botents", l)
+          ) {
+            return -1;
+        }
+    }
+
+    if(!DirCacheHasFile(dir, filename)) {
+        return -1;
+    }
+
+    netpath = fileSystemLocal.BuildOSPath(dir->path, dir->gamedir, filename);
+    fsh[*file].handleFiles.file.o = fopen(netpath, "rb");
+
+    if(!fsh[*file].handleFiles.file.o) {
+        return -1;
+    }
+
+    if(!fileSystemLocal.IsExt(filename, ".cfg", l)     // for config files
+            && !fileSystemLocal.IsExt(filename, ".ttf", l)
+            && !fileSystemLocal.IsExt(filename, ".otf", l)
+            && !fileSystemLocal.IsExt(filename, ".menu", l)    // menu files
+            && !fileSystemLocal.IsExt(filename, ".game", l)    // menu files
+            //&& !fileSystemLocal.IsExt( filename, demoExt, l )  // menu files
+            && !fileSystemLocal.IsExt(filename, ".dat", l)    // for journal files
+            && !fileSystemLocal.IsExt(filename, ".botents", l)
+            && !strstr(filename, "botfiles")) {    // RF, need this for dev
+        fs_fakeChkSum = random();
+    }
+
+    Q_strncpyz(fsh[*file].name, filename, sizeof(fsh[*file].name));
+    fsh[*file].zipFile = false;
+
+    if(fs_debug->integer) {
+        common->Printf("idFileSystemLocal::FOpenFileRead: %s (found in '%s/%s')\n",
+                       filename,
+                       dir->path, dir->gamedir);
+    }
+
+    return filelength(*file);
+}
+
 /*
 ===========
 idFileSystemLocal::FOpenFileRead
@@ -1189,10 +1732,11 @@ sint idFileSystemLocal::FOpenFileRead(pointer filename, fileHandle_t *file,
     valueType *netpath;
     pack_t *pak;
     fileInPack_t *pakFile;
+    fileIndexEntry_t *entry;
     directory_t *dir;
     sint32 hash = 0;
     FILE *temp;
-    sint l;
+    sint l, order;
     //valueType demoExt[16];
 
     hash = 0;
@@ -1294,198 +1838,42 @@ sint idFileSystemLocal::FOpenFileRead(pointer filename, fileHandle_t *file,
     *file = HandleForFile();
     fsh[*file].handleFiles.unique = uniqueFILE;
 
-    for(search = fs_searchpaths ; search ; search = search->next) {
-        if(search->pack) {
-            hash = HashFileName(filename, search->pack->hashSize);
-        }
-
-        // is the element a pak file?
-        if(search->pack && search->pack->hashTable[hash]) {
-            if(fs_filter_flag & FS_EXCLUDE_PK3) {
-                continue;
-            }
-
-            // disregard if it doesn't match one of the allowed pure pak files
-            if(!PakIsPure(search->pack)) {
-                continue;
-            }
-
-            // look through all the pak file elements
-            pak = search->pack;
-            pakFile = pak->hashTable[hash];
-
-            do {
-                // case and separator insensitive comparisons
-                if(!FilenameCompare(pakFile->name, filename)) {
-                    // found it!
-
-                    // mark the pak as having been referenced and mark specifics on cgame and ui
-                    // shaders, txt, arena files  by themselves do not count as a reference as
-                    // these are loaded from all pk3s
-                    // from every pk3 file..
-                    l = strlen(filename);
-
-                    if(!(pak->referenced & FS_GENERAL_REF)) {
-                        if(!fileSystemLocal.IsExt(filename, ".shader", l) &&
-                                !fileSystemLocal.IsExt(filename, ".mtr", l) &&
-                                !fileSystemLocal.IsExt(filename, ".txt", l) &&
-                                !fileSystemLocal.IsExt(filename, ".ttf", l) &&
-                                !fileSystemLocal.IsExt(filename, ".otf", l) &&
-                                !fileSystemLocal.IsExt(filename, ".cfg", l) &&
-                                !fileSystemLocal.IsExt(filename, ".config", l) &&
-                                strstr(filename, "levelshots") == nullptr &&
-                                !fileSystemLocal.IsExt(filename, ".bot", l) &&
-                                !fileSystemLocal.IsExt(filename, ".arena", l) &&
-                                !fileSystemLocal.IsExt(filename, ".menu", l)) {
-                            // hack to work around issue of com_logfile set and this being first thing logged
-                            fsh[*file].handleFiles.file.z = (unzFile) - 1;
-
-                            if(developer->integer) {
-                                common->Printf("Referencing %s due to file %s opened\n", pak->pakFilename,
-                                               filename);
-                            }
-
-                            fsh[*file].handleFiles.file.z = (unzFile)0;
-                            pak->referenced |= FS_GENERAL_REF;
-                        }
-                    }
-
-                    // for OS client/server interoperability, we expect binaries for .so and .dll to be in the same pk3
-                    // so that when we reference the DLL files on any platform, this covers everyone else
-
-                    // cgame dll
-                    if(!(pak->referenced & FS_CGAME_REF) &&
-                            !Q_stricmp(filename, idsystem->GetDLLName("cgame"))) {
-                        pak->referenced |= FS_CGAME_REF;
-                    }
-
-                    // gui dll
-                    if(!(pak->referenced & FS_UI_REF) &&
-                            !Q_stricmp(filename, idsystem->GetDLLName("gui"))) {
-                        pak->referenced |= FS_UI_REF;
-                    }
-
-                    if(uniqueFILE) {
-                        // open a new file on the pakfile
-                        fsh[*file].handleFiles.file.z = unzOpen(pak->pakFilename);
-
-                        if(fsh[*file].handleFiles.file.z == nullptr) {
-                            common->Error(ERR_FATAL, "Couldn't reopen %s", pak->pakFilename);
-                        }
-                    } else {
-                        fsh[*file].handleFiles.file.z = pak->handle;
-                    }
-
-                    Q_strncpyz(fsh[*file].name, filename, sizeof(fsh[*file].name));
-                    fsh[*file].zipFile = true;
-
-                    // set the file position in the zip file (also sets the current file info)
-                    unzSetOffset(fsh[*file].handleFiles.file.z, pakFile->pos);
-
-                    // open the file in the zip
-                    unzOpenCurrentFile(fsh[*file].handleFiles.file.z);
-                    fsh[*file].zipFilePos = pakFile->pos;
-
-                    if(fs_debug->integer) {
-                        common->Printf("idFileSystemLocal::FOpenFileRead: %s (found in '%s')\n",
-                                       filename, pak->pakFilename);
-                    }
-
-                    // Arnout: let's make this thing work from pakfiles as well
-                    // FIXME: doing this seems to break things?
-                    /*if ( fs_copyfiles->integer && fs_buildpath->string[0] && Q_stricmpn( fs_buildpath->string, pak->pakFilename, strlen(fs_buildpath->string) ) ) {
-                        valueType           copypath[MAX_OSPATH];
-                        fileHandle_t    f;
-                        uchar8          *srcData;
-                        sint                len = zfi->cur_file_info.uncompressed_size;
-
-                        Q_strncpyz( copypath, BuildOSPath( fs_buildpath->string, fs_buildgame->string, filename ), sizeof(copypath) );
-                        netpath = BuildOSPath( fs_basepath->string, fs_gamedir, filename );
-
-                        f = FOpenFileWrite( filename );
-                        if ( !f ) {
-                            common->Printf( "idFileSystemLocal::FOpenFileRead Failed to open %s for copying\n", filename );
-                        } else {
-                            srcData = memorySystem->AllocateTempMemory( len) ;
-                            Read( srcData, len, *file );
-                            Write( srcData, len, f );
-                            FCloseFile( f );
-                            memorySystem->FreeTempMemory( srcData );
-
-                            if (rename( netpath, copypath )) {
-                                // Failed, try copying it and deleting the original
-                                CopyFile ( netpath, copypath );
-                                Remove ( netpath );
-                            }
-                        }
-                    }*/
-
-                    return pakFile->len;
-                }
-
-                pakFile = pakFile->next;
-            } while(pakFile != nullptr);
-        } else if(search->dir) {
-            if(fs_filter_flag & FS_EXCLUDE_DIR) {
-                continue;
-            }
-
-            // check a file in the directory tree
-
-            // if we are running restricted, or if the filesystem is configured for pure (fs_numServerPaks)
-            // the only files we will allow to come from the directory are .cfg files
-            l = strlen(filename);
-
-            if(fs_restrict->integer || fs_numServerPaks) {
+    if(!fs_fileIndex) {
+        BuildFileIndex();
+    }
 
-                if(!fileSystemLocal.IsExt(filename, ".cfg", l)     // for config files
-                        && !fileSystemLocal.IsExt(filename, ".ttf", l)
-                        && !fileSystemLocal.IsExt(filename, ".otf", l)
-                        && !fileSystemLocal.IsExt(filename, ".menu", l)    // menu files
-                        && !fileSystemLocal.IsExt(filename, ".game", l)    // menu files
-                        //&& !fileSystemLocal.IsExt( filename, demoExt, l )  // menu files
-                        && !fileSystemLocal.IsExt(filename, ".dat", l)    // for journal files
-                        && !fileSystemLocal.IsExt(filename, "bots.txt", l)
-                        && !fileSystemLocal.IsExt(filename, ".botents", l)
-                  ) {
-                    continue;
-                }
-            }
+    // the index has the first pure pak with the file, only directories that
+    // come before it in the search order can still override it
+    entry = nullptr;
 
-            dir = search->dir;
+    if(!(fs_filter_flag & FS_EXCLUDE_PK3)) {
+        entry = FindFileIndexSlot(filename, HashPath(filename, 0));
 
-            netpath = BuildOSPath(dir->path, dir->gamedir, filename);
-            fsh[*file].handleFiles.file.o = fopen(netpath, "rb");
+        if(!entry->hash) {
+            entry = nullptr;
+        }
+    }
 
-            if(!fsh[*file].handleFiles.file.o) {
+    if(!(fs_filter_flag & FS_EXCLUDE_DIR)) {
+        for(search = fs_searchpaths, order = 0; search &&
+                (!entry || order < entry->order); search = search->next, order++) {
+            if(!search->dir) {
                 continue;
             }
 
-            if(!fileSystemLocal.IsExt(filename, ".cfg", l)     // for config files
-                    && !fileSystemLocal.IsExt(filename, ".ttf", l)
-                    && !fileSystemLocal.IsExt(filename, ".otf", l)
-                    && !fileSystemLocal.IsExt(filename, ".menu", l)    // menu files
-                    && !fileSystemLocal.IsExt(filename, ".game", l)    // menu files
-                    //&& !fileSystemLocal.IsExt( filename, demoExt, l )  // menu files
-                    && !fileSystemLocal.IsExt(filename, ".dat", l)    // for journal files
-                    && !fileSystemLocal.IsExt(filename, ".botents", l)
-                    && !strstr(filename, "botfiles")) {    // RF, need this for dev
-                fs_fakeChkSum = random();
-            }
-
-            Q_strncpyz(fsh[*file].name, filename, sizeof(fsh[*file].name));
-            fsh[*file].zipFile = false;
+            l = OpenFileInDir(filename, file, search->dir);
 
-            if(fs_debug->integer) {
-                common->Printf("idFileSystemLocal::FOpenFileRead: %s (found in '%s/%s')\n",
-                               filename,
-                               dir->path, dir->gamedir);
+            if(l >= 0) {
+                return l;
             }
-
-            return filelength(*file);
         }
     }
 
+    if(entry) {
+        return OpenFileInPack(filename, file, uniqueFILE, entry->pack,
+                              entry->pakFile);
+    }
+
     if(developer->integer) {
         common->Printf("Can't find %s\n", filename);
     }
@@ -2073,10 +2461,7 @@ idFileSystemLocal::FileIsInPAK
 ================
 */
 sint idFileSystemLocal::FileIsInPAK(pointer filename, sint *pChecksum) {
-    searchpath_t *search;
-    pack_t *pak;
-    fileInPack_t *pakFile;
-    sint32 hash = 0;
+    fileIndexEntry_t *entry;
 
     if(!fs_searchpaths) {
         common->Error(ERR_FATAL,
@@ -2100,43 +2485,22 @@ sint idFileSystemLocal::FileIsInPAK(pointer filename, sint *pChecksum) {
         return -1;
     }
 
-    //
-    // search through the path, one element at a time
-    //
-
-    for(search = fs_searchpaths ; search ; search = search->next) {
-        //
-        if(search->pack) {
-            hash = HashFileName(filename, search->pack->hashSize);
-        }
-
-        // is the element a pak file?
-        if(search->pack && search->pack->hashTable[hash]) {
-            // disregard if it doesn't match one of the allowed pure pak files
-            if(!PakIsPure(search->pack)) {
-                continue;
-            }
-
-            // look through all the pak file elements
-            pak = search->pack;
-            pakFile = pak->hashTable[hash];
+    if(!fs_fileIndex) {
+        BuildFileIndex();
+    }
 
-            do {
-                // case and separator insensitive comparisons
-                if(!FilenameCompare(pakFile->name, filename)) {
-                    if(pChecksum) {
-                        *pChecksum = pak->pure_checksum;
-                    }
+    // the index has the first pure pak with the file
+    entry = FindFileIndexSlot(filename, HashPath(filename, 0));
 
-                    return 1;
-                }
+    if(!entry->hash) {
+        return -1;
+    }
 
-                pakFile = pakFile->next;
-            } while(pakFile != nullptr);
-        }
+    if(pChecksum) {
+        *pChecksum = entry->pack->pure_checksum;
     }
 
-    return -1;
+    return 1;
 }
 
 /*
@@ -2260,10 +2624,15 @@ sint idFileSystemLocal::ReadFile(pointer qpath, void **buffer) {
         return len;
     }
 
-    buf = static_cast<uchar8 *>(memorySystem->AllocateTempMemory(len + 1));
-    *buffer = buf;
+    if(ReadMappedFile(h, len, &buf)) {
+        *buffer = buf;
+        fs_readCount += len;
+    } else {
+        buf = static_cast<uchar8 *>(memorySystem->AllocateTempMemory(len + 1));
+        *buffer = buf;
 
-    Read(buf, len, h);
+        Read(buf, len, h);
+    }
 
     fs_loadCount++;
     fs_loadStack++;
@@ -2278,77 +2647,363 @@ sint idFileSystemLocal::ReadFile(pointer qpath, void **buffer) {
             common->Printf("Writing %s to journal file.\n", qpath);
         }
 
-        Write(&len, sizeof(len), com_journalDataFile);
-        Write(buf, len, com_journalDataFile);
-        Flush(com_journalDataFile);
-    }
+        Write(&len, sizeof(len), com_journalDataFile);
+        Write(buf, len, com_journalDataFile);
+        Flush(com_journalDataFile);
+    }
+
+    return len;
+}
+
+/*
+=============
+idFileSystemLocal::FreeFile
+=============
+*/
+void idFileSystemLocal::FreeFile(void *buffer) {
+    if(!fs_searchpaths) {
+        common->Error(ERR_FATAL,
+                      "idFileSystemLocal::FreeFile: Filesystem call made without initialization\n");
+    }
+
+    if(!buffer) {
+        common->Error(ERR_FATAL, "idFileSystemLocal::FreeFile( nullptr )");
+    }
+
+    fs_loadStack--;
+
+    if(!FreeFileView(buffer)) {
+        memorySystem->FreeTempMemory(buffer);
+    }
+
+    // if all of our temp files are free, clear all of our space
+    if(fs_loadStack == 0) {
+        memorySystem->ClearTempMemory();
+    }
+}
+
+/*
+============
+idFileSystemLocal::WriteFile
+
+Filename are reletive to the quake search path
+============
+*/
+void idFileSystemLocal::WriteFile(pointer qpath, const void *buffer,
+                                  sint size) {
+    fileHandle_t f;
+
+    if(!fs_searchpaths) {
+        common->Error(ERR_FATAL, "Filesystem call made without initialization\n");
+    }
+
+    if(!qpath || !buffer) {
+        common->Error(ERR_FATAL,
+                      "idFileSystemLocal::WriteFile: nullptr parameter");
+    }
+
+    f = FOpenFileWrite(qpath);
+
+    if(!f) {
+        common->Printf("Failed to open %s\n", qpath);
+        return;
+    }
+
+    Write(buffer, size, f);
+
+    FCloseFile(f);
+}
+
+/*
+==========================================================================
+ZIP FILE LOADING
+==========================================================================
+*/
+
+/*
+=================
+idFileSystemLocal::MapPakFile
+
+Maps a whole pk3 into memory, so reading from it doesn't go through
+stdio. Returns nullptr if the file can't be mapped, the pk3 is then read
+with stdio as before.
+=================
+*/
+pakMapping_t *idFileSystemLocal::MapPakFile(pointer zipfile) {
+#ifndef _WIN32
+    pakMapping_t *mapping;
+    struct stat st;
+    void *base;
+    sint fd;
+
+    if(!fs_mmap->integer) {
+        return nullptr;
+    }
+
+    fd = open(zipfile, O_RDONLY);
+
+    if(fd == -1) {
+        return nullptr;
+    }
+
+    if(fstat(fd, &st) == -1 || st.st_size <= 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    base = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+    if(base == MAP_FAILED) {
+        if(fs_debug->integer) {
+            common->Printf("idFileSystemLocal::MapPakFile: couldn't map %s (%s)\n",
+                           zipfile, strerror(errno));
+        }
+
+        close(fd);
+        return nullptr;
+    }
+
+    mapping = static_cast<pakMapping_t *>(memorySystem->Malloc(sizeof(
+            pakMapping_t)));
+    mapping->filemap.base = static_cast<const uchar8 *>(base);
+    mapping->filemap.size = st.st_size;
+    mapping->fd = fd;
+
+    return mapping;
+#else
+    return nullptr;
+#endif
+}
+
+/*
+=================
+idFileSystemLocal::UnmapPakFile
+=================
+*/
+void idFileSystemLocal::UnmapPakFile(pakMapping_t *mapping) {
+    if(!mapping) {
+        return;
+    }
+
+#ifndef _WIN32
+    munmap(const_cast<uchar8 *>(mapping->filemap.base), mapping->filemap.size);
+    close(mapping->fd);
+#endif
+
+    memorySystem->Free(mapping);
+}
+
+/*
+=================
+idFileSystemLocal::OpenPakFile
+=================
+*/
+unzFile idFileSystemLocal::OpenPakFile(pointer zipfile,
+                                       pakMapping_t *mapping) {
+    zlib_filefunc64_def filefunc;
+
+    if(!mapping) {
+        return unzOpen(zipfile);
+    }
+
+    fill_filemap64_filefunc(&filefunc, &mapping->filemap);
+
+    return unzOpen2_64(zipfile, &filefunc);
+}
+
+/*
+=================
+idFileSystemLocal::MappedFileData
+
+Returns where the data of a file opened from a memory mapped pk3 starts,
+or nullptr if it wasn't opened from one.
+=================
+*/
+const uchar8 *idFileSystemLocal::MappedFileData(fileHandle_t f,
+        unz_file_info64 *info) {
+    pakMapping_t *mapping;
+    uint64 offset;
+
+    if(!fsh[f].zipFile || !fsh[f].pack || !fsh[f].pack->mapping) {
+        return nullptr;
+    }
+
+    mapping = fsh[f].pack->mapping;
+
+    if(unzGetCurrentFileInfo64(fsh[f].handleFiles.file.z, info, nullptr, 0,
+                               nullptr, 0, nullptr, 0) != UNZ_OK) {
+        return nullptr;
+    }
+
+    // encrypted
+    if(info->flag & 1) {
+        return nullptr;
+    }
+
+    offset = unzGetCurrentFileZStreamPos64(fsh[f].handleFiles.file.z);
+
+    // the byte after the data is needed for the trailing 0
+    if(!offset || offset + info->compressed_size >= mapping->filemap.size) {
+        return nullptr;
+    }
+
+    return mapping->filemap.base + offset;
+}
+
+/*
+=================
+idFileSystemLocal::InflateMappedData
+
+Inflates the raw deflate data of a pk3 entry into buffer.
+=================
+*/
+bool idFileSystemLocal::InflateMappedData(const uchar8 *data, uint64 size,
+        uchar8 *buffer, sint len) {
+    z_stream stream;
+    sint err;
+
+    ::memset(&stream, 0, sizeof(stream));
+
+    // there is no zlib header in a zip
+    if(inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+        return false;
+    }
+
+    stream.next_in = const_cast<Bytef *>(data);
+    stream.avail_in = size;
+    stream.next_out = buffer;
+    stream.avail_out = len;
+
+    err = inflate(&stream, Z_FINISH);
+    inflateEnd(&stream);
+
+    return err == Z_STREAM_END && stream.total_out == static_cast<uLong>(len);
+}
+
+/*
+=================
+idFileSystemLocal::ReadMappedFile
+
+ReadFile for large files in a memory mapped pk3. A stored file at an 8
+byte aligned offset gets a private mapping of its own bytes, so nothing is
+copied and the caller may still write to the buffer. A deflated one is
+inflated straight out of the mapping. Returns false if the file has to be
+read the usual way.
+=================
+*/
+bool idFileSystemLocal::ReadMappedFile(fileHandle_t f, sint len,
+                                       uchar8 **buffer) {
+    unz_file_info64 info;
+    const uchar8 *data;
+    uchar8 *buf;
+
+    if(len < MIN_FILE_VIEW_SIZE) {
+        return false;
+    }
+
+    data = MappedFileData(f, &info);
+
+    if(!data) {
+        return false;
+    }
+
+    // the loaders cast the buffer to their structs, so a stored file is only
+    // handed out in place when it is as aligned as the hunk would make it
+    if(info.compression_method == 0 && info.compressed_size == len) {
+#ifndef _WIN32
+        pakMapping_t *mapping = fsh[f].pack->mapping;
+        uint64 offset, pageSize, start, size;
+        void *base;
+        sint i;
+
+        if(reinterpret_cast<uintptr_t>(data) & (sizeof(sint64) - 1)) {
+            return false;
+        }
+
+        for(i = 0; i < MAX_FILE_VIEWS; i++) {
+            if(!fs_fileViews[i].buffer) {
+                break;
+            }
+        }
+
+        if(i == MAX_FILE_VIEWS) {
+            return false;
+        }
+
+        offset = data - mapping->filemap.base;
+        pageSize = sysconf(_SC_PAGESIZE);
+        start = offset & ~(pageSize - 1);
+        size = offset - start + len + 1;
+
+        base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                    mapping->fd, start);
+
+        if(base == MAP_FAILED) {
+            return false;
+        }
+
+        buf = static_cast<uchar8 *>(base) + (offset - start);
 
-    return len;
-}
+        // only this page gets copied
+        buf[len] = 0;
 
-/*
-=============
-idFileSystemLocal::FreeFile
-=============
-*/
-void idFileSystemLocal::FreeFile(void *buffer) {
-    if(!fs_searchpaths) {
-        common->Error(ERR_FATAL,
-                      "idFileSystemLocal::FreeFile: Filesystem call made without initialization\n");
-    }
+        fs_fileViews[i].buffer = buf;
+        fs_fileViews[i].base = base;
+        fs_fileViews[i].size = size;
 
-    if(!buffer) {
-        common->Error(ERR_FATAL, "idFileSystemLocal::FreeFile( nullptr )");
+        *buffer = buf;
+        return true;
+#else
+        return false;
+#endif
     }
 
-    fs_loadStack--;
+    if(info.compression_method != Z_DEFLATED) {
+        return false;
+    }
 
-    memorySystem->FreeTempMemory(buffer);
+    buf = static_cast<uchar8 *>(memorySystem->AllocateTempMemory(len + 1));
 
-    // if all of our temp files are free, clear all of our space
-    if(fs_loadStack == 0) {
-        memorySystem->ClearTempMemory();
+    if(!InflateMappedData(data, info.compressed_size, buf, len)) {
+        memorySystem->FreeTempMemory(buf);
+        return false;
     }
+
+    buf[len] = 0;
+    *buffer = buf;
+
+    return true;
 }
 
 /*
-============
-idFileSystemLocal::WriteFile
+=================
+idFileSystemLocal::FreeFileView
 
-Filename are reletive to the quake search path
-============
+Returns false if buffer isn't a view made by ReadMappedFile.
+=================
 */
-void idFileSystemLocal::WriteFile(pointer qpath, const void *buffer,
-                                  sint size) {
-    fileHandle_t f;
+bool idFileSystemLocal::FreeFileView(void *buffer) {
+    sint i;
 
-    if(!fs_searchpaths) {
-        common->Error(ERR_FATAL, "Filesystem call made without initialization\n");
+    for(i = 0; i < MAX_FILE_VIEWS; i++) {
+        if(fs_fileViews[i].buffer == buffer) {
+            break;
+        }
     }
 
-    if(!qpath || !buffer) {
-        common->Error(ERR_FATAL,
-                      "idFileSystemLocal::WriteFile: nullptr parameter");
+    if(i == MAX_FILE_VIEWS) {
+        return false;
     }
 
-    f = FOpenFileWrite(qpath);
-
-    if(!f) {
-        common->Printf("Failed to open %s\n", qpath);
-        return;
-    }
+#ifndef _WIN32
+    munmap(fs_fileViews[i].base, fs_fileViews[i].size);
+#endif
 
-    Write(buffer, size, f);
+    ::memset(&fs_fileViews[i], 0, sizeof(fs_fileViews[i]));
 
-    FCloseFile(f);
+    return true;
 }
 
-/*
-==========================================================================
-ZIP FILE LOADING
-==========================================================================
-*/
-
 /*
 =================
 idFileSystemLocal::LoadZipFile
@@ -2368,13 +3023,20 @@ pack_t *idFileSystemLocal::LoadZipFile(pointer zipfile, pointer basename) {
     unz_file_info file_info;
     sint32  hash;
     valueType *namePtr;
+    pakMapping_t *mapping;
 
     fs_numHeaderLongs = 0;
 
-    uf = unzOpen(zipfile);
+    mapping = MapPakFile(zipfile);
+    uf = OpenPakFile(zipfile, mapping);
     err = unzGetGlobalInfo(uf, &gi);
 
     if(err != UNZ_OK) {
+        if(uf) {
+            unzClose(uf);
+        }
+
+        UnmapPakFile(mapping);
         return nullptr;
     }
 
@@ -2436,6 +3098,7 @@ pack_t *idFileSystemLocal::LoadZipFile(pointer zipfile, pointer basename) {
     }
 
     pack->handle = uf;
+    pack->mapping = mapping;
     pack->numfiles = gi.number_entry;
     unzGoToFirstFile(uf);
 
@@ -3162,6 +3825,9 @@ void idFileSystemLocal::Path_f(void) {
         }
     }
 
+    common->Printf("%i pak files indexed, %i directories and %i files listed\n",
+                   fs_fileIndexCount, fs_numDirCacheDirs, fs_numDirCacheFiles);
+
     common->Printf("\n");
 
     for(i = 1 ; i < MAX_FILE_HANDLES ; i++) {
@@ -3351,6 +4017,8 @@ void idFileSystemLocal::AddGameDirectory(pointer path, pointer dir) {
         }
     }
 
+    ClearFileIndex();
+
     Q_strncpyz(fs_gamedir, dir, sizeof(fs_gamedir));
 
     // find all pak files in this directory
@@ -3692,6 +4360,13 @@ void idFileSystemLocal::Shutdown(bool closemfp) {
     searchpath_t *p, *next;
     sint i;
 
+    // the reads in flight hold file handles
+    FinishAsyncReads(true);
+
+    if(closemfp) {
+        StopAsyncThreads();
+    }
+
     for(i = 1; i < MAX_FILE_HANDLES; i++) {
         FCloseFile(i);
     }
@@ -3702,6 +4377,7 @@ void idFileSystemLocal::Shutdown(bool closemfp) {
 
         if(p->pack) {
             unzClose(p->pack->handle);
+            UnmapPakFile(p->pack->mapping);
             memorySystem->Free(p->pack->buildBuffer);
             memorySystem->Free(p->pack);
         }
@@ -3716,6 +4392,17 @@ void idFileSystemLocal::Shutdown(bool closemfp) {
     // any idFileSystemLocal:: calls will now be an error until reinitialized
     fs_searchpaths = nullptr;
 
+    ClearFileIndex();
+
+    if(fs_dirCacheDirs) {
+        memorySystem->Free(fs_dirCacheDirs);
+        memorySystem->Free(fs_dirCacheFiles);
+        memorySystem->Free(fs_dirCacheNames);
+        fs_dirCacheDirs = nullptr;
+        fs_dirCacheFiles = nullptr;
+        fs_dirCacheNames = nullptr;
+    }
+
     cmdSystem->RemoveCommand("path");
     cmdSystem->RemoveCommand("dir");
     cmdSystem->RemoveCommand("fdir");
@@ -3777,6 +4464,9 @@ void idFileSystemLocal::ReorderPurePaks(void) {
             p_previous = &s->next;
         }
     }
+
+    // the search order changed
+    ClearFileIndex();
 }
 
 /*
@@ -3879,6 +4569,8 @@ void idFileSystemLocal::Startup(pointer gameName) {
     // reorder the pure pk3 files according to server order
     ReorderPurePaks();
 
+    BuildFileIndex();
+
     //print the current search paths
     if(fs_debug->integer) {
         idFileSystemLocal::Path_f();
@@ -4196,6 +4888,9 @@ void idFileSystemLocal::PureServerSetLoadedPaks(pointer pakSums,
         fs_serverPaks[i] = atoi(cmdSystem->Argv(i));
     }
 
+    // the set of pure paks changed
+    ClearFileIndex();
+
     if(fs_numServerPaks) {
         if(developer->integer) {
             common->Printf("Connected to a pure server.\n");
@@ -4726,3 +5421,336 @@ idFileSystemLocal::GetFullGamePath
 valueType *idFileSystemLocal::GetFullGamePath(valueType *filename) {
     return BuildOSPath(fs_homepath->string, fs_gamedir, filename);
 }
+
+/*
+=================
+idFileSystemLocal::StartAsyncThreads
+=================
+*/
+void idFileSystemLocal::StartAsyncThreads(void) {
+    sint i, numThreads;
+
+    numThreads = fs_asyncThreads->integer;
+
+    // the image prefetch decodes on these threads, so use every core
+    if(numThreads < 0) {
+        numThreads = static_cast<sint>(std::thread::hardware_concurrency());
+    }
+
+    numThreads = Q_min(Q_max(numThreads, 1), MAX_ASYNC_THREADS);
+
+    if(numThreads == fs_numAsyncThreads) {
+        return;
+    }
+
+    StopAsyncThreads();
+
+    for(i = 0; i < numThreads; i++) {
+        fs_asyncReadThreads[i] = std::thread(AsyncReadThread);
+    }
+
+    fs_numAsyncThreads = numThreads;
+}
+
+/*
+=================
+idFileSystemLocal::StopAsyncThreads
+
+Lets the threads finish the reads that are queued and joins them.
+=================
+*/
+void idFileSystemLocal::StopAsyncThreads(void) {
+    sint i;
+
+    if(!fs_numAsyncThreads) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(fs_asyncMutex);
+        fs_asyncStop = true;
+    }
+
+    fs_asyncWake.notify_all();
+
+    for(i = 0; i < fs_numAsyncThreads; i++) {
+        fs_asyncReadThreads[i].join();
+    }
+
+    fs_asyncStop = false;
+    fs_numAsyncThreads = 0;
+}
+
+/*
+=================
+idFileSystemLocal::ReadAsyncData
+
+Reads a queued file into its buffer on an async read thread. Only the
+mapping or the file descriptor is used, so no shared counters are touched
+and nothing can call Error.
+=================
+*/
+bool idFileSystemLocal::ReadAsyncData(asyncRead_t *read) {
+    if(read->data) {
+        if(read->compression == 0) {
+            ::memcpy(read->buffer, read->data, read->len);
+            return true;
+        }
+
+        return InflateMappedData(read->data, read->dataSize, read->buffer,
+                                 read->len);
+    }
+
+#ifndef _WIN32
+    sint64 done, count;
+
+    for(done = 0; done < read->len; done += count) {
+        count = pread(read->fd, read->buffer + done, read->len - done, done);
+
+        if(count < 0 && errno == EINTR) {
+            count = 0;
+            continue;
+        }
+
+        if(count <= 0) {
+            return false;
+        }
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*
+=================
+idFileSystemLocal::AsyncReadThread
+
+Reads and decodes queued files. The file was already found and opened on
+the main thread with its own handle, so nothing here touches the search
+paths, the zone or the hunk. A failed read is delivered without a buffer.
+=================
+*/
+void idFileSystemLocal::AsyncReadThread(void) {
+    asyncRead_t *read;
+
+    while(true) {
+        {
+            std::unique_lock<std::mutex> lock(fs_asyncMutex);
+
+            fs_asyncWake.wait(lock, [] {
+                return fs_asyncStop || !fs_asyncQueue.empty();
+            });
+
+            if(fs_asyncQueue.empty()) {
+                return;
+            }
+
+            read = fs_asyncQueue.front();
+            fs_asyncQueue.pop();
+        }
+
+        read->buffer = static_cast<uchar8 *>(::malloc(read->len + 1));
+
+        if(read->buffer && !ReadAsyncData(read)) {
+            ::free(read->buffer);
+            read->buffer = nullptr;
+        }
+
+        if(read->buffer) {
+            // guarantee that it will have a trailing 0 for string operations
+            read->buffer[read->len] = 0;
+
+            if(read->decode) {
+                read->decode(read->qpath, read->buffer, read->len, read->userData);
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(fs_asyncMutex);
+            read->done = true;
+        }
+
+        fs_asyncDone.notify_all();
+    }
+}
+
+/*
+=================
+idFileSystemLocal::FinishAsyncRead
+=================
+*/
+void idFileSystemLocal::FinishAsyncRead(asyncRead_t *read) {
+    if(read->handle) {
+        fileSystemLocal.FCloseFile(read->handle);
+    }
+
+    if(read->buffer) {
+        fs_loadCount++;
+    }
+
+    if(read->complete) {
+        read->complete(read->qpath, read->buffer,
+                       read->buffer ? read->len : -1, read->userData);
+    }
+
+    if(read->buffer) {
+        ::free(read->buffer);
+    }
+}
+
+/*
+=================
+idFileSystemLocal::AsyncReadFile
+
+Finds and opens qpath now, then reads it and calls decode on one of the
+async read threads. complete is called from FinishAsyncReads on the main
+thread, in the order the reads were issued. Can only be called from the
+main thread. With fs_asyncThreads 0 or a journal everything happens right
+away, -1 starts a thread per core.
+=================
+*/
+void idFileSystemLocal::AsyncReadFile(pointer qpath, asyncFileFunc_t decode,
+                                      asyncFileFunc_t complete, void *userData) {
+    unz_file_info64 info;
+    asyncRead_t *read;
+    void *buffer;
+    sint len;
+
+    if(!fs_searchpaths) {
+        common->Error(ERR_FATAL,
+                      "idFileSystemLocal::AsyncReadFile: Filesystem call made without initialization\n");
+    }
+
+    if(!qpath || !qpath[0]) {
+        common->Error(ERR_FATAL, "idFileSystemLocal::AsyncReadFile with empty name\n");
+    }
+
+    if(!fs_asyncThreads->integer || journal->integer) {
+        FinishAsyncReads(true);
+
+        len = ReadFile(qpath, &buffer);
+
+        if(buffer && decode) {
+            decode(qpath, buffer, len, userData);
+        }
+
+        if(complete) {
+            complete(qpath, buffer, buffer ? len : -1, userData);
+        }
+
+        if(buffer) {
+            FreeFile(buffer);
+        }
+
+        return;
+    }
+
+    StartAsyncThreads();
+
+    // every slot is waiting to be delivered
+    while(fs_asyncTail - fs_asyncHead == MAX_ASYNC_READS) {
+        FinishAsyncReads(true);
+    }
+
+    read = &fs_asyncReads[fs_asyncTail & (MAX_ASYNC_READS - 1)];
+    fs_asyncTail++;
+
+    Q_strncpyz(read->qpath, qpath, sizeof(read->qpath));
+    read->decode = decode;
+    read->complete = complete;
+    read->userData = userData;
+    read->buffer = nullptr;
+
+    // the lookup marks pak references, so it has to happen here
+    read->len = FOpenFileRead(qpath, &read->handle, true);
+
+    if(!read->handle) {
+        read->done = true;
+        return;
+    }
+
+    read->data = MappedFileData(read->handle, &info);
+    read->fd = -1;
+
+    if(read->data && ((info.compression_method == 0 &&
+                       info.compressed_size == static_cast<uint64>(read->len)) ||
+                      info.compression_method == Z_DEFLATED)) {
+        read->dataSize = info.compressed_size;
+        read->compression = info.compression_method;
+    } else {
+        read->data = nullptr;
+
+#ifndef _WIN32
+        if(!fsh[read->handle].zipFile) {
+            read->fd = fileno(fsh[read->handle].handleFiles.file.o);
+        }
+#endif
+    }
+
+    // neither mapped nor a loose file, so it is read here and only
+    // delivered in order
+    if(!read->data && read->fd < 0) {
+        read->buffer = static_cast<uchar8 *>(::malloc(read->len + 1));
+
+        if(read->buffer &&
+                Read(read->buffer, read->len, read->handle) == read->len) {
+            read->buffer[read->len] = 0;
+
+            if(decode) {
+                decode(qpath, read->buffer, read->len, userData);
+            }
+        } else {
+            ::free(read->buffer);
+            read->buffer = nullptr;
+        }
+
+        read->done = true;
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(fs_asyncMutex);
+        read->done = false;
+        fs_asyncQueue.push(read);
+    }
+
+    fs_asyncWake.notify_one();
+}
+
+/*
+=================
+idFileSystemLocal::FinishAsyncReads
+
+Delivers the async reads that are done, stopping at the first one that
+isn't. With wait set, waits for all of them.
+=================
+*/
+void idFileSystemLocal::FinishAsyncReads(bool wait) {
+    asyncRead_t read, *slot;
+
+    while(fs_asyncHead != fs_asyncTail) {
+        slot = &fs_asyncReads[fs_asyncHead & (MAX_ASYNC_READS - 1)];
+
+        {
+            std::unique_lock<std::mutex> lock(fs_asyncMutex);
+
+            if(!slot->done) {
+                if(!wait) {
+                    return;
+                }
+
+                fs_asyncDone.wait(lock, [slot] {
+                    return slot->done;
+                });
+            }
+        }
+
+        // the callback may issue new reads into this slot
+        read = *slot;
+        fs_asyncHead++;
+
+        FinishAsyncRead(&read);
+    }
+}
@@ -68,6 +68,27 @@ typedef struct searchpath_s {
     directory_t *dir;
 } searchpath_t;
 
+// one slot of the pak file index, the winning pure pak for a qpath
+typedef struct {
+    uint32 hash; // 0 marks a free slot
+    sint order; // position of the search path in fs_searchpaths
+    pack_t *pack;
+    fileInPack_t *pakFile;
+} fileIndexEntry_t;
+
+#define DIR_CACHE_DIRS 1024 // must be a power of two
+#define DIR_CACHE_FILES 16384 // must be a power of two
+#define DIR_CACHE_NAMES 524288
+
+// one slot of the directory listing cache, either a listed directory or
+// a file in a listed directory
+typedef struct {
+    uint32 hash; // 0 marks a free slot
+    directory_t *dir;
+    valueType *name; // relative to the game directory
+    bool complete; // false if the listing didn't fit, then probe with fopen
+} dirCacheEntry_t;
+
 typedef union qfile_gus {
     FILE *o;
     unzFile z;
@@ -78,8 +99,44 @@ typedef struct qfile_us {
     bool unique;
 } qfile_ut;
 
+// a memory mapped pk3, shared by every handle opened on it
+typedef struct pakMapping_s {
+    zlib_filemap_def filemap;
+    sint fd;
+} pakMapping_t;
+
+#define MAX_FILE_VIEWS 64
+#define MIN_FILE_VIEW_SIZE 65536 // smaller files are cheaper to copy
+
+// a ReadFile buffer that maps a stored file straight out of its pk3
+typedef struct {
+    void *buffer;
+    void *base;
+    uint64 size;
+} fileView_t;
+
+#define MAX_ASYNC_READS 64 // must be a power of two
+#define MAX_ASYNC_THREADS 16
+
+// a file read by the async read threads
+typedef struct {
+    valueType qpath[MAX_ZPATH];
+    fileHandle_t handle;
+    sint len;
+    uchar8 *buffer; // nullptr if the read failed
+    const uchar8 *data; // pk3 data the thread copies or inflates
+    uint64 dataSize;
+    sint compression;
+    sint fd; // loose file the thread reads, -1 for pk3 data
+    asyncFileFunc_t decode; // called on the read thread
+    asyncFileFunc_t complete; // called on the main thread
+    void *userData;
+    bool done;
+} asyncRead_t;
+
 typedef struct {
     qfile_ut handleFiles;
+    pack_t *pack; // pk3 the file was opened from
     bool handleSync;
     sint baseOffset;
     sint fileSize;
@@ -218,9 +275,39 @@ public:
                                        pointer filename);
     virtual void FilenameCompletion(pointer dir, pointer ext, bool stripExt,
                                     void(*callback)(pointer s));
+    virtual void AsyncReadFile(pointer qpath, asyncFileFunc_t decode,
+                               asyncFileFunc_t complete, void *userData);
+    virtual void FinishAsyncReads(bool wait);
 
     static bool PakIsPure(pack_t *pack);
     static sint32 HashFileName(pointer fname, uint64 hashSize);
+    static uint32 HashPath(pointer name, uint32 seed);
+    static fileIndexEntry_t *FindFileIndexSlot(pointer filename, uint32 hash);
+    static void BuildFileIndex(void);
+    static void ClearFileIndex(void);
+    static dirCacheEntry_t *FindDirCacheSlot(dirCacheEntry_t *table,
+            sint size, directory_t *dir, pointer name, uint32 hash);
+    static dirCacheEntry_t *ListDirCache(directory_t *dir, pointer subdir);
+    static bool DirCacheHasFile(directory_t *dir, pointer filename);
+    static void ClearDirCache(void);
+    static sint OpenFileInPack(pointer filename, fileHandle_t *file,
+                               bool uniqueFILE, pack_t *pak, fileInPack_t *pakFile);
+    static sint OpenFileInDir(pointer filename, fileHandle_t *file,
+                              directory_t *dir);
+    static pakMapping_t *MapPakFile(pointer zipfile);
+    static void UnmapPakFile(pakMapping_t *mapping);
+    static unzFile OpenPakFile(pointer zipfile, pakMapping_t *mapping);
+    static const uchar8 *MappedFileData(fileHandle_t f,
+                                        unz_file_info64 *info);
+    static bool InflateMappedData(const uchar8 *data, uint64 size,
+                                  uchar8 *buffer, sint len);
+    static bool ReadMappedFile(fileHandle_t f, sint len, uchar8 **buffer);
+    static void StartAsyncThreads(void);
+    static void StopAsyncThreads(void);
+    static bool ReadAsyncData(asyncRead_t *read);
+    static void AsyncReadThread(void);
+    static void FinishAsyncRead(asyncRead_t *read);
+    static bool FreeFileView(void *buffer);
     static fileHandle_t HandleForFile(void);
     static FILE *FileForHandle(fileHandle_t f);
     static sint filelength(fileHandle_t f);
@@ -543,6 +543,119 @@ sint idHuffmanSystemLocal::WriteSymbol(sint symbol, uchar8 *buffer,
                                        sint bitIndex) {
     const uchar16 entry = huff_encodeTable[symbol];
     const sint bitCount = static_cast<sint>(entry & 15);
+    const sint shift = bitIndex & 7;
+    const uint bits = static_cast<uint>((entry >> 4) & 0x7FF) << shift;
+    const sint lastByte = (shift + bitCount - 1) >> 3;
+    uchar8 *out = buffer + (bitIndex >> 3);
+
+    // codes are at most 11 bits so they span at most three bytes. Same
+    // result as WriteBit per bit: the bits already in the first byte are
+    // kept and every byte after it starts from zero
+    if(shift) {
+        out[0] |= static_cast<uchar8>(bits);
+    } else {
+        out[0] = static_cast<uchar8>(bits);
+    }
+
+    if(lastByte >= 1) {
+        out[1] = static_cast<uchar8>(bits >> 8);
+    }
+
+    if(lastByte >= 2) {
+        out[2] = static_cast<uchar8>(bits >> 16);
+    }
+
+    return bitCount;
+}
+
+/*
+===============
+idHuffmanSystemLocal::PutBits
+
+Stores the low bitCount bits LSB first at bitIndex, giving the same result
+as calling WriteBit for each of them. bitIndex & 7 plus bitCount must fit
+in 64 bits.
+===============
+*/
+void idHuffmanSystemLocal::PutBits(uint64 bits, sint bitCount,
+                                   uchar8 *buffer, sint bitIndex) {
+    const sint shift = bitIndex & 7;
+    const sint numBytes = (shift + bitCount + 7) >> 3;
+    uchar8 *out = buffer + (bitIndex >> 3);
+    sint i;
+
+    bits <<= shift;
+
+    if(shift) {
+        bits |= out[0];
+    }
+
+    for(i = 0; i < numBytes; i++) {
+        out[i] = static_cast<uchar8>(bits >> (i * 8));
+    }
+}
+
+/*
+===============
+idHuffmanSystemLocal::PeekBits
+
+Returns the bits starting at bitIndex, at least 57 of them are valid.
+The caller has to make sure 8 bytes can be read from the start byte.
+===============
+*/
+uint64 idHuffmanSystemLocal::PeekBits(const uchar8 *buffer,
+                                      sint bitIndex) {
+    uint64 bits;
+
+    // little endian load, same as ReadSymbol
+    ::memcpy(&bits, buffer + (bitIndex >> 3), sizeof(bits));
+
+    return bits >> (bitIndex & 7);
+}
+
+/*
+===============
+idHuffmanSystemLocal::EncodeSymbol
+
+Appends the code of symbol to bits, which already holds bitCount bits.
+Returns the length of the code.
+===============
+*/
+sint idHuffmanSystemLocal::EncodeSymbol(sint symbol, uint64 *bits,
+                                        sint bitCount) {
+    const uchar16 entry = huff_encodeTable[symbol];
+
+    *bits |= static_cast<uint64>((entry >> 4) & 0x7FF) << bitCount;
+
+    return static_cast<sint>(entry & 15);
+}
+
+/*
+===============
+idHuffmanSystemLocal::DecodeSymbol
+
+Decodes the symbol at the bottom of bits, returns the length of its code
+===============
+*/
+sint idHuffmanSystemLocal::DecodeSymbol(uint64 bits, sint *symbol) {
+    const uchar16 entry = huff_decodeTable[bits & 0x7FF];
+
+    *symbol = static_cast<sint>(entry & 0xFF);
+
+    return static_cast<sint>(entry >> 8);
+}
+
+/*
+===============
+idHuffmanSystemLocal::WriteSymbolBitwise
+
+The old bit at a time encoder, only kept as the reference for huffbench
+===============
+*/
+sint idHuffmanSystemLocal::WriteSymbolBitwise(sint symbol, uchar8 *buffer,
+        sint bitIndex) {
+    const uchar16 entry = huff_encodeTable[symbol];
+    const sint bitCount = static_cast<sint>(entry & 15);
     const sint code = static_cast<sint>((entry >> 4) & 0x7FF);
     sint bits = static_cast<sint>(code);
 
@@ -555,3 +668,164 @@ sint idHuffmanSystemLocal::WriteSymbol(sint symbol, uchar8 *buffer,
     return bitCount;
 }
 
+/*
+===============
+idHuffmanSystemLocal::EncodeBitwise
+===============
+*/
+sint idHuffmanSystemLocal::EncodeBitwise(const uchar8 *input, sint length,
+        uchar8 *output) {
+    sint i, bitIndex = 0;
+
+    for(i = 0; i < length; i++) {
+        bitIndex += WriteSymbolBitwise(input[i], output, bitIndex);
+    }
+
+    return bitIndex;
+}
+
+/*
+===============
+idHuffmanSystemLocal::Encode
+===============
+*/
+sint idHuffmanSystemLocal::Encode(const uchar8 *input, sint length,
+                                  uchar8 *output) {
+    sint i, bitIndex = 0;
+
+    for(i = 0; i < length; i++) {
+        bitIndex += WriteSymbol(input[i], output, bitIndex);
+    }
+
+    return bitIndex;
+}
+
+/*
+===============
+idHuffmanSystemLocal::Decode
+
+Returns the sum of the decoded symbols
+===============
+*/
+sint idHuffmanSystemLocal::Decode(uchar8 *input, sint length,
+                                  uchar8 *output) {
+    sint i, symbol, sum = 0, bitIndex = 0;
+
+    for(i = 0; i < length; i++) {
+        bitIndex += ReadSymbol(&symbol, input, bitIndex);
+        output[i] = symbol;
+        sum += symbol;
+    }
+
+    return sum;
+}
+
+/*
+===============
+idHuffmanSystemLocal::Benchmark_f
+
+huffbench [file]
+Runs the file (or generated data with the symbol statistics of the static
+tree) through the bitwise encoder, the table encoder and the decoder,
+checks that all three agree and prints the throughput of each
+===============
+*/
+void idHuffmanSystemLocal::Benchmark_f(void) {
+    sint i, pass, length, iterations, bits, start, elapsed;
+    sint referenceBits, encodedBits, sum = 0;
+    uchar8 *input, *decoded, *reference, *encoded, *fileData = nullptr;
+    float32 megabytes;
+
+    if(cmdSystem->Argc() > 1) {
+        length = fileSystem->ReadFile(cmdSystem->Argv(1),
+                                      reinterpret_cast<void **>(&fileData));
+
+        if(length <= 0 || !fileData) {
+            common->Printf("huffbench: couldn't load %s\n", cmdSystem->Argv(1));
+
+            // an empty file is still loaded
+            if(fileData) {
+                fileSystem->FreeFile(fileData);
+            }
+
+            return;
+        }
+    } else {
+        length = 1 << 20;
+    }
+
+    // codes are at most 11 bits, ReadSymbol peeks 4 bytes ahead
+    input = static_cast<uchar8 *>(::malloc(length));
+    decoded = static_cast<uchar8 *>(::malloc(length));
+    reference = static_cast<uchar8 *>(::malloc(length * 2 + 4));
+    encoded = static_cast<uchar8 *>(::malloc(length * 2 + 4));
+
+    if(fileData) {
+        if(input) {
+            ::memcpy(input, fileData, length);
+        }
+
+        fileSystem->FreeFile(fileData);
+    } else if(input) {
+        // random 11 bit codes give every symbol its probability in the tree
+        for(i = 0; i < length; i++) {
+            input[i] = huff_decodeTable[::rand() & 0x7FF] & 0xFF;
+        }
+    }
+
+    if(!input || !decoded || !reference || !encoded) {
+        common->Printf("huffbench: out of memory\n");
+        ::free(encoded);
+        ::free(reference);
+        ::free(decoded);
+        ::free(input);
+        return;
+    }
+
+    for(i = 0; i < length; i++) {
+        sum += input[i];
+    }
+
+    referenceBits = EncodeBitwise(input, length, reference);
+    encodedBits = Encode(input, length, encoded);
+
+    if(referenceBits != encodedBits ||
+            ::memcmp(reference, encoded, (encodedBits + 7) >> 3)) {
+        common->Printf("huffbench: table encoder output differs from the bitwise encoder\n");
+    } else if(Decode(encoded, length, decoded) != sum ||
+              ::memcmp(input, decoded, length)) {
+        common->Printf("huffbench: decoded data doesn't match the input\n");
+    } else {
+        iterations = Q_max(1, (64 << 20) / length);
+        megabytes = static_cast<float32>(length) * iterations / (1 << 20);
+
+        common->Printf("%i bytes -> %i bytes, %i iterations\n", length,
+                       (encodedBits + 7) >> 3, iterations);
+
+        for(pass = 0; pass < 3; pass++) {
+            start = idsystem->Milliseconds();
+            bits = 0;
+
+            for(i = 0; i < iterations; i++) {
+                if(pass == 0) {
+                    bits += EncodeBitwise(input, length, reference);
+                } else if(pass == 1) {
+                    bits += Encode(input, length, encoded);
+                } else {
+                    bits += Decode(encoded, length, decoded) == sum;
+                }
+            }
+
+            elapsed = Q_max(idsystem->Milliseconds() - start, 1);
+
+            common->Printf("%-16s %8.2f MB/s (%i)\n",
+                           pass == 0 ? "bitwise encode" : pass == 1 ? "table encode" : "table decode",
+                           megabytes * 1000.0f / elapsed, bits);
+        }
+    }
+
+    ::free(encoded);
+    ::free(reference);
+    ::free(decoded);
+    ::free(input);
+}
@@ -76,7 +76,7 @@ typedef struct {
 } huffman_t;
 
 extern huffman_t clientHuffTables;
-extern sint oldsize;
+extern thread_local sint oldsize;
 static sint bloc = 0;
 
 static const uint16_t huff_decodeTable[2048] = {
@@ -264,6 +264,16 @@ public:
     static void WriteBit(sint bit, uchar8 *buffer, sint bitIndex);
     static sint ReadSymbol(sint *symbol, uchar8 *buffer, sint bitIndex);
     static sint WriteSymbol(sint symbol, uchar8 *buffer, sint bitIndex);
+    static void PutBits(uint64 bits, sint bitCount, uchar8 *buffer,
+                        sint bitIndex);
+    static uint64 PeekBits(const uchar8 *buffer, sint bitIndex);
+    static sint EncodeSymbol(sint symbol, uint64 *bits, sint bitCount);
+    static sint DecodeSymbol(uint64 bits, sint *symbol);
+    static sint WriteSymbolBitwise(sint symbol, uchar8 *buffer, sint bitIndex);
+    static sint EncodeBitwise(const uchar8 *input, sint length, uchar8 *output);
+    static sint Encode(const uchar8 *input, sint length, uchar8 *output);
+    static sint Decode(uchar8 *input, sint length, uchar8 *output);
+    static void Benchmark_f(void);
 };
 
 extern idHuffmanSystemLocal huffmanLocal;
@@ -262,3 +262,106 @@ void fill_fopen64_filefunc(zlib_filefunc64_def  *pzlib_filefunc_def) {
     pzlib_filefunc_def->zerror_file = ferror_file_func;
     pzlib_filefunc_def->opaque = nullptr;
 }
+
+typedef struct {
+    zlib_filemap_def *filemap;
+    ZPOS64_T pos;
+} filemap_stream;
+
+static voidpf ZCALLBACK filemap_open64_file_func(voidpf opaque,
+        const void *filename, int mode) {
+    filemap_stream *stream;
+
+    if((mode & ZLIB_FILEFUNC_MODE_READWRITEFILTER) != ZLIB_FILEFUNC_MODE_READ) {
+        return nullptr;
+    }
+
+    stream = (filemap_stream *)malloc(sizeof(filemap_stream));
+
+    if(stream != nullptr) {
+        stream->filemap = (zlib_filemap_def *)opaque;
+        stream->pos = 0;
+    }
+
+    return stream;
+}
+
+static uLong ZCALLBACK filemap_read_file_func(voidpf opaque, voidpf stream,
+        void *buf, uLong size) {
+    filemap_stream *s = (filemap_stream *)stream;
+
+    if(s->pos >= s->filemap->size) {
+        return 0;
+    }
+
+    if(size > s->filemap->size - s->pos) {
+        size = (uLong)(s->filemap->size - s->pos);
+    }
+
+    memcpy(buf, s->filemap->base + s->pos, size);
+    s->pos += size;
+
+    return size;
+}
+
+static uLong ZCALLBACK filemap_write_file_func(voidpf opaque,
+        voidpf stream, const void *buf, uLong size) {
+    return 0;
+}
+
+static ZPOS64_T ZCALLBACK filemap_tell64_file_func(voidpf opaque,
+        voidpf stream) {
+    return ((filemap_stream *)stream)->pos;
+}
+
+static long ZCALLBACK filemap_seek64_file_func(voidpf opaque,
+        voidpf stream, ZPOS64_T offset, int origin) {
+    filemap_stream *s = (filemap_stream *)stream;
+    ZPOS64_T pos;
+
+    switch(origin) {
+        case ZLIB_FILEFUNC_SEEK_CUR :
+            pos = s->pos + offset;
+            break;
+
+        case ZLIB_FILEFUNC_SEEK_END :
+            pos = s->filemap->size + offset;
+            break;
+
+        case ZLIB_FILEFUNC_SEEK_SET :
+            pos = offset;
+            break;
+
+        default:
+            return -1;
+    }
+
+    if(pos > s->filemap->size) {
+        return -1;
+    }
+
+    s->pos = pos;
+
+    return 0;
+}
+
+static int ZCALLBACK filemap_close_file_func(voidpf opaque, voidpf stream) {
+    free(stream);
+    return 0;
+}
+
+static int ZCALLBACK filemap_error_file_func(voidpf opaque, voidpf stream) {
+    return 0;
+}
+
+void fill_filemap64_filefunc(zlib_filefunc64_def *pzlib_filefunc_def,
+                             zlib_filemap_def *filemap) {
+    pzlib_filefunc_def->zopen64_file = filemap_open64_file_func;
+    pzlib_filefunc_def->zread_file = filemap_read_file_func;
+    pzlib_filefunc_def->zwrite_file = filemap_write_file_func;
+    pzlib_filefunc_def->ztell64_file = filemap_tell64_file_func;
+    pzlib_filefunc_def->zseek64_file = filemap_seek64_file_func;
+    pzlib_filefunc_def->zclose_file = filemap_close_file_func;
+    pzlib_filefunc_def->zerror_file = filemap_error_file_func;
+    pzlib_filefunc_def->opaque = filemap;
+}
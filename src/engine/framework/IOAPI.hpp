@@ -168,6 +168,15 @@ typedef struct zlib_filefunc64_def_s {
 } zlib_filefunc64_def;
 
 void fill_fopen64_filefunc OF((zlib_filefunc64_def *pzlib_filefunc_def));
+
+/* a zip file that is already in memory, the streams only keep a position */
+typedef struct zlib_filemap_def_s {
+    const unsigned char *base;
+    ZPOS64_T size;
+} zlib_filemap_def;
+
+void fill_filemap64_filefunc OF((zlib_filefunc64_def *pzlib_filefunc_def,
+                                 zlib_filemap_def *filemap));
 void fill_fopen_filefunc OF((zlib_filefunc_def *pzlib_filefunc_def));
 
 /* now internal definition, only for zip.c and unzip.h */
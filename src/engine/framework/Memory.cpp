@@ -62,12 +62,31 @@ idMemorySystemLocal::idMemorySystemLocal
 idMemorySystemLocal::~idMemorySystemLocal(void) {
 }
 
+// a slab slot and a zone block are told apart by the id in front of the pointer
+static_assert(sizeof(memblock_t) - offsetof(memblock_t, id) ==
+              sizeof(memslot_t) - offsetof(memslot_t, id),
+              "memblock_t id must sit where memslot_t keeps its id");
+
+/*
+========================
+idMemorySystemLocal::ZoneForTag
+========================
+*/
+memzone_t *idMemorySystemLocal::ZoneForTag(sint tag) {
+    if(tag == TAG_SMALL) {
+        return smallzone;
+    }
+
+    return mainzone;
+}
+
 /*
 ========================
 idMemorySystemLocal::ClearZone
 ========================
 */
 void idMemorySystemLocal::ClearZone(memzone_t *zone, sint size) {
+    sint i;
     memblock_t *block;
 
     // set the entire zone to one free block
@@ -85,6 +104,65 @@ void idMemorySystemLocal::ClearZone(memzone_t *zone, sint size) {
     block->tag = 0;             // free block
     block->id = ZONEID;
     block->size = size - sizeof(memzone_t);
+
+    // forget the blocks and slabs of the tags that lived in this zone
+    for(i = 0; i < NUM_MEMTAGS; i++) {
+        if(ZoneForTag(i) != zone) {
+            continue;
+        }
+
+        s_tagBlocks[i] = nullptr;
+        s_tagSlabs[i] = nullptr;
+        ::memset(s_partialSlabs[i], 0, sizeof(s_partialSlabs[i]));
+    }
+}
+
+/*
+========================
+idMemorySystemLocal::FreeBlock
+
+Returns a block to its zone, merging it with free neighbours
+========================
+*/
+void idMemorySystemLocal::FreeBlock(memzone_t *zone, memblock_t *block) {
+    memblock_t *other;
+
+    zone->used -= block->size;
+    // set the block to something that should cause problems
+    // if it is referenced...
+    ::memset(block + 1, 0xaa, block->size - sizeof(*block));
+
+    block->tag = 0;             // mark as free
+
+    other = block->prev;
+
+    if(!other->tag) {
+        // merge with previous free block
+        other->size += block->size;
+        other->next = block->next;
+        other->next->prev = other;
+
+        if(block == zone->rover) {
+            zone->rover = other;
+        }
+
+        block = other;
+    }
+
+    zone->rover = block;
+
+    other = block->next;
+
+    if(!other->tag) {
+        // merge the next free block onto the end
+        block->size += other->size;
+        block->next = other->next;
+        block->next->prev = block;
+
+        if(other == zone->rover) {
+            zone->rover = block;
+        }
+    }
 }
 
 /*
@@ -93,13 +171,21 @@ idMemorySystemLocal::Free
 ========================
 */
 void idMemorySystemLocal::Free(void *ptr) {
-    memblock_t *block, * other;
-    memzone_t *zone;
+    memblock_t *block;
+    memslot_t *slot;
 
     if(!ptr) {
         common->Error(ERR_DROP, "idMemorySystemLocal::Free: nullptr pointer");
     }
 
+    slot = reinterpret_cast<memslot_t *>(reinterpret_cast<uchar8 *>
+                                         (ptr) - sizeof(memslot_t));
+
+    if(slot->id == SLABID || slot->id == SLAB_FREE_ID) {
+        FreeSlot(slot);
+        return;
+    }
+
     block = (memblock_t *)(reinterpret_cast<uchar8 *>(ptr) - sizeof(
                                memblock_t));
 
@@ -125,102 +211,58 @@ void idMemorySystemLocal::Free(void *ptr) {
                       "idMemorySystemLocal::Free: memory block wrote past end");
     }
 
-    if(block->tag == TAG_SMALL) {
-        zone = smallzone;
+#ifdef ALLOC_PROFILE
+    TrackFree(block->site, block->size);
+#endif
+
+    // unlink from the blocks of its tag
+    if(block->tagPrev) {
+        block->tagPrev->tagNext = block->tagNext;
     } else {
-        zone = mainzone;
+        s_tagBlocks[block->tag] = block->tagNext;
     }
 
-    zone->used -= block->size;
-    // set the block to something that should cause problems
-    // if it is referenced...
-    ::memset(ptr, 0xaa, block->size - sizeof(*block));
-
-    block->tag = 0;             // mark as free
-
-    other = block->prev;
-
-    if(!other->tag) {
-        // merge with previous free block
-        other->size += block->size;
-        other->next = block->next;
-        other->next->prev = other;
-
-        if(block == zone->rover) {
-            zone->rover = other;
-        }
-
-        block = other;
+    if(block->tagNext) {
+        block->tagNext->tagPrev = block->tagPrev;
     }
 
-    zone->rover = block;
-
-    other = block->next;
-
-    if(!other->tag) {
-        // merge the next free block onto the end
-        block->size += other->size;
-        block->next = other->next;
-        block->next->prev = block;
-
-        if(other == zone->rover) {
-            zone->rover = block;
-        }
-    }
+    FreeBlock(ZoneForTag(block->tag), block);
 }
 
 /*
 ================
 idMemorySystemLocal::FreeTags
+
+Only touches the slabs and the blocks of the tag
 ================
 */
 void idMemorySystemLocal::FreeTags(memtag_t tag) {
-    sint count;
-    memzone_t *zone;
-
-    if(tag == TAG_SMALL) {
-        zone = smallzone;
-    } else {
-        zone = mainzone;
+    // static memory is never freed
+    if(tag == TAG_STATIC) {
+        return;
     }
 
-    count = 0;
-    // use the rover as our pointer, because
-    // memorySystem->Free automatically adjusts it
-    zone->rover = zone->blocklist.next;
-
-    do {
-        if(zone->rover->tag == tag) {
-            count++;
-            Free(reinterpret_cast<memzone_t *>(zone->rover) + 1);
-            continue;
-        }
+    while(s_tagSlabs[tag]) {
+        ReleaseSlab(s_tagSlabs[tag]);
+    }
 
-        zone->rover = zone->rover->next;
-    } while(zone->rover != &zone->blocklist);
+    while(s_tagBlocks[tag]) {
+        Free(s_tagBlocks[tag] + 1);
+    }
 }
 
 /*
 ================
-idMemorySystemLocal::TagMalloc
+idMemorySystemLocal::AllocBlock
+
+First fit scan of the zone from the rover. Size is what the caller
+needs, the header and the trash tester are added here.
 ================
 */
-void *idMemorySystemLocal::TagMalloc(uint64 size, memtag_t tag) {
-    sint allocSize;
+memblock_t *idMemorySystemLocal::AllocBlock(memzone_t *zone, uint64 size,
+        sint tag) {
     sint64 extra;
     memblock_t *start, * rover, * _new, * base;
-    memzone_t *zone;
-
-    if(!tag) {
-        common->Error(ERR_FATAL,
-                      "idMemorySystemLocal::TagMalloc: tried to use a 0 tag");
-    }
-
-    if(tag == TAG_SMALL) {
-        zone = smallzone;
-    } else {
-        zone = mainzone;
-    }
 
     //
     // scan through the block list looking for the first free block
@@ -270,6 +312,7 @@ void *idMemorySystemLocal::TagMalloc(uint64 size, memtag_t tag) {
     }
 
     base->tag = tag;            // no longer a free block
+    base->tagNext = base->tagPrev = nullptr;
 
     zone->rover = base->next;   // next allocation will start looking here
     zone->used += base->size;   //
@@ -280,19 +323,286 @@ void *idMemorySystemLocal::TagMalloc(uint64 size, memtag_t tag) {
     * reinterpret_cast<sint *>(reinterpret_cast<uchar8 *>
                                (base) + base->size - 4) = ZONEID;
 
-    return reinterpret_cast<void *>(reinterpret_cast<uchar8 *>(base) + sizeof(
+    return base;
+}
+
+/*
+================
+idMemorySystemLocal::NewSlab
+
+Takes a zone block and threads all of its slots on the free list
+================
+*/
+memslab_t *idMemorySystemLocal::NewSlab(memzone_t *zone, sint tag,
+                                        sint sizeClass) {
+    sint i;
+    uint64 size;
+    memblock_t *block;
+    memslab_t *slab;
+    memslot_t *slot;
+
+    // the block header and the trash tester come out of SLAB_SIZE as well
+    size = SLAB_SIZE - sizeof(memblock_t) - sizeof(sint64);
+    block = AllocBlock(zone, size, tag);
+
+    slab = reinterpret_cast<memslab_t *>(block + 1);
+    slab->id = SLABID;
+    slab->tag = tag;
+    slab->sizeClass = sizeClass;
+    // the trash tester takes 8 bytes so the slots stay aligned
+    slab->slotSize = sizeof(memslot_t) + (sizeClass + 1) * SLAB_GRANULARITY +
+                     sizeof(sint64);
+    slab->numSlots = (size - sizeof(memslab_t)) / slab->slotSize;
+    slab->usedSlots = 0;
+    slab->zone = zone;
+    slab->freeSlots = nullptr;
+
+    // thread back to front so the slots get handed out in address order
+    for(i = slab->numSlots - 1; i >= 0; i--) {
+        slot = reinterpret_cast<memslot_t *>(reinterpret_cast<uchar8 *>
+                                             (slab + 1) + i * slab->slotSize);
+        slot->id = SLAB_FREE_ID;
+        slot->slab = static_cast<uint>(reinterpret_cast<uchar8 *>(slot) -
+                                         reinterpret_cast<uchar8 *>(slab));
+        *reinterpret_cast<memslot_t **>(slot + 1) = slab->freeSlots;
+        slab->freeSlots = slot;
+    }
+
+    slab->prev = nullptr;
+    slab->next = s_partialSlabs[tag][sizeClass];
+
+    if(slab->next) {
+        slab->next->prev = slab;
+    }
+
+    s_partialSlabs[tag][sizeClass] = slab;
+
+    slab->tagPrev = nullptr;
+    slab->tagNext = s_tagSlabs[tag];
+
+    if(slab->tagNext) {
+        slab->tagNext->tagPrev = slab;
+    }
+
+    s_tagSlabs[tag] = slab;
+
+    return slab;
+}
+
+/*
+================
+idMemorySystemLocal::ReleaseSlab
+
+Gives the slab back to the zone, whatever is still allocated from it
+================
+*/
+void idMemorySystemLocal::ReleaseSlab(memslab_t *slab) {
+    // full slabs aren't on the partial list
+    if(slab->usedSlots < slab->numSlots) {
+        if(slab->prev) {
+            slab->prev->next = slab->next;
+        } else {
+            s_partialSlabs[slab->tag][slab->sizeClass] = slab->next;
+        }
+
+        if(slab->next) {
+            slab->next->prev = slab->prev;
+        }
+    }
+
+    if(slab->tagPrev) {
+        slab->tagPrev->tagNext = slab->tagNext;
+    } else {
+        s_tagSlabs[slab->tag] = slab->tagNext;
+    }
+
+    if(slab->tagNext) {
+        slab->tagNext->tagPrev = slab->tagPrev;
+    }
+
+#ifdef ALLOC_PROFILE
+    // FreeTags drops the slots that are still in use with the slab
+    for(sint i = 0; i < slab->numSlots; i++) {
+        memslot_t *slot = reinterpret_cast<memslot_t *>(reinterpret_cast<uchar8 *>
+                          (slab + 1) + i * slab->slotSize);
+
+        if(slot->id == SLABID) {
+            TrackFree(slot->site, slab->slotSize);
+        }
+    }
+#endif
+
+    slab->id = 0;
+
+    FreeBlock(slab->zone, reinterpret_cast<memblock_t *>(slab) - 1);
+}
+
+/*
+================
+idMemorySystemLocal::SlabMalloc
+================
+*/
+void *idMemorySystemLocal::SlabMalloc(memzone_t *zone, uint64 size,
+                                      sint tag) {
+    sint sizeClass;
+    memslab_t *slab;
+    memslot_t *slot;
+
+    sizeClass = size ? static_cast<sint>((size - 1) / SLAB_GRANULARITY) : 0;
+
+    slab = s_partialSlabs[tag][sizeClass];
+
+    if(!slab) {
+        slab = NewSlab(zone, tag, sizeClass);
+    }
+
+    slot = slab->freeSlots;
+    slab->freeSlots = *reinterpret_cast<memslot_t **>(slot + 1);
+    slot->id = SLABID;
+
+    // marker for memory trash testing
+    *reinterpret_cast<sint *>(reinterpret_cast<uchar8 *>
+                              (slot) + slab->slotSize - 4) = ZONEID;
+
+    // a full slab leaves the partial list until a slot comes back
+    if(++slab->usedSlots == slab->numSlots) {
+        s_partialSlabs[tag][sizeClass] = slab->next;
+
+        if(slab->next) {
+            slab->next->prev = nullptr;
+        }
+
+        slab->next = slab->prev = nullptr;
+    }
+
+    return slot + 1;
+}
+
+/*
+================
+idMemorySystemLocal::FreeSlot
+================
+*/
+void idMemorySystemLocal::FreeSlot(memslot_t *slot) {
+    memslab_t *slab;
+    memslab_t **partial;
+
+    if(slot->id == SLAB_FREE_ID) {
+        common->Error(ERR_FATAL,
+                      "idMemorySystemLocal::Free: freed a freed pointer");
+    }
+
+    slab = reinterpret_cast<memslab_t *>(reinterpret_cast<uchar8 *>
+                                         (slot) - slot->slab);
+
+    if(slab->id != SLABID) {
+        common->Error(ERR_FATAL,
+                      "idMemorySystemLocal::Free: freed a pointer without SLABID");
+    }
+
+    // check the memory trash tester
+    if(*reinterpret_cast<sint *>((reinterpret_cast<uchar8 *>
+                                  (slot) + slab->slotSize - 4)) != ZONEID) {
+        common->Error(ERR_FATAL,
+                      "idMemorySystemLocal::Free: memory block wrote past end");
+    }
+
+#ifdef ALLOC_PROFILE
+    TrackFree(slot->site, slab->slotSize);
+#endif
+
+    // set the slot to something that should cause problems
+    // if it is referenced...
+    ::memset(slot + 1, 0xaa, slab->slotSize - sizeof(*slot));
+
+    slot->id = SLAB_FREE_ID;
+    *reinterpret_cast<memslot_t **>(slot + 1) = slab->freeSlots;
+    slab->freeSlots = slot;
+
+    partial = &s_partialSlabs[slab->tag][slab->sizeClass];
+
+    // a full slab goes back on the partial list
+    if(slab->usedSlots-- == slab->numSlots) {
+        slab->prev = nullptr;
+        slab->next = *partial;
+
+        if(slab->next) {
+            slab->next->prev = slab;
+        }
+
+        *partial = slab;
+    }
+
+    // empty slabs go back to the zone, but keep the last one of
+    // the class around so a single alloc / free doesn't churn
+    if(!slab->usedSlots && (*partial != slab || slab->next)) {
+        ReleaseSlab(slab);
+    }
+}
+
+/*
+================
+idMemorySystemLocal::TagMallocSite
+================
+*/
+void *idMemorySystemLocal::TagMallocSite(uint64 size, memtag_t tag,
+        pointer file, sint line) {
+    memblock_t *block;
+    memzone_t *zone;
+
+    if(!tag) {
+        common->Error(ERR_FATAL,
+                      "idMemorySystemLocal::TagMalloc: tried to use a 0 tag");
+    }
+
+    zone = ZoneForTag(tag);
+
+    // static memory is never freed, keep it out of the slabs
+    if(size <= MAX_SLAB_ALLOC && tag != TAG_STATIC) {
+#ifdef ALLOC_PROFILE
+        void *buf = SlabMalloc(zone, size, tag);
+        memslot_t *slot = reinterpret_cast<memslot_t *>(buf) - 1;
+
+        slot->site = FindAllocSite(file, line, ALLOC_ZONE);
+        TrackAlloc(slot->site, reinterpret_cast<memslab_t *>
+                   (reinterpret_cast<uchar8 *>(slot) - slot->slab)->slotSize);
+
+        return buf;
+#else
+        return SlabMalloc(zone, size, tag);
+#endif
+    }
+
+    block = AllocBlock(zone, size, tag);
+
+#ifdef ALLOC_PROFILE
+    block->site = FindAllocSite(file, line, ALLOC_ZONE);
+    TrackAlloc(block->site, block->size);
+#endif
+
+    if(tag != TAG_STATIC) {
+        block->tagNext = s_tagBlocks[tag];
+
+        if(block->tagNext) {
+            block->tagNext->tagPrev = block;
+        }
+
+        s_tagBlocks[tag] = block;
+    }
+
+    return reinterpret_cast<void *>(reinterpret_cast<uchar8 *>(block) + sizeof(
                                         memblock_t));
 }
 
 /*
 ========================
-idMemorySystemLocal::Malloc
+idMemorySystemLocal::MallocSite
 ========================
 */
-void *idMemorySystemLocal::Malloc(uint64 size) {
+void *idMemorySystemLocal::MallocSite(uint64 size, pointer file, sint line) {
     void *buf;
 
-    buf = TagMalloc(size, TAG_GENERAL);
+    buf = TagMallocSite(size, TAG_GENERAL, file, line);
     ::memset(buf, 0, size);
 
     return buf;
@@ -300,11 +610,11 @@ void *idMemorySystemLocal::Malloc(uint64 size) {
 
 /*
 ========================
-idMemorySystemLocal::SMalloc
+idMemorySystemLocal::SMallocSite
 ========================
 */
-void *idMemorySystemLocal::SMalloc(uint64 size) {
-    return TagMalloc(size, TAG_SMALL);
+void *idMemorySystemLocal::SMallocSite(uint64 size, pointer file, sint line) {
+    return TagMallocSite(size, TAG_SMALL, file, line);
 }
 
 /*
@@ -408,6 +718,8 @@ void idMemorySystemLocal::Meminfo_f(void) {
     uint64          smallZoneBytes, smallZoneBlocks;
     uint64          botlibBytes, rendererBytes, otherBytes;
     uint64          staticBytes, generalBytes;
+    uint64          slabBytes, slabs, slots, usedSlots;
+    memslab_t *slab;
 
     zoneBytes = 0;
     botlibBytes = 0;
@@ -504,6 +816,22 @@ void idMemorySystemLocal::Meminfo_f(void) {
     common->Printf("        %8i bytes in static server memory\n", staticBytes);
     common->Printf("        %8i bytes in general common memory\n",
                    generalBytes);
+
+    slabBytes = slabs = slots = usedSlots = 0;
+
+    for(sint i = 0; i < NUM_MEMTAGS; i++) {
+        for(slab = s_tagSlabs[i]; slab; slab = slab->tagNext) {
+            slabs++;
+            slots += slab->numSlots;
+            usedSlots += slab->usedSlots;
+            slabBytes += slab->usedSlots * slab->slotSize;
+        }
+    }
+
+    common->Printf("%8i bytes in %i of %i slab slots (%i slabs)\n", slabBytes,
+                   usedSlots, slots, slabs);
+    common->Printf("%8i K reserved in scratch arenas\n",
+                   s_scratchReserved.load() / 1024);
 }
 
 /*
@@ -656,6 +984,16 @@ void idMemorySystemLocal::InitHunkMemory(void) {
 
     cmdSystem->AddCommand("meminfo", &idMemorySystemLocal::Meminfo_f,
                           "Shows memory usage in the console");
+#ifdef ALLOC_PROFILE
+    cmdSystem->AddCommand("allocsites", &idMemorySystemLocal::AllocSites_f,
+                          "Lists the source lines that allocate the most, allocsites [count] [count|bytes|live|frame]");
+    cmdSystem->AddCommand("allocsites_csv",
+                          &idMemorySystemLocal::AllocSitesCSV_f,
+                          "Writes every allocation site to a CSV file, allocsites_csv [filename]");
+    cmdSystem->AddCommand("allocsites_reset",
+                          &idMemorySystemLocal::AllocSitesReset_f,
+                          "Starts counting allocations per site from zero");
+#endif
 }
 
 /*
@@ -676,6 +1014,16 @@ The server calls this after the level and game VM have been loaded
 */
 void idMemorySystemLocal::SetMark(void) {
     s_hunk.mark = s_hunk.permTop;
+
+#ifdef ALLOC_PROFILE
+
+    for(sint i = 0; i < s_numAllocSites; i++) {
+        if(s_allocSites[i].kind == ALLOC_HUNK) {
+            s_allocSites[i].markLive = s_allocSites[i].liveBytes;
+        }
+    }
+
+#endif
 }
 
 /*
@@ -690,6 +1038,11 @@ void idMemorySystemLocal::ClearToMark(void) {
     s_hunk.permMax = s_hunk.permTop;
 
     s_hunk.tempMax = s_hunk.tempTop = 0;
+
+#ifdef ALLOC_PROFILE
+    ClearAllocSites(ALLOC_HUNK, true);
+    ClearAllocSites(ALLOC_TEMP, false);
+#endif
 }
 
 /*
@@ -729,6 +1082,11 @@ void idMemorySystemLocal::Clear(void) {
     s_hunk.maxEver = 0;
     s_hunk.mark = 0;
 
+#ifdef ALLOC_PROFILE
+    ClearAllocSites(ALLOC_HUNK, false);
+    ClearAllocSites(ALLOC_TEMP, false);
+#endif
+
     common->Printf("idMemorySystemLocal::Clear: reset the hunk ok\n");
 
     //stake out a chunk for the frame temp data
@@ -737,12 +1095,13 @@ void idMemorySystemLocal::Clear(void) {
 
 /*
 =================
-idMemorySystemLocal::Alloc
+idMemorySystemLocal::AllocSite
 
 Allocate permanent (until the hunk is cleared) memory
 =================
 */
-void *idMemorySystemLocal::Alloc(uint64 size, ha_pref preference) {
+void *idMemorySystemLocal::AllocSite(uint64 size, ha_pref preference,
+                                     pointer file, sint line) {
     void *buf;
 
     if(s_hunk.mem == nullptr) {
@@ -773,19 +1132,24 @@ void *idMemorySystemLocal::Alloc(uint64 size, ha_pref preference) {
 
     ::memset(buf, 0, size);
 
+#ifdef ALLOC_PROFILE
+    TrackAlloc(FindAllocSite(file, line, ALLOC_HUNK), size);
+#endif
+
     return buf;
 }
 
 /*
 =================
-idMemorySystemLocal::AllocateTempMemory
+idMemorySystemLocal::AllocateTempMemorySite
 
 This is used by the file loading system.
 Multiple files can be loaded in temporary memory.
 When the files-in-use count reaches zero, all temp memory will be deleted
 =================
 */
-void *idMemorySystemLocal::AllocateTempMemory(uint64 size) {
+void *idMemorySystemLocal::AllocateTempMemorySite(uint64 size,
+        pointer file, sint line) {
     void *buf;
     hunkHeader_t *hdr;
 
@@ -794,7 +1158,7 @@ void *idMemorySystemLocal::AllocateTempMemory(uint64 size) {
     // by the file system without redunant routines in the file system utilizing different
     // memory systems
     if(s_hunk.mem == nullptr) {
-        return Malloc(size);
+        return MallocSite(size, file, line);
     }
 
     size = PAD(size, sizeof(sint64)) + sizeof(hunkHeader_t);
@@ -821,6 +1185,11 @@ void *idMemorySystemLocal::AllocateTempMemory(uint64 size) {
     hdr->magic = HUNK_MAGIC;
     hdr->size = size;
 
+#ifdef ALLOC_PROFILE
+    hdr->site = FindAllocSite(file, line, ALLOC_TEMP);
+    TrackAlloc(hdr->site, size);
+#endif
+
     // don't bother clearing, because we are going to load a file over it
     return buf;
 }
@@ -851,6 +1220,10 @@ void idMemorySystemLocal::FreeTempMemory(void *buf) {
 
     hdr->magic = HUNK_FREE_MAGIC;
 
+#ifdef ALLOC_PROFILE
+    TrackFree(hdr->site, hdr->size);
+#endif
+
     // this only works if the files are freed in stack order,
     // otherwise the memory will stay around until Hunk_ClearTempMemory
     if(reinterpret_cast<uchar8 *>(hdr) == s_hunk.mem + s_hunk.memSize -
@@ -872,6 +1245,10 @@ void idMemorySystemLocal::ClearTempMemory(void) {
     if(s_hunk.mem) {
         s_hunk.tempTop = 0;
         s_hunk.tempMax = 0;
+
+#ifdef ALLOC_PROFILE
+        ClearAllocSites(ALLOC_TEMP, false);
+#endif
     }
 }
 
@@ -972,4 +1349,516 @@ idMemorySystemLocal::ReleaseMemory
 */
 void idMemorySystemLocal::FrameReset(void) {
     s_frameStackLoc = s_frameStackBase;
+
+#ifdef ALLOC_PROFILE
+    EndAllocFrame();
+#endif
+}
+
+/*
+==============================================================================
+
+SCRATCH ARENAS
+
+==============================================================================
+*/
+
+#define SCRATCH_ROUND( x ) ( ( ( x ) + SCRATCH_ALIGN - 1 ) & ~( static_cast<uint64>( SCRATCH_ALIGN ) - 1 ) )
+#define SCRATCH_DATA( chunk ) ( reinterpret_cast<uchar8 *>( ( chunk ) + 1 ) )
+
+static_assert(sizeof(scratchChunk_t) % SCRATCH_ALIGN == 0,
+              "scratch chunk header would misalign the data");
+#ifdef SCRATCH_DEBUG
+static_assert(sizeof(scratchHeader_t) % SCRATCH_ALIGN == 0,
+              "scratch allocation header would misalign the data");
+#endif
+
+/*
+========================
+scratchArena_s::~scratchArena_s
+
+Hands the chunks of an exiting thread back to the system
+========================
+*/
+scratchArena_s::~scratchArena_s(void) {
+    scratchChunk_t *chunk;
+
+    while(top) {
+        chunk = top;
+        top = chunk->prev;
+        s_scratchReserved -= chunk->size;
+        free(chunk);
+    }
+
+    while(spare) {
+        chunk = spare;
+        spare = chunk->prev;
+        s_scratchReserved -= chunk->size;
+        free(chunk);
+    }
+}
+
+/*
+========================
+idMemorySystemLocal::CheckScratch
+
+Verifies the guards of every allocation in the chunk from the given offset
+up and poisons the memory being given back
+========================
+*/
+void idMemorySystemLocal::CheckScratch(scratchChunk_t *chunk, uint64 from) {
+#ifdef SCRATCH_DEBUG
+    uint64 ofs, i, end;
+    uchar8 *data;
+    scratchHeader_t *header;
+
+    data = SCRATCH_DATA(chunk);
+
+    for(ofs = from; ofs < chunk->used; ofs = end + SCRATCH_ALIGN) {
+        header = reinterpret_cast<scratchHeader_t *>(data + ofs);
+
+        if(header->magic != SCRATCH_MAGIC) {
+            common->Error(ERR_FATAL,
+                          "idMemorySystemLocal::CheckScratch: bad header at %p",
+                          static_cast<void *>(header));
+        }
+
+        end = ofs + sizeof(scratchHeader_t) + SCRATCH_ROUND(header->size);
+
+        for(i = ofs + sizeof(scratchHeader_t) + header->size;
+                i < end + SCRATCH_ALIGN; i++) {
+            if(data[i] != SCRATCH_GUARD) {
+                common->Error(ERR_FATAL,
+                              "idMemorySystemLocal::CheckScratch: %i byte allocation at %p overrun",
+                              static_cast<sint>(header->size), static_cast<void *>(header + 1));
+            }
+        }
+    }
+
+    if(from < chunk->used) {
+        ::memset(data + from, SCRATCH_POISON, chunk->used - from);
+    }
+#endif
+}
+
+/*
+========================
+idMemorySystemLocal::ScratchAlloc
+
+Bumps size bytes off the calling thread's arena, starting a new chunk
+when the current one is full
+========================
+*/
+void *idMemorySystemLocal::ScratchAlloc(uint64 size) {
+    uint64 need;
+    uchar8 *buf;
+    scratchChunk_t *chunk, **link;
+
+    need = SCRATCH_ROUND(size);
+#ifdef SCRATCH_DEBUG
+    need += sizeof(scratchHeader_t) + SCRATCH_ALIGN;
+#endif
+
+    chunk = s_scratch.top;
+
+    if(!chunk || chunk->used + need > chunk->size) {
+        // reuse a chunk that was popped earlier if it is big enough
+        for(link = &s_scratch.spare; *link; link = &(*link)->prev) {
+            if((*link)->size >= need) {
+                break;
+            }
+        }
+
+        if(*link) {
+            chunk = *link;
+            *link = chunk->prev;
+        } else {
+            uint64 chunkSize = need > SCRATCH_CHUNK_SIZE ? need : SCRATCH_CHUNK_SIZE;
+
+            chunk = static_cast<scratchChunk_t *>(malloc(sizeof(scratchChunk_t) +
+                                                  chunkSize));
+
+            if(!chunk) {
+                common->Error(ERR_FATAL,
+                              "idMemorySystemLocal::ScratchAlloc: failed on allocation of %i bytes",
+                              static_cast<sint>(chunkSize));
+            }
+
+            chunk->size = chunkSize;
+            s_scratchReserved += chunkSize;
+        }
+
+        chunk->used = 0;
+        chunk->prev = s_scratch.top;
+        s_scratch.top = chunk;
+    }
+
+    buf = SCRATCH_DATA(chunk) + chunk->used;
+    chunk->used += need;
+
+#ifdef SCRATCH_DEBUG
+    scratchHeader_t *header = reinterpret_cast<scratchHeader_t *>(buf);
+
+    header->size = size;
+    header->magic = SCRATCH_MAGIC;
+    header->pad = 0;
+    buf += sizeof(scratchHeader_t);
+
+    ::memset(buf, SCRATCH_POISON, size);
+    ::memset(buf + size, SCRATCH_GUARD, SCRATCH_ROUND(size) - size + SCRATCH_ALIGN);
+#endif
+
+    return buf;
+}
+
+/*
+========================
+idMemorySystemLocal::ScratchMark
+========================
+*/
+scratchMark_t idMemorySystemLocal::ScratchMark(void) {
+    scratchMark_t mark;
+
+    mark.chunk = s_scratch.top;
+    mark.used = s_scratch.top ? s_scratch.top->used : 0;
+
+    return mark;
+}
+
+/*
+========================
+idMemorySystemLocal::ScratchRestore
+
+Gives back everything allocated on this thread since the mark was taken.
+Marks have to be restored in the reverse order they were taken in
+========================
+*/
+void idMemorySystemLocal::ScratchRestore(scratchMark_t mark) {
+    scratchChunk_t *chunk;
+
+    while(s_scratch.top != mark.chunk) {
+        chunk = s_scratch.top;
+
+        if(!chunk) {
+            common->Error(ERR_FATAL,
+                          "idMemorySystemLocal::ScratchRestore: mark is not on this thread's arena");
+        }
+
+        CheckScratch(chunk, 0);
+
+        s_scratch.top = chunk->prev;
+        chunk->prev = s_scratch.spare;
+        s_scratch.spare = chunk;
+    }
+
+    chunk = s_scratch.top;
+
+    if(!chunk) {
+        return;
+    }
+
+    if(mark.used > chunk->used) {
+        common->Error(ERR_FATAL,
+                      "idMemorySystemLocal::ScratchRestore: mark restored out of order");
+    }
+
+    CheckScratch(chunk, mark.used);
+    chunk->used = mark.used;
 }
+
+#ifdef ALLOC_PROFILE
+/*
+==============================================================================
+
+ALLOCATION PROFILE
+
+==============================================================================
+*/
+
+static pointer s_allocKindNames[] = { "zone", "hunk", "temp" };
+
+/*
+========================
+idMemorySystemLocal::FindAllocSite
+
+Call sites are told apart by the address of their __FILE__ string, the line
+and the allocator, so the lookup never has to compare strings.  Modules
+built without ALLOC_PROFILE pass no file and share the first slot
+========================
+*/
+sint idMemorySystemLocal::FindAllocSite(pointer file, sint line,
+                                        sint kind) {
+    sint index;
+    uint64 hash;
+    allocSite_t *site;
+
+    if(!file) {
+        return 0;
+    }
+
+    hash = (reinterpret_cast<uintptr_t>(file) ^ (static_cast<uint64>
+            (line) << 2) ^ kind) * 0x9e3779b97f4a7c15ULL;
+
+    for(hash >>= 32; ; hash++) {
+        hash &= ALLOC_SITE_HASH - 1;
+        index = s_allocSiteHash[hash];
+
+        if(!index) {
+            break;
+        }
+
+        site = &s_allocSites[index];
+
+        if(site->file == file && site->line == line && site->kind == kind) {
+            return index;
+        }
+    }
+
+    if(s_numAllocSites == MAX_ALLOC_SITES) {
+        return 0;
+    }
+
+    index = s_numAllocSites++;
+    s_allocSiteHash[hash] = index;
+
+    site = &s_allocSites[index];
+    site->file = file;
+    site->line = line;
+    site->kind = kind;
+
+    return index;
+}
+
+/*
+========================
+idMemorySystemLocal::TrackAlloc
+========================
+*/
+void idMemorySystemLocal::TrackAlloc(sint site, uint64 size) {
+    allocSite_t *s = &s_allocSites[site];
+
+    s->count++;
+    s->bytes += size;
+    s->liveBytes += size;
+    s->frameCount++;
+
+    if(s->liveBytes > s->peakLive) {
+        s->peakLive = s->liveBytes;
+    }
+}
+
+/*
+========================
+idMemorySystemLocal::TrackFree
+========================
+*/
+void idMemorySystemLocal::TrackFree(sint site, uint64 size) {
+    allocSite_t *s = &s_allocSites[site];
+
+    s->liveBytes = s->liveBytes > size ? s->liveBytes - size : 0;
+}
+
+/*
+========================
+idMemorySystemLocal::ClearAllocSites
+
+The hunk lets go of its memory without freeing the single allocations
+========================
+*/
+void idMemorySystemLocal::ClearAllocSites(sint kind, bool toMark) {
+    for(sint i = 0; i < s_numAllocSites; i++) {
+        allocSite_t *s = &s_allocSites[i];
+
+        if(s->kind != kind) {
+            continue;
+        }
+
+        if(toMark) {
+            s->liveBytes = s->markLive;
+        } else {
+            s->liveBytes = s->markLive = 0;
+        }
+    }
+}
+
+/*
+========================
+idMemorySystemLocal::EndAllocFrame
+========================
+*/
+void idMemorySystemLocal::EndAllocFrame(void) {
+    s_allocFrames++;
+
+    for(sint i = 0; i < s_numAllocSites; i++) {
+        allocSite_t *s = &s_allocSites[i];
+
+        s->lastFrame = s->frameCount;
+
+        if(s->frameCount > s->peakFrame) {
+            s->peakFrame = s->frameCount;
+        }
+
+        s->frameCount = 0;
+    }
+}
+
+/*
+========================
+idMemorySystemLocal::AllocSiteName
+
+Drops everything up to the last src directory so that dumps from
+different build machines line up
+========================
+*/
+pointer idMemorySystemLocal::AllocSiteName(const allocSite_t *site) {
+    pointer name, p;
+
+    if(!site->file) {
+        return "(unknown)";
+    }
+
+    name = site->file;
+
+    for(p = ::strstr(name, "src"); p; p = ::strstr(p + 1, "src")) {
+        if(p[3] == '/' || p[3] == '\\') {
+            name = p + 4;
+        }
+    }
+
+    return name;
+}
+
+/*
+========================
+idMemorySystemLocal::SortAllocSites
+
+Puts the sites that allocated anything into order, biggest key first
+========================
+*/
+sint idMemorySystemLocal::SortAllocSites(sint *order, pointer key) {
+    sint i, num;
+    uint64 allocSite_t::*field;
+
+    if(!Q_stricmp(key, "count")) {
+        field = &allocSite_t::count;
+    } else if(!Q_stricmp(key, "live")) {
+        field = &allocSite_t::liveBytes;
+    } else if(!Q_stricmp(key, "frame")) {
+        field = &allocSite_t::peakFrame;
+    } else {
+        field = &allocSite_t::bytes;
+    }
+
+    for(i = num = 0; i < s_numAllocSites; i++) {
+        if(s_allocSites[i].count || s_allocSites[i].liveBytes) {
+            order[num++] = i;
+        }
+    }
+
+    std::sort(order, order + num, [field](sint a, sint b) {
+        if(s_allocSites[a].*field != s_allocSites[b].*field) {
+            return s_allocSites[a].*field > s_allocSites[b].*field;
+        }
+
+        return a < b;
+    });
+
+    return num;
+}
+
+/*
+========================
+idMemorySystemLocal::AllocSites_f
+========================
+*/
+void idMemorySystemLocal::AllocSites_f(void) {
+    sint i, num, count;
+    pointer key;
+    allocSite_t *s;
+    static sint order[MAX_ALLOC_SITES];
+
+    count = cmdSystem->Argc() > 1 ? atoi(cmdSystem->Argv(1)) : 20;
+    key = cmdSystem->Argc() > 2 ? cmdSystem->Argv(2) : "bytes";
+
+    if(count <= 0) {
+        common->Printf("usage: allocsites [count] [count|bytes|live|frame]\n");
+        return;
+    }
+
+    num = SortAllocSites(order, key);
+
+    common->Printf("  allocs      K total     K live  per frame  last  peak kind site\n");
+
+    for(i = 0; i < num && i < count; i++) {
+        s = &s_allocSites[order[i]];
+
+        common->Printf("%8llu %12llu %10llu %10.2f %5llu %5llu %s %s:%i\n",
+                       s->count, s->bytes / 1024, s->liveBytes / 1024,
+                       s_allocFrames ? static_cast<float64>(s->count) / s_allocFrames : 0.0,
+                       s->lastFrame, s->peakFrame, s_allocKindNames[s->kind],
+                       AllocSiteName(s), s->line);
+    }
+
+    common->Printf("%i of %i sites over %llu frames\n", i, num, s_allocFrames);
+}
+
+/*
+========================
+idMemorySystemLocal::AllocSitesCSV_f
+========================
+*/
+void idMemorySystemLocal::AllocSitesCSV_f(void) {
+    sint i, num;
+    pointer filename;
+    fileHandle_t f;
+    allocSite_t *s;
+    static sint order[MAX_ALLOC_SITES];
+
+    filename = cmdSystem->Argc() > 1 ? cmdSystem->Argv(1) : "allocsites.csv";
+
+    f = fileSystem->FOpenFileWrite(filename);
+
+    if(!f) {
+        common->Printf("Couldn't open %s for writing\n", filename);
+        return;
+    }
+
+    num = SortAllocSites(order, "bytes");
+
+    fileSystem->Printf(f,
+                       "kind,file,line,count,bytes,live_bytes,peak_live_bytes,per_frame,last_frame,peak_frame\n");
+
+    for(i = 0; i < num; i++) {
+        s = &s_allocSites[order[i]];
+
+        fileSystem->Printf(f, "%s,%s,%i,%llu,%llu,%llu,%llu,%.4f,%llu,%llu\n",
+                           s_allocKindNames[s->kind], AllocSiteName(s), s->line,
+                           s->count, s->bytes, s->liveBytes, s->peakLive,
+                           s_allocFrames ? static_cast<float64>(s->count) / s_allocFrames : 0.0,
+                           s->lastFrame, s->peakFrame);
+    }
+
+    fileSystem->FCloseFile(f);
+
+    common->Printf("Wrote %i allocation sites to %s\n", num, filename);
+}
+
+/*
+========================
+idMemorySystemLocal::AllocSitesReset_f
+
+Live bytes are kept, they still describe memory that is in use
+========================
+*/
+void idMemorySystemLocal::AllocSitesReset_f(void) {
+    for(sint i = 0; i < s_numAllocSites; i++) {
+        allocSite_t *s = &s_allocSites[i];
+
+        s->count = s->bytes = 0;
+        s->frameCount = s->lastFrame = s->peakFrame = 0;
+        s->peakLive = s->liveBytes;
+    }
+
+    s_allocFrames = 0;
+}
+#endif
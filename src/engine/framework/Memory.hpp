@@ -57,12 +57,26 @@ The rover can be left pointing at a non-empty block
 
 The zone calls are pretty much only used for small strings and structures,
 all big things are allocated on the hunk.
+
+Allocations of up to MAX_SLAB_ALLOC bytes don't get a block of their own.
+They are handed out from slabs, zone blocks split into equal slots of one
+size class that all belong to a single tag, so allocating and freeing them
+never walks the block list.  Every tag also keeps a list of its blocks and
+slabs, which is all FreeTags has to look at.
 ==============================================================================
 */
 
 #define ZONEID  0x1d4a11
 #define MINFRAGMENT 64
 
+#define SLABID          0x51ab1d
+#define SLAB_FREE_ID    0x51ab1e
+#define SLAB_SIZE       4096    // zone bytes taken by one slab
+#define SLAB_GRANULARITY 16
+#define MAX_SLAB_ALLOC  256
+#define NUM_SLAB_CLASSES ( MAX_SLAB_ALLOC / SLAB_GRANULARITY )
+#define NUM_MEMTAGS     ( TAG_STATIC + 1 )
+
 typedef struct zonedebug_s {
     valueType *label;
     valueType *file;
@@ -74,7 +88,11 @@ typedef struct memblock_s {
     uint64 size;        // including the header and possibly tiny fragments
     sint tag;       // a tag of 0 is a free block
     struct memblock_s *next, * prev;
-    sint id;            // should be ZONEID
+    struct memblock_s *tagNext, * tagPrev; // other blocks of the same tag
+    sint id;            // should be ZONEID, memslot_t has its id at the same place
+#ifdef ALLOC_PROFILE
+    sint site;          // index in s_allocSites, 0 if not tracked
+#endif
 #ifdef ZONE_DEBUG
     zonedebug_t     d;
 #endif
@@ -87,6 +105,36 @@ typedef struct {
     memblock_t *rover;
 } memzone_t;
 
+// header in front of every slab allocation
+typedef struct memslot_s {
+#ifdef ALLOC_PROFILE
+    sint site;          // index in s_allocSites
+    sint pad;           // keeps the header 16 bytes
+#endif
+    sint id;            // SLABID, or SLAB_FREE_ID while on the free list
+    uint slab;          // bytes back to the owning memslab_t
+#ifdef ZONE_DEBUG
+    zonedebug_t     d;  // keeps id as far from the data as in memblock_t
+#endif
+} memslot_t;
+
+// lives at the start of the zone block it carves into slots
+typedef struct memslab_s {
+    sint id;            // SLABID
+    sint tag;
+    sint sizeClass;
+    sint numSlots, usedSlots;
+    uint64 slotSize;    // including the memslot_t and the trash tester
+    memzone_t *zone;
+    memslot_t *freeSlots; // linked through the first bytes of the freed slots
+    struct memslab_s *next, * prev; // slabs of this tag and class with free slots
+    struct memslab_s *tagNext, * tagPrev; // all slabs of this tag
+} memslab_t;
+
+static memslab_t *s_partialSlabs[NUM_MEMTAGS][NUM_SLAB_CLASSES];
+static memslab_t *s_tagSlabs[NUM_MEMTAGS];
+static memblock_t *s_tagBlocks[NUM_MEMTAGS];
+
 // main zone for all "dynamic" memory allocation
 static memzone_t *mainzone;
 
@@ -101,48 +149,48 @@ typedef struct memstatic_s {
 } memstatic_t;
 
 // bk001204 - initializer brackets
-static memstatic_t emptystring = { {(sizeof(memblock_t) + 2 + 3) & ~3, TAG_STATIC, NULL, NULL, ZONEID}
+static memstatic_t emptystring = { {(sizeof(memblock_t) + 2 + 3) & ~3, TAG_STATIC, NULL, NULL, NULL, NULL, ZONEID}
     , {'\0', '\0'}
 };
 
 static memstatic_t numberstring[] = {
-    {   {(sizeof(memstatic_t) + 3) & ~3, TAG_STATIC, NULL, NULL, ZONEID}
+    {   {(sizeof(memstatic_t) + 3) & ~3, TAG_STATIC, NULL, NULL, NULL, NULL, ZONEID}
         , {'0', '\0'}
     }
     ,
-    {   {(sizeof(memstatic_t) + 3) & ~3, TAG_STATIC, NULL, NULL, ZONEID}
+    {   {(sizeof(memstatic_t) + 3) & ~3, TAG_STATIC, NULL, NULL, NULL, NULL, ZONEID}
         , {'1', '\0'}
     }
     ,
-    {   {(sizeof(memstatic_t) + 3) & ~3, TAG_STATIC, NULL, NULL, ZONEID}
+    {   {(sizeof(memstatic_t) + 3) & ~3, TAG_STATIC, NULL, NULL, NULL, NULL, ZONEID}
         , {'2', '\0'}
     }
     ,
-    {   {(sizeof(memstatic_t) + 3) & ~3, TAG_STATIC, NULL, NULL, ZONEID}
+    {   {(sizeof(memstatic_t) + 3) & ~3, TAG_STATIC, NULL, NULL, NULL, NULL, ZONEID}
         , {'3', '\0'}
     }
     ,
-    {   {(sizeof(memstatic_t) + 3) & ~3, TAG_STATIC, NULL, NULL, ZONEID}
+    {   {(sizeof(memstatic_t) + 3) & ~3, TAG_STATIC, NULL, NULL, NULL, NULL, ZONEID}
         , {'4', '\0'}
     }
     ,
-    {   {(sizeof(memstatic_t) + 3) & ~3, TAG_STATIC, NULL, NULL, ZONEID}
+    {   {(sizeof(memstatic_t) + 3) & ~3, TAG_STATIC, NULL, NULL, NULL, NULL, ZONEID}
         , {'5', '\0'}
     }
     ,
-    {   {(sizeof(memstatic_t) + 3) & ~3, TAG_STATIC, NULL, NULL, ZONEID}
+    {   {(sizeof(memstatic_t) + 3) & ~3, TAG_STATIC, NULL, NULL, NULL, NULL, ZONEID}
         , {'6', '\0'}
     }
     ,
-    {   {(sizeof(memstatic_t) + 3) & ~3, TAG_STATIC, NULL, NULL, ZONEID}
+    {   {(sizeof(memstatic_t) + 3) & ~3, TAG_STATIC, NULL, NULL, NULL, NULL, ZONEID}
         , {'7', '\0'}
     }
     ,
-    {   {(sizeof(memstatic_t) + 3) & ~3, TAG_STATIC, NULL, NULL, ZONEID}
+    {   {(sizeof(memstatic_t) + 3) & ~3, TAG_STATIC, NULL, NULL, NULL, NULL, ZONEID}
         , {'8', '\0'}
     }
     ,
-    {   {(sizeof(memstatic_t) + 3) & ~3, TAG_STATIC, NULL, NULL, ZONEID}
+    {   {(sizeof(memstatic_t) + 3) & ~3, TAG_STATIC, NULL, NULL, NULL, NULL, ZONEID}
         , {'9', '\0'}
     }
 };
@@ -186,6 +234,9 @@ Goals:
 
 typedef struct {
     sint             magic;
+#ifdef ALLOC_PROFILE
+    sint             site;
+#endif
     uint64             size;
 } hunkHeader_t;
 
@@ -224,8 +275,102 @@ static hunkblock_t *hunkblocks;
 static hunkUsed_t hunk_low, hunk_high;
 static hunkUsed_t *hunk_permanent, * hunk_temp;
 
+/*
+==============================================================================
+
+SCRATCH ARENAS
+
+Every thread that asks gets its own stack of malloc'd chunks that scratch
+allocations are bumped out of.  A mark is the chunk and offset at the top
+of the stack, restoring it pops whatever was allocated on top.  Chunks that
+get popped are kept for reuse until the thread exits.
+
+Debug builds put a header and a guard around every allocation, poison the
+memory going in and out, and check the guards when it is given back.
+
+==============================================================================
+*/
+
+#ifndef NDEBUG
+#define SCRATCH_DEBUG
+#endif
+
+#define SCRATCH_CHUNK_SIZE  ( 1024 * 1024 )
+#define SCRATCH_ALIGN       16
+#define SCRATCH_MAGIC       0x5c4a7c11
+#define SCRATCH_GUARD       0xfd
+#define SCRATCH_POISON      0xcd
+
+typedef struct scratchChunk_s {
+    struct scratchChunk_s *prev;    // chunk below on the stack, or next spare
+    uint64 size;        // usable bytes after the header
+    uint64 used;
+    uint64 pad;         // keeps the data SCRATCH_ALIGN aligned
+} scratchChunk_t;
+
+#ifdef SCRATCH_DEBUG
+typedef struct {
+    uint64 size;        // payload bytes, a SCRATCH_ALIGN guard follows
+    sint magic;
+    sint pad;
+} scratchHeader_t;
+#endif
+
+typedef struct scratchArena_s {
+    scratchChunk_t *top;
+    scratchChunk_t *spare;
+
+    ~scratchArena_s(void);
+} scratchArena_t;
+
+/*
+==============================================================================
+
+ALLOCATION PROFILE
+
+With ALLOC_PROFILE every zone, hunk and temp allocation is counted against
+the source line that asked for it.  The size counted is what the allocator
+gave out, headers and rounding included, and live bytes go down again when
+the memory is freed or the hunk is cleared.
+
+==============================================================================
+*/
+
+#ifdef ALLOC_PROFILE
+#define MAX_ALLOC_SITES     4096
+#define ALLOC_SITE_HASH     8192    // power of two, at least twice MAX_ALLOC_SITES
+
+typedef enum {
+    ALLOC_ZONE,
+    ALLOC_HUNK,
+    ALLOC_TEMP
+} allocKind_t;
+
+typedef struct {
+    pointer file;
+    sint line;
+    sint kind;          // allocKind_t
+    uint64 count;       // allocations since the last reset
+    uint64 bytes;
+    uint64 liveBytes;
+    uint64 peakLive;
+    uint64 markLive;    // hunk bytes that survive a ClearToMark
+    uint64 frameCount;  // allocations in the running frame
+    uint64 lastFrame;
+    uint64 peakFrame;
+} allocSite_t;
+
+// site 0 takes whatever has no file or doesn't fit in the table
+static allocSite_t s_allocSites[MAX_ALLOC_SITES];
+static sint s_numAllocSites = 1;
+static sint s_allocSiteHash[ALLOC_SITE_HASH];
+static uint64 s_allocFrames;    // frames since the last reset
+#endif
+
 static uint64 s_zoneTotal;
 static uint64 s_smallZoneTotal;
+static std::atomic<uint64> s_scratchReserved;  // chunk bytes held by all threads
+static thread_local scratchArena_t s_scratch;
 
 extern fileHandle_t logfile_;
 
@@ -239,9 +384,10 @@ public:
 
     virtual void Free(void *ptr);
     virtual void FreeTags(memtag_t tag);
-    virtual void *Malloc(uint64 size);
-    virtual void *TagMalloc(uint64 size, memtag_t tag);
-    virtual void *SMalloc(uint64 size);
+    virtual void *MallocSite(uint64 size, pointer file, sint line);
+    virtual void *TagMallocSite(uint64 size, memtag_t tag, pointer file,
+                                sint line);
+    virtual void *SMallocSite(uint64 size, pointer file, sint line);
     virtual void CheckHeap(void) ;
     virtual bool CheckMark(void);
     virtual void TouchMemory(void);
@@ -252,16 +398,41 @@ public:
     virtual void SetMark(void);
     virtual void ClearToMark(void);
     virtual void Clear(void);
-    virtual void *Alloc(uint64 size, ha_pref preference);
-    virtual void *AllocateTempMemory(uint64 size);
+    virtual void *AllocSite(uint64 size, ha_pref preference, pointer file,
+                            sint line);
+    virtual void *AllocateTempMemorySite(uint64 size, pointer file,
+                                         sint line);
     virtual void FreeTempMemory(void *buf);
     virtual void ClearTempMemory(void);
     virtual valueType *CopyString(pointer in);
     virtual void GetHunkInfo(sint *hunkused, sint *hunkexpected);
     virtual void ReleaseMemory(void);
     virtual void FrameReset(void);
+    virtual void *ScratchAlloc(uint64 size);
+    virtual scratchMark_t ScratchMark(void);
+    virtual void ScratchRestore(scratchMark_t mark);
 
+    static memzone_t *ZoneForTag(sint tag);
     static void ClearZone(memzone_t *zone, sint size);
+    static memblock_t *AllocBlock(memzone_t *zone, uint64 size, sint tag);
+    static void FreeBlock(memzone_t *zone, memblock_t *block);
+    static memslab_t *NewSlab(memzone_t *zone, sint tag, sint sizeClass);
+    static void ReleaseSlab(memslab_t *slab);
+    static void *SlabMalloc(memzone_t *zone, uint64 size, sint tag);
+    static void FreeSlot(memslot_t *slot);
+    static void CheckScratch(scratchChunk_t *chunk, uint64 from);
+#ifdef ALLOC_PROFILE
+    static sint FindAllocSite(pointer file, sint line, sint kind);
+    static void TrackAlloc(sint site, uint64 size);
+    static void TrackFree(sint site, uint64 size);
+    static void ClearAllocSites(sint kind, bool toMark);
+    static void EndAllocFrame(void);
+    static pointer AllocSiteName(const allocSite_t *site);
+    static sint SortAllocSites(sint *order, pointer key);
+    static void AllocSites_f(void);
+    static void AllocSitesCSV_f(void);
+    static void AllocSitesReset_f(void);
+#endif
     static void LogZoneHeap(memzone_t *zone, valueType *name);
     static sint AvailableZoneMemory(const memzone_t *zone);
     static void LogHeap(void);
@@ -45,9 +45,11 @@
 #endif
 
 sint pcount[256];
-sint wastedbits = 0;
 
-sint oldsize = 0;
+// the snapshot jobs write messages on the job threads, so the statistics
+// are kept per thread and only the main thread's ones are ever reported
+thread_local sint wastedbits = 0;
+thread_local sint oldsize = 0;
 
 idMessageToFunctionsLocal msgToFuncLocalSystem;
 idMessageToFunctions *msgToFuncSystem = &msgToFuncLocalSystem;
@@ -144,12 +146,12 @@ bit functions
 =============================================================================
 */
 
-sint    overflows;
+thread_local sint overflows;
 
 // negative bit values include signs
 void idMessageToFunctionsLocal::WriteBits(msg_t *msg, sint value,
         sint bits) {
-    sint i, bitIndex;
+    sint i;
 
     oldsize += bits;
 
@@ -214,37 +216,95 @@ void idMessageToFunctionsLocal::WriteBits(msg_t *msg, sint value,
             common->Error(ERR_DROP, "can't read %d bits\n", bits);
         }
     } else {
-        //      fp = fopen("c:\\netchan.bin", "a");
+        uint64 word;
+        uint rest;
+        sint nbits, count;
+
         value &= (0xffffffff >> (32 - bits));
 
-        if(bits & 7) {
-            sint             nbits;
+        // the odd bits go out raw, then the huffman code of each whole
+        // byte. At most 7 + 4 * 11 bits, so they are gathered in one
+        // register and stored in one go
+        nbits = bits & 7;
+        word = static_cast<uint>(value) & ((1u << nbits) - 1);
+        count = nbits;
+        rest = static_cast<uint>(value) >> nbits;
+
+        for(i = nbits; i < bits; i += 8) {
+            count += idHuffmanSystemLocal::EncodeSymbol(rest & 0xff, &word, count);
+            rest >>= 8;
+        }
 
-            nbits = bits & 7;
-            bitIndex = msg->bit;
+        idHuffmanSystemLocal::PutBits(word, count, msg->data, msg->bit);
+        msg->bit += count;
 
-            for(i = 0; i < nbits; i++) {
-                idHuffmanSystemLocal::WriteBit((value & 1), msg->data, bitIndex);
-                value = (value >> 1);
-                bitIndex++;
-            }
+        msg->cursize = (msg->bit >> 3) + 1;
+    }
+}
 
-            msg->bit = bitIndex;
-            bits = bits - nbits;
-        }
+/*
+==================
+idMessageToFunctionsLocal::WriteFlags
 
-        if(bits) {
-            bitIndex = msg->bit;
+Writes count single bit flags, LSB first. Produces the same stream as a
+WriteBits( msg, bit, 1 ) call per flag.
+==================
+*/
+void idMessageToFunctionsLocal::WriteFlags(msg_t *msg, uint64 flags,
+        sint count) {
+    oldsize += count;
 
-            for(i = 0; i < bits; i += 8) {
-                bitIndex += idHuffmanSystemLocal::WriteSymbol((value & 0xff), msg->data,
-                            bitIndex);
-                value = (value >> 8);
-            }
+    msg->uncompsize += count;   // NERVE - SMF - net debugging
 
-            msg->bit = bitIndex;
+    // this isn't an exact overflow check, but close enough
+    if(msg->maxsize - msg->cursize < 32) {
+        msg->overflowed = true;
+        return;
+    }
+
+    idHuffmanSystemLocal::PutBits(flags, count, msg->data, msg->bit);
+    msg->bit += count;
+
+    msg->cursize = (msg->bit >> 3) + 1;
+}
+
+/*
+==================
+idMessageToFunctionsLocal::WriteBitStream
+
+Appends numBits bits that were written to another message starting at bit 0.
+Since WriteBits output doesn't depend on the position, this is the same as
+repeating the original calls.
+==================
+*/
+void idMessageToFunctionsLocal::WriteBitStream(msg_t *msg,
+        const uchar8 *data, sint numBits) {
+    uint64 word;
+    sint i, bitIndex, count;
+
+    if(numBits <= 0) {
+        return;
+    }
+
+    // 56 bit chunks, so every chunk starts on a byte of the source
+    for(bitIndex = 0; bitIndex < numBits; bitIndex += count) {
+        // the same margin as WriteBits, checked before every chunk
+        if(msg->maxsize - msg->cursize < 32) {
+            msg->overflowed = true;
+            return;
         }
 
+        count = Q_min(numBits - bitIndex, 56);
+        word = 0;
+
+        for(i = 0; i < (count + 7) >> 3; i++) {
+            word |= static_cast<uint64>(data[(bitIndex >> 3) + i]) << (i * 8);
+        }
+
+        word &= (1ull << count) - 1;
+
+        idHuffmanSystemLocal::PutBits(word, count, msg->data, msg->bit);
+        msg->bit += count;
         msg->cursize = (msg->bit >> 3) + 1;
     }
 }
@@ -282,7 +342,32 @@ sint idMessageToFunctionsLocal::ReadBits(msg_t *msg, sint bits) {
         } else {
             common->Error(ERR_DROP, "can't read %d bits\n", bits);
         }
+    } else if((msg->bit >> 3) + 8 <= msg->maxsize) {
+        uint64 word;
+        sint count;
+
+        // one 64 bit load covers the raw bits and up to four huffman codes
+        word = idHuffmanSystemLocal::PeekBits(msg->data, msg->bit);
+
+        nbits = bits & 7;
+        value = static_cast<sint>(word & ((1u << nbits) - 1));
+        word >>= nbits;
+        count = nbits;
+
+        for(i = nbits; i < bits; i += 8) {
+            bitIndex = idHuffmanSystemLocal::DecodeSymbol(word, &get);
+            value |= get << i;
+            word >>= bitIndex;
+            count += bitIndex;
+        }
+
+        msg->bit += count;
+        msg->readcount = (msg->bit >> 3) + 1;
+
+        // the sign below is taken the same way as on the bitwise path
+        bits -= nbits;
     } else {
+        // too close to the end of the buffer for the wide load
         nbits = 0;
 
         if(bits & 7) {
@@ -1026,17 +1111,20 @@ netField_t entityStateFields[] = {
 };
 
 
+// how often each entity field changed, per thread like the ones above
+static thread_local sint entityStateFieldsUsed[ARRAY_LEN(entityStateFields)];
+
 static sint qsort_entitystatefields(const void *a, const void *b) {
     sint             aa, bb;
 
     aa = *const_cast<sint *>(reinterpret_cast<const sint *>(a));
     bb = *const_cast<sint *>(reinterpret_cast<const sint *>(b));
 
-    if(entityStateFields[aa].used > entityStateFields[bb].used) {
+    if(entityStateFieldsUsed[aa] > entityStateFieldsUsed[bb]) {
         return -1;
     }
 
-    if(entityStateFields[bb].used > entityStateFields[aa].used) {
+    if(entityStateFieldsUsed[bb] > entityStateFieldsUsed[aa]) {
         return 1;
     }
 
@@ -1087,7 +1175,7 @@ identical, under the assumption that the in-order delta code will catch it.
 void idMessageToFunctionsLocal::WriteDeltaEntity(msg_t *msg,
         struct entityState_s *from,
         struct entityState_s *to, bool force) {
-    sint             i, lc;
+    sint             i, lc, run;
     sint             numFields;
     netField_t     *field;
     sint             trunc;
@@ -1135,7 +1223,7 @@ void idMessageToFunctionsLocal::WriteDeltaEntity(msg_t *msg,
         if(*fromF != *toF) {
             lc = i + 1;
 
-            field->used++;
+            entityStateFieldsUsed[i]++;
         }
     }
 
@@ -1162,6 +1250,10 @@ void idMessageToFunctionsLocal::WriteDeltaEntity(msg_t *msg,
 
     //  common->Printf( "Delta for ent %i: ", to->number );
 
+    // the 0 bits of unchanged fields are held back and go out in the same
+    // WriteFlags call as the flag bits of the next changed field
+    run = 0;
+
     for(i = 0, field = entityStateFields; i < lc; i++, field++) {
         fromF = reinterpret_cast<sint *>(reinterpret_cast<uchar8 *>
                                          (from) + field->offset);
@@ -1169,55 +1261,49 @@ void idMessageToFunctionsLocal::WriteDeltaEntity(msg_t *msg,
                                        (to) + field->offset);
 
         if(*fromF == *toF) {
-            WriteBits(msg, 0, 1);    // no change
+            // no change
+            if(++run == 32) {
+                WriteFlags(msg, 0, run);
+                run = 0;
+            }
 
             wastedbits++;
 
             continue;
         }
 
-        WriteBits(msg, 1, 1);    // changed
-
+        // changed
         if(field->bits == 0) {
             // float32
             fullFloat = *reinterpret_cast<float32 *>(toF);
             trunc = static_cast<sint>(fullFloat);
 
             if(fullFloat == 0.0f) {
-                WriteBits(msg, 0, 1);
+                // changed, zero
+                WriteFlags(msg, 1ull << run, run + 2);
                 oldsize += FLOAT_INT_BITS;
+            } else if(trunc == fullFloat && trunc + FLOAT_INT_BIAS >= 0 &&
+                      trunc + FLOAT_INT_BIAS < (1 << FLOAT_INT_BITS)) {
+                // changed, non zero, send as small integer
+                WriteFlags(msg, 3ull << run, run + 3);
+                WriteBits(msg, trunc + FLOAT_INT_BIAS, FLOAT_INT_BITS);
             } else {
-                WriteBits(msg, 1, 1);
-
-                if(trunc == fullFloat && trunc + FLOAT_INT_BIAS >= 0 &&
-                        trunc + FLOAT_INT_BIAS < (1 << FLOAT_INT_BITS)) {
-                    // send as small integer
-                    WriteBits(msg, 0, 1);
-                    WriteBits(msg, trunc + FLOAT_INT_BIAS, FLOAT_INT_BITS);
-                    //                  if ( print ) {
-                    //                      common->Printf( "%s:%i ", field->name, trunc );
-                    //                  }
-                } else {
-                    // send as full floating point value
-                    WriteBits(msg, 1, 1);
-                    WriteBits(msg, *toF, 32);
-                    //                  if ( print ) {
-                    //                      common->Printf( "%s:%f ", field->name, *(float32 *)toF );
-                    //                  }
-                }
+                // changed, non zero, send as full floating point value
+                WriteFlags(msg, 7ull << run, run + 3);
+                WriteBits(msg, *toF, 32);
             }
         } else {
             if(*toF == 0) {
-                WriteBits(msg, 0, 1);
+                // changed, zero
+                WriteFlags(msg, 1ull << run, run + 2);
             } else {
-                WriteBits(msg, 1, 1);
-                // integer
+                // changed, non zero integer
+                WriteFlags(msg, 3ull << run, run + 2);
                 WriteBits(msg, *toF, field->bits);
-                //              if ( print ) {
-                //                  common->Printf( "%s:%i ", field->name, *toF );
-                //              }
             }
         }
+
+        run = 0;
     }
 
     //  common->Printf( "\n" );
@@ -1504,7 +1590,7 @@ void idMessageToFunctionsLocal::WriteDeltaPlayerstate(msg_t *msg,
     netField_t *field;
     sint *fromF, * toF;
     float32 fullFloat;
-    sint trunc, lc;
+    sint trunc, lc, run;
 
     if(!from) {
         from = &dummy;
@@ -1530,16 +1616,25 @@ void idMessageToFunctionsLocal::WriteDeltaPlayerstate(msg_t *msg,
 
     oldsize += numFields - lc;
 
+    // unchanged fields are batched into the flags of the next changed one,
+    // as in WriteDeltaEntity
+    run = 0;
+
     for(i = 0, field = playerStateFields; i < lc; i++, field++) {
         fromF = reinterpret_cast<sint *>((uchar8 *)from + field->offset);
         toF = reinterpret_cast<sint *>((uchar8 *)to + field->offset);
 
         if(*fromF == *toF) {
-            WriteBits(msg, 0, 1);   // no change
+            // no change
+            if(++run == 32) {
+                WriteFlags(msg, 0, run);
+                run = 0;
+            }
+
             continue;
         }
 
-        WriteBits(msg, 1, 1);   // changed
+        // changed
         //      pcount[i]++;
 
         if(field->bits == 0) {
@@ -1549,18 +1644,21 @@ void idMessageToFunctionsLocal::WriteDeltaPlayerstate(msg_t *msg,
 
             if(trunc == fullFloat && trunc + FLOAT_INT_BIAS >= 0 &&
                     trunc + FLOAT_INT_BIAS < (1 << FLOAT_INT_BITS)) {
-                // send as small integer
-                WriteBits(msg, 0, 1);
+                // changed, send as small integer
+                WriteFlags(msg, 1ull << run, run + 2);
                 WriteBits(msg, trunc + FLOAT_INT_BIAS, FLOAT_INT_BITS);
             } else {
-                // send as full floating point value
-                WriteBits(msg, 1, 1);
+                // changed, send as full floating point value
+                WriteFlags(msg, 3ull << run, run + 2);
                 WriteBits(msg, *toF, 32);
             }
         } else {
-            // integer
+            // changed, integer
+            WriteFlags(msg, 1ull << run, run + 1);
             WriteBits(msg, *toF, field->bits);
         }
+
+        run = 0;
     }
 
     c = msg->cursize - c;
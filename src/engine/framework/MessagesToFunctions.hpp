@@ -51,6 +51,7 @@ public:
     // sets data buffer as MSG_Init does prior to do the copy
     virtual void Copy(msg_t *buf, uchar8 *data, sint length, msg_t *src);
     virtual void WriteBits(msg_t *msg, sint value, sint bits);
+    virtual void WriteBitStream(msg_t *msg, const uchar8 *data, sint numBits);
 #if !defined(_DEBUG)
     virtual void WriteByte(msg_t *sb, sint c);
     virtual void WriteShort(msg_t *sb, sint c);
@@ -115,6 +116,7 @@ public:
     static float32 ReadDeltaKeyFloat(msg_t *msg, sint key,
                                      float32 oldV);
     static void ReportChangeVectors_f(void);
+    static void WriteFlags(msg_t *msg, uint64 flags, sint count);
 };
 
 extern idMessageToFunctionsLocal msgToFuncLocalSystem;
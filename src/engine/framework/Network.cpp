@@ -605,76 +605,163 @@ bool idNetworkSystemLocal::IsLocalAddress(netadr_t adr) {
 
 //=============================================================================
 
-/*
-==================
-idNetworkSystemLocal::GetPacket
-
-Never called by the game logic, just the system event queing
-==================
-*/
 #ifdef _DEBUG
 sint    recvfromCount;
 #endif
 
-bool idNetworkSystemLocal::GetPacket(netadr_t *net_from,
-                                     msg_t *net_message) {
-    sint    ret;
-    struct sockaddr_storage from;
-    socklen_t   fromlen;
-    sint        err;
+// packets moved per socket syscall, reported by net_iostats
+static uint recvPacketCount, recvCallCount;
+static uint sendPacketCount, sendCallCount;
 
-#ifdef _DEBUG
-    recvfromCount++;        // performance check
+#ifdef NET_BATCHED_IO
+typedef struct {
+    SOCKET socket;
+    sint length;
+    struct sockaddr_storage from;
+    socklen_t fromlen;
+    uchar8 data[MAX_MSGLEN + 1];
+} netRecvSlot_t;
+
+typedef struct {
+    SOCKET socket;
+    sint length;
+    netadr_t to;
+    struct sockaddr_storage addr;
+    socklen_t addrlen;
+    uchar8 data[MAX_PACKETLEN];
+} netSendSlot_t;
+
+static netRecvSlot_t recvSlots[NET_RECV_BATCH];
+static sint numRecvSlots, nextRecvSlot;
+
+static netSendSlot_t sendSlots[NET_SEND_BATCH];
+static sint numSendSlots;
+static bool sendBatching = false;
 #endif
 
-    if(ip_socket != INVALID_SOCKET) {
-        fromlen = sizeof(from);
-        ret = recvfrom(ip_socket, reinterpret_cast<valueType *>(net_message->data),
-                       net_message->maxsize, 0, (struct sockaddr *) &from, &fromlen);
+#ifdef NET_REACTOR
+static sint reactorFd = -1;
+static sint reactorTimer = -1;
+static SOCKET reactorSockets[2] = { INVALID_SOCKET, INVALID_SOCKET };
+#endif
 
-        if(ret == SOCKET_ERROR) {
-            err = socketError;
+/*
+==================
+idNetworkSystemLocal::ParsePacket
 
-            if(err != EAGAIN && err != ECONNRESET) {
-                common->Printf("idNetworkSystemLocal::GetPacket: %s\n", ErrorString());
+Fills in net_from for a datagram already copied into net_message
+==================
+*/
+bool idNetworkSystemLocal::ParsePacket(SOCKET sock,
+                                       struct sockaddr_storage *from, socklen_t fromlen, sint length,
+                                       netadr_t *net_from, msg_t *net_message) {
+    if(sock == ip_socket) {
+        memset(((struct sockaddr_in *)from)->sin_zero, 0, 8);
+
+        if(usingSocks && memcmp(from, &socksRelayAddr, fromlen) == 0) {
+            if(length < 10 || net_message->data[0] != 0 ||
+                    net_message->data[1] != 0 ||
+                    net_message->data[2] != 0 || net_message->data[3] != 1) {
+                return false;
             }
+
+            net_from->type = NA_IP;
+            net_from->ip[0] = net_message->data[4];
+            net_from->ip[1] = net_message->data[5];
+            net_from->ip[2] = net_message->data[6];
+            net_from->ip[3] = net_message->data[7];
+            net_from->port = *reinterpret_cast<schar16 *>(&net_message->data[8]);
+            net_message->readcount = 10;
         } else {
+            SockadrToNetadr((struct sockaddr *) from, net_from);
+            net_message->readcount = 0;
+        }
+    } else {
+        SockadrToNetadr((struct sockaddr *) from, net_from);
+        net_message->readcount = 0;
+    }
 
-            memset(((struct sockaddr_in *)&from)->sin_zero, 0, 8);
+    if(length >= net_message->maxsize) {
+        common->Printf("Oversize packet from %s\n", AdrToString(*net_from));
+        return false;
+    }
 
-            if(usingSocks && memcmp(&from, &socksRelayAddr, fromlen) == 0) {
-                if(ret < 10 || net_message->data[0] != 0 || net_message->data[1] != 0 ||
-                        net_message->data[2] != 0 || net_message->data[3] != 1) {
-                    return false;
-                }
+    net_message->cursize = length;
+    return true;
+}
 
-                net_from->type = NA_IP;
-                net_from->ip[0] = net_message->data[4];
-                net_from->ip[1] = net_message->data[5];
-                net_from->ip[2] = net_message->data[6];
-                net_from->ip[3] = net_message->data[7];
-                net_from->port = *reinterpret_cast<schar16 *>(&net_message->data[8]);
-                net_message->readcount = 10;
-            } else {
-                SockadrToNetadr((struct sockaddr *) &from, net_from);
-                net_message->readcount = 0;
-            }
+/*
+==================
+idNetworkSystemLocal::ReceivePacket
 
-            if(ret == net_message->maxsize) {
-                common->Printf("Oversize packet from %s\n", AdrToString(*net_from));
-                return false;
-            }
+Reads a single datagram from sock. Returns false if there was nothing to
+read, otherwise valid tells if net_message holds a usable packet.
+==================
+*/
+bool idNetworkSystemLocal::ReceivePacket(SOCKET sock, netadr_t *net_from,
+        msg_t *net_message, bool *valid) {
+    sint ret;
+    struct sockaddr_storage from;
+    socklen_t fromlen;
+    sint err;
 
-            net_message->cursize = ret;
-            return true;
+    fromlen = sizeof(from);
+    ret = recvfrom(sock, reinterpret_cast<valueType *>(net_message->data),
+                   net_message->maxsize, 0, (struct sockaddr *) &from, &fromlen);
+
+    recvCallCount++;
+
+    if(ret == SOCKET_ERROR) {
+        err = socketError;
+
+        if(err != EAGAIN && err != ECONNRESET) {
+            common->Printf("idNetworkSystemLocal::GetPacket: %s\n", ErrorString());
         }
+
+        return false;
     }
 
-    if(ip6_socket != INVALID_SOCKET) {
-        fromlen = sizeof(from);
-        ret = recvfrom(ip6_socket,
-                       reinterpret_cast<valueType *>(net_message->data), net_message->maxsize, 0,
-                       (struct sockaddr *) &from, &fromlen);
+    recvPacketCount++;
+
+    *valid = ParsePacket(sock, &from, fromlen, ret, net_from, net_message);
+    return true;
+}
+
+#ifdef NET_BATCHED_IO
+/*
+==================
+idNetworkSystemLocal::ReceiveBatch
+
+Refills the receive ring with a single recvmmsg call
+==================
+*/
+bool idNetworkSystemLocal::ReceiveBatch(void) {
+    struct mmsghdr hdrs[NET_RECV_BATCH];
+    struct iovec iovs[NET_RECV_BATCH];
+    SOCKET sockets[2] = { ip_socket, ip6_socket };
+    sint i, j, ret, err;
+
+    numRecvSlots = nextRecvSlot = 0;
+
+    for(i = 0; i < 2; i++) {
+        if(sockets[i] == INVALID_SOCKET) {
+            continue;
+        }
+
+        memset(hdrs, 0, sizeof(hdrs));
+
+        for(j = 0; j < NET_RECV_BATCH; j++) {
+            iovs[j].iov_base = recvSlots[j].data;
+            iovs[j].iov_len = sizeof(recvSlots[j].data);
+            hdrs[j].msg_hdr.msg_iov = &iovs[j];
+            hdrs[j].msg_hdr.msg_iovlen = 1;
+            hdrs[j].msg_hdr.msg_name = &recvSlots[j].from;
+            hdrs[j].msg_hdr.msg_namelen = sizeof(recvSlots[j].from);
+        }
+
+        ret = recvmmsg(sockets[i], hdrs, NET_RECV_BATCH, 0, nullptr);
+
+        recvCallCount++;
 
         if(ret == SOCKET_ERROR) {
             err = socketError;
@@ -682,51 +769,174 @@ bool idNetworkSystemLocal::GetPacket(netadr_t *net_from,
             if(err != EAGAIN && err != ECONNRESET) {
                 common->Printf("idNetworkSystemLocal::GetPacket: %s\n", ErrorString());
             }
-        } else {
-            SockadrToNetadr((struct sockaddr *) &from, net_from);
-            net_message->readcount = 0;
 
-            if(ret == net_message->maxsize) {
-                common->Printf("Oversize packet from %s\n", AdrToString(*net_from));
-                return false;
-            }
+            continue;
+        }
 
-            net_message->cursize = ret;
-            return true;
+        if(ret <= 0) {
+            continue;
+        }
+
+        for(j = 0; j < ret; j++) {
+            recvSlots[j].socket = sockets[i];
+            recvSlots[j].fromlen = hdrs[j].msg_hdr.msg_namelen;
+            recvSlots[j].length = hdrs[j].msg_len;
+
+            if(hdrs[j].msg_hdr.msg_flags & MSG_TRUNC) {
+                recvSlots[j].length = sizeof(recvSlots[j].data);
+            }
         }
+
+        recvPacketCount += ret;
+        numRecvSlots = ret;
+        return true;
     }
 
-    if(multicast6_socket != INVALID_SOCKET &&
-            multicast6_socket != ip6_socket) {
-        fromlen = sizeof(from);
-        ret = recvfrom(multicast6_socket,
-                       reinterpret_cast<valueType *>(net_message->data), net_message->maxsize, 0,
-                       (struct sockaddr *) &from, &fromlen);
+    return false;
+}
+#endif
 
-        if(ret == SOCKET_ERROR) {
-            err = socketError;
+/*
+==================
+idNetworkSystemLocal::GetPacket
 
-            if(err != EAGAIN && err != ECONNRESET) {
-                common->Printf("idNetworkSystemLocal::GetPacket: %s\n", ErrorString());
+Never called by the game logic, just the system event queing
+==================
+*/
+bool idNetworkSystemLocal::GetPacket(netadr_t *net_from,
+                                     msg_t *net_message) {
+    bool valid;
+
+#ifdef _DEBUG
+    recvfromCount++;        // performance check
+#endif
+
+#ifdef NET_BATCHED_IO
+
+    if(net_batchIO->integer) {
+        netRecvSlot_t *slot;
+
+        for(;;) {
+            if(nextRecvSlot == numRecvSlots && !ReceiveBatch()) {
+                break;
             }
-        } else {
-            SockadrToNetadr((struct sockaddr *) &from, net_from);
-            net_message->readcount = 0;
 
-            if(ret == net_message->maxsize) {
-                common->Printf("Oversize packet from %s\n", AdrToString(*net_from));
-                return false;
+            slot = &recvSlots[nextRecvSlot++];
+
+            ::memcpy(net_message->data, slot->data, Q_min(slot->length,
+                     net_message->maxsize));
+
+            if(ParsePacket(slot->socket, &slot->from, slot->fromlen, slot->length,
+                           net_from, net_message)) {
+                return true;
             }
+        }
+    } else
+#endif
+    {
+        if(ip_socket != INVALID_SOCKET &&
+                ReceivePacket(ip_socket, net_from, net_message, &valid)) {
+            return valid;
+        }
 
-            net_message->cursize = ret;
-            return true;
+        if(ip6_socket != INVALID_SOCKET &&
+                ReceivePacket(ip6_socket, net_from, net_message, &valid)) {
+            return valid;
         }
     }
 
+    if(multicast6_socket != INVALID_SOCKET &&
+            multicast6_socket != ip6_socket &&
+            ReceivePacket(multicast6_socket, net_from, net_message, &valid)) {
+        return valid;
+    }
 
     return false;
 }
 
+/*
+==================
+idNetworkSystemLocal::SendError
+==================
+*/
+void idNetworkSystemLocal::SendError(netadr_t *to) {
+    sint err = socketError;
+
+    // wouldblock is silent
+    if(err == EAGAIN) {
+        return;
+    }
+
+    // some PPP links do not allow broadcasts and return an error
+    if((err == EADDRNOTAVAIL) && ((to->type == NA_BROADCAST))) {
+        return;
+    }
+
+    common->Printf("idNetworkSystemLocal::SendPacket: %s\n", ErrorString());
+}
+
+/*
+==================
+idNetworkSystemLocal::BeginPacketBatch
+
+Until FlushPacketBatch, outgoing datagrams are queued and sent together
+==================
+*/
+void idNetworkSystemLocal::BeginPacketBatch(void) {
+#ifdef NET_BATCHED_IO
+    sendBatching = net_batchIO->integer ? true : false;
+#endif
+}
+
+/*
+==================
+idNetworkSystemLocal::FlushPacketBatch
+==================
+*/
+void idNetworkSystemLocal::FlushPacketBatch(void) {
+#ifdef NET_BATCHED_IO
+    struct mmsghdr hdrs[NET_SEND_BATCH];
+    struct iovec iovs[NET_SEND_BATCH];
+    sint i, first, count, ret;
+
+    sendBatching = false;
+
+    memset(hdrs, 0, numSendSlots * sizeof(hdrs[0]));
+
+    for(i = 0; i < numSendSlots; i++) {
+        iovs[i].iov_base = sendSlots[i].data;
+        iovs[i].iov_len = sendSlots[i].length;
+        hdrs[i].msg_hdr.msg_iov = &iovs[i];
+        hdrs[i].msg_hdr.msg_iovlen = 1;
+        hdrs[i].msg_hdr.msg_name = &sendSlots[i].addr;
+        hdrs[i].msg_hdr.msg_namelen = sendSlots[i].addrlen;
+    }
+
+    // sendmmsg works on one socket, send each run of ipv4 or ipv6
+    // packets in turn so the ordering is kept
+    for(first = 0; first < numSendSlots; first += ret) {
+        for(count = 1; first + count < numSendSlots &&
+                sendSlots[first + count].socket == sendSlots[first].socket; count++) {
+        }
+
+        ret = sendmmsg(sendSlots[first].socket, &hdrs[first], count, 0);
+
+        sendCallCount++;
+
+        if(ret == SOCKET_ERROR || ret == 0) {
+            // skip the datagram that failed
+            SendError(&sendSlots[first].to);
+            ret = 1;
+            continue;
+        }
+
+        sendPacketCount += ret;
+    }
+
+    numSendSlots = 0;
+#endif
+}
+
 /*
 ==================
 idNetworkSystemLocal::SendPacket
@@ -757,6 +967,42 @@ void idNetworkSystemLocal::SendPacket(sint length, const void *data,
     memset(&addr, 0, sizeof(addr));
     NetadrToSockadr(&to, (struct sockaddr *) &addr);
 
+#ifdef NET_BATCHED_IO
+
+    if(sendBatching) {
+        if(!usingSocks && length <= MAX_PACKETLEN &&
+                (addr.ss_family == AF_INET || addr.ss_family == AF_INET6)) {
+            netSendSlot_t *slot;
+
+            if(numSendSlots == NET_SEND_BATCH) {
+                FlushPacketBatch();
+                sendBatching = true;
+            }
+
+            slot = &sendSlots[numSendSlots++];
+            slot->to = to;
+            slot->length = length;
+            slot->addr = addr;
+
+            if(addr.ss_family == AF_INET) {
+                slot->socket = ip_socket;
+                slot->addrlen = sizeof(struct sockaddr_in);
+            } else {
+                slot->socket = ip6_socket;
+                slot->addrlen = sizeof(struct sockaddr_in6);
+            }
+
+            ::memcpy(slot->data, data, length);
+            return;
+        }
+
+        // anything we can't queue goes out after what is already queued
+        FlushPacketBatch();
+        sendBatching = true;
+    }
+
+#endif
+
     if(usingSocks && to.type == NA_IP) {
         socksBuf[0] = 0;    // reserved
         socksBuf[1] = 0;
@@ -779,20 +1025,39 @@ void idNetworkSystemLocal::SendPacket(sint length, const void *data,
         }
     }
 
-    if(ret == SOCKET_ERROR) {
-        sint err = socketError;
+    sendCallCount++;
 
-        // wouldblock is silent
-        if(err == EAGAIN) {
-            return;
-        }
+    if(ret == SOCKET_ERROR) {
+        SendError(&to);
+        return;
+    }
 
-        // some PPP links do not allow broadcasts and return an error
-        if((err == EADDRNOTAVAIL) && ((to.type == NA_BROADCAST))) {
-            return;
-        }
+    sendPacketCount++;
+}
 
-        common->Printf("idNetworkSystemLocal::SendPacket: %s\n", ErrorString());
+/*
+==================
+idNetworkSystemLocal::IOStats_f
+==================
+*/
+void idNetworkSystemLocal::IOStats_f(void) {
+#ifdef NET_BATCHED_IO
+    common->Printf("batched io: %s\n", net_batchIO->integer ? "on" : "off");
+#else
+    common->Printf("batched io: not supported on this platform\n");
+#endif
+    common->Printf("received %u packets in %u calls (%.2f per call)\n",
+                   recvPacketCount, recvCallCount,
+                   recvCallCount ? static_cast<float32>(recvPacketCount) / recvCallCount :
+                   0.0f);
+    common->Printf("sent %u packets in %u calls (%.2f per call)\n",
+                   sendPacketCount, sendCallCount,
+                   sendCallCount ? static_cast<float32>(sendPacketCount) / sendCallCount :
+                   0.0f);
+
+    if(cmdSystem->Argc() > 1 && !Q_stricmp(cmdSystem->Argv(1), "reset")) {
+        recvPacketCount = recvCallCount = 0;
+        sendPacketCount = sendCallCount = 0;
     }
 }
 
@@ -1685,6 +1950,16 @@ void idNetworkSystemLocal::Config(bool enableNetworking) {
             socks_socket = INVALID_SOCKET;
         }
 
+#ifdef NET_BATCHED_IO
+        // anything still buffered belongs to the old sockets
+        numRecvSlots = nextRecvSlot = 0;
+        numSendSlots = 0;
+#endif
+
+#ifdef NET_REACTOR
+        // closing the sockets dropped them from the epoll set
+        reactorSockets[0] = reactorSockets[1] = INVALID_SOCKET;
+#endif
     }
 
     if(start) {
@@ -1729,6 +2004,8 @@ void idNetworkSystemLocal::Init(void) {
 
     cmdSystem->AddCommand("net_restart", NETRestart_f,
                           "If you change any net_ setting in-game or in a config you need to also to a net_restart to make the changes take effect, i have seen very few people with this in their configurations, but i have seen some people specify a lot of net_ settings and they have it in their config.");
+    cmdSystem->AddCommand("net_iostats", IOStats_f,
+                          "Shows how many packets were moved per socket syscall. Use \"net_iostats reset\" to clear the counters.");
 }
 
 
@@ -1744,6 +2021,10 @@ void idNetworkSystemLocal::Shutdown(void) {
 
     Config(false);
 
+#ifdef NET_REACTOR
+    CloseReactor();
+#endif
+
 #ifdef _WIN32
     WSACleanup();
     winsockInitialized = false;
@@ -1761,6 +2042,7 @@ void idNetworkSystemLocal::Event(fd_set *fdr) {
     uchar8 bufData[MAX_MSGLEN + 1];
     netadr_t from;
     msg_t netmsg;
+    idProfileScope profile("NET_Event");
 
     while(1) {
         msgToFuncSystem->Init(&netmsg, bufData, sizeof(bufData));
@@ -1790,6 +2072,166 @@ void idNetworkSystemLocal::Event(fd_set *fdr) {
 }
 
 
+#ifdef NET_REACTOR
+/*
+====================
+idNetworkSystemLocal::OpenReactor
+
+Creates the epoll set and deadline timer on first use and keeps the
+game sockets registered with it
+====================
+*/
+bool idNetworkSystemLocal::OpenReactor(void) {
+    struct epoll_event event;
+    SOCKET sockets[2] = { ip_socket, ip6_socket };
+    sint i;
+
+    if(reactorFd == -1) {
+        reactorFd = epoll_create1(EPOLL_CLOEXEC);
+
+        if(reactorFd == -1) {
+            common->Printf("WARNING: idNetworkSystemLocal::OpenReactor: epoll_create1: %s\n",
+                           ErrorString());
+            return false;
+        }
+
+        reactorTimer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+        if(reactorTimer == -1) {
+            common->Printf("WARNING: idNetworkSystemLocal::OpenReactor: timerfd_create: %s\n",
+                           ErrorString());
+            CloseReactor();
+            return false;
+        }
+
+        ::memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.fd = reactorTimer;
+
+        if(epoll_ctl(reactorFd, EPOLL_CTL_ADD, reactorTimer, &event) == -1) {
+            common->Printf("WARNING: idNetworkSystemLocal::OpenReactor: epoll_ctl: %s\n",
+                           ErrorString());
+            CloseReactor();
+            return false;
+        }
+    }
+
+    for(i = 0; i < 2; i++) {
+        if(reactorSockets[i] == sockets[i]) {
+            continue;
+        }
+
+        if(reactorSockets[i] != INVALID_SOCKET) {
+            epoll_ctl(reactorFd, EPOLL_CTL_DEL, reactorSockets[i], nullptr);
+        }
+
+        reactorSockets[i] = INVALID_SOCKET;
+
+        if(sockets[i] == INVALID_SOCKET) {
+            continue;
+        }
+
+        ::memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.fd = sockets[i];
+
+        if(epoll_ctl(reactorFd, EPOLL_CTL_ADD, sockets[i], &event) == -1) {
+            common->Printf("WARNING: idNetworkSystemLocal::OpenReactor: epoll_ctl: %s\n",
+                           ErrorString());
+            return false;
+        }
+
+        reactorSockets[i] = sockets[i];
+    }
+
+    return true;
+}
+
+/*
+====================
+idNetworkSystemLocal::CloseReactor
+====================
+*/
+void idNetworkSystemLocal::CloseReactor(void) {
+    if(reactorTimer != -1) {
+        close(reactorTimer);
+        reactorTimer = -1;
+    }
+
+    if(reactorFd != -1) {
+        close(reactorFd);
+        reactorFd = -1;
+    }
+
+    reactorSockets[0] = reactorSockets[1] = INVALID_SOCKET;
+}
+
+/*
+====================
+idNetworkSystemLocal::ReactorWait
+
+Waits usec microseconds or until a packet arrives. The timer runs on
+CLOCK_MONOTONIC with a relative value, so stepping the wall clock doesn't
+stretch the wait. Returns false if the reactor can't be used and the caller
+should fall back to select.
+====================
+*/
+bool idNetworkSystemLocal::ReactorWait(sint64 usec) {
+    struct epoll_event events[4];
+    struct itimerspec deadline;
+    uint64 expirations;
+    sint i, count;
+    bool readable = false;
+
+    if(!OpenReactor()) {
+        return false;
+    }
+
+    // a zero it_value would disarm the timer
+    if(usec < 1) {
+        usec = 1;
+    }
+
+    ::memset(&deadline, 0, sizeof(deadline));
+    deadline.it_value.tv_sec = usec / 1000000;
+    deadline.it_value.tv_nsec = (usec % 1000000) * 1000;
+
+    if(timerfd_settime(reactorTimer, 0, &deadline, nullptr) == -1) {
+        common->Printf("WARNING: idNetworkSystemLocal::ReactorWait: timerfd_settime: %s\n",
+                       ErrorString());
+        return false;
+    }
+
+    count = epoll_wait(reactorFd, events, ARRAY_LEN(events), -1);
+
+    if(count == -1) {
+        if(errno != EINTR) {
+            common->Printf("Warning: epoll_wait() syscall failed: %s\n",
+                           ErrorString());
+        }
+
+        return true;
+    }
+
+    for(i = 0; i < count; i++) {
+        if(events[i].data.fd == reactorTimer) {
+            // acknowledge the expiration so the timer isn't reported again
+            if(read(reactorTimer, &expirations, sizeof(expirations)) == -1) {
+                continue;
+            }
+        } else {
+            readable = true;
+        }
+    }
+
+    if(readable) {
+        Event(nullptr);
+    }
+
+    return true;
+}
+#endif
+
 /*
 ====================
 idNetworkSystemLocal::Sleep
@@ -1798,6 +2240,17 @@ Sleeps msec or until something happens on the network
 ====================
 */
 void idNetworkSystemLocal::Sleep(sint msec) {
+    SleepUsec(static_cast<sint64>(msec) * 1000);
+}
+
+/*
+====================
+idNetworkSystemLocal::SleepUsec
+
+Sleeps usec or until something happens on the network
+====================
+*/
+void idNetworkSystemLocal::SleepUsec(sint64 usec) {
     struct timeval timeout;
     fd_set  fdset;
     sint highestfd = -1;
@@ -1810,10 +2263,18 @@ void idNetworkSystemLocal::Sleep(sint msec) {
         return;
     }
 
-    if(msec < 0) {
+    if(usec < 0) {
+        return;
+    }
+
+#ifdef NET_REACTOR
+
+    if(ReactorWait(usec)) {
         return;
     }
 
+#endif
+
     FD_ZERO(&fdset);
 
     if(ip_socket != INVALID_SOCKET) {
@@ -1835,15 +2296,15 @@ void idNetworkSystemLocal::Sleep(sint msec) {
 
     if(highestfd == INVALID_SOCKET) {
         // windows ain't happy when select is called without valid FDs
-        SleepEx(msec, 0);
+        SleepEx(static_cast<DWORD>(usec / 1000), 0);
         return;
     }
 
 #endif
 
 
-    timeout.tv_sec = msec / 1000;
-    timeout.tv_usec = (msec % 1000) * 1000;
+    timeout.tv_sec = usec / 1000000;
+    timeout.tv_usec = usec % 1000000;
 
     sint retval = select(highestfd + 1, &fdset, NULL, NULL, &timeout);
 
@@ -68,6 +68,16 @@ static bool winsockInitialized = false;
 #define ioctlsocket         ioctl
 #define socketError         errno
 typedef sint SOCKET;
+
+#if defined (__linux__)
+// recvmmsg and sendmmsg move several datagrams per syscall
+#define NET_BATCHED_IO
+#define NET_RECV_BATCH      16
+#define NET_SEND_BATCH      64
+
+// dedicated servers wait on epoll with a timerfd deadline instead of select
+#define NET_REACTOR
+#endif
 #endif
 
 #ifndef IF_NAMESIZE
@@ -139,6 +149,9 @@ public:
     virtual void Sleep(sint msec);
     virtual void Restart_f(void);
     virtual sint ConnectTCP(valueType *s_host_port);
+    virtual void BeginPacketBatch(void);
+    virtual void FlushPacketBatch(void);
+    virtual void SleepUsec(sint64 usec);
 
     static valueType *ErrorString(void);
     static void SockaddrToString(valueType *dest, uint64 destlen,
@@ -162,6 +175,16 @@ public:
     static void Config(bool enableNetworking);
     static void NETRestart_f(void);
     static void Event(fd_set *fdr);
+    bool ParsePacket(SOCKET sock, struct sockaddr_storage *from,
+                     socklen_t fromlen, sint length, netadr_t *net_from, msg_t *net_message);
+    bool ReceivePacket(SOCKET sock, netadr_t *net_from, msg_t *net_message,
+                       bool *valid);
+    bool ReceiveBatch(void);
+    static void SendError(netadr_t *to);
+    static void IOStats_f(void);
+    static bool OpenReactor(void);
+    static void CloseReactor(void);
+    static bool ReactorWait(sint64 usec);
 };
 
 extern idNetworkSystemLocal networkSystemLocal;
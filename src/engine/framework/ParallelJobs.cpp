@@ -0,0 +1,223 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Copyright(C) 2011 - 2023 Dusan Jocic <dusanjocic@msn.com>
+//
+// This file is part of the OpenWolf GPL Source Code.
+// OpenWolf Source Code is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWolf Source Code is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with OpenWolf Source Code.  If not, see <http://www.gnu.org/licenses/>.
+//
+// In addition, the OpenWolf Source Code is also subject to certain additional terms.
+// You should have received a copy of these additional terms immediately following the
+// terms and conditions of the GNU General Public License which accompanied the
+// OpenWolf Source Code. If not, please request a copy in writing from id Software
+// at the address below.
+//
+// If you have questions concerning this license or the applicable additional terms,
+// you may contact in writing id Software LLC, c/o ZeniMax Media Inc.,
+// Suite 120, Rockville, Maryland 20850 USA.
+//
+// -------------------------------------------------------------------------------------
+// File name:   ParallelJobs.cpp
+// Created:     10/18/2026
+// Compilers:   Microsoft (R) C/C++ Optimizing Compiler Version 19.26.28806 for x64,
+//              gcc (Ubuntu 9.3.0-10ubuntu2) 9.3.0,
+//              AppleClang 9.0.0.9000039
+// Description: Fork/join worker pool used to spread independent per-frame work
+// -------------------------------------------------------------------------------------
+////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef UPDATE_SERVER
+#include <server/serverAutoPrecompiled.hpp>
+#elif DEDICATED
+#include <server/serverDedPrecompiled.hpp>
+#else
+#include <framework/precompiled.hpp>
+#endif
+
+idParallelJobSystemLocal parallelJobLocal;
+idParallelJobSystem *parallelJobSystem = &parallelJobLocal;
+
+/*
+===============
+idParallelJobSystemLocal::idParallelJobSystemLocal
+===============
+*/
+idParallelJobSystemLocal::idParallelJobSystemLocal(void) : numWorkers(0),
+    activeWorkers(0), busyWorkers(0), jobGeneration(0), quit(false),
+    jobFunction(nullptr), jobData(nullptr), numJobs(0), nextJob(0) {
+}
+
+/*
+===============
+idParallelJobSystemLocal::~idParallelJobSystemLocal
+===============
+*/
+idParallelJobSystemLocal::~idParallelJobSystemLocal(void) {
+    Shutdown();
+}
+
+/*
+===============
+idParallelJobSystemLocal::NumCores
+===============
+*/
+sint idParallelJobSystemLocal::NumCores(void) {
+    sint cores = static_cast<sint>(std::thread::hardware_concurrency());
+
+    return cores > 0 ? cores : 1;
+}
+
+/*
+===============
+idParallelJobSystemLocal::ExecuteJobs
+
+Pulls job indexes until the current batch is drained
+===============
+*/
+void idParallelJobSystemLocal::ExecuteJobs(void) {
+    sint job;
+
+    for(;;) {
+        job = nextJob.fetch_add(1);
+
+        if(job >= numJobs) {
+            break;
+        }
+
+        jobFunction(jobData, job);
+    }
+}
+
+/*
+===============
+idParallelJobSystemLocal::WorkerThread
+===============
+*/
+void idParallelJobSystemLocal::WorkerThread(sint index) {
+    sint generation = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for(;;) {
+        wakeCondition.wait(lock, [&] {
+            return quit || generation != jobGeneration;
+        });
+
+        if(quit) {
+            return;
+        }
+
+        generation = jobGeneration;
+
+        // the pool may have been asked for fewer threads than it has
+        if(index >= activeWorkers) {
+            continue;
+        }
+
+        busyWorkers++;
+        lock.unlock();
+
+        ExecuteJobs();
+
+        lock.lock();
+        busyWorkers--;
+
+        if(!busyWorkers) {
+            doneCondition.notify_all();
+        }
+    }
+}
+
+/*
+===============
+idParallelJobSystemLocal::Run
+
+Calls function( data, 0 .. numJobs - 1 ) spread across numThreads threads,
+the calling thread included, and returns once every job has finished
+===============
+*/
+void idParallelJobSystemLocal::Run(parallelJobFunction_t function,
+                                   void *data, sint numJobs, sint numThreads) {
+    sint i;
+
+    if(numThreads > MAX_PARALLEL_JOB_THREADS + 1) {
+        numThreads = MAX_PARALLEL_JOB_THREADS + 1;
+    }
+
+    if(numThreads > numJobs) {
+        numThreads = numJobs;
+    }
+
+    if(numThreads <= 1) {
+        for(i = 0; i < numJobs; i++) {
+            function(data, i);
+        }
+
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    // a worker that woke up late for the previous batch may still be
+    // draining it, don't pull the job description from under it
+    doneCondition.wait(lock, [&] {
+        return !busyWorkers;
+    });
+
+    while(numWorkers < numThreads - 1) {
+        workers[numWorkers] = std::thread(&idParallelJobSystemLocal::WorkerThread,
+                                          this, numWorkers);
+        numWorkers++;
+    }
+
+    jobFunction = function;
+    jobData = data;
+    this->numJobs = numJobs;
+    nextJob = 0;
+    activeWorkers = numThreads - 1;
+    jobGeneration++;
+
+    lock.unlock();
+    wakeCondition.notify_all();
+
+    ExecuteJobs();
+
+    lock.lock();
+    doneCondition.wait(lock, [&] {
+        return !busyWorkers;
+    });
+}
+
+/*
+===============
+idParallelJobSystemLocal::Shutdown
+===============
+*/
+void idParallelJobSystemLocal::Shutdown(void) {
+    sint i;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+
+    wakeCondition.notify_all();
+
+    for(i = 0; i < numWorkers; i++) {
+        if(workers[i].joinable()) {
+            workers[i].join();
+        }
+    }
+
+    numWorkers = 0;
+    activeWorkers = 0;
+    quit = false;
+}
@@ -0,0 +1,506 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Copyright(C) 2011 - 2023 Dusan Jocic <dusanjocic@msn.com>
+//
+// This file is part of the OpenWolf GPL Source Code.
+// OpenWolf Source Code is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWolf Source Code is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with OpenWolf Source Code.  If not, see <http://www.gnu.org/licenses/>.
+//
+// In addition, the OpenWolf Source Code is also subject to certain additional terms.
+// You should have received a copy of these additional terms immediately following the
+// terms and conditions of the GNU General Public License which accompanied the
+// OpenWolf Source Code. If not, please request a copy in writing from id Software
+// at the address below.
+//
+// If you have questions concerning this license or the applicable additional terms,
+// you may contact in writing id Software LLC, c/o ZeniMax Media Inc.,
+// Suite 120, Rockville, Maryland 20850 USA.
+//
+// -------------------------------------------------------------------------------------
+// File name:   Profiler.cpp
+// Created:     10/18/2026
+// Compilers:   Microsoft (R) C/C++ Optimizing Compiler Version 19.26.28806 for x64,
+//              gcc (Ubuntu 9.3.0-10ubuntu2) 9.3.0,
+//              AppleClang 9.0.0.9000039
+// Description: Hierarchical scoped timers recorded per thread for frame profiling
+// -------------------------------------------------------------------------------------
+////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef UPDATE_SERVER
+#include <server/serverAutoPrecompiled.hpp>
+#elif DEDICATED
+#include <server/serverDedPrecompiled.hpp>
+#else
+#include <framework/precompiled.hpp>
+#endif
+
+static const std::chrono::steady_clock::time_point s_profileEpoch =
+    std::chrono::steady_clock::now();
+
+// rings are never freed, a worker may still be writing when the profiler
+// shuts down
+static profileThread_t s_profileThreads[MAX_PROFILE_THREADS];
+static thread_local profileThreadSlot_t s_profileSlot;
+static std::atomic<bool> s_profileRecording;
+
+// main thread only
+static profileZone_t s_profileZones[MAX_PROFILE_ZONES];
+static sint s_numProfileZones;
+static uint64 s_profileFrames;
+static uint64 s_profileDropped;
+
+idProfilerSystemLocal profilerLocal;
+idProfilerSystem *profilerSystem = &profilerLocal;
+
+/*
+===============
+idProfilerSystemLocal::idProfilerSystemLocal
+===============
+*/
+idProfilerSystemLocal::idProfilerSystemLocal(void) {
+}
+
+/*
+===============
+idProfilerSystemLocal::~idProfilerSystemLocal
+===============
+*/
+idProfilerSystemLocal::~idProfilerSystemLocal(void) {
+}
+
+/*
+===============
+profileThreadSlot_s::~profileThreadSlot_s
+===============
+*/
+profileThreadSlot_s::~profileThreadSlot_s(void) {
+    if(thread) {
+        thread->depth = 0;
+        thread->inUse = false;
+    }
+}
+
+/*
+===============
+idProfilerSystemLocal::Init
+===============
+*/
+void idProfilerSystemLocal::Init(void) {
+    cmdSystem->AddCommand("profile", &idProfilerSystemLocal::Profile_f,
+                          "Shows how long the profile zones took per frame, profile reset starts over. Needs com_profile 1");
+    cmdSystem->AddCommand("profile_trace", &idProfilerSystemLocal::ProfileTrace_f,
+                          "Writes the recent profile zones of every thread as a Chrome trace, profile_trace [filename]");
+}
+
+/*
+===============
+idProfilerSystemLocal::Shutdown
+===============
+*/
+void idProfilerSystemLocal::Shutdown(void) {
+    s_profileRecording = false;
+}
+
+/*
+===============
+idProfilerSystemLocal::Nanoseconds
+===============
+*/
+sint64 idProfilerSystemLocal::Nanoseconds(void) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>
+           (std::chrono::steady_clock::now() - s_profileEpoch).count();
+}
+
+/*
+===============
+idProfilerSystemLocal::Microseconds
+===============
+*/
+sint64 idProfilerSystemLocal::Microseconds(void) {
+    return Nanoseconds() / 1000;
+}
+
+/*
+===============
+idProfilerSystemLocal::ClaimThread
+
+Hands the calling thread a ring of its own
+===============
+*/
+profileThread_t *idProfilerSystemLocal::ClaimThread(void) {
+    for(sint i = 0; i < MAX_PROFILE_THREADS; i++) {
+        profileThread_t *thread = &s_profileThreads[i];
+        bool expected = false;
+
+        if(!thread->inUse.compare_exchange_strong(expected, true)) {
+            continue;
+        }
+
+        if(!thread->events) {
+            thread->events = static_cast<profileEvent_t *>(malloc(sizeof(
+                                 profileEvent_t) * PROFILE_RING_EVENTS));
+
+            if(!thread->events) {
+                thread->inUse = false;
+                return nullptr;
+            }
+        }
+
+        thread->depth = 0;
+
+        return thread;
+    }
+
+    return nullptr;
+}
+
+/*
+===============
+idProfilerSystemLocal::BeginZone
+===============
+*/
+bool idProfilerSystemLocal::BeginZone(pointer name) {
+    profileThread_t *thread;
+    profileOpenZone_t *open;
+
+    if(!s_profileRecording.load(std::memory_order_relaxed)) {
+        return false;
+    }
+
+    thread = s_profileSlot.thread;
+
+    if(!thread) {
+        thread = s_profileSlot.thread = ClaimThread();
+
+        if(!thread) {
+            return false;
+        }
+    }
+
+    // zones nested too deep are still counted so the ends pair up
+    if(thread->depth < MAX_PROFILE_DEPTH) {
+        open = &thread->stack[thread->depth];
+        open->name = name;
+        open->parent = thread->depth ? thread->stack[thread->depth - 1].name :
+                       nullptr;
+        open->start = Nanoseconds();
+    }
+
+    thread->depth++;
+
+    return true;
+}
+
+/*
+===============
+idProfilerSystemLocal::EndZone
+===============
+*/
+void idProfilerSystemLocal::EndZone(void) {
+    sint64 end, duration;
+    uint64 head;
+    profileThread_t *thread;
+    profileOpenZone_t *open;
+    profileEvent_t *event;
+
+    end = Nanoseconds();
+    thread = s_profileSlot.thread;
+
+    if(--thread->depth >= MAX_PROFILE_DEPTH) {
+        return;
+    }
+
+    open = &thread->stack[thread->depth];
+    duration = end - open->start;
+
+    head = thread->head.load(std::memory_order_relaxed);
+    event = &thread->events[head & (PROFILE_RING_EVENTS - 1)];
+    event->name = open->name;
+    event->parent = open->parent;
+    event->start = open->start;
+    event->duration = duration < 0xffffffff ? static_cast<uint>(duration) :
+                      0xffffffff;
+    event->depth = thread->depth;
+
+    // publish the event to the main thread
+    thread->head.store(head + 1, std::memory_order_release);
+}
+
+/*
+===============
+idProfilerSystemLocal::CopyEvents
+
+Copies the events written since from, or as many of them as the ring
+still holds, and throws away the ones the owner may have overwritten
+while they were being copied.  Returns the head that was copied up to.
+===============
+*/
+sint idProfilerSystemLocal::CopyEvents(profileThread_t *thread,
+                                       uint64 from, profileEvent_t *out, uint64 *first) {
+    uint64 head, start, valid, i;
+    sint num;
+
+    head = thread->head.load(std::memory_order_acquire);
+    start = head > PROFILE_RING_EVENTS ? head - PROFILE_RING_EVENTS : 0;
+
+    if(start < from) {
+        start = from;
+    }
+
+    for(i = start; i < head; i++) {
+        out[i - start] = thread->events[i & (PROFILE_RING_EVENTS - 1)];
+    }
+
+    // the owner may be writing the slot of head already, which is the
+    // one of head - PROFILE_RING_EVENTS
+    head = thread->head.load(std::memory_order_acquire);
+    valid = head + 1 > PROFILE_RING_EVENTS ? head + 1 - PROFILE_RING_EVENTS : 0;
+    num = static_cast<sint>(i - start);
+
+    if(valid > start) {
+        num -= static_cast<sint>(Q_min(valid - start, i - start));
+        ::memmove(out, out + (i - start - num), num * sizeof(*out));
+        start = i - num;
+    }
+
+    *first = start;
+
+    return num;
+}
+
+/*
+===============
+idProfilerSystemLocal::FindZone
+===============
+*/
+profileZone_t *idProfilerSystemLocal::FindZone(pointer name,
+        pointer parent, sint depth) {
+    static sint last;
+    profileZone_t *zone;
+
+    // runs of the same zone are common
+    if(last < s_numProfileZones && s_profileZones[last].name == name &&
+            s_profileZones[last].parent == parent) {
+        return &s_profileZones[last];
+    }
+
+    for(sint i = 0; i < s_numProfileZones; i++) {
+        if(s_profileZones[i].name == name && s_profileZones[i].parent == parent) {
+            last = i;
+            return &s_profileZones[i];
+        }
+    }
+
+    if(s_numProfileZones == MAX_PROFILE_ZONES) {
+        return nullptr;
+    }
+
+    last = s_numProfileZones++;
+    zone = &s_profileZones[last];
+    ::memset(zone, 0, sizeof(*zone));
+    zone->name = name;
+    zone->parent = parent;
+    zone->depth = depth;
+
+    return zone;
+}
+
+/*
+===============
+idProfilerSystemLocal::DrainThread
+
+Folds the events a thread finished since the last frame into the zones
+===============
+*/
+void idProfilerSystemLocal::DrainThread(profileThread_t *thread) {
+    sint i, num;
+    uint64 first;
+    profileEvent_t *event;
+    profileZone_t *zone;
+    idScratchScope scratch;
+    profileEvent_t *events = static_cast<profileEvent_t *>(scratch.Alloc(sizeof(
+                                 profileEvent_t) * PROFILE_RING_EVENTS));
+
+    num = CopyEvents(thread, thread->drained, events, &first);
+
+    s_profileDropped += first - thread->drained;
+    thread->drained = first + num;
+
+    for(i = 0, event = events; i < num; i++, event++) {
+        zone = FindZone(event->name, event->parent, event->depth);
+
+        if(!zone) {
+            s_profileDropped++;
+            continue;
+        }
+
+        zone->count++;
+        zone->totalUsec += event->duration * 0.001;
+        zone->samples[zone->nextSample] = event->duration;
+        zone->nextSample = (zone->nextSample + 1) % PROFILE_WINDOW;
+
+        if(zone->numSamples < PROFILE_WINDOW) {
+            zone->numSamples++;
+        }
+    }
+}
+
+/*
+===============
+idProfilerSystemLocal::EndFrame
+
+Called by the main thread at the end of every frame
+===============
+*/
+void idProfilerSystemLocal::EndFrame(void) {
+    bool recording = s_profileRecording;
+
+    s_profileRecording = com_profile->integer != 0;
+
+    if(!recording) {
+        return;
+    }
+
+    for(sint i = 0; i < MAX_PROFILE_THREADS; i++) {
+        profileThread_t *thread = &s_profileThreads[i];
+
+        if(thread->head.load(std::memory_order_acquire) != thread->drained) {
+            DrainThread(thread);
+        }
+    }
+
+    s_profileFrames++;
+}
+
+/*
+===============
+idProfilerSystemLocal::PrintZones_r
+===============
+*/
+void idProfilerSystemLocal::PrintZones_r(pointer parent, sint depth) {
+    sint i, j;
+    uint max;
+    static uint samples[PROFILE_WINDOW];
+    profileZone_t *zone;
+
+    for(i = 0, zone = s_profileZones; i < s_numProfileZones; i++, zone++) {
+        if(zone->parent != parent || zone->depth != depth) {
+            continue;
+        }
+
+        ::memcpy(samples, zone->samples, zone->numSamples * sizeof(samples[0]));
+        std::sort(samples, samples + zone->numSamples);
+
+        for(j = 0, max = 0; j < zone->numSamples; j++) {
+            max = samples[j] > max ? samples[j] : max;
+        }
+
+        common->Printf("%*s%-*s %9.2f %9.1f %9.1f %9.1f %9.1f\n", depth * 2, "",
+                       32 - depth * 2, zone->name,
+                       static_cast<float64>(zone->count) / s_profileFrames,
+                       zone->totalUsec / zone->count,
+                       samples[zone->numSamples / 2] * 0.001,
+                       samples[(zone->numSamples * 99) / 100] * 0.001, max * 0.001);
+
+        if(depth + 1 < MAX_PROFILE_DEPTH) {
+            PrintZones_r(zone->name, depth + 1);
+        }
+    }
+}
+
+/*
+===============
+idProfilerSystemLocal::Profile_f
+===============
+*/
+void idProfilerSystemLocal::Profile_f(void) {
+    if(!Q_stricmp(cmdSystem->Argv(1), "reset")) {
+        s_numProfileZones = 0;
+        s_profileFrames = 0;
+        s_profileDropped = 0;
+        return;
+    }
+
+    if(!s_profileFrames || !s_numProfileZones) {
+        common->Printf("No profile zones recorded, set com_profile 1 first\n");
+        return;
+    }
+
+    common->Printf("%-32s %9s %9s %9s %9s %9s\n", "zone (usec)", "calls/fr",
+                   "mean", "p50", "p99", "max");
+
+    PrintZones_r(nullptr, 0);
+
+    common->Printf("%llu frames, percentiles over the last %i calls of each zone, %llu events dropped\n",
+                   s_profileFrames, PROFILE_WINDOW, s_profileDropped);
+}
+
+/*
+===============
+idProfilerSystemLocal::ProfileTrace_f
+
+Writes what is left in the rings in the Chrome trace event format, it can
+be opened with chrome://tracing or Perfetto
+===============
+*/
+void idProfilerSystemLocal::ProfileTrace_f(void) {
+    sint i, j, num, total;
+    uint64 first;
+    pointer filename;
+    fileHandle_t f;
+    profileEvent_t *event;
+    idScratchScope scratch;
+    profileEvent_t *events = static_cast<profileEvent_t *>(scratch.Alloc(sizeof(
+                                 profileEvent_t) * PROFILE_RING_EVENTS));
+
+    filename = cmdSystem->Argc() > 1 ? cmdSystem->Argv(1) : "profile.json";
+
+    f = fileSystem->FOpenFileWrite(filename);
+
+    if(!f) {
+        common->Printf("Couldn't open %s for writing\n", filename);
+        return;
+    }
+
+    // leading entry so that every event after it can start with a comma
+    fileSystem->Printf(f,
+                       "{\"traceEvents\":[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"%s\"}}\n",
+                       ENGINE_NAME);
+
+    for(i = 0, total = 0; i < MAX_PROFILE_THREADS; i++) {
+        profileThread_t *thread = &s_profileThreads[i];
+
+        if(!thread->head.load(std::memory_order_acquire)) {
+            continue;
+        }
+
+        fileSystem->Printf(f,
+                           ",{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%i,\"args\":{\"name\":\"%s %i\"}}\n",
+                           i, thread == s_profileSlot.thread ? "main" : "thread", i);
+
+        num = CopyEvents(thread, 0, events, &first);
+
+        for(j = 0, event = events; j < num; j++, event++) {
+            fileSystem->Printf(f,
+                               ",{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%i}\n",
+                               event->name, event->parent ? event->parent : "", event->start * 0.001,
+                               event->duration * 0.001, i);
+        }
+
+        total += num;
+    }
+
+    fileSystem->Printf(f, "]}\n");
+    fileSystem->FCloseFile(f);
+
+    common->Printf("Wrote %i profile events to %s\n", total, filename);
+}
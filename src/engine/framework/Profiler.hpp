@@ -0,0 +1,122 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Copyright(C) 2011 - 2023 Dusan Jocic <dusanjocic@msn.com>
+//
+// This file is part of the OpenWolf GPL Source Code.
+// OpenWolf Source Code is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// OpenWolf Source Code is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with OpenWolf Source Code.  If not, see <http://www.gnu.org/licenses/>.
+//
+// In addition, the OpenWolf Source Code is also subject to certain additional terms.
+// You should have received a copy of these additional terms immediately following the
+// terms and conditions of the GNU General Public License which accompanied the
+// OpenWolf Source Code. If not, please request a copy in writing from id Software
+// at the address below.
+//
+// If you have questions concerning this license or the applicable additional terms,
+// you may contact in writing id Software LLC, c/o ZeniMax Media Inc.,
+// Suite 120, Rockville, Maryland 20850 USA.
+//
+// -------------------------------------------------------------------------------------
+// File name:   Profiler.hpp
+// Created:     10/18/2026
+// Compilers:   Microsoft (R) C/C++ Optimizing Compiler Version 19.26.28806 for x64,
+//              gcc (Ubuntu 9.3.0-10ubuntu2) 9.3.0,
+//              AppleClang 9.0.0.9000039
+// Description: Hierarchical scoped timers recorded per thread for frame profiling
+// -------------------------------------------------------------------------------------
+////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __PROFILER_HPP__
+#define __PROFILER_HPP__
+
+#define MAX_PROFILE_THREADS     32
+#define MAX_PROFILE_DEPTH       32
+#define MAX_PROFILE_ZONES       256
+#define PROFILE_RING_EVENTS     32768   // per thread, power of two
+#define PROFILE_WINDOW          1024    // samples each zone keeps for the percentiles
+
+// one finished zone, written only by the thread that owns the ring
+typedef struct {
+    pointer name;
+    pointer parent;     // zone this one was nested in, nullptr at the top
+    sint64 start;       // nanoseconds since Init
+    uint duration;      // nanoseconds, saturated at ~4 seconds
+    sint depth;
+} profileEvent_t;
+
+typedef struct {
+    pointer name;
+    pointer parent;
+    sint64 start;
+} profileOpenZone_t;
+
+typedef struct {
+    std::atomic<bool> inUse;
+    std::atomic<uint64> head;           // events ever written to the ring
+    uint64 drained;                     // main thread: events folded into the zones
+    profileEvent_t *events;
+
+    // owner only
+    sint depth;
+    profileOpenZone_t stack[MAX_PROFILE_DEPTH];
+} profileThread_t;
+
+// a zone is a name under a given parent
+typedef struct {
+    pointer name;
+    pointer parent;
+    sint depth;
+    uint64 count;       // since the last reset
+    float64 totalUsec;
+    uint samples[PROFILE_WINDOW];
+    sint numSamples;
+    sint nextSample;
+} profileZone_t;
+
+// gives the ring of an exiting thread to the next thread that wants one
+typedef struct profileThreadSlot_s {
+    profileThread_t *thread;
+
+    ~profileThreadSlot_s(void);
+} profileThreadSlot_t;
+
+//
+// idProfilerSystemLocal
+//
+class idProfilerSystemLocal : public idProfilerSystem {
+public:
+    idProfilerSystemLocal();
+    ~idProfilerSystemLocal();
+
+    virtual void Init(void);
+    virtual void Shutdown(void);
+    virtual bool BeginZone(pointer name);
+    virtual void EndZone(void);
+    virtual void EndFrame(void);
+    virtual sint64 Microseconds(void);
+
+    static sint64 Nanoseconds(void);
+
+private:
+    static profileThread_t *ClaimThread(void);
+    static sint CopyEvents(profileThread_t *thread, uint64 from,
+                           profileEvent_t *out, uint64 *first);
+    static profileZone_t *FindZone(pointer name, pointer parent, sint depth);
+    static void DrainThread(profileThread_t *thread);
+    static void PrintZones_r(pointer parent, sint depth);
+    static void Profile_f(void);
+    static void ProfileTrace_f(void);
+};
+
+extern idProfilerSystemLocal profilerLocal;
+
+#endif //!__PROFILER_HPP__
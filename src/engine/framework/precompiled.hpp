@@ -41,6 +41,15 @@
 #include <queue>
 #include <assert.h>
 #include <thread>
+#include <chrono>
+#include <atomic>
+#include <condition_variable>
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#endif
 
 #ifndef _WIN32
 #include <sys/ioctl.h>
@@ -51,6 +60,7 @@
 
 #include <signal.h>
 #include <limits.h>
+#include <float.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <string.h>
@@ -83,6 +93,7 @@
 #include <fenv.h>
 #include <pwd.h>
 #include <unistd.h>
+#include <sys/mman.h>
 #endif
 
 #ifdef _WIN32
@@ -114,6 +125,10 @@
 #include <sys/time.h>
 #include <unistd.h>
 #include <ifaddrs.h>
+#if defined (__linux__)
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#endif
 #endif
 
 #include <framework/appConfig.hpp>
@@ -271,6 +286,10 @@
 #include <framework/CmdBuffer.hpp>
 #include <API/CmdDelay_api.hpp>
 #include <framework/CmdDelay.hpp>
+#include <API/ParallelJobs_api.hpp>
+#include <framework/ParallelJobs.hpp>
+#include <API/Profiler_api.hpp>
+#include <framework/Profiler.hpp>
 #include <API/MD4_api.hpp>
 #include <framework/MD4.hpp>
 #include <API/MD5_api.hpp>
@@ -149,6 +149,7 @@ convar_t *r_imageUpsample;
 convar_t *r_imageUpsampleMaxSize;
 convar_t *r_imageUpsampleType;
 convar_t *r_genNormalMaps;
+convar_t *r_imagePrefetchMegs;
 convar_t *r_forceSun;
 convar_t *r_forceSunLightScale;
 convar_t *r_forceSunAmbientScale;
@@ -498,6 +499,9 @@ void R_InitConsoleVars(void) {
     r_genNormalMaps = cvarSystem->Get("r_genNormalMaps", "0",
                                       CVAR_ARCHIVE | CVAR_LATCH,
                                       "Naively generate normal maps for all textures. 0 - Don't. (default) 1 - Do.");
+    r_imagePrefetchMegs = cvarSystem->Get("r_imagePrefetchMegs", "256",
+                                          CVAR_ARCHIVE,
+                                          "Megabytes of world textures decoded ahead on all cores while a map loads. 0 - Decode every image when it is uploaded.");
 
     r_forceSun = cvarSystem->Get("r_forceSun", "1", CVAR_ARCHIVE | CVAR_LATCH,
                                  "Force sunlight and shadows, using sun position from sky material. 0 - Don't. (default) 1 - Do. 2 - Sunrise, sunset.");
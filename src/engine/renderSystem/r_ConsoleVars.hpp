@@ -226,6 +226,7 @@ extern  convar_t  *r_imageUpsample;
 extern  convar_t  *r_imageUpsampleMaxSize;
 extern  convar_t  *r_imageUpsampleType;
 extern  convar_t  *r_genNormalMaps;
+extern  convar_t  *r_imagePrefetchMegs;
 extern  convar_t  *r_forceSun;
 extern  convar_t  *r_forceSunLightScale;
 extern  convar_t  *r_forceSunAmbientScale;
@@ -3782,6 +3782,15 @@ void idRenderSystemLocal::LoadWorld(pointer name) {
     // load into heap
     R_LoadEntities(&header->lumps[LUMP_ENTITIES]);
     R_LoadShaders(&header->lumps[LUMP_SHADERS]);
+
+    // decode the world's images on the async read threads before the
+    // surfaces register their shaders one by one
+    for(i = 0; i < s_worldData.numShaders; i++) {
+        R_PrefetchShaderImages(s_worldData.shaders[i].shader);
+    }
+
+    R_StartImagePrefetch();
+
     R_LoadLightmaps(&header->lumps[LUMP_LIGHTMAPS],
                     &header->lumps[LUMP_SURFACES]);
     R_LoadPlanes(&header->lumps[LUMP_PLANES]);
@@ -4036,5 +4045,7 @@ void idRenderSystemLocal::LoadWorld(pointer name) {
 
     R_InitExternalShaders();
 
+    R_FinishImagePrefetch();
+
     fileSystem->FreeFile(buffer.v);
 }
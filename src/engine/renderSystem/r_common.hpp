@@ -114,9 +114,29 @@ IMAGE LOADERS
 =============================================================
 */
 
-void R_LoadJPG(pointer name, uchar8 **pic, sint *width, sint *height);
-void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height);
-void R_LoadTGA(pointer name, uchar8 **pic, sint *width, sint *height);
+// the decoders work on a file that is already in memory and never print
+// or drop, so the image prefetch workers can run them. They allocate with
+// R_ImageMalloc and leave a message in error for the caller to print, or
+// to drop with for IMAGE_DECODE_ERROR
+typedef enum {
+    IMAGE_DECODE_OK,
+    IMAGE_DECODE_FAILED,
+    IMAGE_DECODE_ERROR
+} imageDecode_t;
+
+typedef imageDecode_t(*imageDecoder_t)(pointer name, const uchar8 *buffer,
+                                       sint length, uchar8 **pic, sint *width, sint *height,
+                                       valueType *error, sint errorSize);
+
+imageDecode_t R_DecodeJPG(pointer name, const uchar8 *buffer, sint length,
+                          uchar8 **pic, sint *width, sint *height, valueType *error,
+                          sint errorSize);
+imageDecode_t R_DecodePNG(pointer name, const uchar8 *buffer, sint length,
+                          uchar8 **pic, sint *width, sint *height, valueType *error,
+                          sint errorSize);
+imageDecode_t R_DecodeTGA(pointer name, const uchar8 *buffer, sint length,
+                          uchar8 **pic, sint *width, sint *height, valueType *error,
+                          sint errorSize);
 
 /*
 ====================================================================
@@ -2295,42 +2295,33 @@ void R_LoadDDS(pointer filename, uchar8 **pic, sint *width, sint *height,
 
 typedef struct {
     pointer ext;
-    void (*ImageLoader)(pointer, uchar8 **, sint *, sint *);
+    imageDecoder_t ImageDecoder;
 } imageExtToLoaderMap_t;
 
 // Note that the ordering indicates the order of preference used
 // when there are multiple images of different formats available
 static imageExtToLoaderMap_t imageLoaders[ ] = {
-    { "png",  R_LoadPNG },
-    { "tga",  R_LoadTGA },
-    { "jpg",  R_LoadJPG },
-    { "jpeg", R_LoadJPG }
+    { "png",  R_DecodePNG },
+    { "tga",  R_DecodeTGA },
+    { "jpg",  R_DecodeJPG },
+    { "jpeg", R_DecodeJPG }
 };
 
 static sint numImageLoaders = ARRAY_LEN(imageLoaders);
 
 /*
 =================
-R_LoadImage
+R_ImageCandidates
 
-Loads any of the supported image types into a cannonical
-32 bit format.
+The files R_LoadImage tries for name, in order. A DDS has no decoder.
 =================
 */
-void R_LoadImage(pointer name, uchar8 **pic, sint *width, sint *height,
-                 uint *picFormat, sint *numMips) {
-    bool orgNameFailed = false;
+sint R_ImageCandidates(pointer name, imageCandidate_t *candidates) {
+    sint numCandidates = 0;
     sint orgLoader = -1;
     sint i;
     valueType localName[ MAX_QPATH ];
     pointer ext;
-    pointer altName;
-
-    *pic = nullptr;
-    *width = 0;
-    *height = 0;
-    *picFormat = GL_RGBA8;
-    *numMips = 0;
 
     Q_strncpyz(localName, name, MAX_QPATH);
 
@@ -2338,41 +2329,30 @@ void R_LoadImage(pointer name, uchar8 **pic, sint *width, sint *height,
 
     // If compressed textures are enabled, try loading a DDS first, it'll load fastest
     if(r_ext_compressed_textures->integer) {
-        valueType ddsName[MAX_QPATH];
-
-        COM_StripExtension3(name, ddsName, MAX_QPATH);
-        Q_strcat(ddsName, MAX_QPATH, ".dds");
-
-        R_LoadDDS(ddsName, pic, width, height, picFormat, numMips);
-
-        // If loaded, we're done.
-        if(*pic) {
-            return;
-        }
+        COM_StripExtension3(name, candidates[numCandidates].name, MAX_QPATH);
+        Q_strcat(candidates[numCandidates].name, MAX_QPATH, ".dds");
+        candidates[numCandidates].decode = nullptr;
+        candidates[numCandidates].alternative = false;
+        numCandidates++;
     }
 
     if(*ext) {
         // Look for the correct loader and use it
         for(i = 0; i < numImageLoaders; i++) {
             if(!Q_stricmp(ext, imageLoaders[ i ].ext)) {
-                // Load
-                imageLoaders[ i ].ImageLoader(localName, pic, width, height);
+                Q_strncpyz(candidates[numCandidates].name, localName, MAX_QPATH);
+                candidates[numCandidates].decode = imageLoaders[ i ].ImageDecoder;
+                candidates[numCandidates].alternative = false;
+                numCandidates++;
                 break;
             }
         }
 
-        // A loader was found
+        // A loader was found, if the file isn't there try again
+        // without the extension
         if(i < numImageLoaders) {
-            if(*pic == nullptr) {
-                // Loader failed, most likely because the file isn't there;
-                // try again without the extension
-                orgNameFailed = true;
-                orgLoader = i;
-                COM_StripExtension3(name, localName, MAX_QPATH);
-            } else {
-                // Something loaded
-                return;
-            }
+            orgLoader = i;
+            COM_StripExtension3(name, localName, MAX_QPATH);
         }
     }
 
@@ -2383,20 +2363,105 @@ void R_LoadImage(pointer name, uchar8 **pic, sint *width, sint *height,
             continue;
         }
 
-        altName = va(nullptr, "%s.%s", localName, imageLoaders[ i ].ext);
+        Q_vsprintf_s(candidates[numCandidates].name, MAX_QPATH, MAX_QPATH,
+                     "%s.%s", localName, imageLoaders[ i ].ext);
+        candidates[numCandidates].decode = imageLoaders[ i ].ImageDecoder;
+        candidates[numCandidates].alternative = orgLoader >= 0;
+        numCandidates++;
+    }
+
+    return numCandidates;
+}
+
+/*
+=================
+R_ReportImageDecode
+
+Prints the message a decoder left, or drops with it
+=================
+*/
+void R_ReportImageDecode(imageDecode_t result, pointer error) {
+    if(result == IMAGE_DECODE_ERROR) {
+        common->Error(ERR_DROP, "%s", error);
+    }
+
+    if(error[0]) {
+        clientRendererSystem->RefPrintf(PRINT_WARNING, "%s", error);
+    }
+}
+
+/*
+=================
+R_LoadImageFile
+=================
+*/
+static void R_LoadImageFile(pointer name, imageDecoder_t decode,
+                            uchar8 **pic, sint *width, sint *height) {
+    valueType error[MAX_STRING_CHARS];
+    imageDecode_t result;
+    union {
+        uchar8 *b;
+        void *v;
+    } buffer;
+    sint length;
+
+    length = fileSystem->ReadFile(name, &buffer.v);
+
+    if(!buffer.b) {
+        return;
+    }
+
+    result = decode(name, buffer.b, length, pic, width, height, error,
+                    sizeof(error));
+
+    fileSystem->FreeFile(buffer.v);
+
+    R_ReportImageDecode(result, error);
+}
+
+/*
+=================
+R_LoadImage
+
+Loads any of the supported image types into a cannonical
+32 bit format.
+=================
+*/
+void R_LoadImage(pointer name, uchar8 **pic, sint *width, sint *height,
+                 uint *picFormat, sint *numMips) {
+    imageCandidate_t candidates[MAX_IMAGE_CANDIDATES];
+    sint numCandidates, i;
+
+    *pic = nullptr;
+    *width = 0;
+    *height = 0;
+    *picFormat = GL_RGBA8;
+    *numMips = 0;
+
+    // decoded on the async read threads already
+    if(R_TakePrefetchedImage(name, pic, width, height)) {
+        return;
+    }
 
-        // Load
-        imageLoaders[ i ].ImageLoader(altName, pic, width, height);
+    numCandidates = R_ImageCandidates(name, candidates);
+
+    for(i = 0; i < numCandidates; i++) {
+        if(!candidates[i].decode) {
+            R_LoadDDS(candidates[i].name, pic, width, height, picFormat, numMips);
+        } else {
+            R_LoadImageFile(candidates[i].name, candidates[i].decode, pic, width,
+                            height);
+        }
 
         if(*pic) {
-            if(orgNameFailed) {
+            if(candidates[i].alternative) {
 #ifdef _DEBUG
                 clientRendererSystem->RefPrintf(PRINT_DEVELOPER,
-                                                "WARNING: %s not present, using %s instead\n", name, altName);
+                                                "WARNING: %s not present, using %s instead\n", name, candidates[i].name);
 #endif
             }
 
-            break;
+            return;
         }
     }
 }
@@ -2582,7 +2647,7 @@ image_t    *R_FindImageFile(pointer name, imgType_t type,
 
     image = R_CreateImage2(const_cast< valueType * >(name), pic, width, height,
                            picFormat, picNumMips, type, flags, 0);
-    memorySystem->Free(pic);
+    R_FreeImagePic(pic);
     return image;
 }
 
@@ -44,6 +44,9 @@ typedef struct q_jpeg_error_mgr_s {
     struct jpeg_error_mgr pub;  /* "public" fields */
 
     jmp_buf setjmp_buffer;  /* for return to caller */
+
+    valueType *message;     /* kept here instead of printed when decoding */
+    sint messageSize;
 } q_jpeg_error_mgr_t;
 
 static void R_JPGErrorExit(j_common_ptr cinfo) {
@@ -54,7 +57,12 @@ static void R_JPGErrorExit(j_common_ptr cinfo) {
 
     (*cinfo->err->format_message)(cinfo, buffer);
 
-    clientRendererSystem->RefPrintf(PRINT_ALL, "Error: %s", buffer);
+    if(jerr->message) {
+        Q_vsprintf_s(jerr->message, jerr->messageSize, jerr->messageSize,
+                     "Error: %s", buffer);
+    } else {
+        clientRendererSystem->RefPrintf(PRINT_ALL, "Error: %s", buffer);
+    }
 
     /* Return control to the setjmp point */
     longjmp(jerr->setjmp_buffer, 1);
@@ -62,15 +70,25 @@ static void R_JPGErrorExit(j_common_ptr cinfo) {
 
 static void R_JPGOutputMessage(j_common_ptr cinfo) {
     valueType buffer[200];
+    q_jpeg_error_mgr_t *jerr = (q_jpeg_error_mgr_t *)cinfo->err;
 
     /* Create the message */
     (*cinfo->err->format_message)(cinfo, buffer);
 
-    /* Send it to stderr, adding a newline */
-    clientRendererSystem->RefPrintf(PRINT_ALL, "%s\n", buffer);
+    /* Keep the first one, or send it to the console adding a newline */
+    if(jerr->message) {
+        if(!jerr->message[0]) {
+            Q_vsprintf_s(jerr->message, jerr->messageSize, jerr->messageSize,
+                         "%s\n", buffer);
+        }
+    } else {
+        clientRendererSystem->RefPrintf(PRINT_ALL, "%s\n", buffer);
+    }
 }
 
-void R_LoadJPG(pointer filename, uchar8 **pic, sint *width, sint *height) {
+imageDecode_t R_DecodeJPG(pointer filename, const uchar8 *fbuffer,
+                          sint len, uchar8 **pic, sint *width, sint *height,
+                          valueType *error, sint errorSize) {
     /* This struct contains the JPEG decompression parameters and pointers to
      * working space (which is allocated as needed by the JPEG library).
      */
@@ -94,25 +112,14 @@ void R_LoadJPG(pointer filename, uchar8 **pic, sint *width, sint *height) {
     uint row_stride;    /* physical row width in output buffer */
     uint pixelcount, memcount;
     uint sindex, dindex;
-    uchar8 *out;
-    sint len;
-    union {
-        uchar8 *b;
-        void *v;
-    } fbuffer;
+    uchar8 *volatile out = nullptr;
     uchar8  *buf;
 
-    /* In this example we want to open the input file before doing anything else,
-     * so that the setjmp() error recovery below can assume the file is open.
-     * VERY IMPORTANT: use "b" option to fopen() if you are on a machine that
-     * requires it in order to read binary files.
-     */
-
-    len = fileSystem->ReadFile(const_cast< valueType * >(filename),
-                               &fbuffer.v);
+    *pic = nullptr;
+    error[0] = '\0';
 
-    if(!fbuffer.b || len < 0) {
-        return;
+    if(len <= 0) {
+        return IMAGE_DECODE_FAILED;
     }
 
     /* Step 1: allocate and initialize JPEG decompression object */
@@ -125,19 +132,26 @@ void R_LoadJPG(pointer filename, uchar8 **pic, sint *width, sint *height) {
     cinfo.err = jpeg_std_error(&jerr.pub);
     cinfo.err->error_exit = R_JPGErrorExit;
     cinfo.err->output_message = R_JPGOutputMessage;
+    jerr.message = error;
+    jerr.messageSize = errorSize;
 
     /* Establish the setjmp return context for R_JPGErrorExit to use. */
     if(setjmp(jerr.setjmp_buffer)) {
         /* If we get here, the JPEG code has signaled an error.
-         * We need to clean up the JPEG object, close the input file, and return.
+         * We need to clean up the JPEG object and the output, and return.
          */
         jpeg_destroy_decompress(&cinfo);
-        fileSystem->FreeFile(fbuffer.v);
+
+        if(out) {
+            R_ImageFree(out);
+            *pic = nullptr;
+        }
 
         /* Append the filename to the error for easier debugging */
-        clientRendererSystem->RefPrintf(PRINT_ALL, ", loading file %s\n",
-                                        filename);
-        return;
+        Q_strcat(error, errorSize, ", loading file ");
+        Q_strcat(error, errorSize, filename);
+        Q_strcat(error, errorSize, "\n");
+        return IMAGE_DECODE_FAILED;
     }
 
     /* Now we can initialize the JPEG decompression object. */
@@ -145,7 +159,7 @@ void R_LoadJPG(pointer filename, uchar8 **pic, sint *width, sint *height) {
 
     /* Step 2: specify data source (eg, a file) */
 
-    jpeg_mem_src(&cinfo, fbuffer.b, len);
+    jpeg_mem_src(&cinfo, const_cast<uchar8 *>(fbuffer), len);
 
     /* Step 3: read file parameters with jpeg_read_header() */
 
@@ -185,21 +199,22 @@ void R_LoadJPG(pointer filename, uchar8 **pic, sint *width, sint *height) {
             || ((pixelcount * 4) / cinfo.output_width) / 4 != cinfo.output_height
             || pixelcount > 0x1FFFFFFF || cinfo.output_components != 3
       ) {
+        Q_vsprintf_s(error, errorSize, errorSize,
+                     "LoadJPG: %s has an invalid image format: %dx%d*4=%d, components: %d",
+                     filename,
+                     cinfo.output_width, cinfo.output_height, pixelcount * 4,
+                     cinfo.output_components);
+
         // Free the memory to make sure we don't leak memory
-        fileSystem->FreeFile(fbuffer.v);
         jpeg_destroy_decompress(&cinfo);
 
-        common->Error(ERR_DROP,
-                      "LoadJPG: %s has an invalid image format: %dx%d*4=%d, components: %d",
-                      filename,
-                      cinfo.output_width, cinfo.output_height, pixelcount * 4,
-                      cinfo.output_components);
+        return IMAGE_DECODE_ERROR;
     }
 
     memcount = pixelcount * 4;
     row_stride = cinfo.output_width * cinfo.output_components;
 
-    out = static_cast<uchar8 *>(clientRendererSystem->RefMalloc(memcount));
+    out = static_cast<uchar8 *>(R_ImageMalloc(memcount));
 
     *width = cinfo.output_width;
     *height = cinfo.output_height;
@@ -247,18 +262,12 @@ void R_LoadJPG(pointer filename, uchar8 **pic, sint *width, sint *height) {
     /* This is an important step since it will release a good deal of memory. */
     jpeg_destroy_decompress(&cinfo);
 
-    /* After finish_decompress, we can close the input file.
-     * Here we postpone it until after no more JPEG errors are possible,
-     * so as to simplify the setjmp error logic above.  (Actually, I don't
-     * think that jpeg_destroy can do an error exit, but why assume anything...)
-     */
-    fileSystem->FreeFile(fbuffer.v);
-
     /* At this point you may want to check to see whether any corrupt-data
      * warnings occurred (test whether jerr.pub.num_warnings is nonzero).
      */
 
     /* And we're done! */
+    return IMAGE_DECODE_OK;
 }
 
 /* Expanded data destination object for stdio output */
@@ -385,6 +394,7 @@ uint32 RE_SaveJPGToBuffer(uchar8 *buffer, uint32 bufSize, sint quality,
     cinfo.err = jpeg_std_error(&jerr.pub);
     cinfo.err->error_exit = R_JPGErrorExit;
     cinfo.err->output_message = R_JPGOutputMessage;
+    jerr.message = nullptr;
 
     /* Establish the setjmp return context for R_JPGErrorExit to use. */
     if(setjmp(jerr.setjmp_buffer)) {
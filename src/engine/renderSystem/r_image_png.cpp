@@ -214,21 +214,18 @@ struct BufferedFile {
 };
 
 /*
- *  Read a file into a buffer.
+ *  Wrap a file that is already in memory, the caller keeps the data.
  */
 
-static struct BufferedFile *ReadBufferedFile(pointer name) {
+static struct BufferedFile *OpenBufferedFile(const uchar8 *data,
+        sint length) {
     struct BufferedFile *BF;
-    union {
-        uchar8 *b;
-        void *v;
-    } buffer;
 
     /*
      *  input verification
      */
 
-    if(!name) {
+    if(!(data && (length > 0))) {
         return(nullptr);
     }
 
@@ -236,44 +233,19 @@ static struct BufferedFile *ReadBufferedFile(pointer name) {
      *  Allocate control struct.
      */
 
-    BF = (struct BufferedFile *)clientRendererSystem->RefMalloc(sizeof(
-                struct BufferedFile));
+    BF = static_cast<struct BufferedFile *>(R_ImageMalloc(sizeof(
+            struct BufferedFile)));
 
     if(!BF) {
         return(nullptr);
     }
 
-    /*
-     *  Initialize the structs components.
-     */
-
-    BF->Length    = 0;
-    BF->Buffer    = nullptr;
-    BF->Ptr       = nullptr;
-    BF->BytesLeft = 0;
-
-    /*
-     *  Read the file.
-     */
-
-    BF->Length = fileSystem->ReadFile(const_cast< valueType * >(name),
-                                      &buffer.v);
-    BF->Buffer = buffer.b;
-
-    /*
-     *  Did we get it? Is it big enough?
-     */
-
-    if(!(BF->Buffer && (BF->Length > 0))) {
-        memorySystem->Free(BF);
-
-        return(nullptr);
-    }
-
     /*
      *  Set the pointers and counters.
      */
 
+    BF->Buffer    = const_cast<uchar8 *>(data);
+    BF->Length    = length;
     BF->Ptr       = BF->Buffer;
     BF->BytesLeft = BF->Length;
 
@@ -286,11 +258,7 @@ static struct BufferedFile *ReadBufferedFile(pointer name) {
 
 static void CloseBufferedFile(struct BufferedFile *BF) {
     if(BF) {
-        if(BF->Buffer) {
-            fileSystem->FreeFile(BF->Buffer);
-        }
-
-        memorySystem->Free(BF);
+        R_ImageFree(BF);
     }
 }
 
@@ -599,7 +567,7 @@ static uint DecompressIDATs(struct BufferedFile *BF, uchar8 **Buffer) {
 
     BufferedFileRewind(BF, BytesToRewind);
 
-    CompressedData = static_cast<uchar8 *>(clientRendererSystem->RefMalloc(
+    CompressedData = static_cast<uchar8 *>(R_ImageMalloc(
             CompressedDataLength));
 
     if(!CompressedData) {
@@ -620,7 +588,7 @@ static uint DecompressIDATs(struct BufferedFile *BF, uchar8 **Buffer) {
         CH = (struct PNG_ChunkHeader *)BufferedFileRead(BF, PNG_ChunkHeader_Size);
 
         if(!CH) {
-            memorySystem->Free(CompressedData);
+            R_ImageFree(CompressedData);
 
             return(-1);
         }
@@ -652,13 +620,13 @@ static uint DecompressIDATs(struct BufferedFile *BF, uchar8 **Buffer) {
             OrigCompressedData = static_cast<uchar8 *>(BufferedFileRead(BF, Length));
 
             if(!OrigCompressedData) {
-                memorySystem->Free(CompressedData);
+                R_ImageFree(CompressedData);
 
                 return(-1);
             }
 
             if(!BufferedFileSkip(BF, PNG_ChunkCRC_Size)) {
-                memorySystem->Free(CompressedData);
+                R_ImageFree(CompressedData);
 
                 return(-1);
             }
@@ -690,7 +658,7 @@ static uint DecompressIDATs(struct BufferedFile *BF, uchar8 **Buffer) {
     puffResult = puff(puffDest, &puffDestLen, puffSrc, &puffSrcLen);
 
     if(!((puffResult == 0) && (puffDestLen > 0))) {
-        memorySystem->Free(CompressedData);
+        R_ImageFree(CompressedData);
 
         return(-1);
     }
@@ -699,11 +667,11 @@ static uint DecompressIDATs(struct BufferedFile *BF, uchar8 **Buffer) {
      *  Allocate the buffer for the uncompressed data.
      */
 
-    DecompressedData = static_cast<uchar8 *>(clientRendererSystem->RefMalloc(
+    DecompressedData = static_cast<uchar8 *>(R_ImageMalloc(
                            puffDestLen));
 
     if(!DecompressedData) {
-        memorySystem->Free(CompressedData);
+        R_ImageFree(CompressedData);
 
         return(-1);
     }
@@ -727,14 +695,14 @@ static uint DecompressIDATs(struct BufferedFile *BF, uchar8 **Buffer) {
      *  The compressed data is not needed anymore.
      */
 
-    memorySystem->Free(CompressedData);
+    R_ImageFree(CompressedData);
 
     /*
      *  Check if the last puff() was successfull.
      */
 
     if(!((puffResult == 0) && (puffDestLen > 0))) {
-        memorySystem->Free(DecompressedData);
+        R_ImageFree(DecompressedData);
 
         return(-1);
     }
@@ -1757,10 +1725,12 @@ static bool DecodeImageInterlaced(struct PNG_Chunk_IHDR *IHDR,
 }
 
 /*
- *  The PNG loader
+ *  The PNG decoder
  */
 
-void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
+imageDecode_t R_DecodePNG(pointer name, const uchar8 *buffer,
+                          sint length, uchar8 **pic, sint *width, sint *height,
+                          valueType *error, sint errorSize) {
     struct BufferedFile *ThePNG;
     uchar8 *OutBuffer;
     uchar8 *Signature;
@@ -1789,12 +1759,14 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
     bool HasTransparentColour = false;
     uchar8 TransparentColour[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
 
+    error[0] = '\0';
+
     /*
      *  input verification
      */
 
     if(!(name && pic)) {
-        return;
+        return IMAGE_DECODE_FAILED;
     }
 
     /*
@@ -1812,13 +1784,13 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
     }
 
     /*
-     *  Read the file.
+     *  Wrap the file.
      */
 
-    ThePNG = ReadBufferedFile(name);
+    ThePNG = OpenBufferedFile(buffer, length);
 
     if(!ThePNG) {
-        return;
+        return IMAGE_DECODE_FAILED;
     }
 
     /*
@@ -1831,7 +1803,7 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
     if(!Signature) {
         CloseBufferedFile(ThePNG);
 
-        return;
+        return IMAGE_DECODE_FAILED;
     }
 
     /*
@@ -1841,7 +1813,7 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
     if(memcmp(Signature, PNG_Signature, PNG_Signature_Size)) {
         CloseBufferedFile(ThePNG);
 
-        return;
+        return IMAGE_DECODE_FAILED;
     }
 
     /*
@@ -1854,7 +1826,7 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
     if(!CH) {
         CloseBufferedFile(ThePNG);
 
-        return;
+        return IMAGE_DECODE_FAILED;
     }
 
     /*
@@ -1872,7 +1844,7 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
             (ChunkHeaderLength == PNG_Chunk_IHDR_Size))) {
         CloseBufferedFile(ThePNG);
 
-        return;
+        return IMAGE_DECODE_FAILED;
     }
 
     /*
@@ -1885,7 +1857,7 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
     if(!IHDR) {
         CloseBufferedFile(ThePNG);
 
-        return;
+        return IMAGE_DECODE_FAILED;
     }
 
     /*
@@ -1897,7 +1869,7 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
     if(!CRC) {
         CloseBufferedFile(ThePNG);
 
-        return;
+        return IMAGE_DECODE_FAILED;
     }
 
     /*
@@ -1919,10 +1891,10 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
             || IHDR_Width > INT_MAX / Q3IMAGE_BYTESPERPIXEL / IHDR_Height) {
         CloseBufferedFile(ThePNG);
 
-        clientRendererSystem->RefPrintf(PRINT_WARNING, "%s: invalid image size\n",
-                                        name);
+        Q_vsprintf_s(error, errorSize, errorSize, "%s: invalid image size\n",
+                     name);
 
-        return;
+        return IMAGE_DECODE_FAILED;
     }
 
     /*
@@ -1937,7 +1909,7 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
             (IHDR->FilterMethod == PNG_FilterMethod_0))) {
         CloseBufferedFile(ThePNG);
 
-        return;
+        return IMAGE_DECODE_FAILED;
     }
 
     /*
@@ -1948,7 +1920,7 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
             (IHDR->InterlaceMethod == PNG_InterlaceMethod_Interlaced))) {
         CloseBufferedFile(ThePNG);
 
-        return;
+        return IMAGE_DECODE_FAILED;
     }
 
     /*
@@ -1963,7 +1935,7 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
         if(!FindChunk(ThePNG, PNG_ChunkType_PLTE)) {
             CloseBufferedFile(ThePNG);
 
-            return;
+            return IMAGE_DECODE_FAILED;
         }
 
         /*
@@ -1976,7 +1948,7 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
         if(!CH) {
             CloseBufferedFile(ThePNG);
 
-            return;
+            return IMAGE_DECODE_FAILED;
         }
 
         /*
@@ -1993,7 +1965,7 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
         if(!(ChunkHeaderType == PNG_ChunkType_PLTE)) {
             CloseBufferedFile(ThePNG);
 
-            return;
+            return IMAGE_DECODE_FAILED;
         }
 
         /*
@@ -2003,7 +1975,7 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
         if(ChunkHeaderLength % 3) {
             CloseBufferedFile(ThePNG);
 
-            return;
+            return IMAGE_DECODE_FAILED;
         }
 
         /*
@@ -2015,7 +1987,7 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
         if(!InPal) {
             CloseBufferedFile(ThePNG);
 
-            return;
+            return IMAGE_DECODE_FAILED;
         }
 
         /*
@@ -2027,7 +1999,7 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
         if(!CRC) {
             CloseBufferedFile(ThePNG);
 
-            return;
+            return IMAGE_DECODE_FAILED;
         }
 
         /*
@@ -2074,7 +2046,7 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
         if(!CH) {
             CloseBufferedFile(ThePNG);
 
-            return;
+            return IMAGE_DECODE_FAILED;
         }
 
         /*
@@ -2091,7 +2063,7 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
         if(!(ChunkHeaderType == PNG_ChunkType_tRNS)) {
             CloseBufferedFile(ThePNG);
 
-            return;
+            return IMAGE_DECODE_FAILED;
         }
 
         /*
@@ -2103,7 +2075,7 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
         if(!Trans) {
             CloseBufferedFile(ThePNG);
 
-            return;
+            return IMAGE_DECODE_FAILED;
         }
 
         /*
@@ -2115,7 +2087,7 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
         if(!CRC) {
             CloseBufferedFile(ThePNG);
 
-            return;
+            return IMAGE_DECODE_FAILED;
         }
 
         /*
@@ -2127,7 +2099,7 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
                 if(ChunkHeaderLength != 2) {
                     CloseBufferedFile(ThePNG);
 
-                    return;
+                    return IMAGE_DECODE_FAILED;
                 }
 
                 HasTransparentColour = true;
@@ -2147,7 +2119,7 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
                 if(ChunkHeaderLength != 6) {
                     CloseBufferedFile(ThePNG);
 
-                    return;
+                    return IMAGE_DECODE_FAILED;
                 }
 
                 HasTransparentColour = true;
@@ -2175,7 +2147,7 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
                 if(ChunkHeaderLength > 256) {
                     CloseBufferedFile(ThePNG);
 
-                    return;
+                    return IMAGE_DECODE_FAILED;
                 }
 
                 HasTransparentColour = true;
@@ -2198,7 +2170,7 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
             default : {
                 CloseBufferedFile(ThePNG);
 
-                return;
+                return IMAGE_DECODE_FAILED;
             }
         }
     }
@@ -2210,7 +2182,7 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
     if(!BufferedFileRewind(ThePNG, -1)) {
         CloseBufferedFile(ThePNG);
 
-        return;
+        return IMAGE_DECODE_FAILED;
     }
 
     /*
@@ -2220,7 +2192,7 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
     if(!BufferedFileSkip(ThePNG, PNG_Signature_Size)) {
         CloseBufferedFile(ThePNG);
 
-        return;
+        return IMAGE_DECODE_FAILED;
     }
 
     /*
@@ -2232,22 +2204,22 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
     if(!(DecompressedDataLength && DecompressedData)) {
         CloseBufferedFile(ThePNG);
 
-        return;
+        return IMAGE_DECODE_FAILED;
     }
 
     /*
      *  Allocate output buffer.
      */
 
-    OutBuffer = static_cast<uchar8 *>(clientRendererSystem->RefMalloc(
+    OutBuffer = static_cast<uchar8 *>(R_ImageMalloc(
                                           IHDR_Width * IHDR_Height *
                                           Q3IMAGE_BYTESPERPIXEL));
 
     if(!OutBuffer) {
-        memorySystem->Free(DecompressedData);
+        R_ImageFree(DecompressedData);
         CloseBufferedFile(ThePNG);
 
-        return;
+        return IMAGE_DECODE_FAILED;
     }
 
     /*
@@ -2258,11 +2230,11 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
         case PNG_InterlaceMethod_NonInterlaced : {
             if(!DecodeImageNonInterlaced(IHDR, OutBuffer, DecompressedData,
                                          DecompressedDataLength, HasTransparentColour, TransparentColour, OutPal)) {
-                memorySystem->Free(OutBuffer);
-                memorySystem->Free(DecompressedData);
+                R_ImageFree(OutBuffer);
+                R_ImageFree(DecompressedData);
                 CloseBufferedFile(ThePNG);
 
-                return;
+                return IMAGE_DECODE_FAILED;
             }
 
             break;
@@ -2271,22 +2243,22 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
         case PNG_InterlaceMethod_Interlaced : {
             if(!DecodeImageInterlaced(IHDR, OutBuffer, DecompressedData,
                                       DecompressedDataLength, HasTransparentColour, TransparentColour, OutPal)) {
-                memorySystem->Free(OutBuffer);
-                memorySystem->Free(DecompressedData);
+                R_ImageFree(OutBuffer);
+                R_ImageFree(DecompressedData);
                 CloseBufferedFile(ThePNG);
 
-                return;
+                return IMAGE_DECODE_FAILED;
             }
 
             break;
         }
 
         default : {
-            memorySystem->Free(OutBuffer);
-            memorySystem->Free(DecompressedData);
+            R_ImageFree(OutBuffer);
+            R_ImageFree(DecompressedData);
             CloseBufferedFile(ThePNG);
 
-            return;
+            return IMAGE_DECODE_FAILED;
         }
     }
 
@@ -2312,11 +2284,13 @@ void R_LoadPNG(pointer name, uchar8 **pic, sint *width, sint *height) {
      *  DecompressedData is not needed anymore.
      */
 
-    memorySystem->Free(DecompressedData);
+    R_ImageFree(DecompressedData);
 
     /*
      *  We have all data, so close the file.
      */
 
     CloseBufferedFile(ThePNG);
+
+    return IMAGE_DECODE_OK;
 }
@@ -0,0 +1,401 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Copyright(C) 2011 - 2023 Dusan Jocic <dusanjocic@msn.com>
+//
+// This file is part of OpenWolf.
+//
+// OpenWolf is free software; you can redistribute it
+// and / or modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of the License,
+// or (at your option) any later version.
+//
+// OpenWolf is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with OpenWolf; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110 - 1301  USA
+//
+// -------------------------------------------------------------------------------------
+// File name:   r_image_prefetch.cpp
+// Created:     10/18/2026
+// Compilers:   Microsoft (R) C/C++ Optimizing Compiler Version 19.26.28806 for x64,
+//              gcc (Ubuntu 9.3.0-10ubuntu2) 9.3.0,
+//              AppleClang 9.0.0.9000039
+// Description: world images decoded on the async read threads while a map loads
+// -------------------------------------------------------------------------------------
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include <renderSystem/r_precompiled.hpp>
+
+/*
+===============================================================================
+
+While a map loads, the images its shaders name are queued before the
+surfaces register those shaders. R_StartImagePrefetch reads them with
+the async file reads and decodes them right on the read threads, out of
+the read buffer and into the thread's scratch memory, until
+r_imagePrefetchMegs of decoded images wait in C heap staging buffers.
+So as many images are decoded at once as fs_asyncThreads has threads,
+one per core by default, and a decode holds its thread from other reads.
+R_LoadImage takes a decoded image from here as it is instead of reading
+it, an image that was queued but not decoded yet is decoded with the next
+batch right then.
+
+The file an image comes from is picked like R_LoadImage does it. When a
+decoder fails, or a DDS would be loaded, the image is left to R_LoadImage,
+so messages and drops stay what they were. Everything that depends on the
+image flags - light scale, normal maps, resampling and the mipmaps - is
+still done in R_CreateImage on the main thread.
+
+===============================================================================
+*/
+
+#define MAX_PREFETCH_IMAGES     MAX_DRAWIMAGES
+#define PREFETCH_HASH_SIZE      1024
+#define PREFETCH_BATCH          32
+
+typedef enum {
+    PREFETCH_QUEUED,            // nothing read yet
+    PREFETCH_DECODED,           // waiting in the staging memory
+    PREFETCH_DONE               // taken, or left to R_LoadImage
+} prefetchState_t;
+
+typedef struct prefetchImage_s {
+    valueType name[MAX_QPATH];      // as R_FindImageFile gets it
+    prefetchState_t state;
+    valueType fileName[MAX_QPATH];  // the candidate that is read
+    imageDecoder_t decode;
+    uchar8 *pic;                    // on the C heap
+    sint width, height;
+    imageDecode_t result;
+    valueType error[MAX_STRING_CHARS];
+    struct prefetchImage_s *next;
+} prefetchImage_t;
+
+static prefetchImage_t prefetchImages[MAX_PREFETCH_IMAGES];
+static prefetchImage_t *prefetchHash[PREFETCH_HASH_SIZE];
+static sint numPrefetchImages;
+static sint64 prefetchStaged;       // bytes of decoded images not taken yet
+static sint prefetchDecoded;
+static uchar8 *prefetchTaken;       // handed to R_FindImageFile, see R_FreeImagePic
+
+// set while a read thread decodes, the zone is for the main thread only
+static thread_local bool decodeInScratch;
+
+/*
+================
+R_ImageMalloc
+
+The image decoders allocate through here
+================
+*/
+void *R_ImageMalloc(sint size) {
+    if(decodeInScratch) {
+        return memorySystem->ScratchAlloc(size);
+    }
+
+    return clientRendererSystem->RefMalloc(size);
+}
+
+/*
+================
+R_ImageFree
+
+Scratch memory goes back when the decode is done
+================
+*/
+void R_ImageFree(void *ptr) {
+    if(decodeInScratch) {
+        return;
+    }
+
+    memorySystem->Free(ptr);
+}
+
+/*
+================
+R_FreeImagePic
+
+Frees what R_LoadImage returned
+================
+*/
+void R_FreeImagePic(uchar8 *pic) {
+    if(pic && pic == prefetchTaken) {
+        ::free(pic);
+        prefetchTaken = nullptr;
+        return;
+    }
+
+    memorySystem->Free(pic);
+}
+
+/*
+================
+R_PrefetchHash
+================
+*/
+static sint R_PrefetchHash(pointer name) {
+    sint i, hash;
+
+    for(i = 0, hash = 0; name[i]; i++) {
+        hash += static_cast<uchar8>(name[i]) * (i + 119);
+    }
+
+    return hash & (PREFETCH_HASH_SIZE - 1);
+}
+
+/*
+================
+R_FindPrefetchImage
+================
+*/
+static prefetchImage_t *R_FindPrefetchImage(pointer name) {
+    prefetchImage_t *image;
+
+    for(image = prefetchHash[R_PrefetchHash(name)]; image; image = image->next) {
+        if(!strcmp(image->name, name)) {
+            return image;
+        }
+    }
+
+    return nullptr;
+}
+
+/*
+================
+R_PrefetchImage
+
+Queues name the way it will be passed to R_FindImageFile
+================
+*/
+void R_PrefetchImage(pointer name) {
+    prefetchImage_t *image;
+    sint hash;
+
+    if(!r_imagePrefetchMegs->integer || !name[0] || name[0] == '*' ||
+            name[0] == '$' || ::strlen(name) >= MAX_QPATH) {
+        return;
+    }
+
+    if(numPrefetchImages == MAX_PREFETCH_IMAGES || R_FindPrefetchImage(name)) {
+        return;
+    }
+
+    image = &prefetchImages[numPrefetchImages++];
+    ::memset(image, 0, sizeof(*image));
+
+    Q_strncpyz(image->name, name, sizeof(image->name));
+    image->state = PREFETCH_QUEUED;
+
+    hash = R_PrefetchHash(name);
+    image->next = prefetchHash[hash];
+    prefetchHash[hash] = image;
+}
+
+/*
+================
+R_DecodePrefetchFile
+
+Async read thread, decodes straight out of the read buffer. Only the
+finished image is copied out of the scratch memory
+================
+*/
+static void R_DecodePrefetchFile(pointer qpath, void *buffer, sint len,
+                                 void *userData) {
+    prefetchImage_t *image = static_cast<prefetchImage_t *>(userData);
+    idScratchScope scope;
+    uchar8 *pic = nullptr;
+    sint size;
+
+    decodeInScratch = true;
+
+    image->result = image->decode(image->fileName,
+                                  static_cast<const uchar8 *>(buffer), len, &pic, &image->width,
+                                  &image->height, image->error, sizeof(image->error));
+
+    decodeInScratch = false;
+
+    if(image->result != IMAGE_DECODE_OK || !pic) {
+        image->result = IMAGE_DECODE_FAILED;
+        return;
+    }
+
+    size = image->width * image->height * 4;
+    image->pic = static_cast<uchar8 *>(::malloc(size));
+
+    if(!image->pic) {
+        image->result = IMAGE_DECODE_FAILED;
+        return;
+    }
+
+    ::memcpy(image->pic, pic, size);
+}
+
+/*
+================
+R_DecodePrefetchBatch
+
+Reads and decodes the next batch of queued images from first on and
+returns the index after the last one it looked at
+================
+*/
+static sint R_DecodePrefetchBatch(sint first) {
+    imageCandidate_t candidates[MAX_IMAGE_CANDIDATES];
+    prefetchImage_t *batch[PREFETCH_BATCH];
+    prefetchImage_t *image;
+    sint i, j, numCandidates, numImages;
+
+    numImages = 0;
+
+    for(i = first; i < numPrefetchImages && numImages < PREFETCH_BATCH; i++) {
+        image = &prefetchImages[i];
+
+        if(image->state != PREFETCH_QUEUED) {
+            continue;
+        }
+
+        // R_LoadImage does it from here on if nothing gets decoded
+        image->state = PREFETCH_DONE;
+
+        numCandidates = R_ImageCandidates(image->name, candidates);
+
+        // the first one found wins like in R_LoadImage
+        for(j = 0; j < numCandidates; j++) {
+            if(fileSystem->FOpenFileRead(candidates[j].name, nullptr, false)) {
+                break;
+            }
+        }
+
+        // a DDS is loaded by R_LoadImage
+        if(j == numCandidates || !candidates[j].decode) {
+            continue;
+        }
+
+        Q_strncpyz(image->fileName, candidates[j].name, sizeof(image->fileName));
+        image->decode = candidates[j].decode;
+        image->result = IMAGE_DECODE_FAILED;
+        batch[numImages++] = image;
+
+        fileSystem->AsyncReadFile(image->fileName, R_DecodePrefetchFile, nullptr,
+                                  image);
+    }
+
+    fileSystem->FinishAsyncReads(true);
+
+    for(j = 0; j < numImages; j++) {
+        image = batch[j];
+
+        if(image->result != IMAGE_DECODE_OK) {
+            continue;
+        }
+
+        image->state = PREFETCH_DECODED;
+        prefetchStaged += image->width * image->height * 4;
+        prefetchDecoded++;
+    }
+
+    return i;
+}
+
+/*
+================
+R_StartImagePrefetch
+
+Decodes the queued images until the staging memory is full
+================
+*/
+void R_StartImagePrefetch(void) {
+    sint64 budget;
+    sint next, start;
+
+    if(!numPrefetchImages) {
+        return;
+    }
+
+    budget = static_cast<sint64>(r_imagePrefetchMegs->integer) * 1024 * 1024;
+    start = idsystem->Milliseconds();
+
+    for(next = 0; next < numPrefetchImages && prefetchStaged < budget;) {
+        clientRendererSystem->LoadingProgress("decoding images", next,
+                                              numPrefetchImages);
+
+        next = R_DecodePrefetchBatch(next);
+    }
+
+    clientRendererSystem->LoadingProgress("decoding images",
+                                          numPrefetchImages, numPrefetchImages);
+
+    clientRendererSystem->RefPrintf(PRINT_DEVELOPER,
+                                    "%d of %d images decoded ahead in %d msec, %d KB staged\n",
+                                    prefetchDecoded, numPrefetchImages, idsystem->Milliseconds() - start,
+                                    static_cast<sint>(prefetchStaged / 1024));
+}
+
+/*
+================
+R_TakePrefetchedImage
+
+Hands over a decoded image as it is, it has to be freed with
+R_FreeImagePic
+================
+*/
+bool R_TakePrefetchedImage(pointer name, uchar8 **pic, sint *width,
+                           sint *height) {
+    prefetchImage_t *image;
+
+    if(!numPrefetchImages) {
+        return false;
+    }
+
+    image = R_FindPrefetchImage(name);
+
+    if(!image) {
+        return false;
+    }
+
+    if(image->state == PREFETCH_QUEUED) {
+        R_DecodePrefetchBatch(image - prefetchImages);
+    }
+
+    if(image->state != PREFETCH_DECODED) {
+        return false;
+    }
+
+    // R_FindImageFile frees it before it loads the next one
+    ::free(prefetchTaken);
+
+    *pic = prefetchTaken = image->pic;
+    *width = image->width;
+    *height = image->height;
+
+    image->pic = nullptr;
+    image->state = PREFETCH_DONE;
+    prefetchStaged -= image->width * image->height * 4;
+
+    // a warning the decoder left
+    R_ReportImageDecode(image->result, image->error);
+
+    return true;
+}
+
+/*
+================
+R_FinishImagePrefetch
+
+Drops what wasn't taken once the map is loaded
+================
+*/
+void R_FinishImagePrefetch(void) {
+    sint i;
+
+    for(i = 0; i < numPrefetchImages; i++) {
+        ::free(prefetchImages[i].pic);
+    }
+
+    ::memset(prefetchHash, 0, sizeof(prefetchHash));
+    numPrefetchImages = 0;
+    prefetchStaged = 0;
+    prefetchDecoded = 0;
+}
@@ -39,21 +39,19 @@ TGA files are used for 24/32 bit images
 ========================================================================
 */
 
-void R_LoadTGA(pointer name, uchar8 **pic, sint *width, sint *height) {
+imageDecode_t R_DecodeTGA(pointer name, const uchar8 *buffer,
+                          sint length, uchar8 **pic, sint *width, sint *height,
+                          valueType *error, sint errorSize) {
     uint    columns, rows, numPixels;
     uchar8 *pixbuf;
     sint        row, column;
-    uchar8 *buf_p;
-    uchar8 *end;
-    union {
-        uchar8 *b;
-        void *v;
-    } buffer;
+    const uchar8 *buf_p;
+    const uchar8 *end;
     TargaHeader targa_header;
     uchar8     *targa_rgba;
-    sint length;
 
     *pic = nullptr;
+    error[0] = '\0';
 
     if(width) {
         *width = 0;
@@ -63,22 +61,14 @@ void R_LoadTGA(pointer name, uchar8 **pic, sint *width, sint *height) {
         *height = 0;
     }
 
-    //
-    // load the file
-    //
-    length = fileSystem->ReadFile(const_cast< valueType * >(name), &buffer.v);
-
-    if(!buffer.b || length < 0) {
-        return;
-    }
-
     if(length < 18) {
-        fileSystem->FreeFile(buffer.v);
-        common->Error(ERR_DROP, "LoadTGA: header too short (%s)", name);
+        Q_vsprintf_s(error, errorSize, errorSize,
+                     "LoadTGA: header too short (%s)", name);
+        return IMAGE_DECODE_ERROR;
     }
 
-    buf_p = buffer.b;
-    end = buffer.b + length;
+    buf_p = buffer;
+    end = buffer + length;
 
     targa_header.id_length = buf_p[0];
     targa_header.colormap_type = buf_p[1];
@@ -106,18 +96,22 @@ void R_LoadTGA(pointer name, uchar8 **pic, sint *width, sint *height) {
     if(targa_header.image_type != 2
             && targa_header.image_type != 10
             && targa_header.image_type != 3) {
-        common->Error(ERR_DROP,
-                      "LoadTGA: Only type 2 (RGB), 3 (gray), and 10 (RGB) TGA images supported");
+        Q_vsprintf_s(error, errorSize, errorSize,
+                     "LoadTGA: Only type 2 (RGB), 3 (gray), and 10 (RGB) TGA images supported");
+        return IMAGE_DECODE_ERROR;
     }
 
     if(targa_header.colormap_type != 0) {
-        common->Error(ERR_DROP, "LoadTGA: colormaps not supported");
+        Q_vsprintf_s(error, errorSize, errorSize,
+                     "LoadTGA: colormaps not supported");
+        return IMAGE_DECODE_ERROR;
     }
 
     if((targa_header.pixel_size != 32 && targa_header.pixel_size != 24) &&
             targa_header.image_type != 3) {
-        common->Error(ERR_DROP,
-                      "LoadTGA: Only 32 or 24 bit images supported (no colormaps)");
+        Q_vsprintf_s(error, errorSize, errorSize,
+                     "LoadTGA: Only 32 or 24 bit images supported (no colormaps)");
+        return IMAGE_DECODE_ERROR;
     }
 
     columns = targa_header.width;
@@ -126,18 +120,21 @@ void R_LoadTGA(pointer name, uchar8 **pic, sint *width, sint *height) {
 
     if(!columns || !rows || numPixels > 0x7FFFFFFF ||
             numPixels / columns / 4 != rows) {
-        common->Error(ERR_DROP, "LoadTGA: %s has an invalid image size", name);
+        Q_vsprintf_s(error, errorSize, errorSize,
+                     "LoadTGA: %s has an invalid image size", name);
+        return IMAGE_DECODE_ERROR;
     }
 
 
-    targa_rgba = static_cast<uchar8 *>(clientRendererSystem->RefMalloc(
+    targa_rgba = static_cast<uchar8 *>(R_ImageMalloc(
                                            numPixels));
 
     if(targa_header.id_length != 0) {
         if(buf_p + targa_header.id_length > end) {
-            memorySystem->Free(targa_rgba);
-            fileSystem->FreeFile(buffer.v);
-            common->Error(ERR_DROP, "LoadTGA: header too short (%s)", name);
+            R_ImageFree(targa_rgba);
+            Q_vsprintf_s(error, errorSize, errorSize,
+                         "LoadTGA: header too short (%s)", name);
+            return IMAGE_DECODE_ERROR;
         }
 
         buf_p += targa_header.id_length;  // skip TARGA image comment
@@ -145,9 +142,10 @@ void R_LoadTGA(pointer name, uchar8 **pic, sint *width, sint *height) {
 
     if(targa_header.image_type == 2 || targa_header.image_type == 3) {
         if(buf_p + columns * rows * targa_header.pixel_size / 8 > end) {
-            memorySystem->Free(targa_rgba);
-            fileSystem->FreeFile(buffer.v);
-            common->Error(ERR_DROP, "LoadTGA: file truncated (%s)", name);
+            R_ImageFree(targa_rgba);
+            Q_vsprintf_s(error, errorSize, errorSize,
+                         "LoadTGA: file truncated (%s)", name);
+            return IMAGE_DECODE_ERROR;
         }
 
         // Uncompressed RGB or gray scale image
@@ -191,8 +189,11 @@ void R_LoadTGA(pointer name, uchar8 **pic, sint *width, sint *height) {
                         break;
 
                     default:
-                        common->Error(ERR_DROP, "LoadTGA: illegal pixel_size '%d' in file '%s'",
-                                      targa_header.pixel_size, name);
+                        R_ImageFree(targa_rgba);
+                        Q_vsprintf_s(error, errorSize, errorSize,
+                                     "LoadTGA: illegal pixel_size '%d' in file '%s'",
+                                     targa_header.pixel_size, name);
+                        return IMAGE_DECODE_ERROR;
                         break;
                 }
             }
@@ -205,7 +206,10 @@ void R_LoadTGA(pointer name, uchar8 **pic, sint *width, sint *height) {
 
             for(column = 0; column < columns;) {
                 if(buf_p + 1 > end) {
-                    common->Error(ERR_DROP, "LoadTGA: file truncated (%s)", name);
+                    R_ImageFree(targa_rgba);
+                    Q_vsprintf_s(error, errorSize, errorSize,
+                                 "LoadTGA: file truncated (%s)", name);
+                    return IMAGE_DECODE_ERROR;
                 }
 
                 packetHeader = *buf_p++;
@@ -213,7 +217,10 @@ void R_LoadTGA(pointer name, uchar8 **pic, sint *width, sint *height) {
 
                 if(packetHeader & 0x80) {         // run-length packet
                     if(buf_p + targa_header.pixel_size / 8 > end) {
-                        common->Error(ERR_DROP, "LoadTGA: file truncated (%s)", name);
+                        R_ImageFree(targa_rgba);
+                        Q_vsprintf_s(error, errorSize, errorSize,
+                                     "LoadTGA: file truncated (%s)", name);
+                        return IMAGE_DECODE_ERROR;
                     }
 
                     switch(targa_header.pixel_size) {
@@ -232,8 +239,11 @@ void R_LoadTGA(pointer name, uchar8 **pic, sint *width, sint *height) {
                             break;
 
                         default:
-                            common->Error(ERR_DROP, "LoadTGA: illegal pixel_size '%d' in file '%s'",
-                                          targa_header.pixel_size, name);
+                            R_ImageFree(targa_rgba);
+                            Q_vsprintf_s(error, errorSize, errorSize,
+                                         "LoadTGA: illegal pixel_size '%d' in file '%s'",
+                                         targa_header.pixel_size, name);
+                            return IMAGE_DECODE_ERROR;
                             break;
                     }
 
@@ -259,7 +269,10 @@ void R_LoadTGA(pointer name, uchar8 **pic, sint *width, sint *height) {
                 } else {                          // non run-length packet
 
                     if(buf_p + targa_header.pixel_size / 8 * packetSize > end) {
-                        common->Error(ERR_DROP, "LoadTGA: file truncated (%s)", name);
+                        R_ImageFree(targa_rgba);
+                        Q_vsprintf_s(error, errorSize, errorSize,
+                                     "LoadTGA: file truncated (%s)", name);
+                        return IMAGE_DECODE_ERROR;
                     }
 
                     for(j = 0; j < packetSize; j++) {
@@ -286,8 +299,11 @@ void R_LoadTGA(pointer name, uchar8 **pic, sint *width, sint *height) {
                                 break;
 
                             default:
-                                common->Error(ERR_DROP, "LoadTGA: illegal pixel_size '%d' in file '%s'",
-                                              targa_header.pixel_size, name);
+                                R_ImageFree(targa_rgba);
+                                Q_vsprintf_s(error, errorSize, errorSize,
+                                             "LoadTGA: illegal pixel_size '%d' in file '%s'",
+                                             targa_header.pixel_size, name);
+                                return IMAGE_DECODE_ERROR;
                                 break;
                         }
 
@@ -353,5 +369,5 @@ breakOut:
 
     *pic = targa_rgba;
 
-    fileSystem->FreeFile(buffer.v);
+    return IMAGE_DECODE_OK;
 }
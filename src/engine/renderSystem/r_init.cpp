@@ -1190,6 +1190,7 @@ void idRenderSystemLocal::Shutdown(bool destroyWindow) {
         ShutdownGPUShaders();
     }
 
+    R_FinishImagePrefetch();
     R_DoneFreeType();
 
     // shut down platform specific OpenGL stuff
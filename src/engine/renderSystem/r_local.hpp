@@ -1916,6 +1916,29 @@ float32 R_FogFactor(float32 s, float32 t);
 void R_InitImages(void);
 void R_DeleteTextures(void);
 sint    R_SumOfUsedImages(void);
+
+#define MAX_IMAGE_CANDIDATES 5  // a DDS and every image loader
+
+typedef struct {
+    valueType name[MAX_QPATH];
+    imageDecoder_t decode;      // nullptr for a DDS
+    bool alternative;           // not the extension that was asked for
+} imageCandidate_t;
+
+sint R_ImageCandidates(pointer name, imageCandidate_t *candidates);
+void R_ReportImageDecode(imageDecode_t result, pointer error);
+
+//
+// r_image_prefetch.cpp
+//
+void *R_ImageMalloc(sint size);
+void R_ImageFree(void *ptr);
+void R_FreeImagePic(uchar8 *pic);
+void R_PrefetchImage(pointer name);
+void R_StartImagePrefetch(void);
+bool R_TakePrefetchedImage(pointer name, uchar8 **pic, sint *width,
+                           sint *height);
+void R_FinishImagePrefetch(void);
 void R_InitSkins(void);
 skin_t *R_GetSkinByHandle(qhandle_t hSkin);
 
@@ -1931,6 +1954,7 @@ shader_t   *R_FindShader(pointer name, sint lightmapIndex,
 shader_t   *R_GetShaderByHandle(qhandle_t hShader);
 shader_t   *R_GetShaderByState(sint index, sint32 *cycleTime);
 shader_t *R_FindShaderByName(pointer name);
+void        R_PrefetchShaderImages(pointer name);
 void        R_InitShaders(void);
 void        R_ShaderList_f(void);
 
@@ -3798,6 +3798,109 @@ static valueType *FindShaderInShaderText(pointer shadername) {
 }
 
 
+/*
+====================
+R_PrefetchDiffuseImage
+
+Also queues the normal and specular maps CollapseStagesToGLSL looks for
+====================
+*/
+static void R_PrefetchDiffuseImage(pointer name) {
+    valueType companionName[MAX_QPATH];
+
+    R_PrefetchImage(name);
+
+    COM_StripExtension2(name, companionName, MAX_QPATH);
+
+    if(r_normalMapping->integer) {
+        R_PrefetchImage(va(nullptr, "%s_h", companionName));
+        R_PrefetchImage(va(nullptr, "%s_n", companionName));
+    }
+
+    if(r_specularMapping->integer && r_pbr->integer) {
+        R_PrefetchImage(va(nullptr, "%s_s", companionName));
+    }
+}
+
+/*
+====================
+R_PrefetchShaderImages
+
+Queues the images R_FindShader will load for name on the image prefetch
+workers. This only scans the shader text, an image it misses is loaded
+the old way and one it queues for nothing is dropped again.
+====================
+*/
+void R_PrefetchShaderImages(pointer name) {
+    valueType strippedName[MAX_QPATH], fileName[MAX_QPATH];
+    valueType *text, *token;
+    sint depth = 0;
+    bool hasText, implicit = false;
+
+    if(!name[0]) {
+        return;
+    }
+
+    COM_StripExtension2(name, strippedName, sizeof(strippedName));
+
+    text = FindShaderInShaderText(strippedName);
+    hasText = text != nullptr;
+
+    Q_strncpyz(fileName, name, sizeof(fileName));
+
+    while(text) {
+        token = COM_ParseExt2(&text, true);
+
+        if(!token[0]) {
+            break;
+        }
+
+        if(token[0] == '{') {
+            depth++;
+        } else if(token[0] == '}') {
+            if(--depth <= 0) {
+                break;
+            }
+        } else if(!Q_stricmp(token, "map") || !Q_stricmp(token, "clampmap")) {
+            token = COM_ParseExt2(&text, false);
+
+            if(token[0] && token[0] != '$' && token[0] != '*') {
+                R_PrefetchDiffuseImage(token);
+            }
+        } else if(!Q_stricmp(token, "animMap")) {
+            // skip the frequency
+            COM_ParseExt2(&text, false);
+
+            while(1) {
+                token = COM_ParseExt2(&text, false);
+
+                if(!token[0]) {
+                    break;
+                }
+
+                R_PrefetchImage(token);
+            }
+        } else if(!Q_stricmpn(token, "implicit", 8)) {
+            token = COM_ParseExt2(&text, false);
+
+            if(token[0] && token[0] != '-') {
+                Q_strncpyz(fileName, token, sizeof(fileName));
+            }
+
+            implicit = true;
+        }
+    }
+
+    // without a shader the image file of the same name is used
+    if(hasText && !implicit) {
+        return;
+    }
+
+    COM_DefaultExtension(fileName, sizeof(fileName), ".tga");
+
+    R_PrefetchDiffuseImage(fileName);
+}
+
 /*
 ==================
 R_FindShaderByName
@@ -209,8 +209,9 @@ typedef struct server_s {
     // show_bug.cgi?id=475
     // the serverId associated with the current checksumFeed (always <= serverId)
     sint             checksumFeedServerId;
-    sint             snapshotCounter;   // incremented for each snapshot built
     sint             timeResidual;  // <= 1000 / sv_frame->value
+    sint             frameUsecResidual; // usec the whole msec frames are behind sv_fps
+    sint64           frameDeadline; // usec, when a dedicated server runs the next frame
     sint             nextFrameTime; // when time > nextFrameTime, process world
     struct cmodel_s *models[MAX_MODELS];
     configString_t  configstrings[MAX_CONFIGSTRINGS];
@@ -414,6 +415,65 @@ typedef struct svstats_s {
     sint    latched_packets;
 } svstats_t;
 
+// what a client slot costs the server, see the tickstatus command
+typedef enum {
+    CLIENTCOST_USERMOVE,    // reading usercmds, the think they trigger not included
+    CLIENTCOST_THINK,       // game ClientThink, bots included
+    CLIENTCOST_SNAPSHOT,    // building, encoding and sending snapshots
+    CLIENTCOST_DOWNLOAD,    // reading and writing download blocks
+    CLIENTCOST_NUM
+} clientCostType_t;
+
+typedef struct {
+    sint64  usec[CLIENTCOST_NUM];   // since the last server frame
+    sint    bytes;                  // messages sent, downloads included
+
+    sint64  windowUsec[CLIENTCOST_NUM];     // over the running STATFRAMES window
+    sint64  windowBytes;
+    sint64  windowPeak;                     // worst single frame
+
+    float32 latchedUsec[CLIENTCOST_NUM];    // per frame, over the last full window
+    float32 latchedBytes;
+    sint    latchedPeak;
+} clientCost_t;
+
+#define MAX_TICK_OVERRUNS       32
+#define TICK_OVERRUN_OFFENDERS  3
+
+// a server frame that took longer than 1000 / sv_fps
+typedef struct {
+    sint    time;                   // svs.time when it finished
+    sint    usec;
+    sint    budgetUsec;
+    sint    ticks;                  // game frames it ran
+    sint    clients[TICK_OVERRUN_OFFENDERS];    // costliest slots, -1 if none
+    sint    clientUsec[TICK_OVERRUN_OFFENDERS];
+} tickOverrun_t;
+
+//
+// idClientCostScope
+//
+// Charges the rest of the block to a client slot.  Scopes opened inside it on
+// the same thread are charged to their own slot and type and left out of this
+// one, so a snapshot doesn't pay for the download written into it.
+//
+class idClientCostScope {
+public:
+    idClientCostScope(client_t *cl, clientCostType_t type);
+    ~idClientCostScope(void);
+
+private:
+    idClientCostScope(const idClientCostScope &);
+    idClientCostScope &operator=(const idClientCostScope &);
+
+    sint64 *usec;
+    sint64 start;
+    sint64 nested;
+    idClientCostScope *outer;
+
+    static thread_local idClientCostScope *current;
+};
+
 // MAX_CHALLENGES is made large to prevent a denial
 // of service attack that could cycle all of them
 // out before legitimate users connected
@@ -509,6 +569,11 @@ typedef struct serverStatic_s {
     svstats_t       stats;
     sint                queryDone;
 
+    clientCost_t    clientCosts[MAX_CLIENTS];
+    sint            clientCostFrames;       // into the running window
+    tickOverrun_t   tickOverruns[MAX_TICK_OVERRUNS];
+    sint            numTickOverruns;        // ever, the ring keeps the last ones
+
     netadr_t authorizeAddress;
 
     struct {
@@ -910,6 +910,76 @@ void idServerCcmdsSystemLocal::Status_f(void) {
     common->Printf("\n");
 }
 
+/*
+================
+idServerCcmdsSystemLocal::TickStatus_f
+
+What each client slot cost the server per frame over the last STATFRAMES
+frames, and the last frames that ran over budget
+================
+*/
+void idServerCcmdsSystemLocal::TickStatus_f(void) {
+    sint i, j, num;
+    float32 total;
+    client_t *cl;
+    clientCost_t *cost;
+    tickOverrun_t *overrun;
+
+    // make sure server is running
+    if(!sv_running->integer) {
+        common->Printf("Server is not running.\n");
+        return;
+    }
+
+    common->Printf("frame budget: %i usec, %i frames over it\n",
+                   1000000 / (sv_fps->integer > 0 ? sv_fps->integer : 1),
+                   svs.numTickOverruns);
+    common->Printf("usec per frame over the last %i frames\n", STATFRAMES);
+    common->Printf("num name            usermove  think snapshot download  total  peak bytes\n");
+    common->Printf("--- --------------- -------- ------ -------- -------- ------ ----- -----\n");
+
+    for(i = 0, cl = svs.clients, cost = svs.clientCosts;
+            i < sv_maxclients->integer; i++, cl++, cost++) {
+        if(!cl->state) {
+            continue;
+        }
+
+        for(j = 0, total = 0; j < CLIENTCOST_NUM; j++) {
+            total += cost->latchedUsec[j];
+        }
+
+        common->Printf("%3i %-15.15s %8.0f %6.0f %8.0f %8.0f %6.0f %5i %5.0f\n",
+                       i, cl->name, cost->latchedUsec[CLIENTCOST_USERMOVE],
+                       cost->latchedUsec[CLIENTCOST_THINK],
+                       cost->latchedUsec[CLIENTCOST_SNAPSHOT],
+                       cost->latchedUsec[CLIENTCOST_DOWNLOAD], total, cost->latchedPeak,
+                       cost->latchedBytes);
+    }
+
+    num = Q_min(svs.numTickOverruns, MAX_TICK_OVERRUNS);
+
+    if(!num) {
+        return;
+    }
+
+    common->Printf("\nlast %i overruns, newest first\n", num);
+    common->Printf("    time   usec budget ticks costliest slots (usec)\n");
+
+    for(i = 0; i < num; i++) {
+        overrun = &svs.tickOverruns[(svs.numTickOverruns - 1 - i) %
+                                    MAX_TICK_OVERRUNS];
+
+        common->Printf("%8i %6i %6i %5i", overrun->time, overrun->usec,
+                       overrun->budgetUsec, overrun->ticks);
+
+        for(j = 0; j < TICK_OVERRUN_OFFENDERS && overrun->clients[j] >= 0; j++) {
+            common->Printf(" %i (%i)", overrun->clients[j], overrun->clientUsec[j]);
+        }
+
+        common->Printf("\n");
+    }
+}
+
 /*
 ==================
 idServerCcmdsSystemLocal::ConSay_f
@@ -1923,6 +1993,8 @@ void idServerCcmdsSystemLocal::AddOperatorCommands(void) {
                           "Sends an update from the server to the master server with the result of updating server info.");
     cmdSystem->AddCommand("status", &idServerCcmdsSystemLocal::Status_f,
                           "Reports map loaded, and information on all connected players.");
+    cmdSystem->AddCommand("tickstatus", &idServerCcmdsSystemLocal::TickStatus_f,
+                          "Reports the time and bytes each client slot costs the server per frame, and the last frames that ran over budget.");
     cmdSystem->AddCommand("serverinfo",
                           &idServerCcmdsSystemLocal::Serverinfo_f,
                           "Shows server cvars on the local machine, including user created variables set with the sets command.");
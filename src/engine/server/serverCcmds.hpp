@@ -61,6 +61,7 @@ public:
     static void MapRestart_f(void);
     static void LoadGame_f(void);
     static void Status_f(void);
+    static void TickStatus_f(void);
     static void ConSay_f(void);
     static void Serverinfo_f(void);
     static void Systeminfo_f(void);
@@ -695,6 +695,8 @@ gotnewcl:
     // accept the new client
     // this is the only place a client_t is ever initialized
     *newcl = temp;
+    ::memset(&svs.clientCosts[ARRAY_INDEX(svs.clients, newcl)], 0,
+             sizeof(clientCost_t));
 
     // Adding Community server Data
 
@@ -1405,6 +1407,7 @@ void idServerClientSystemLocal::WriteDownloadToClient(client_t *cl,
 #endif
 
     bool bTellRate = false; // verbosity
+    idClientCostScope cost(cl, CLIENTCOST_DOWNLOAD);
 
     if(!*cl->downloadName) {
         // Nothing being downloaded
@@ -2587,6 +2590,8 @@ void idServerClientSystemLocal::ClientThink(sint client, usercmd_t *cmd) {
         return;
     }
 
+    idClientCostScope cost(cl, CLIENTCOST_THINK);
+
     if(cl->lastUserInfoCount >= INFO_CHANGE_MAX_COUNT &&
             cl->lastUserInfoChange < svs.time &&
             cl->userinfoPostponed[0]) {
@@ -2630,6 +2635,7 @@ void idServerClientSystemLocal::UserMove(client_t *cl, msg_t *msg,
         bool delta) {
     sint i, key, cmdCount;
     usercmd_t nullcmd, cmds[MAX_PACKET_USERCMDS], * cmd, * oldcmd;
+    idClientCostScope cost(cl, CLIENTCOST_USERMOVE);
 
     if(delta) {
         cl->deltaMessage = cl->messageAcknowledge;
@@ -1128,6 +1128,7 @@ void idServerInitSystemLocal::Shutdown(valueType *finalmsg) {
     // free current level
     ClearServer();
     collisionModelManager->ClearMap();
+    idServerSnapshotSystemLocal::FreeSnapshotMemory();
 
     // free server static data
     if(svs.clients) {
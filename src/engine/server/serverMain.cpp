@@ -1645,7 +1645,9 @@ happen before idServerMainSystemLocal::Frame is called
 ==================
 */
 void idServerMainSystemLocal::Frame(sint msec) {
-    sint frameMsec, startTime, frameStartTime = 0, frameEndTime;
+    sint frameMsec, frameUsec, frameStartTime = 0, frameEndTime;
+    sint64 startTime, now, timeVal;
+    bool due = false;
     static sint start, end;
     valueType mapname[MAX_QPATH];
 
@@ -1711,24 +1713,50 @@ void idServerMainSystemLocal::Frame(sint msec) {
     }
 
     if(svs.hibernation.enabled) {
-        frameMsec = 1000 / 2;
+        frameUsec = 1000000 / 2;
     } else {
-        frameMsec = 1000 / sv_fps->integer;
+        // a frame has to move the game time by at least a msec
+        frameUsec = 1000000 / Q_min(sv_fps->integer, 1000);
     }
 
+    // the game time moves in whole msec, so a frame is rounded down to
+    // them and the rest is carried over to the next one. That keeps rates
+    // above 100 that don't divide 1000 right on average
+    frameMsec = (sv.frameUsecResidual + frameUsec) / 1000;
+
     sv.timeResidual += msec;
 
-    if(dedicated->integer && sv.timeResidual < frameMsec &&
-            (!timescale || timescale->value >= 1)) {
-        // first check if we need to send any pending packets
-        sint timeVal = serverMainSystem->SendQueuedPackets();
+    if(dedicated->integer && (!timescale || timescale->value >= 1)) {
+        now = profilerSystem->Microseconds();
 
-        // networkSystem->Sleep will give the OS time slices until either get a packet
-        // or time enough for a server frame has gone by
-        networkSystem->Sleep(Q_min(frameMsec - sv.timeResidual, timeVal));
-        return;
+        // start the schedule over after a stall, a map change or hibernation
+        if(sv.frameDeadline < now - frameUsec || sv.frameDeadline > now + frameUsec) {
+            sv.frameDeadline = now + static_cast<sint64>(Q_max(frameMsec -
+                               sv.timeResidual, 0)) * 1000;
+        }
+
+        // msec comes from a millisecond clock that may not have ticked over
+        // yet when the deadline is reached, the frame runs then anyway and
+        // timeResidual pays the msec back
+        due = sv.timeResidual < frameMsec && sv.timeResidual >= frameMsec - 1 &&
+              now >= sv.frameDeadline;
+
+        if(sv.timeResidual < frameMsec && !due) {
+            // first check if we need to send any pending packets
+            timeVal = static_cast<sint64>(serverMainSystem->SendQueuedPackets()) * 1000;
+
+            // networkSystem->SleepUsec will give the OS time slices until either get a packet
+            // or the deadline of the next server frame has come
+            networkSystem->SleepUsec(Q_min(Q_max(sv.frameDeadline - now,
+                                                 static_cast<sint64>(frameMsec - 1 - sv.timeResidual) * 1000), timeVal));
+            return;
+        }
     }
 
+    // everything before this point may sleep waiting for the next frame
+    idProfileScope profile("SV_Frame");
+    sint64 tickStart = profilerSystem->Microseconds();
+    sint ticks = 0;
     bool hasHuman = false;
 
     for(sint i = 0; i < sv_maxclients->integer; ++i) {
@@ -1816,7 +1844,7 @@ void idServerMainSystemLocal::Frame(sint msec) {
     }
 
     if(com_speeds->integer) {
-        startTime = idsystem->Milliseconds();
+        startTime = profilerSystem->Microseconds();
     } else {
         // quite a compiler warning
         startTime = 0;
@@ -1826,14 +1854,21 @@ void idServerMainSystemLocal::Frame(sint msec) {
     CalcPings();
 
     // run the game simulation in chunks
-    while(sv.timeResidual >= frameMsec) {
+    while(sv.timeResidual >= frameMsec || due) {
+        due = false;
         sv.timeResidual -= frameMsec;
         svs.time += frameMsec;
         sv.time += frameMsec;
+        sv.frameUsecResidual = (sv.frameUsecResidual + frameUsec) % 1000;
+        sv.frameDeadline += frameUsec;
+        ticks++;
 
         // let everything in the world think and move
 #if !defined (UPDATE_SERVER)
-        sgame->RunFrame(sv.time);
+        {
+            idProfileScope profileGame("G_RunFrame");
+            sgame->RunFrame(sv.time);
+        }
 #endif
 
         if(sv_oacsEnable->integer == 1) {
@@ -1841,10 +1876,12 @@ void idServerMainSystemLocal::Frame(sint msec) {
             idServerOACSSystemLocal::ExtendedRecordUpdate();
 #endif
         }
+
+        frameMsec = (sv.frameUsecResidual + frameUsec) / 1000;
     }
 
     if(com_speeds->integer) {
-        time_game = idsystem->Milliseconds() - startTime;
+        time_game = static_cast<sint>(profilerSystem->Microseconds() - startTime);
     }
 
     // check timeouts
@@ -1853,8 +1890,10 @@ void idServerMainSystemLocal::Frame(sint msec) {
     // check user info buffer thingy
     serverSnapshotSystem->CheckClientUserinfoTimer();
 
-    // send messages back to the clients
+    // send messages back to the clients, coalescing the datagrams
+    networkSystem->BeginPacketBatch();
     serverSnapshotSystem->SendClientMessages();
+    networkSystem->FlushPacketBatch();
 
     CheckCvars();
 
@@ -1908,8 +1947,8 @@ void idServerMainSystemLocal::Frame(sint msec) {
 
                 averageFrameTime = totalTime / SERVER_PERFORMANCECOUNTER_SAMPLES;
 
-                svs.serverLoad = (averageFrameTime / static_cast<float32>
-                                  (frameMsec)) * 100;
+                svs.serverLoad = (averageFrameTime / (static_cast<float32>
+                                  (frameUsec) / 1000)) * 100;
             }
 
             //common->Printf( "ServerLoad: %i (%i/%i)\n", svs.serverLoad, averageFrameTime, frameMsec );
@@ -1921,6 +1960,9 @@ void idServerMainSystemLocal::Frame(sint msec) {
         svs.serverLoad = -1;
     }
 
+    UpdateClientCosts(profilerSystem->Microseconds() - tickStart,
+                      frameUsec, ticks);
+
     // collect timing statistics
     end = idsystem->Milliseconds();
     svs.stats.active += (static_cast<float64>((end) - start)) / 1000;
@@ -1936,6 +1978,126 @@ void idServerMainSystemLocal::Frame(sint msec) {
     }
 }
 
+/*
+==================
+idServerMainSystemLocal::UpdateClientCosts
+
+Closes the costs of the frame for every client slot and logs the frame
+with its costliest slots if it ran over budget
+==================
+*/
+void idServerMainSystemLocal::UpdateClientCosts(sint64 frameUsec,
+        sint budgetUsec, sint ticks) {
+    sint i, j, k;
+    sint64 usec, worstUsec[TICK_OVERRUN_OFFENDERS];
+    sint worst[TICK_OVERRUN_OFFENDERS];
+    bool latch;
+    clientCost_t *cost;
+    tickOverrun_t *overrun;
+
+    for(i = 0; i < TICK_OVERRUN_OFFENDERS; i++) {
+        worst[i] = -1;
+        worstUsec[i] = 0;
+    }
+
+    latch = ++svs.clientCostFrames == STATFRAMES;
+
+    if(latch) {
+        svs.clientCostFrames = 0;
+    }
+
+    for(i = 0, cost = svs.clientCosts; i < sv_maxclients->integer;
+            i++, cost++) {
+        usec = 0;
+
+        for(j = 0; j < CLIENTCOST_NUM; j++) {
+            usec += cost->usec[j];
+            cost->windowUsec[j] += cost->usec[j];
+            cost->usec[j] = 0;
+        }
+
+        cost->windowBytes += cost->bytes;
+        cost->bytes = 0;
+
+        if(usec > cost->windowPeak) {
+            cost->windowPeak = usec;
+        }
+
+        // keep the costliest slots sorted
+        for(j = 0; j < TICK_OVERRUN_OFFENDERS; j++) {
+            if(usec > worstUsec[j]) {
+                for(k = TICK_OVERRUN_OFFENDERS - 1; k > j; k--) {
+                    worst[k] = worst[k - 1];
+                    worstUsec[k] = worstUsec[k - 1];
+                }
+
+                worst[j] = i;
+                worstUsec[j] = usec;
+                break;
+            }
+        }
+
+        if(latch) {
+            for(j = 0; j < CLIENTCOST_NUM; j++) {
+                cost->latchedUsec[j] = static_cast<float32>(cost->windowUsec[j]) /
+                                       STATFRAMES;
+                cost->windowUsec[j] = 0;
+            }
+
+            cost->latchedBytes = static_cast<float32>(cost->windowBytes) / STATFRAMES;
+            cost->latchedPeak = static_cast<sint>(cost->windowPeak);
+            cost->windowBytes = 0;
+            cost->windowPeak = 0;
+        }
+    }
+
+    if(frameUsec <= budgetUsec) {
+        return;
+    }
+
+    overrun = &svs.tickOverruns[svs.numTickOverruns++ % MAX_TICK_OVERRUNS];
+    overrun->time = svs.time;
+    overrun->usec = static_cast<sint>(frameUsec);
+    overrun->budgetUsec = budgetUsec;
+    overrun->ticks = ticks;
+
+    for(i = 0; i < TICK_OVERRUN_OFFENDERS; i++) {
+        overrun->clients[i] = worst[i];
+        overrun->clientUsec[i] = static_cast<sint>(worstUsec[i]);
+    }
+}
+
+// innermost scope open on this thread
+thread_local idClientCostScope *idClientCostScope::current;
+
+/*
+==================
+idClientCostScope::idClientCostScope
+==================
+*/
+idClientCostScope::idClientCostScope(client_t *cl, clientCostType_t type) :
+    usec(&svs.clientCosts[cl - svs.clients].usec[type]),
+    start(profilerSystem->Microseconds()), nested(0), outer(current) {
+    current = this;
+}
+
+/*
+==================
+idClientCostScope::~idClientCostScope
+==================
+*/
+idClientCostScope::~idClientCostScope(void) {
+    sint64 elapsed = profilerSystem->Microseconds() - start;
+
+    *usec += elapsed - nested;
+
+    if(outer) {
+        outer->nested += elapsed;
+    }
+
+    current = outer;
+}
+
 /*
 =================
 idServerMainSystemLocal::LoadTag
@@ -83,6 +83,7 @@ public:
     static bool CheckPaused(void);
     static void GetUpdateInfo(netadr_t from);
     static void CheckCvars(void);
+    static void UpdateClientCosts(sint64 frameUsec, sint budgetUsec, sint ticks);
 
     static void FlushRedirect(valueType *outputbuf);
     static bool IsRconWhitelisted(netadr_t *from);
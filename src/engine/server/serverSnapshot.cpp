@@ -47,6 +47,18 @@
 idServerSnapshotSystemLocal serverSnapshotSystemLocal;
 idServerSnapshotSystem *serverSnapshotSystem = &serverSnapshotSystemLocal;
 
+snapshotJob_t *idServerSnapshotSystemLocal::snapshotJobs = nullptr;
+sint idServerSnapshotSystemLocal::numSnapshotJobs = 0;
+visCacheEntry_t idServerSnapshotSystemLocal::visCache[MAX_VIS_CACHE_ENTRIES];
+sint idServerSnapshotSystemLocal::numVisCacheEntries = 0;
+bool idServerSnapshotSystemLocal::visCacheActive = false;
+std::mutex idServerSnapshotSystemLocal::visCacheMutex;
+deltaCacheEntry_t *idServerSnapshotSystemLocal::deltaCache = nullptr;
+sint idServerSnapshotSystemLocal::deltaCacheGeneration = 0;
+std::mutex idServerSnapshotSystemLocal::deltaCacheLocks[DELTA_CACHE_LOCKS];
+std::atomic<sint> idServerSnapshotSystemLocal::deltaCacheHits(0);
+std::atomic<sint> idServerSnapshotSystemLocal::deltaCacheMisses(0);
+
 /*
 ===============
 idServerSnapshotSystemLocal::idServerSnapshotSystemLocal
@@ -61,6 +73,31 @@ idServerWorldSystemLocal::~idServerWorldSystemLocal
 ===============
 */
 idServerSnapshotSystemLocal::~idServerSnapshotSystemLocal(void) {
+    FreeSnapshotMemory();
+}
+
+/*
+===============
+idServerSnapshotSystemLocal::FreeSnapshotMemory
+
+Frees the snapshot jobs and the delta cache, they are allocated again the
+next time they are needed
+===============
+*/
+void idServerSnapshotSystemLocal::FreeSnapshotMemory(void) {
+    if(snapshotJobs) {
+        ::free(snapshotJobs);
+        snapshotJobs = nullptr;
+    }
+
+    numSnapshotJobs = 0;
+
+    if(deltaCache) {
+        ::free(deltaCache);
+        deltaCache = nullptr;
+    }
+
+    deltaCacheGeneration = 0;
 }
 
 /*
@@ -84,6 +121,126 @@ A normal server packet will look like:
 =============================================================================
 */
 
+/*
+=============
+idServerSnapshotSystemLocal::BeginDeltaCache
+
+Invalidates the encodings of the previous frame. Outside of
+SendClientMessages the generation is 0 and nothing is cached.
+=============
+*/
+void idServerSnapshotSystemLocal::BeginDeltaCache(void) {
+    if(!sv_deltaCache->integer) {
+        deltaCacheGeneration = 0;
+        return;
+    }
+
+    if(!deltaCache) {
+        deltaCache = static_cast<deltaCacheEntry_t *>(::calloc(DELTA_CACHE_SIZE,
+                     sizeof(deltaCacheEntry_t)));
+
+        if(!deltaCache) {
+            deltaCacheGeneration = 0;
+            return;
+        }
+    }
+
+    // skip 0 on wrap so stale entries never look valid
+    if(++deltaCacheGeneration <= 0) {
+        deltaCacheGeneration = 1;
+    }
+}
+
+/*
+=============
+idServerSnapshotSystemLocal::WriteDeltaEntity
+
+Same as msgToFuncSystem->WriteDeltaEntity, but clients that see the same
+entity change from the same state share one encoding. The bits don't depend
+on where they land in the message, so a cached encoding is just copied in.
+Safe to call from the snapshot jobs.
+=============
+*/
+void idServerSnapshotSystemLocal::WriteDeltaEntity(msg_t *msg,
+        entityState_t *from, entityState_t *to, bool force) {
+    const uint32 *words;
+    const sint numWords = sizeof(entityState_t) / 4;
+    uint32 hash;
+    sint i, generation;
+    deltaCacheEntry_t *entry;
+    uchar8 data[MAX_DELTA_ENTITY_BYTES + 32];
+    msg_t scratch;
+
+    generation = deltaCacheGeneration;
+
+    if(!generation || !to || msg->oob) {
+        msgToFuncSystem->WriteDeltaEntity(msg, from, to, force);
+        return;
+    }
+
+    // unchanged entities write nothing, don't bother hashing them
+    if(!force && !::memcmp(from, to, sizeof(entityState_t))) {
+        return;
+    }
+
+    // FNV-1a over both states
+    hash = 2166136261u;
+
+    words = reinterpret_cast<const uint32 *>(from);
+
+    for(i = 0; i < numWords; i++) {
+        hash = (hash ^ words[i]) * 16777619u;
+    }
+
+    words = reinterpret_cast<const uint32 *>(to);
+
+    for(i = 0; i < numWords; i++) {
+        hash = (hash ^ words[i]) * 16777619u;
+    }
+
+    hash = (hash ^ force) * 16777619u;
+
+    entry = &deltaCache[hash & (DELTA_CACHE_SIZE - 1)];
+
+    {
+        std::lock_guard<std::mutex> lock(deltaCacheLocks[hash %
+                                                         DELTA_CACHE_LOCKS]);
+
+        if(entry->generation == generation && entry->force == force &&
+                !::memcmp(&entry->to, to, sizeof(entityState_t)) &&
+                !::memcmp(&entry->from, from, sizeof(entityState_t))) {
+            msgToFuncSystem->WriteBitStream(msg, entry->data, entry->numBits);
+            msg->uncompsize += entry->uncompsize;
+            deltaCacheHits++;
+            return;
+        }
+    }
+
+    deltaCacheMisses++;
+
+    msgToFuncSystem->Init(&scratch, data, sizeof(data));
+    msgToFuncSystem->WriteDeltaEntity(&scratch, from, to, force);
+
+    if(scratch.overflowed || scratch.bit > MAX_DELTA_ENTITY_BYTES * 8) {
+        msgToFuncSystem->WriteDeltaEntity(msg, from, to, force);
+        return;
+    }
+
+    msgToFuncSystem->WriteBitStream(msg, data, scratch.bit);
+    msg->uncompsize += scratch.uncompsize;
+
+    std::lock_guard<std::mutex> lock(deltaCacheLocks[hash %
+                                                     DELTA_CACHE_LOCKS]);
+
+    entry->generation = generation;
+    entry->force = force;
+    entry->numBits = scratch.bit;
+    entry->uncompsize = scratch.uncompsize;
+    entry->from = *from;
+    entry->to = *to;
+    ::memcpy(entry->data, data, (scratch.bit + 7) >> 3);
+}
+
 /*
 =============
 idServerSnapshotSystemLocal::EmitPacketEntities
@@ -129,7 +286,7 @@ void idServerSnapshotSystemLocal::EmitPacketEntities(
             // delta update from old position
             // because the force parm is false, this will not result
             // in any bytes being emited if the entity has not changed at all
-            msgToFuncSystem->WriteDeltaEntity(msg, oldent, newent, false);
+            WriteDeltaEntity(msg, oldent, newent, false);
             oldindex++;
             newindex++;
             continue;
@@ -137,8 +294,8 @@ void idServerSnapshotSystemLocal::EmitPacketEntities(
 
         if(newnum < oldnum) {
             // this is a new entity, send it from the baseline
-            msgToFuncSystem->WriteDeltaEntity(msg, &sv.svEntities[newnum].baseline,
-                                              newent, true);
+            WriteDeltaEntity(msg, &sv.svEntities[newnum].baseline, newent,
+                             true);
             newindex++;
             continue;
         }
@@ -161,13 +318,16 @@ idServerSnapshotSystemLocal::WriteSnapshotToClient
 ==================
 */
 void idServerSnapshotSystemLocal::WriteSnapshotToClient(client_t *client,
-        msg_t *msg) {
+        msg_t *msg, pointer *deltaWarning) {
     sint lastframe, i, snapFlags, deltaMessage;
     clientSnapshot_t *frame, *oldframe;
 
     // this is the snapshot we are creating
     frame = &client->frames[client->netchan.outgoingSequence & PACKET_MASK];
 
+    // this may run on a snapshot worker, the caller prints it
+    *deltaWarning = nullptr;
+
     // bots never acknowledge, but it doesn't matter since the only use case is for serverside demos
     // in which case we can delta against the very last message every time
     deltaMessage = client->deltaMessage;
@@ -184,10 +344,7 @@ void idServerSnapshotSystemLocal::WriteSnapshotToClient(client_t *client,
     } else if(client->netchan.outgoingSequence - client->deltaMessage >=
               (PACKET_BACKUP - 3)) {
         // client hasn't gotten a good message through in a long time
-        if(developer->integer) {
-            common->Printf("%s: Delta request from out of date packet.\n",
-                           client->name);
-        }
+        *deltaWarning = "Delta request from out of date packet.";
 
         oldframe = nullptr;
         lastframe = 0;
@@ -209,10 +366,7 @@ void idServerSnapshotSystemLocal::WriteSnapshotToClient(client_t *client,
         // the snapshot's entities may still have rolled off the buffer, though
         if(oldframe->first_entity <= svs.nextSnapshotEntities -
                 svs.numSnapshotEntities) {
-            if(developer->integer) {
-                common->Printf("%s: Delta request from out of date entities.\n",
-                               client->name);
-            }
+            *deltaWarning = "Delta request from out of date entities.";
 
             oldframe = nullptr;
             lastframe = 0;
@@ -375,23 +529,29 @@ sint idServerSnapshotSystemLocal::QsortEntityNumbers(const void *a,
 idServerSnapshotSystemLocal::AddEntToSnapshot
 ===============
 */
-void idServerSnapshotSystemLocal::AddEntToSnapshot(sharedEntity_t
-        *clientEnt, svEntity_t *svEnt, sharedEntity_t *gEnt,
-        snapshotEntityNumbers_t *eNums) {
+void idServerSnapshotSystemLocal::AddEntToSnapshot(svEntity_t *svEnt,
+        sharedEntity_t *gEnt, snapshotEntityNumbers_t *eNums) {
+    sint num = ARRAY_INDEX(sv.svEntities, svEnt);
+
     // if we have already added this entity to this snapshot, don't add again
-    if(svEnt->snapshotCounter == sv.snapshotCounter) {
+    if(eNums->added[num >> 3] & (1 << (num & 7))) {
         return;
     }
 
-    svEnt->snapshotCounter = sv.snapshotCounter;
+    eNums->added[num >> 3] |= (1 << (num & 7));
 
     // if we are full, silently discard entities
     if(eNums->numSnapshotEntities == MAX_SNAPSHOT_ENTITIES) {
+        eNums->overflowed = true;
         return;
     }
 
+    // the game callback can't be called from a snapshot worker,
+    // FinishClientSnapshot runs it on the main thread
     if(gEnt->r.snapshotCallback) {
-        if(!sgame->SnapshotCallback(gEnt->s.number, clientEnt->s.number)) {
+        if(!eNums->runCallbacks) {
+            eNums->needsCallback = true;
+        } else if(!sgame->SnapshotCallback(gEnt->s.number, eNums->clientNum)) {
             return;
         }
     }
@@ -402,41 +562,23 @@ void idServerSnapshotSystemLocal::AddEntToSnapshot(sharedEntity_t
 
 /*
 ===============
-idServerSnapshotSystemLocal::AddEntitiesVisibleFromPoint
+idServerSnapshotSystemLocal::CollectVisibleEntities
+
+Gathers every entity that could be seen from the given cluster and area,
+leaving out the tests that depend on the receiving client. Runs on the cull
+workers, so it only reads the game entities.
 ===============
 */
-void idServerSnapshotSystemLocal::AddEntitiesVisibleFromPoint(
-    vec3_t origin, clientSnapshot_t *frame, snapshotEntityNumbers_t *eNums,
-    bool portal) {
-    uchar8 *clientpvs, *bitvector;
-    sint e, i, l, clientarea, clientcluster, leafnum, c_fullsend;
-    sharedEntity_t *ent, *playerEnt;
+sint idServerSnapshotSystemLocal::CollectVisibleEntities(sint cluster,
+        sint area, uchar16 *list) {
+    uchar8 *bitvector;
+    sint e, i, l, numEntities;
+    sharedEntity_t *ent;
     svEntity_t *svEnt;
 
-    // during an error shutdown message we may need to transmit
-    // the shutdown message after the server has shutdown, so
-    // specfically check for it
-    if(!sv.state) {
-        return;
-    }
-
-    leafnum = collisionModelManager->PointLeafnum(origin);
-    clientarea = collisionModelManager->LeafArea(leafnum);
-    clientcluster = collisionModelManager->LeafCluster(leafnum);
-
-    // calculate the visible areas
-    frame->areabytes = collisionModelManager->WriteAreaBits(frame->areabits,
-                       clientarea);
-
-    clientpvs = collisionModelManager->ClusterPVS(clientcluster);
-
-    c_fullsend = 0;
+    bitvector = collisionModelManager->ClusterPVS(cluster);
 
-    playerEnt = serverGameSystem->GentityNum(frame->ps.clientNum);
-
-    if(playerEnt->r.svFlags & SVF_SELF_PORTAL) {
-        AddEntitiesVisibleFromPoint(playerEnt->s.origin2, frame, eNums, true);
-    }
+    numEntities = 0;
 
     for(e = 0; e < sv.num_entities; e++) {
         ent = serverGameSystem->GentityNum(e);
@@ -446,46 +588,11 @@ void idServerSnapshotSystemLocal::AddEntitiesVisibleFromPoint(
             continue;
         }
 
-        if(ent->s.number != e) {
-            if(developer->integer) {
-                common->Printf("FIXING ENT->S.NUMBER!!!\n");
-            }
-
-            ent->s.number = e;
-        }
-
         // entities can be flagged to explicitly not be sent to the client
         if(ent->r.svFlags & SVF_NOCLIENT) {
             continue;
         }
 
-        // entities can be flagged to be sent to only one client
-        if(ent->r.svFlags & SVF_SINGLECLIENT) {
-            if(ent->r.singleClient != frame->ps.clientNum) {
-                continue;
-            }
-        }
-
-        // entities can be flagged to be sent to everyone but one client
-        if(ent->r.svFlags & SVF_NOTSINGLECLIENT) {
-            if(ent->r.singleClient == frame->ps.clientNum) {
-                continue;
-            }
-        }
-
-        // entities can be flagged to be sent to only a given mask of clients
-        if(ent->r.svFlags & SVF_CLIENTMASK) {
-            if(frame->ps.clientNum >= MAX_CLIENTS) {
-                if(~ent->r.hiMask & (1 << (frame->ps.clientNum - MAX_CLIENTS))) {
-                    continue;
-                }
-            } else {
-                if(~ent->r.loMask & (1 << frame->ps.clientNum)) {
-                    continue;
-                }
-            }
-        }
-
 #if defined (DEDICATED)
 
         if(ent->s.eType >= ET_EVENTS) {
@@ -500,26 +607,19 @@ void idServerSnapshotSystemLocal::AddEntitiesVisibleFromPoint(
 
 #endif
 
-        svEnt = serverGameSystem->SvEntityForGentity(ent);
-
-        // don't double add an entity through portals
-        if(svEnt->snapshotCounter == sv.snapshotCounter) {
-            continue;
-        }
-
         // broadcast entities are always sent
-        if(ent->r.svFlags & SVF_BROADCAST || (e == frame->ps.clientNum)) {
-            AddEntToSnapshot(playerEnt, svEnt, ent, eNums);
+        if(ent->r.svFlags & SVF_BROADCAST) {
+            list[numEntities++] = e;
             continue;
         }
 
-        bitvector = clientpvs;
+        svEnt = serverGameSystem->SvEntityForGentity(ent);
 
         // Gordon: just check origin for being in pvs, ignore bmodel extents
         if(ent->r.svFlags & SVF_IGNOREBMODELEXTENTS) {
             if(bitvector[svEnt->originCluster >> 3] & (1 << (svEnt->originCluster &
                     7))) {
-                AddEntToSnapshot(playerEnt, svEnt, ent, eNums);
+                list[numEntities++] = e;
             }
 
             continue;
@@ -527,10 +627,10 @@ void idServerSnapshotSystemLocal::AddEntitiesVisibleFromPoint(
 
         // ignore if not touching a PV leaf
         // check area
-        if(!collisionModelManager->AreasConnected(clientarea, svEnt->areanum)) {
+        if(!collisionModelManager->AreasConnected(area, svEnt->areanum)) {
             // doors can legally straddle two areas, so
             // we may need to check another one
-            if(!collisionModelManager->AreasConnected(clientarea, svEnt->areanum2)) {
+            if(!collisionModelManager->AreasConnected(area, svEnt->areanum2)) {
                 continue;
             }
         }
@@ -568,151 +668,335 @@ void idServerSnapshotSystemLocal::AddEntitiesVisibleFromPoint(
             }
         }
 
-        //----(SA) added "visibility dummies"
-        if(ent->r.svFlags & SVF_VISDUMMY) {
-            sharedEntity_t *ment = 0;
-
-            //find master;
-            ment = serverGameSystem->GentityNum(ent->s.otherEntityNum);
+        list[numEntities++] = e;
+    }
 
-            if(ment) {
-                svEntity_t *master = 0;
+    return numEntities;
+}
 
-                master = serverGameSystem->SvEntityForGentity(ment);
+/*
+===============
+idServerSnapshotSystemLocal::FixEntityNumbers
 
-                if(master->snapshotCounter == sv.snapshotCounter || !ment->r.linked) {
-                    continue;
-                }
+The culling only reads the game entities, so a linked entity with the
+wrong number is put right on the main thread before it starts
+===============
+*/
+void idServerSnapshotSystemLocal::FixEntityNumbers(void) {
+    sint e;
+    sharedEntity_t *ent;
 
-                AddEntToSnapshot(playerEnt, master, ment, eNums);
-            }
+    for(e = 0; e < sv.num_entities; e++) {
+        ent = serverGameSystem->GentityNum(e);
 
-            // master needs to be added, but not this dummy ent
+        if(!ent->r.linked || ent->s.number == e) {
             continue;
-        } else if(ent->r.svFlags & SVF_VISDUMMY_MULTIPLE) {
-            sint h;
-            sharedEntity_t *ment = 0;
-            svEntity_t *master = 0;
-
-            for(h = 0; h < sv.num_entities; h++) {
-                ment = serverGameSystem->GentityNum(h);
-
-                if(ment == ent) {
-                    continue;
-                }
+        }
 
-                if(ment) {
-                    master = serverGameSystem->SvEntityForGentity(ment);
-                } else {
-                    continue;
-                }
+        if(developer->integer) {
+            common->Printf("FIXING ENT->S.NUMBER!!!\n");
+        }
 
-                if(!(ment->r.linked)) {
-                    continue;
-                }
+        ent->s.number = e;
+    }
+}
 
-                if(ment->s.number != h) {
-                    if(developer->integer) {
-                        common->Printf("FIXING vis dummy multiple ment->S.NUMBER!!!\n");
-                    }
+/*
+===============
+idServerSnapshotSystemLocal::BeginVisibilityCache
 
-                    ment->s.number = h;
-                }
+Clients standing in the same cluster and area see the same set of
+entities, so during SendClientMessages that set is only worked out once
+===============
+*/
+void idServerSnapshotSystemLocal::BeginVisibilityCache(void) {
+    FixEntityNumbers();
 
-                if(ment->r.svFlags & SVF_NOCLIENT) {
-                    continue;
-                }
+    numVisCacheEntries = 0;
+    visCacheActive = true;
+}
 
-                if(master->snapshotCounter == sv.snapshotCounter) {
-                    continue;
-                }
+/*
+===============
+idServerSnapshotSystemLocal::EndVisibilityCache
+===============
+*/
+void idServerSnapshotSystemLocal::EndVisibilityCache(void) {
+    visCacheActive = false;
+}
 
-                if(ment->s.otherEntityNum == ent->s.number) {
-                    AddEntToSnapshot(playerEnt, master, ment, eNums);
-                }
-            }
+/*
+===============
+idServerSnapshotSystemLocal::FindVisibleEntities
 
-            continue;
-        }
+Returns the cached entity list for the cluster and area, building it if
+needed. buffer is only used when the cache is inactive or full.
+===============
+*/
+const uchar16 *idServerSnapshotSystemLocal::FindVisibleEntities(
+    sint cluster, sint area, uchar16 *buffer, sint *numEntities) {
+    sint i;
+    visCacheEntry_t *entry;
 
-        sharedEntity_t *client;
+    if(visCacheActive) {
+        std::lock_guard<std::mutex> lock(visCacheMutex);
 
-        if(e < sv_maxclients->integer) {    // client
-            if(e == frame->ps.clientNum) {
-                continue;
+        for(i = 0, entry = visCache; i < numVisCacheEntries; i++, entry++) {
+            if(entry->cluster == cluster && entry->area == area) {
+                *numEntities = entry->numEntities;
+                return entry->entities;
             }
+        }
+    }
 
-            client = serverGameSystem->GentityNum(frame->ps.clientNum);
+    *numEntities = CollectVisibleEntities(cluster, area, buffer);
 
-#if !defined (UPDATE_SERVER)
+    if(!visCacheActive) {
+        return buffer;
+    }
 
-            if(sv_wh_active->integer && !portal &&
-                    !(client->r.svFlags &
-                      SVF_BOT)) {   // playerEnt->r.svFlags & SVF_SELF_PORTAL
-                if(!idServerWallhackSystemLocal::CanSee(frame->ps.clientNum, e)) {
-                    idServerWallhackSystemLocal::RandomizePos(frame->ps.clientNum, e);
-                    AddEntToSnapshot(client, svEnt, ent, eNums);
-                    continue;
-                }
-            }
+    std::lock_guard<std::mutex> lock(visCacheMutex);
 
-#endif
+    // another snapshot job may have built it meanwhile
+    for(i = 0, entry = visCache; i < numVisCacheEntries; i++, entry++) {
+        if(entry->cluster == cluster && entry->area == area) {
+            return entry->entities;
         }
+    }
 
-        // add it
-        AddEntToSnapshot(playerEnt, svEnt, ent, eNums);
-
-        // if its a portal entity, add everything visible from its camera position
-        if(ent->r.svFlags & SVF_PORTAL) {
-            if(ent->s.generic1) {
-                vec3_t dir;
-
-                VectorSubtract(ent->s.origin, origin, dir);
+    if(numVisCacheEntries == MAX_VIS_CACHE_ENTRIES) {
+        return buffer;
+    }
 
-                if(VectorLengthSquared(dir) > static_cast<float32>(ent->s.generic1) *
-                        ent->s.generic1) {
-                    continue;
-                }
-            }
+    entry->cluster = cluster;
+    entry->area = area;
+    entry->numEntities = *numEntities;
+    ::memcpy(entry->entities, buffer, *numEntities * sizeof(buffer[0]));
 
-            AddEntitiesVisibleFromPoint(ent->s.origin2, frame, eNums, true);
-        }
+    numVisCacheEntries++;
 
-        continue;
-    }
+    return entry->entities;
 }
 
 /*
-=============
-idServerSnapshotSystemLocalBuildClientSnapshot
+===============
+idServerSnapshotSystemLocal::AddEntitiesVisibleFromPoint
+===============
+*/
+void idServerSnapshotSystemLocal::AddEntitiesVisibleFromPoint(
+    vec3_t origin, clientSnapshot_t *frame, snapshotEntityNumbers_t *eNums,
+    bool portal) {
+    sint e, i, clientarea, clientcluster, leafnum, numVisible;
+    uchar16 visibleBuffer[MAX_GENTITIES];
+    const uchar16 *visible;
+    sharedEntity_t *ent, *playerEnt;
+    svEntity_t *svEnt;
 
-Decides which entities are going to be visible to the client, and
-copies off the playerstate and areabits.
+    // during an error shutdown message we may need to transmit
+    // the shutdown message after the server has shutdown, so
+    // specfically check for it
+    if(!sv.state) {
+        return;
+    }
 
-This properly handles multiple recursive portals, but the render
-currently doesn't.
+    leafnum = collisionModelManager->PointLeafnum(origin);
+    clientarea = collisionModelManager->LeafArea(leafnum);
+    clientcluster = collisionModelManager->LeafCluster(leafnum);
 
-For viewing through other player's eyes, clent can be something other than client->gentity
+    // calculate the visible areas
+    frame->areabytes = collisionModelManager->WriteAreaBits(frame->areabits,
+                       clientarea);
+
+    playerEnt = serverGameSystem->GentityNum(frame->ps.clientNum);
+
+    if(playerEnt->r.svFlags & SVF_SELF_PORTAL) {
+        AddEntitiesVisibleFromPoint(playerEnt->s.origin2, frame, eNums, true);
+    }
+
+    // everything that passed the pvs and area checks
+    visible = FindVisibleEntities(clientcluster, clientarea, visibleBuffer,
+                                  &numVisible);
+
+    for(i = 0; i < numVisible; i++) {
+        e = visible[i];
+        ent = serverGameSystem->GentityNum(e);
+
+        // entities can be flagged to be sent to only one client
+        if(ent->r.svFlags & SVF_SINGLECLIENT) {
+            if(ent->r.singleClient != frame->ps.clientNum) {
+                continue;
+            }
+        }
+
+        // entities can be flagged to be sent to everyone but one client
+        if(ent->r.svFlags & SVF_NOTSINGLECLIENT) {
+            if(ent->r.singleClient == frame->ps.clientNum) {
+                continue;
+            }
+        }
+
+        // entities can be flagged to be sent to only a given mask of clients
+        if(ent->r.svFlags & SVF_CLIENTMASK) {
+            if(frame->ps.clientNum >= MAX_CLIENTS) {
+                if(~ent->r.hiMask & (1 << (frame->ps.clientNum - MAX_CLIENTS))) {
+                    continue;
+                }
+            } else {
+                if(~ent->r.loMask & (1 << frame->ps.clientNum)) {
+                    continue;
+                }
+            }
+        }
+
+        svEnt = serverGameSystem->SvEntityForGentity(ent);
+
+        // don't double add an entity through portals
+        if(eNums->added[e >> 3] & (1 << (e & 7))) {
+            continue;
+        }
+
+        // broadcast entities are always sent, the others went through the
+        // pvs check already
+        if(ent->r.svFlags & (SVF_BROADCAST | SVF_IGNOREBMODELEXTENTS) ||
+                (e == frame->ps.clientNum)) {
+            AddEntToSnapshot(svEnt, ent, eNums);
+            continue;
+        }
+
+        //----(SA) added "visibility dummies"
+        if(ent->r.svFlags & SVF_VISDUMMY) {
+            sint h;
+            sharedEntity_t *ment = 0;
+
+            //find master;
+            ment = serverGameSystem->GentityNum(ent->s.otherEntityNum);
+
+            if(ment) {
+                svEntity_t *master = 0;
+
+                master = serverGameSystem->SvEntityForGentity(ment);
+                h = ARRAY_INDEX(sv.svEntities, master);
+
+                if((eNums->added[h >> 3] & (1 << (h & 7))) || !ment->r.linked) {
+                    continue;
+                }
+
+                AddEntToSnapshot(master, ment, eNums);
+            }
+
+            // master needs to be added, but not this dummy ent
+            continue;
+        } else if(ent->r.svFlags & SVF_VISDUMMY_MULTIPLE) {
+            sint h, m;
+            sharedEntity_t *ment = 0;
+            svEntity_t *master = 0;
+
+            for(h = 0; h < sv.num_entities; h++) {
+                ment = serverGameSystem->GentityNum(h);
+
+                if(ment == ent) {
+                    continue;
+                }
+
+                if(ment) {
+                    master = serverGameSystem->SvEntityForGentity(ment);
+                } else {
+                    continue;
+                }
+
+                if(!(ment->r.linked)) {
+                    continue;
+                }
+
+                if(ment->r.svFlags & SVF_NOCLIENT) {
+                    continue;
+                }
+
+                m = ARRAY_INDEX(sv.svEntities, master);
+
+                if(eNums->added[m >> 3] & (1 << (m & 7))) {
+                    continue;
+                }
+
+                if(ment->s.otherEntityNum == ent->s.number) {
+                    AddEntToSnapshot(master, ment, eNums);
+                }
+            }
+
+            continue;
+        }
+
+        sharedEntity_t *client;
+
+        if(e < sv_maxclients->integer) {    // client
+            if(e == frame->ps.clientNum) {
+                continue;
+            }
+
+            client = serverGameSystem->GentityNum(frame->ps.clientNum);
+
+#if !defined (UPDATE_SERVER)
+
+            if(sv_wh_active->integer && !portal &&
+                    !(client->r.svFlags &
+                      SVF_BOT)) {   // playerEnt->r.svFlags & SVF_SELF_PORTAL
+                if(!idServerWallhackSystemLocal::CanSee(frame->ps.clientNum, e)) {
+                    idServerWallhackSystemLocal::RandomizePos(frame->ps.clientNum, e);
+                    AddEntToSnapshot(svEnt, ent, eNums);
+                    continue;
+                }
+            }
+
+#endif
+        }
+
+        // add it
+        AddEntToSnapshot(svEnt, ent, eNums);
+
+        // if its a portal entity, add everything visible from its camera position
+        if(ent->r.svFlags & SVF_PORTAL) {
+            if(ent->s.generic1) {
+                vec3_t dir;
+
+                VectorSubtract(ent->s.origin, origin, dir);
+
+                if(VectorLengthSquared(dir) > static_cast<float32>(ent->s.generic1) *
+                        ent->s.generic1) {
+                    continue;
+                }
+            }
+
+            AddEntitiesVisibleFromPoint(ent->s.origin2, frame, eNums, true);
+        }
+
+        continue;
+    }
+}
+
+/*
+=============
+idServerSnapshotSystemLocal::BeginClientSnapshot
+
+Clears the frame we are about to build and grabs the current playerstate.
+Returns false if there is nothing to add to it.
 =============
 */
-void idServerSnapshotSystemLocal::BuildClientSnapshot(client_t *client) {
-    sint i, clientNum;
-    vec3_t org;
+bool idServerSnapshotSystemLocal::BeginClientSnapshot(client_t *client,
+        snapshotEntityNumbers_t *eNums) {
+    sint clientNum;
     clientSnapshot_t *frame;
-    snapshotEntityNumbers_t entityNumbers;
-    sharedEntity_t *ent, *clent;
-    entityState_t *state;
-    svEntity_t *svEnt;
+    sharedEntity_t *clent;
     playerState_t *ps;
 
-    // bump the counter used to prevent double adding
-    sv.snapshotCounter++;
-
     // this is the frame we are creating
     frame = &client->frames[client->netchan.outgoingSequence & PACKET_MASK];
 
     // clear everything in this snapshot
-    entityNumbers.numSnapshotEntities = 0;
+    eNums->numSnapshotEntities = 0;
+    eNums->needsCallback = false;
+    eNums->runCallbacks = false;
+    eNums->overflowed = false;
+    ::memset(eNums->added, 0, sizeof(eNums->added));
     ::memset(frame->areabits, 0, sizeof(frame->areabits));
 
     // show_bug.cgi?id=62
@@ -721,7 +1005,7 @@ void idServerSnapshotSystemLocal::BuildClientSnapshot(client_t *client) {
     clent = client->gentity;
 
     if(!clent || client->state == CS_ZOMBIE) {
-        return;
+        return false;
     }
 
     // grab the current playerState_t
@@ -736,18 +1020,38 @@ void idServerSnapshotSystemLocal::BuildClientSnapshot(client_t *client) {
         common->Error(ERR_DROP, "SV_SvEntityForGentity: bad gEnt");
     }
 
-    svEnt = &sv.svEntities[clientNum];
+    eNums->clientNum = clientNum;
+    eNums->added[clientNum >> 3] |= (1 << (clientNum & 7));
 
-    svEnt->snapshotCounter = sv.snapshotCounter;
+    return true;
+}
+
+/*
+=============
+idServerSnapshotSystemLocal::AddClientSnapshotEntities
+
+Culls the entities visible to the client into eNums. Only touches the
+client's own frame and eNums, so several clients can be culled at once.
+=============
+*/
+void idServerSnapshotSystemLocal::AddClientSnapshotEntities(
+    client_t *client, snapshotEntityNumbers_t *eNums) {
+    sint i;
+    vec3_t org;
+    clientSnapshot_t *frame;
+    sharedEntity_t *clent;
+
+    frame = &client->frames[client->netchan.outgoingSequence & PACKET_MASK];
+    clent = client->gentity;
 
     if(clent->r.svFlags & SVF_SELF_PORTAL_EXCLUSIVE) {
         // find the client's viewpoint
         VectorCopy(clent->s.origin2, org);
     } else {
-        VectorCopy(ps->origin, org);
+        VectorCopy(frame->ps.origin, org);
     }
 
-    org[2] += ps->viewheight;
+    org[2] += frame->ps.viewheight;
 
     //----(SA)  added for 'lean'
     // need to account for lean, so areaportal doors draw properly
@@ -756,7 +1060,7 @@ void idServerSnapshotSystemLocal::BuildClientSnapshot(client_t *client) {
     if(frame->ps.leanf != 0) {
         vec3_t right, v3ViewAngles;
 
-        VectorCopy(ps->viewangles, v3ViewAngles);
+        VectorCopy(frame->ps.viewangles, v3ViewAngles);
         v3ViewAngles[2] += frame->ps.leanf / 2.0f;
         AngleVectors(v3ViewAngles, nullptr, right, nullptr);
         VectorMA(org, frame->ps.leanf, right, org);
@@ -768,28 +1072,70 @@ void idServerSnapshotSystemLocal::BuildClientSnapshot(client_t *client) {
     // add all the entities directly visible to the eye, which
     // may include portal entities that merge other viewpoints
     AddEntitiesVisibleFromPoint(org, frame,
-                                &entityNumbers /*, false, client->netchan.remoteAddress.type == NA_LOOPBACK */,
+                                eNums /*, false, client->netchan.remoteAddress.type == NA_LOOPBACK */,
                                 false);
 
-    // if there were portals visible, there may be out of order entities
-    // in the list which will need to be resorted for the delta compression
-    // to work correctly.  This also catches the error condition
-    // of an entity being included twice.
-    qsort(entityNumbers.snapshotEntities, entityNumbers.numSnapshotEntities,
-          sizeof(entityNumbers.snapshotEntities[0]), QsortEntityNumbers);
-
     // now that all viewpoint's areabits have been OR'd together, invert
     // all of them to make it a mask vector, which is what the renderer wants
     for(i = 0; i < MAX_MAP_AREA_BYTES / 4; i++) {
         frame->areabits[i] = frame->areabits[i] ^ -1;
     }
+}
+
+/*
+=============
+idServerSnapshotSystemLocal::FinishClientSnapshot
+
+Runs the deferred game snapshot callbacks and copies the entity states
+out into svs.snapshotEntities. Must be called on the main thread.
+=============
+*/
+void idServerSnapshotSystemLocal::FinishClientSnapshot(client_t *client,
+        snapshotEntityNumbers_t *eNums) {
+    sint i, j;
+    clientSnapshot_t *frame;
+    sharedEntity_t *ent;
+    entityState_t *state;
+
+    frame = &client->frames[client->netchan.outgoingSequence & PACKET_MASK];
+
+    // let the game veto the entities that asked for it
+    if(eNums->needsCallback) {
+        for(i = 0, j = 0; i < eNums->numSnapshotEntities; i++) {
+            ent = serverGameSystem->GentityNum(eNums->snapshotEntities[i]);
+
+            if(ent->r.snapshotCallback &&
+                    !sgame->SnapshotCallback(ent->s.number, eNums->clientNum)) {
+                continue;
+            }
+
+            eNums->snapshotEntities[j++] = eNums->snapshotEntities[i];
+        }
+
+        // vetoed entities took the room of ones that were discarded, cull
+        // again here with the veto run while adding, like the serial path
+        if(j < eNums->numSnapshotEntities && eNums->overflowed) {
+            BeginClientSnapshot(client, eNums);
+            eNums->runCallbacks = true;
+            AddClientSnapshotEntities(client, eNums);
+        } else {
+            eNums->numSnapshotEntities = j;
+        }
+    }
+
+    // if there were portals visible, there may be out of order entities
+    // in the list which will need to be resorted for the delta compression
+    // to work correctly.  This also catches the error condition
+    // of an entity being included twice.
+    qsort(eNums->snapshotEntities, eNums->numSnapshotEntities,
+          sizeof(eNums->snapshotEntities[0]), QsortEntityNumbers);
 
     // copy the entity states out
     frame->num_entities = 0;
     frame->first_entity = svs.nextSnapshotEntities;
 
-    for(i = 0; i < entityNumbers.numSnapshotEntities; i++) {
-        ent = serverGameSystem->GentityNum(entityNumbers.snapshotEntities[i]);
+    for(i = 0; i < eNums->numSnapshotEntities; i++) {
+        ent = serverGameSystem->GentityNum(eNums->snapshotEntities[i]);
         state = &svs.snapshotEntities[svs.nextSnapshotEntities %
                                                                svs.numSnapshotEntities];
         *state = ent->s;
@@ -797,10 +1143,10 @@ void idServerSnapshotSystemLocal::BuildClientSnapshot(client_t *client) {
 #if !defined (UPDATE_SERVER)
 
         if(sv_wh_active->integer &&
-                entityNumbers.snapshotEntities[i] < sv_maxclients->integer) {
+                eNums->snapshotEntities[i] < sv_maxclients->integer) {
             if(idServerWallhackSystemLocal::PositionChanged(
-                        entityNumbers.snapshotEntities[i])) {
-                idServerWallhackSystemLocal::RestorePos(entityNumbers.snapshotEntities[i]);
+                        eNums->snapshotEntities[i])) {
+                idServerWallhackSystemLocal::RestorePos(eNums->snapshotEntities[i]);
             }
         }
 
@@ -818,6 +1164,39 @@ void idServerSnapshotSystemLocal::BuildClientSnapshot(client_t *client) {
     }
 }
 
+/*
+=============
+idServerSnapshotSystemLocal::BuildClientSnapshot
+
+Decides which entities are going to be visible to the client, and
+copies off the playerstate and areabits.
+
+This properly handles multiple recursive portals, but the render
+currently doesn't.
+
+For viewing through other player's eyes, clent can be something other than client->gentity
+=============
+*/
+void idServerSnapshotSystemLocal::BuildClientSnapshot(client_t *client) {
+    snapshotEntityNumbers_t entityNumbers;
+    idProfileScope profile("SV_BuildClientSnapshot");
+
+    if(!BeginClientSnapshot(client, &entityNumbers)) {
+        return;
+    }
+
+    // SendClientMessages did it already
+    if(!visCacheActive) {
+        FixEntityNumbers();
+    }
+
+    // already on the main thread, the veto runs while adding
+    entityNumbers.runCallbacks = true;
+
+    AddClientSnapshotEntities(client, &entityNumbers);
+    FinishClientSnapshot(client, &entityNumbers);
+}
+
 /*
 ====================
 idServerSnapshotSystemLocal::RateMsec
@@ -873,6 +1252,8 @@ void idServerSnapshotSystemLocal::SendMessageToClient(msg_t *msg,
         client_t *client) {
     sint rateMsec;
 
+    svs.clientCosts[client - svs.clients].bytes += msg->cursize;
+
     while(client->state && client->netchan.unsentFragments) {
         common->Printf("idServerSnapshotSystemLocal::SendMessageToClient [1] for %s, writing out old fragments\n",
                        client->name);
@@ -1001,6 +1382,116 @@ void idServerSnapshotSystemLocal::SendClientIdle(client_t *client) {
     sv.ubpsTotalBytes += msg.uncompsize / 8;    // NERVE - SMF - net debugging
 }
 
+/*
+=======================
+idServerSnapshotSystemLocal::WriteClientMessage
+
+Writes the reliable commands and the snapshot into msg. Returns false if
+the reliable commands alone filled it up, in which case msg holds only those.
+=======================
+*/
+bool idServerSnapshotSystemLocal::WriteClientMessage(client_t *client,
+        msg_t *msg, msg_t *msgBackup, uchar8 *msgBuffer, sint msgBufferSize,
+        pointer *deltaWarning) {
+    *deltaWarning = nullptr;
+
+    msgToFuncSystem->Init(msg, msgBuffer, msgBufferSize);
+    msg->allowoverflow = true;
+
+    // NOTE, MRE: all server->client messages now acknowledge
+    // let the client know which reliable clientCommands we have received
+    msgToFuncSystem->WriteLong(msg, client->lastClientCommand);
+
+    // (re)send any reliable server commands
+    if(!UpdateServerCommandsToClients(client, msg, true)) {
+        return false;
+    }
+
+    // Backup the msg state in case the snapshot would overflow it
+    ::memcpy(msgBackup, msg, sizeof(*msgBackup));
+
+    // send over all the relevant entityState_t
+    // and the playerState_t
+    WriteSnapshotToClient(client, msg, deltaWarning);
+
+    return true;
+}
+
+/*
+=======================
+idServerSnapshotSystemLocal::TransmitClientMessage
+
+Appends any download data to a message built by WriteClientMessage and sends it
+=======================
+*/
+void idServerSnapshotSystemLocal::TransmitClientMessage(client_t *client,
+        msg_t *msg, msg_t *msgBackup, bool commandsFit, pointer deltaWarning) {
+    if(deltaWarning && developer->integer) {
+        common->Printf("%s: %s\n", client->name, deltaWarning);
+    }
+
+    if(!commandsFit) {
+        // If we can't fit all commands in a single message send what we got and
+        // don't even try to send entities
+        SendMessageToClient(msg, client);
+        return;
+    }
+
+    if(msg->overflowed && !msgBackup->overflowed) {
+        // The entity states were too much and the message overflowed. So send
+        // the old state of the message from before we tried to append the
+        // entity states. As the net code doesn't send the msg_buf content after
+        // the current size of the message we don't have to clear anything and
+        // we can just use the old msg values (which point to the updated buffer).
+        SendMessageToClient(msgBackup, client);
+        return;
+    }
+
+    // Backup the msg state in case the download would overflow it
+    ::memcpy(msgBackup, msg, sizeof(*msgBackup));
+
+    // Add any download data if the client is downloading
+    serverClientSystem->WriteDownloadToClient(client, msg);
+
+    if(msg->overflowed && !msgBackup->overflowed) {
+        // Downloads usually don't happen in situations that are likely to have
+        // message overflows, but let's make sure and apply the same logic we
+        // used for the entity states.
+        SendMessageToClient(msgBackup, client);
+        return;
+    }
+
+    // check for overflow
+    if(msg->overflowed) {
+        common->Printf("idServerSnapshotSystemLocal::SendClientSnapshot : WARNING: msg overflowed for %s\n",
+                       client->name);
+        msgToFuncSystem->Clear(msg);
+
+        serverClientSystem->DropClient(client,
+                                       "idServerSnapshotSystemLocal::SendClientSnapshot : Msg overflowed");
+        return;
+    }
+
+    SendMessageToClient(msg, client);
+
+    sv.bpsTotalBytes += msg->cursize;            // NERVE - SMF - net debugging
+    sv.ubpsTotalBytes += msg->uncompsize / 8;    // NERVE - SMF - net debugging
+}
+
+/*
+=======================
+idServerSnapshotSystemLocal::CheckAutoRecordDemo
+=======================
+*/
+void idServerSnapshotSystemLocal::CheckAutoRecordDemo(client_t *client) {
+    if(sv_autoRecDemo->integer && !client->demo.demorecording) {
+        if(client->netchan.remoteAddress.type != NA_BOT ||
+                sv_autoRecDemoBots->integer) {
+            idServerCcmdsSystemLocal::BeginAutoRecordDemos();
+        }
+    }
+}
+
 /*
 =======================
 idServerSnapshotSystemLocal::SendClientSnapshot
@@ -1011,6 +1502,9 @@ Also called by idServerInitSystemLocal::FinalCommand
 void idServerSnapshotSystemLocal::SendClientSnapshot(client_t *client) {
     uchar8 msg_buf[MAX_MSGLEN];
     msg_t msg, msgBackup;
+    bool commandsFit;
+    pointer deltaWarning;
+    idClientCostScope cost(client, CLIENTCOST_SNAPSHOT);
 
     //bots dont need snapshots
     if(client->gentity && client->gentity->r.svFlags & SVF_BOT) {
@@ -1030,12 +1524,7 @@ void idServerSnapshotSystemLocal::SendClientSnapshot(client_t *client) {
     // build the snapshot
     BuildClientSnapshot(client);
 
-    if(sv_autoRecDemo->integer && !client->demo.demorecording) {
-        if(client->netchan.remoteAddress.type != NA_BOT ||
-                sv_autoRecDemoBots->integer) {
-            idServerCcmdsSystemLocal::BeginAutoRecordDemos();
-        }
-    }
+    CheckAutoRecordDemo(client);
 
     // bots need to have their snapshots built, but
     // they query them directly without needing to be sent
@@ -1045,67 +1534,109 @@ void idServerSnapshotSystemLocal::SendClientSnapshot(client_t *client) {
         return;
     }
 
-    msgToFuncSystem->Init(&msg, msg_buf, sizeof(msg_buf));
-    msg.allowoverflow = true;
+    commandsFit = WriteClientMessage(client, &msg, &msgBackup, msg_buf,
+                                     sizeof(msg_buf), &deltaWarning);
 
-    // NOTE, MRE: all server->client messages now acknowledge
-    // let the client know which reliable clientCommands we have received
-    msgToFuncSystem->WriteLong(&msg, client->lastClientCommand);
+    TransmitClientMessage(client, &msg, &msgBackup, commandsFit, deltaWarning);
+}
 
-    // (re)send any reliable server commands
-    if(!UpdateServerCommandsToClients(client, &msg, true)) {
-        // If we can't fit all commands in a single message send what we got and
-        // don't even try to send entities
-        SendMessageToClient(&msg, client);
-        return;
+/*
+=======================
+idServerSnapshotSystemLocal::CullSnapshotJob
+=======================
+*/
+void idServerSnapshotSystemLocal::CullSnapshotJob(void *data, sint jobNum) {
+    snapshotJob_t *job = &reinterpret_cast<snapshotJob_t *>(data)[jobNum];
+    idClientCostScope cost(job->client, CLIENTCOST_SNAPSHOT);
+
+    if(job->built) {
+        AddClientSnapshotEntities(job->client, &job->entityNumbers);
     }
+}
 
-    // Backup the msg state in case the snapshot would overflow it
-    ::memcpy(&msgBackup, &msg, sizeof(msgBackup));
+/*
+=======================
+idServerSnapshotSystemLocal::WriteSnapshotJob
+=======================
+*/
+void idServerSnapshotSystemLocal::WriteSnapshotJob(void *data, sint jobNum) {
+    snapshotJob_t *job = &reinterpret_cast<snapshotJob_t *>(data)[jobNum];
+    idClientCostScope cost(job->client, CLIENTCOST_SNAPSHOT);
 
-    // send over all the relevant entityState_t
-    // and the playerState_t
-    WriteSnapshotToClient(client, &msg);
+    job->commandsFit = WriteClientMessage(job->client, &job->msg,
+                                          &job->msgBackup, job->msgBuffer, sizeof(job->msgBuffer),
+                                          &job->deltaWarning);
+}
 
-    if(msg.overflowed && !msgBackup.overflowed) {
-        // The entity states were too much and the message overflowed. So send
-        // the old state of the message from before we tried to append the
-        // entity states. As the net code doesn't send the msg_buf content after
-        // the current size of the message we don't have to clear anything and
-        // we can just use the old msg values (which point to the updated buffer).
-        SendMessageToClient(&msgBackup, client);
-        return;
+/*
+=======================
+idServerSnapshotSystemLocal::SendClientSnapshotsParallel
+
+Same as calling SendClientSnapshot on every client in the list, but the
+entity culling and the delta encoding run on the job pool. Everything that
+touches shared server or game state stays on the main thread, in order.
+=======================
+*/
+void idServerSnapshotSystemLocal::SendClientSnapshotsParallel(
+    client_t **clients, sint numClients, sint numThreads) {
+    sint i;
+    snapshotJob_t *job;
+
+    if(numSnapshotJobs < sv_maxclients->integer) {
+        if(snapshotJobs) {
+            ::free(snapshotJobs);
+        }
+
+        numSnapshotJobs = sv_maxclients->integer;
+        snapshotJobs = static_cast<snapshotJob_t *>(::calloc(numSnapshotJobs,
+                       sizeof(snapshotJob_t)));
+
+        if(!snapshotJobs) {
+            common->Error(ERR_FATAL,
+                          "idServerSnapshotSystemLocal::SendClientSnapshotsParallel: can't allocate snapshot jobs");
+        }
     }
 
-    // Backup the msg state in case the download would overflow it
-    ::memcpy(&msgBackup, &msg, sizeof(msgBackup));
+    {
+        // the zone BuildClientSnapshot times on the serial path, for all
+        // the clients at once with the cull jobs and their join
+        idProfileScope profile("SV_BuildClientSnapshot");
 
-    // Add any download data if the client is downloading
-    serverClientSystem->WriteDownloadToClient(client, &msg);
+        for(i = 0, job = snapshotJobs; i < numClients; i++, job++) {
+            idClientCostScope cost(clients[i], CLIENTCOST_SNAPSHOT);
 
-    if(msg.overflowed && !msgBackup.overflowed) {
-        // Downloads usually don't happen in situations that are likely to have
-        // message overflows, but let's make sure and apply the same logic we
-        // used for the entity states.
-        SendMessageToClient(&msgBackup, client);
-        return;
+            job->client = clients[i];
+            job->built = BeginClientSnapshot(job->client, &job->entityNumbers);
+        }
+
+        parallelJobSystem->Run(CullSnapshotJob, snapshotJobs, numClients,
+                               numThreads);
+
+        // svs.snapshotEntities is a shared ring, fill it in client order
+        for(i = 0, job = snapshotJobs; i < numClients; i++, job++) {
+            idClientCostScope cost(job->client, CLIENTCOST_SNAPSHOT);
+
+            if(job->built) {
+                FinishClientSnapshot(job->client, &job->entityNumbers);
+            }
+
+            CheckAutoRecordDemo(job->client);
+        }
     }
 
-    // check for overflow
-    if(msg.overflowed) {
-        common->Printf("idServerSnapshotSystemLocal::SendClientSnapshot : WARNING: msg overflowed for %s\n",
-                       client->name);
-        msgToFuncSystem->Clear(&msg);
+    {
+        idProfileScope profile("SV_WriteClientSnapshots");
 
-        serverClientSystem->DropClient(client,
-                                       "idServerSnapshotSystemLocal::SendClientSnapshot : Msg overflowed");
-        return;
+        parallelJobSystem->Run(WriteSnapshotJob, snapshotJobs, numClients,
+                               numThreads);
     }
 
-    SendMessageToClient(&msg, client);
+    for(i = 0, job = snapshotJobs; i < numClients; i++, job++) {
+        idClientCostScope cost(job->client, CLIENTCOST_SNAPSHOT);
 
-    sv.bpsTotalBytes += msg.cursize;            // NERVE - SMF - net debugging
-    sv.ubpsTotalBytes += msg.uncompsize / 8;    // NERVE - SMF - net debugging
+        TransmitClientMessage(job->client, &job->msg, &job->msgBackup,
+                              job->commandsFit, job->deltaWarning);
+    }
 }
 
 /*
@@ -1115,7 +1646,9 @@ idServerSnapshotSystemLocal::SendClientMessages
 */
 void idServerSnapshotSystemLocal::SendClientMessages(void) {
     sint i, numclients = 0; // NERVE - SMF - net debugging
-    client_t *c;
+    sint numThreads, numSnapshotClients = 0;
+    client_t *c, *snapshotClients[MAX_CLIENTS];
+    idProfileScope profile("SV_SendClientMessages");
 
     sv.bpsTotalBytes = 0; // NERVE - SMF - net debugging
     sv.ubpsTotalBytes = 0; // NERVE - SMF - net debugging
@@ -1123,6 +1656,25 @@ void idServerSnapshotSystemLocal::SendClientMessages(void) {
     // Gordon: update any changed configstrings from this frame
     serverInitSystem->UpdateConfigStrings();
 
+    // the wallhack protection moves entities around while culling and
+    // developer prints aren't thread safe, build those snapshots serially
+    numThreads = sv_snapshotThreads->integer;
+
+#if !defined (UPDATE_SERVER)
+
+    if(sv_wh_active->integer) {
+        numThreads = 0;
+    }
+
+#endif
+
+    if(developer->integer) {
+        numThreads = 0;
+    }
+
+    BeginVisibilityCache();
+    BeginDeltaCache();
+
     // send a message to each connected client
     for(i = 0; i < sv_maxclients->integer; i++) {
         c = &svs.clients[i];
@@ -1164,10 +1716,23 @@ void idServerSnapshotSystemLocal::SendClientMessages(void) {
             continue;
         }
 
+        // clients that get a full snapshot are built together below
+        if(numThreads > 1 && (c->state >= CS_ACTIVE || c->state == CS_ZOMBIE)) {
+            snapshotClients[numSnapshotClients++] = c;
+            continue;
+        }
+
         // generate and send a new message
         SendClientSnapshot(c);
     }
 
+    if(numSnapshotClients) {
+        SendClientSnapshotsParallel(snapshotClients, numSnapshotClients,
+                                    numThreads);
+    }
+
+    EndVisibilityCache();
+
     // NERVE - SMF - net debugging
     if(sv_showAverageBPS->integer && numclients > 0) {
         float32 ave = 0, uave = 0;
@@ -1213,13 +1778,61 @@ void idServerSnapshotSystemLocal::SendClientMessages(void) {
                                ave / static_cast<float32>(numclients), ave, sv.bpsMaxBytes, uave,
                                sv.ubpsMaxBytes, comp_ratio,
                                sv.ucompAve / sv.ucompNum);
+
+                if(deltaCacheHits + deltaCacheMisses > 0) {
+                    common->Printf("delta cache: %i hits %i misses (%2.2f%%)\n",
+                                   deltaCacheHits.load(), deltaCacheMisses.load(),
+                                   100.f * deltaCacheHits / (deltaCacheHits + deltaCacheMisses));
+                }
+
+                PrintCostliestClient();
             }
+
+            deltaCacheHits = 0;
+            deltaCacheMisses = 0;
         }
     }
 
     // -NERVE - SMF
 }
 
+/*
+=======================
+idServerSnapshotSystemLocal::PrintCostliestClient
+
+Goes with the sv_showAverageBPS report, see tickstatus for all of them
+=======================
+*/
+void idServerSnapshotSystemLocal::PrintCostliestClient(void) {
+    sint i, j, worst = -1;
+    float32 usec, worstUsec = 0;
+    clientCost_t *cost;
+
+    for(i = 0, cost = svs.clientCosts; i < sv_maxclients->integer;
+            i++, cost++) {
+        if(!svs.clients[i].state) {
+            continue;
+        }
+
+        for(j = 0, usec = 0; j < CLIENTCOST_NUM; j++) {
+            usec += cost->latchedUsec[j];
+        }
+
+        if(usec > worstUsec) {
+            worst = i;
+            worstUsec = usec;
+        }
+    }
+
+    if(worst < 0) {
+        return;
+    }
+
+    common->Printf("costliest client: %i %s %.0f usec/frame (peak %i) %.0f bytes/frame\n",
+                   worst, svs.clients[worst].name, worstUsec,
+                   svs.clientCosts[worst].latchedPeak, svs.clientCosts[worst].latchedBytes);
+}
+
 /*
 =======================
 idServerSnapshotSystemLocal::CheckClientUserinfoTimer
@@ -46,8 +46,53 @@
 typedef struct {
     sint numSnapshotEntities;
     sint snapshotEntities[MAX_SNAPSHOT_ENTITIES];
+    // entities already added to this snapshot, kept per snapshot instead of
+    // stamping svEntity_t so that several snapshots can be culled at once
+    uchar8 added[MAX_GENTITIES / 8];
+    sint clientNum; // the one the snapshot is for
+    bool needsCallback; // an entity wants sgame->SnapshotCallback
+    bool runCallbacks; // on the main thread, veto while adding
+    bool overflowed; // entities were discarded for lack of room
 } snapshotEntityNumbers_t;
 
+#define MAX_VIS_CACHE_ENTRIES 64
+
+// entities potentially visible from a cluster, shared by every snapshot
+// built from that cluster and area during one SendClientMessages
+typedef struct {
+    sint cluster;
+    sint area;
+    sint numEntities;
+    uchar16 entities[MAX_GENTITIES];
+} visCacheEntry_t;
+
+#define DELTA_CACHE_SIZE        2048    // must be a power of two
+#define DELTA_CACHE_LOCKS       16
+#define MAX_DELTA_ENTITY_BYTES  512
+
+// an encoded WriteDeltaEntity, shared by every client that sends the same
+// entity change during one SendClientMessages
+typedef struct {
+    sint generation;
+    bool force;
+    sint numBits;
+    sint uncompsize;
+    entityState_t from;
+    entityState_t to;
+    uchar8 data[MAX_DELTA_ENTITY_BYTES];
+} deltaCacheEntry_t;
+
+// one client's snapshot while it is being built on the job pool
+typedef struct {
+    client_t *client;
+    bool built;
+    bool commandsFit;
+    pointer deltaWarning; // printed on the main thread
+    snapshotEntityNumbers_t entityNumbers;
+    msg_t msg, msgBackup;
+    uchar8 msgBuffer[MAX_MSGLEN];
+} snapshotJob_t;
+
 //
 // idServerSnapshotSystemLocal
 //
@@ -64,18 +109,58 @@ public:
     idServerSnapshotSystemLocal();
     ~idServerSnapshotSystemLocal();
 
+    static void BeginDeltaCache(void);
+    static void WriteDeltaEntity(msg_t *msg, entityState_t *from,
+                                 entityState_t *to, bool force);
     static void EmitPacketEntities(clientSnapshot_t *from,
                                    clientSnapshot_t *to, msg_t *msg);
-    static void WriteSnapshotToClient(client_t *client, msg_t *msg);
+    static void WriteSnapshotToClient(client_t *client, msg_t *msg,
+                                      pointer *deltaWarning);
     static sint QsortEntityNumbers(const void *a, const void *b);
-    static void AddEntToSnapshot(sharedEntity_t *clientEnt, svEntity_t *svEnt,
-                                 sharedEntity_t *gEnt, snapshotEntityNumbers_t *eNums);
+    static void AddEntToSnapshot(svEntity_t *svEnt, sharedEntity_t *gEnt,
+                                 snapshotEntityNumbers_t *eNums);
+    static sint CollectVisibleEntities(sint cluster, sint area, uchar16 *list);
+    static void FixEntityNumbers(void);
+    static void BeginVisibilityCache(void);
+    static void EndVisibilityCache(void);
+    static const uchar16 *FindVisibleEntities(sint cluster, sint area,
+            uchar16 *buffer, sint *numEntities);
     static void AddEntitiesVisibleFromPoint(vec3_t origin,
                                             clientSnapshot_t *frame, snapshotEntityNumbers_t *eNums, bool portal);
+    static bool BeginClientSnapshot(client_t *client,
+                                    snapshotEntityNumbers_t *eNums);
+    static void AddClientSnapshotEntities(client_t *client,
+                                          snapshotEntityNumbers_t *eNums);
+    static void FinishClientSnapshot(client_t *client,
+                                     snapshotEntityNumbers_t *eNums);
     static void BuildClientSnapshot(client_t *client);
+    static bool WriteClientMessage(client_t *client, msg_t *msg,
+                                   msg_t *msgBackup, uchar8 *msgBuffer, sint msgBufferSize,
+                                   pointer *deltaWarning);
+    void TransmitClientMessage(client_t *client, msg_t *msg, msg_t *msgBackup,
+                               bool commandsFit, pointer deltaWarning);
+    static void CheckAutoRecordDemo(client_t *client);
+    static void CullSnapshotJob(void *data, sint jobNum);
+    static void WriteSnapshotJob(void *data, sint jobNum);
+    static void PrintCostliestClient(void);
+    void SendClientSnapshotsParallel(client_t **clients, sint numClients,
+                                     sint numThreads);
     static sint RateMsec(client_t *client, sint messageSize);
     static bool UpdateServerCommandsToClients(client_t *client, msg_t *msg,
             bool allowPartial);
+    static void FreeSnapshotMemory(void);
+
+private:
+    static snapshotJob_t *snapshotJobs;
+    static sint numSnapshotJobs;
+    static visCacheEntry_t visCache[MAX_VIS_CACHE_ENTRIES];
+    static sint numVisCacheEntries;
+    static bool visCacheActive;
+    static std::mutex visCacheMutex;
+    static deltaCacheEntry_t *deltaCache;
+    static sint deltaCacheGeneration;
+    static std::mutex deltaCacheLocks[DELTA_CACHE_LOCKS];
+    static std::atomic<sint> deltaCacheHits, deltaCacheMisses;
 };
 
 extern idServerSnapshotSystemLocal serverSnapshotSystemLocal;
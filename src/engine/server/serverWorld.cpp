@@ -92,126 +92,436 @@ clipHandle_t idServerWorldSystemLocal::ClipHandleForEntity(
 /*
 ===============
 idServerWorldSystemLocal::SectorList_f
+
+Prints the shape of the world tree and what the area queries cost since
+the last time it was asked
 ===============
 */
 void idServerWorldSystemLocal::SectorList_f(void) {
-    sint i, c;
-    worldSector_t *sec;
-    svEntity_t *ent;
+    sint i, leafs, inner, depth, maxDepth, totalDepth, queries;
+    worldNode_t *node;
+
+    leafs = inner = maxDepth = totalDepth = 0;
+
+    for(i = 0; i < WORLD_NODES; i++) {
+        node = &sv_worldNodes[i];
+
+        if(node->height < 0) {
+            continue;
+        }
+
+        if(node->height > 0) {
+            inner++;
+            continue;
+        }
 
-    for(i = 0; i < AREA_NODES; i++) {
-        sec = &sv_worldSectors[i];
+        leafs++;
 
-        c = 0;
+        depth = 0;
 
-        for(ent = sec->entities; ent; ent = ent->nextEntityInWorldSector) {
-            c++;
+        for(sint n = node->parent; n != WORLD_NODE_NULL;
+                n = sv_worldNodes[n].parent) {
+            depth++;
         }
 
-        common->Printf("sector %i: %i entities\n", i, c);
+        totalDepth += depth;
+
+        if(depth > maxDepth) {
+            maxDepth = depth;
+        }
     }
+
+    common->Printf("%i entities in %i leafs and %i inner nodes (%i of %i nodes in use)\n",
+                   leafs, leafs, inner, sv_numWorldNodes, WORLD_NODES);
+    common->Printf("height %i, leaf depth max %i avg %.1f\n",
+                   sv_worldRoot != WORLD_NODE_NULL ? sv_worldNodes[sv_worldRoot].height : 0,
+                   maxDepth, leafs ? static_cast<float32>(totalDepth) / leafs : 0.0f);
+
+    queries = sv_worldStats.queries;
+
+    common->Printf("%i queries: %.1f nodes visited, %.1f entities tested, %.1f found per query\n",
+                   queries,
+                   queries ? static_cast<float32>(sv_worldStats.nodesVisited) / queries : 0.0f,
+                   queries ? static_cast<float32>(sv_worldStats.entitiesTested) / queries : 0.0f,
+                   queries ? static_cast<float32>(sv_worldStats.entitiesFound) / queries : 0.0f);
+    common->Printf("%i links: %i inside the fat box, %i reinserted\n",
+                   sv_worldStats.links, sv_worldStats.refits, sv_worldStats.reinserts);
+    common->Printf("%i clip candidates, %i clipped exactly\n",
+                   sv_worldStats.clipCandidates, sv_worldStats.clipExact);
+
+    ::memset(&sv_worldStats, 0, sizeof(sv_worldStats));
 }
 
 /*
 ===============
-idServerWorldSystemLocal::CreateworldSector
+WorldBoxArea
 
-Builds a uniformly subdivided tree for the given world size
+Surface area of the box, the insertion cost metric
 ===============
 */
-worldSector_t *idServerWorldSystemLocal::CreateworldSector(sint depth,
-        vec3_t mins, vec3_t maxs) {
-    worldSector_t *anode = &sv_worldSectors[sv_numworldSectors];
-    vec3_t size, mins1, maxs1, mins2, maxs2;
+static float32 WorldBoxArea(const vec3_t mins, const vec3_t maxs) {
+    float32 dx = maxs[0] - mins[0];
+    float32 dy = maxs[1] - mins[1];
+    float32 dz = maxs[2] - mins[2];
+
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
 
-    sv_numworldSectors++;
+/*
+===============
+WorldUnionArea
+===============
+*/
+static float32 WorldUnionArea(const worldNode_t *a, const worldNode_t *b) {
+    vec3_t mins, maxs;
 
-    if(depth == AREA_DEPTH) {
-        anode->axis = -1;
-        anode->children[0] = anode->children[1] = nullptr;
-        return anode;
+    for(sint i = 0; i < 3; i++) {
+        mins[i] = Q_min(a->mins[i], b->mins[i]);
+        maxs[i] = Q_max(a->maxs[i], b->maxs[i]);
     }
 
-    VectorSubtract(maxs, mins, size);
+    return WorldBoxArea(mins, maxs);
+}
 
-    if(size[0] > size[1]) {
-        anode->axis = 0;
-    } else {
-        anode->axis = 1;
+/*
+===============
+WorldEncloseChildren
+===============
+*/
+static void WorldEncloseChildren(worldNode_t *node) {
+    const worldNode_t *a = &sv_worldNodes[node->children[0]];
+    const worldNode_t *b = &sv_worldNodes[node->children[1]];
+
+    for(sint i = 0; i < 3; i++) {
+        node->mins[i] = Q_min(a->mins[i], b->mins[i]);
+        node->maxs[i] = Q_max(a->maxs[i], b->maxs[i]);
     }
 
-    anode->dist = 0.5 * (maxs[anode->axis] + mins[anode->axis]);
-    VectorCopy(mins, mins1);
-    VectorCopy(mins, mins2);
-    VectorCopy(maxs, maxs1);
-    VectorCopy(maxs, maxs2);
+    node->height = 1 + Q_max(a->height, b->height);
+}
 
-    maxs1[anode->axis] = mins2[anode->axis] = anode->dist;
+/*
+===============
+idServerWorldSystemLocal::AllocWorldNode
+===============
+*/
+sint idServerWorldSystemLocal::AllocWorldNode(void) {
+    sint nodeNum;
+    worldNode_t *node;
+
+    // there are always enough nodes for a full tree of MAX_GENTITIES leafs
+    nodeNum = sv_worldFreeList;
+    node = &sv_worldNodes[nodeNum];
 
-    anode->children[0] = CreateworldSector(depth + 1, mins2, maxs2);
-    anode->children[1] = CreateworldSector(depth + 1, mins1, maxs1);
+    sv_worldFreeList = node->parent;
+    sv_numWorldNodes++;
 
-    return anode;
+    node->parent = WORLD_NODE_NULL;
+    node->children[0] = node->children[1] = WORLD_NODE_NULL;
+    node->height = 0;
+    node->entityNum = -1;
+
+    return nodeNum;
 }
 
 /*
 ===============
-idServerWorldSystemLocal::ClearWorld
+idServerWorldSystemLocal::FreeWorldNode
 ===============
 */
-void idServerWorldSystemLocal::ClearWorld(void) {
-    vec3_t mins, maxs;
-    clipHandle_t h;
+void idServerWorldSystemLocal::FreeWorldNode(sint nodeNum) {
+    worldNode_t *node = &sv_worldNodes[nodeNum];
+
+    node->parent = sv_worldFreeList;
+    node->height = -1;
+    node->entityNum = -1;
+
+    sv_worldFreeList = nodeNum;
+    sv_numWorldNodes--;
+}
+
+/*
+===============
+idServerWorldSystemLocal::BalanceWorldNode
+
+If one child of the node is more than one level taller than the other,
+rotate the taller one up.  Returns the node now standing in its place.
+===============
+*/
+sint idServerWorldSystemLocal::BalanceWorldNode(sint nodeNum) {
+    sint balance, up, upNum, smaller, swap;
+    worldNode_t *node, *upNode;
+
+    node = &sv_worldNodes[nodeNum];
+
+    if(node->height < 2) {
+        return nodeNum;
+    }
 
-    memset(sv_worldSectors, 0, sizeof(sv_worldSectors));
-    sv_numworldSectors = 0;
+    balance = sv_worldNodes[node->children[1]].height -
+              sv_worldNodes[node->children[0]].height;
 
-    for(uint i = 0; i < ARRAY_LEN(sv.svEntities); i++) {
-        sv.svEntities[i].worldSector = nullptr;
-        sv.svEntities[i].nextEntityInWorldSector = nullptr;
+    if(balance >= -1 && balance <= 1) {
+        return nodeNum;
     }
 
-    // get world map bounds
-    h = collisionModelManager->InlineModel(0);
-    collisionModelManager->ModelBounds(h, mins, maxs);
-    CreateworldSector(0, mins, maxs);
+    // the taller child takes the place of the node, and the node
+    // takes the shorter of the taller child's children
+    up = balance > 1 ? 1 : 0;
+    upNum = node->children[up];
+    upNode = &sv_worldNodes[upNum];
+
+    smaller = sv_worldNodes[upNode->children[0]].height >
+              sv_worldNodes[upNode->children[1]].height ? 1 : 0;
+    swap = upNode->children[smaller];
+
+    upNode->parent = node->parent;
+    node->parent = upNum;
+
+    if(upNode->parent != WORLD_NODE_NULL) {
+        worldNode_t *parent = &sv_worldNodes[upNode->parent];
+
+        parent->children[parent->children[0] == nodeNum ? 0 : 1] = upNum;
+    } else {
+        sv_worldRoot = upNum;
+    }
+
+    upNode->children[smaller] = nodeNum;
+    node->children[up] = swap;
+    sv_worldNodes[swap].parent = nodeNum;
+
+    WorldEncloseChildren(node);
+    WorldEncloseChildren(upNode);
+
+    return upNum;
 }
 
+/*
+===============
+idServerWorldSystemLocal::RefitWorldNodes
+
+Walks from the node up to the root, re-enclosing and balancing every node on the way
+===============
+*/
+void idServerWorldSystemLocal::RefitWorldNodes(sint nodeNum) {
+    while(nodeNum != WORLD_NODE_NULL) {
+        nodeNum = BalanceWorldNode(nodeNum);
+
+        WorldEncloseChildren(&sv_worldNodes[nodeNum]);
+
+        nodeNum = sv_worldNodes[nodeNum].parent;
+    }
+}
 
 /*
 ===============
-idServerWorldSystemLocal::UnlinkEntity
+idServerWorldSystemLocal::InsertWorldLeaf
 ===============
 */
-void idServerWorldSystemLocal::UnlinkEntity(sharedEntity_t *gEnt) {
-    svEntity_t *ent, *scan;
-    worldSector_t *ws;
+void idServerWorldSystemLocal::InsertWorldLeaf(sint leaf) {
+    sint sibling, oldParent, newParent, i;
+    float32 area, combined, cost, inherit, childCost[2];
+    worldNode_t *leafNode, *node, *child;
+
+    if(sv_worldRoot == WORLD_NODE_NULL) {
+        sv_worldRoot = leaf;
+        sv_worldNodes[leaf].parent = WORLD_NODE_NULL;
+        return;
+    }
 
-    ent = serverGameSystem->SvEntityForGentity(gEnt);
+    leafNode = &sv_worldNodes[leaf];
 
-    gEnt->r.linked = false;
+    // find the cheapest sibling, the one whose subtree grows the least
+    sibling = sv_worldRoot;
 
-    ws = ent->worldSector;
+    while(sv_worldNodes[sibling].height > 0) {
+        node = &sv_worldNodes[sibling];
 
-    if(!ws) {
-        return; // not linked in anywhere
+        area = WorldBoxArea(node->mins, node->maxs);
+        combined = WorldUnionArea(node, leafNode);
+
+        // cost of pairing with this node, and what every node
+        // below inherits from having to enlarge it
+        cost = 2.0f * combined;
+        inherit = 2.0f * (combined - area);
+
+        for(i = 0; i < 2; i++) {
+            child = &sv_worldNodes[node->children[i]];
+
+            childCost[i] = WorldUnionArea(child, leafNode) + inherit;
+
+            if(child->height > 0) {
+                childCost[i] -= WorldBoxArea(child->mins, child->maxs);
+            }
+        }
+
+        if(cost < childCost[0] && cost < childCost[1]) {
+            break;
+        }
+
+        sibling = node->children[childCost[0] < childCost[1] ? 0 : 1];
+    }
+
+    // make a new parent for the leaf and its sibling
+    oldParent = sv_worldNodes[sibling].parent;
+    newParent = AllocWorldNode();
+
+    node = &sv_worldNodes[newParent];
+    node->parent = oldParent;
+    node->children[0] = sibling;
+    node->children[1] = leaf;
+    WorldEncloseChildren(node);
+
+    if(oldParent != WORLD_NODE_NULL) {
+        child = &sv_worldNodes[oldParent];
+        child->children[child->children[0] == sibling ? 0 : 1] = newParent;
+    } else {
+        sv_worldRoot = newParent;
     }
 
-    ent->worldSector = nullptr;
+    sv_worldNodes[sibling].parent = newParent;
+    sv_worldNodes[leaf].parent = newParent;
+
+    RefitWorldNodes(oldParent);
+}
+
+/*
+===============
+idServerWorldSystemLocal::RemoveWorldLeaf
+===============
+*/
+void idServerWorldSystemLocal::RemoveWorldLeaf(sint leaf) {
+    sint parent, grandParent, sibling;
+    worldNode_t *parentNode;
 
-    if(ws->entities == ent) {
-        ws->entities = ent->nextEntityInWorldSector;
+    if(leaf == sv_worldRoot) {
+        sv_worldRoot = WORLD_NODE_NULL;
         return;
     }
 
-    for(scan = ws->entities; scan; scan = scan->nextEntityInWorldSector) {
-        if(scan->nextEntityInWorldSector == ent) {
-            scan->nextEntityInWorldSector = ent->nextEntityInWorldSector;
+    parent = sv_worldNodes[leaf].parent;
+    parentNode = &sv_worldNodes[parent];
+    grandParent = parentNode->parent;
+    sibling = parentNode->children[parentNode->children[0] == leaf ? 1 : 0];
+
+    // the sibling takes the place of the parent
+    if(grandParent != WORLD_NODE_NULL) {
+        worldNode_t *node = &sv_worldNodes[grandParent];
+
+        node->children[node->children[0] == parent ? 0 : 1] = sibling;
+        sv_worldNodes[sibling].parent = grandParent;
+    } else {
+        sv_worldRoot = sibling;
+        sv_worldNodes[sibling].parent = WORLD_NODE_NULL;
+    }
+
+    FreeWorldNode(parent);
+
+    RefitWorldNodes(grandParent);
+}
+
+/*
+===============
+idServerWorldSystemLocal::LinkWorldLeaf
+
+Puts the entity bounds into the tree.  Nothing changes when the bounds
+are still inside the fat box from the last insertion.
+===============
+*/
+void idServerWorldSystemLocal::LinkWorldLeaf(svEntity_t *ent,
+        const vec3_t absmin, const vec3_t absmax) {
+    sint leaf;
+    worldNode_t *node;
+
+    sv_worldStats.links++;
+
+    leaf = ent->worldNode;
+
+    if(leaf != WORLD_NODE_NULL) {
+        node = &sv_worldNodes[leaf];
+
+        if(absmin[0] >= node->mins[0] && absmin[1] >= node->mins[1] &&
+                absmin[2] >= node->mins[2] && absmax[0] <= node->maxs[0] &&
+                absmax[1] <= node->maxs[1] && absmax[2] <= node->maxs[2]) {
+            sv_worldStats.refits++;
             return;
         }
+
+        RemoveWorldLeaf(leaf);
+    } else {
+        leaf = AllocWorldNode();
+        sv_worldNodes[leaf].entityNum = ARRAY_INDEX(sv.svEntities, ent);
+        ent->worldNode = leaf;
     }
 
-    common->Printf("WARNING: idServerWorldSystemLocal::UnlinkEntity: not found in worldSector\n");
+    sv_worldStats.reinserts++;
+
+    node = &sv_worldNodes[leaf];
+
+    for(sint i = 0; i < 3; i++) {
+        node->mins[i] = absmin[i] - WORLD_FAT_MARGIN;
+        node->maxs[i] = absmax[i] + WORLD_FAT_MARGIN;
+    }
+
+    InsertWorldLeaf(leaf);
+}
+
+/*
+===============
+idServerWorldSystemLocal::UnlinkWorldLeaf
+===============
+*/
+void idServerWorldSystemLocal::UnlinkWorldLeaf(svEntity_t *ent) {
+    if(ent->worldNode == WORLD_NODE_NULL) {
+        return; // not linked in anywhere
+    }
+
+    RemoveWorldLeaf(ent->worldNode);
+    FreeWorldNode(ent->worldNode);
+
+    ent->worldNode = WORLD_NODE_NULL;
+}
+
+/*
+===============
+idServerWorldSystemLocal::ClearWorld
+===============
+*/
+void idServerWorldSystemLocal::ClearWorld(void) {
+    sint i;
+
+    for(i = 0; i < WORLD_NODES; i++) {
+        sv_worldNodes[i].parent = i + 1 < WORLD_NODES ? i + 1 : WORLD_NODE_NULL;
+        sv_worldNodes[i].children[0] = sv_worldNodes[i].children[1] =
+                                           WORLD_NODE_NULL;
+        sv_worldNodes[i].height = -1;
+        sv_worldNodes[i].entityNum = -1;
+    }
+
+    sv_worldRoot = WORLD_NODE_NULL;
+    sv_worldFreeList = 0;
+    sv_numWorldNodes = 0;
+    ::memset(&sv_worldStats, 0, sizeof(sv_worldStats));
+
+    for(uint j = 0; j < ARRAY_LEN(sv.svEntities); j++) {
+        sv.svEntities[j].worldNode = WORLD_NODE_NULL;
+    }
+}
+
+
+/*
+===============
+idServerWorldSystemLocal::UnlinkEntity
+===============
+*/
+void idServerWorldSystemLocal::UnlinkEntity(sharedEntity_t *gEnt) {
+    svEntity_t *ent;
+
+    ent = serverGameSystem->SvEntityForGentity(gEnt);
+
+    gEnt->r.linked = false;
+
+    UnlinkWorldLeaf(ent);
 }
 
 /*
@@ -223,7 +533,6 @@ void idServerWorldSystemLocal::LinkEntity(sharedEntity_t *gEnt) {
     sint leafs[MAX_TOTAL_ENT_LEAFS], cluster, num_leafs, i, j, k, area,
          lastLeaf;
     float32 *origin, *angles;
-    worldSector_t *node;
     svEntity_t *ent;
 
     ent = serverGameSystem->SvEntityForGentity(gEnt);
@@ -235,9 +544,10 @@ void idServerWorldSystemLocal::LinkEntity(sharedEntity_t *gEnt) {
         }
     }
 
-    if(ent->worldSector) {
-        // unlink from old position
-        UnlinkEntity(gEnt);
+    if(ent->worldNode != WORLD_NODE_NULL) {
+        // the tree leaf is kept until the new bounds are known,
+        // most moves stay inside its fat box
+        gEnt->r.linked = false;
     }
 
     // encode the size into the entityState_t for client prediction
@@ -335,6 +645,7 @@ void idServerWorldSystemLocal::LinkEntity(sharedEntity_t *gEnt) {
     // if none of the leafs were inside the map, the
     // entity is outside the world and can be considered unlinked
     if(!num_leafs) {
+        UnlinkWorldLeaf(ent);
         return;
     }
 
@@ -383,49 +694,61 @@ void idServerWorldSystemLocal::LinkEntity(sharedEntity_t *gEnt) {
 
     gEnt->r.linkcount++;
 
-    // find the first world sector node that the ent's box crosses
-    node = sv_worldSectors;
-
-    while(1) {
-        if(node->axis == -1) {
-            break;
-        }
-
-        if(gEnt->r.absmin[node->axis] > node->dist) {
-            node = node->children[0];
-        } else if(gEnt->r.absmax[node->axis] < node->dist) {
-            node = node->children[1];
-        } else {
-            // crosses the node
-            break;
-        }
-    }
-
-    // link it in
-    ent->worldSector = node;
-    ent->nextEntityInWorldSector = node->entities;
-    node->entities = ent;
+    // move it in the world tree
+    LinkWorldLeaf(ent, gEnt->r.absmin, gEnt->r.absmax);
 
     gEnt->r.linked = true;
 }
 
 /*
-====================
-idServerWorldSystemLocal::AreaEntities_r
-====================
+================
+idServerWorldSystemLocal::AreaEntities
+================
 */
-void idServerWorldSystemLocal::AreaEntities_r(worldSector_t *node,
-        areaParms_t *ap) {
-    sint count;
-    svEntity_t *check, *next;
+sint idServerWorldSystemLocal::AreaEntities(const vec3_t mins,
+        const vec3_t maxs, sint *entityList, sint maxcount) {
+    sint stack[WORLD_NODES], depth, nodeNum;
+    worldNode_t *node;
     sharedEntity_t *gcheck;
+    areaParms_t ap;
 
-    count = 0;
+    ap.mins = mins;
+    ap.maxs = maxs;
+    ap.list = entityList;
+    ap.count = 0;
+    ap.maxcount = maxcount;
+
+    sv_worldStats.queries++;
+
+    if(sv_worldRoot == WORLD_NODE_NULL) {
+        return 0;
+    }
+
+    depth = 0;
+    stack[depth++] = sv_worldRoot;
 
-    for(check = node->entities; check; check = next) {
-        next = check->nextEntityInWorldSector;
+    while(depth) {
+        nodeNum = stack[--depth];
+        node = &sv_worldNodes[nodeNum];
 
-        gcheck = serverGameSystem->GEntityForSvEntity(check);
+        sv_worldStats.nodesVisited++;
+
+        if(node->mins[0] > ap.maxs[0] || node->mins[1] > ap.maxs[1] ||
+                node->mins[2] > ap.maxs[2] || node->maxs[0] < ap.mins[0] ||
+                node->maxs[1] < ap.mins[1] || node->maxs[2] < ap.mins[2]) {
+            continue;
+        }
+
+        if(node->height > 0) {
+            stack[depth++] = node->children[1];
+            stack[depth++] = node->children[0];
+            continue;
+        }
+
+        // the leaf box is fat, check the real bounds
+        sv_worldStats.entitiesTested++;
+
+        gcheck = serverGameSystem->GEntityForSvEntity(&sv.svEntities[node->entityNum]);
 
         if(!gcheck) {
             continue;
@@ -435,55 +758,26 @@ void idServerWorldSystemLocal::AreaEntities_r(worldSector_t *node,
             continue;
         }
 
-        if(gcheck->r.absmin[0] > ap->maxs[0] ||
-                gcheck->r.absmin[1] > ap->maxs[1] || gcheck->r.absmin[2] > ap->maxs[2] ||
-                gcheck->r.absmax[0] < ap->mins[0] || gcheck->r.absmax[1] < ap->mins[1] ||
-                gcheck->r.absmax[2] < ap->mins[2]) {
+        if(gcheck->r.absmin[0] > ap.maxs[0] ||
+                gcheck->r.absmin[1] > ap.maxs[1] || gcheck->r.absmin[2] > ap.maxs[2] ||
+                gcheck->r.absmax[0] < ap.mins[0] || gcheck->r.absmax[1] < ap.mins[1] ||
+                gcheck->r.absmax[2] < ap.mins[2]) {
             continue;
         }
 
-        if(ap->count >= ap->maxcount) {
+        if(ap.count >= ap.maxcount) {
             if(developer->integer) {
                 common->Printf("idServerWorldSystemLocal::AreaEntities: MAXCOUNT\n");
             }
 
-            return;
+            break;
         }
 
-        ap->list[ap->count] = ARRAY_INDEX(sv.svEntities, check);
-        ap->count++;
-    }
-
-    if(node->axis == -1) {
-        return; // terminal node
-    }
-
-    // recurse down both sides
-    if(ap->maxs[node->axis] > node->dist) {
-        AreaEntities_r(node->children[0], ap);
+        ap.list[ap.count] = node->entityNum;
+        ap.count++;
     }
 
-    if(ap->mins[node->axis] < node->dist) {
-        AreaEntities_r(node->children[1], ap);
-    }
-}
-
-/*
-================
-idServerWorldSystemLocal::AreaEntities
-================
-*/
-sint idServerWorldSystemLocal::AreaEntities(const vec3_t mins,
-        const vec3_t maxs, sint *entityList, sint maxcount) {
-    areaParms_t ap;
-
-    ap.mins = mins;
-    ap.maxs = maxs;
-    ap.list = entityList;
-    ap.count = 0;
-    ap.maxcount = maxcount;
-
-    AreaEntities_r(sv_worldSectors, &ap);
+    sv_worldStats.entitiesFound += ap.count;
 
     return ap.count;
 }
@@ -511,38 +805,133 @@ void idServerWorldSystemLocal::ClipToEntity(trace_t *trace,
         return;
     }
 
-    // might intersect, so do an exact clip
-    clipHandle = ClipHandleForEntity(touch);
-
     origin = touch->r.currentOrigin;
     angles = touch->r.currentAngles;
 
     if(!touch->r.bmodel) {
-        angles = vec3_origin;   // boxes don't rotate
-    }
+        bool capsule = (touch->r.svFlags & SVF_CAPSULE) != 0;
 
-    collisionModelManager->TransformedBoxTrace(trace,
-            const_cast<float32 *>(start), const_cast<float32 *>(end),
-            const_cast<float32 *>(mins),
-            const_cast<float32 *>(maxs), clipHandle, contentmask, origin, angles,
-            type);
+        // boxes don't rotate. The temp box is private to this trace and
+        // has the body contents of the shared one
+        collisionModelManager->TempBoxTrace(trace, start, end, mins, maxs,
+                                            touch->r.mins, touch->r.maxs, CONTENTS_BODY, capsule,
+                                            contentmask, origin, type);
+    } else {
+        // might intersect, so do an exact clip
+        clipHandle = ClipHandleForEntity(touch);
+
+        collisionModelManager->TransformedBoxTrace(trace,
+                const_cast<float32 *>(start), const_cast<float32 *>(end),
+                const_cast<float32 *>(mins),
+                const_cast<float32 *>(maxs), clipHandle, contentmask, origin, angles,
+                type);
+    }
 
     if(trace->fraction < 1) {
         trace->entityNum = touch->s.number;
     }
 }
 
+/*
+====================
+idServerWorldSystemLocal::SweepClipCandidates
+
+Slab test of the move against the grown candidate bounds.  Sets enterFrac
+to where the move first touches each box, or 2 if it never does.
+====================
+*/
+void idServerWorldSystemLocal::SweepClipCandidates(const moveclip_t *clip,
+        clipBroadphase_t *bp, sint count) {
+    sint i, j;
+    float32 start[3], invDir[3], delta;
+
+    for(j = 0; j < 3; j++) {
+        start[j] = clip->start[j];
+        delta = clip->end[j] - clip->start[j];
+
+        // a huge slope instead of an infinite one keeps every product
+        // finite, a box the move doesn't already overlap on this axis
+        // then gets an entry time far outside 0..1
+        invDir[j] = Q_fabs(delta) < 1e-6f ? 1e30f : 1.0f / delta;
+    }
+
+#ifdef SV_SIMD_CLIP
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 never = _mm_set1_ps(2.0f);
+
+    for(i = 0; i < count; i += 4) {
+        __m128 enter = _mm_set1_ps(-FLT_MAX);
+        __m128 leave = _mm_set1_ps(FLT_MAX);
+
+        for(j = 0; j < 3; j++) {
+            __m128 p = _mm_set1_ps(start[j]);
+            __m128 inv = _mm_set1_ps(invDir[j]);
+            __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(&bp->mins[j][i]), p), inv);
+            __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(&bp->maxs[j][i]), p), inv);
+
+            enter = _mm_max_ps(enter, _mm_min_ps(t1, t2));
+            leave = _mm_min_ps(leave, _mm_max_ps(t1, t2));
+        }
+
+        __m128 hit = _mm_and_ps(_mm_and_ps(_mm_cmple_ps(enter, leave),
+                                           _mm_cmpge_ps(leave, zero)), _mm_cmple_ps(enter, one));
+
+        _mm_store_ps(&bp->enterFrac[i], _mm_or_ps(_mm_and_ps(hit, enter),
+                     _mm_andnot_ps(hit, never)));
+    }
+
+#else
+
+    for(i = 0; i < count; i++) {
+        float32 enter = -FLT_MAX, leave = FLT_MAX, t1, t2;
+
+        for(j = 0; j < 3; j++) {
+            t1 = (bp->mins[j][i] - start[j]) * invDir[j];
+            t2 = (bp->maxs[j][i] - start[j]) * invDir[j];
+
+            enter = Q_max(enter, Q_min(t1, t2));
+            leave = Q_min(leave, Q_max(t1, t2));
+        }
+
+        bp->enterFrac[i] = (enter <= leave && leave >= 0.0f &&
+                            enter <= 1.0f) ? enter : 2.0f;
+    }
+
+#endif
+}
+
+/*
+====================
+CompareClipCandidates
+====================
+*/
+static bool CompareClipCandidates(const clipCandidate_t &a,
+                                  const clipCandidate_t &b) {
+    if(a.enterFrac != b.enterFrac) {
+        return a.enterFrac < b.enterFrac;
+    }
+
+    return a.entityNum < b.entityNum;
+}
+
 /*
 ====================
 idServerWorldSystemLocal::ClipMoveToEntities
+
+The candidates are clipped nearest first.  Both the epsilon grown absolute
+bounds and the sweep are conservative, an entity can't cut the trace before
+its enterFrac, so the loop stops at the first one past the trace fraction.
 ====================
 */
 void idServerWorldSystemLocal::ClipMoveToEntities(moveclip_t *clip) {
-    sint i, num, touchlist[MAX_GENTITIES], passOwnerNum;
+    sint i, j, num, touchlist[MAX_GENTITIES], passOwnerNum, count, numHits;
     sharedEntity_t *touch;
     trace_t trace;
     clipHandle_t clipHandle;
     float32 *origin, *angles;
+    static thread_local clipBroadphase_t broadphase;
+    clipBroadphase_t *bp = &broadphase;
 
     num = serverWorldSystemLocal.AreaEntities(clip->boxmins, clip->boxmaxs,
             touchlist, MAX_GENTITIES);
@@ -558,11 +947,9 @@ void idServerWorldSystemLocal::ClipMoveToEntities(moveclip_t *clip) {
         passOwnerNum = -1;
     }
 
-    for(i = 0; i < num; i++) {
-        if(clip->trace.allsolid) {
-            return;
-        }
+    count = 0;
 
+    for(i = 0; i < num; i++) {
         touch = serverGameSystem->GentityNum(touchlist[i]);
 
         // see if we should ignore this entity
@@ -586,35 +973,96 @@ void idServerWorldSystemLocal::ClipMoveToEntities(moveclip_t *clip) {
             continue;
         }
 
-        // might intersect, so do an exact clip
-        clipHandle = ClipHandleForEntity(touch);
+        for(j = 0; j < 3; j++) {
+            bp->mins[j][count] = touch->r.absmin[j] - clip->maxs[j];
+            bp->maxs[j][count] = touch->r.absmax[j] - clip->mins[j];
+        }
 
-        if(clipHandle == 0) {
+        bp->entityNums[count] = touchlist[i];
+        count++;
+    }
+
+    if(!count) {
+        return;
+    }
+
+    // pad the last group of four
+    for(i = count; i & 3; i++) {
+        for(j = 0; j < 3; j++) {
+            bp->mins[j][i] = bp->maxs[j][i] = 0.0f;
+        }
+    }
+
+    SweepClipCandidates(clip, bp, count);
+
+    numHits = 0;
+
+    for(i = 0; i < count; i++) {
+        touch = serverGameSystem->GentityNum(bp->entityNums[i]);
+        angles = touch->r.currentAngles;
+
+        if(touch->r.bmodel && (angles[0] || angles[1] || angles[2])) {
+            // a rotated bmodel is clipped with the unrotated trace box,
+            // which can reach past the sweep against its bounds
+            bp->hits[numHits].enterFrac = -1.0f;
+        } else if(bp->enterFrac[i] > clip->trace.fraction) {
             continue;
+        } else {
+            bp->hits[numHits].enterFrac = bp->enterFrac[i];
         }
 
-        // If clipping against BBOX, set to correct contents
-        if(clipHandle == BOX_MODEL_HANDLE) {
-            collisionModelManager->SetTempBoxModelContents(touch->r.contents);
+        bp->hits[numHits].entityNum = bp->entityNums[i];
+        numHits++;
+    }
+
+    std::sort(bp->hits, bp->hits + numHits, CompareClipCandidates);
+
+    sv_worldStats.clipCandidates += count;
+
+    for(i = 0; i < numHits; i++) {
+        if(clip->trace.allsolid) {
+            return;
+        }
+
+        if(bp->hits[i].enterFrac > clip->trace.fraction) {
+            break;
         }
 
+        sv_worldStats.clipExact++;
+
+        touch = serverGameSystem->GentityNum(bp->hits[i].entityNum);
+
         origin = touch->r.currentOrigin;
         angles = touch->r.currentAngles;
 
         if(!touch->r.bmodel) {
-            // boxes don't rotate
-            angles = vec3_origin;
-        }
+            bool capsule = (touch->r.svFlags & SVF_CAPSULE) != 0;
+
+            // boxes don't rotate. The temp box is private to this trace,
+            // a box gets the entity's contents here like the shared one
+            // did, capsules keep the default body contents
+            collisionModelManager->TempBoxTrace(&trace, clip->start, clip->end,
+                                                clip->mins, clip->maxs, touch->r.mins, touch->r.maxs,
+                                                capsule ? CONTENTS_BODY : touch->r.contents, capsule,
+                                                clip->contentmask, origin, clip->collisionType);
+        } else {
+            // might intersect, so do an exact clip
+            clipHandle = ClipHandleForEntity(touch);
+
+            if(clipHandle == 0) {
+                continue;
+            }
 
-        collisionModelManager->TransformedBoxTrace(&trace,
-                (const_cast<float32 *>(reinterpret_cast<const float32 *>(clip->start))),
-                (const_cast<float32 *>(reinterpret_cast<const float32 *>(clip->end))),
-                (const_cast<float32 *>(reinterpret_cast<const float32 *>(clip->mins))),
-                (const_cast<float32 *>(reinterpret_cast<const float32 *>(clip->maxs))),
-                clipHandle,
-                clip->contentmask,
-                origin, angles,
-                clip->collisionType);
+            collisionModelManager->TransformedBoxTrace(&trace,
+                    (const_cast<float32 *>(reinterpret_cast<const float32 *>(clip->start))),
+                    (const_cast<float32 *>(reinterpret_cast<const float32 *>(clip->end))),
+                    (const_cast<float32 *>(reinterpret_cast<const float32 *>(clip->mins))),
+                    (const_cast<float32 *>(reinterpret_cast<const float32 *>(clip->maxs))),
+                    clipHandle,
+                    clip->contentmask,
+                    origin, angles,
+                    clip->collisionType);
+        }
 
         if(trace.allsolid) {
             clip->trace.allsolid = true;
@@ -637,11 +1085,6 @@ void idServerWorldSystemLocal::ClipMoveToEntities(moveclip_t *clip) {
             clip->trace.startsolid = static_cast<uint>(clip->trace.startsolid) |
                                      static_cast<uint>(oldStart);
         }
-
-        // Reset contents to default
-        if(clipHandle == BOX_MODEL_HANDLE) {
-            collisionModelManager->SetTempBoxModelContents(CONTENTS_BODY);
-        }
     }
 }
 
@@ -719,7 +1162,6 @@ idServerWorldSystemLocal::PointContents
 sint idServerWorldSystemLocal::PointContents(const vec3_t p,
         sint passEntityNum) {
     sint touch[MAX_GENTITIES], i, num, contents, c2;
-    float32 *angles;
     sharedEntity_t *hit;
     clipHandle_t clipHandle;
 
@@ -736,6 +1178,16 @@ sint idServerWorldSystemLocal::PointContents(const vec3_t p,
 
         hit = serverGameSystem->GentityNum(touch[i]);
 
+        if(!hit->r.bmodel) {
+            // boxes don't rotate, the temp box is private to this call and
+            // has the body contents of the shared one
+            c2 = collisionModelManager->TempBoxPointContents(p, hit->r.mins,
+                    hit->r.maxs, CONTENTS_BODY, hit->r.currentOrigin);
+
+            contents |= c2;
+            continue;
+        }
+
         // might intersect, so do an exact clip
         clipHandle = ClipHandleForEntity(hit);
 
@@ -744,12 +1196,6 @@ sint idServerWorldSystemLocal::PointContents(const vec3_t p,
             continue;
         }
 
-        angles = hit->r.currentAngles;
-
-        if(!hit->r.bmodel) {
-            angles = vec3_origin; // boxes don't rotate
-        }
-
         c2 = collisionModelManager->TransformedPointContents(p, clipHandle,
                 hit->r.currentOrigin, hit->r.currentAngles);
 
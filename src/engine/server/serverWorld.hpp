@@ -43,24 +43,45 @@
 ENTITY CHECKING
 
 To avoid linearly searching through lists of entities during environment testing,
-the world is carved up with an evenly spaced, axially aligned bsp tree.  Entities
-are kept in chains either at the final leafs, or at the first node that splits
-them, which prevents having to deal with multiple fragments of a single entity.
+linked entities are kept in a dynamic AABB tree.  Every entity is a leaf holding a
+slightly enlarged ("fat") copy of its absolute bounds, so an entity that moves
+inside its fat box doesn't touch the tree at all.  Inner nodes enclose their two
+children, new leafs go where they grow the enclosing surface area the least, and
+the tree is kept balanced by rotations on the way back up.
 ===============================================================================
 */
 
-typedef struct worldSector_s {
-    sint    axis; // -1 = leaf node
-    float32 dist;
-    struct worldSector_s *children[2];
-    svEntity_t *entities;
-} worldSector_t;
-
-#define AREA_DEPTH 4
-#define AREA_NODES 64
-
-static worldSector_t sv_worldSectors[AREA_NODES];
-static sint sv_numworldSectors;
+#define WORLD_NODE_NULL -1
+#define WORLD_NODES ( MAX_GENTITIES * 2 )
+
+// how far a leaf box is grown on each side when it's (re)inserted
+#define WORLD_FAT_MARGIN 8.0f
+
+typedef struct worldNode_s {
+    vec3_t  mins, maxs;
+    sint    parent; // next free node while on the free list
+    sint    children[2]; // WORLD_NODE_NULL for leafs
+    sint    height; // 0 = leaf, -1 = free
+    sint    entityNum;
+} worldNode_t;
+
+typedef struct worldTreeStats_s {
+    sint    queries;
+    sint    nodesVisited;
+    sint    entitiesTested;
+    sint    entitiesFound;
+    sint    links;
+    sint    refits; // links that stayed inside the fat box
+    sint    reinserts;
+    sint    clipCandidates; // entities ClipMoveToEntities slab tested
+    sint    clipExact; // ... and still had to clip exactly
+} worldTreeStats_t;
+
+static worldNode_t sv_worldNodes[WORLD_NODES];
+static sint sv_worldRoot;
+static sint sv_worldFreeList;
+static sint sv_numWorldNodes;
+static worldTreeStats_t sv_worldStats;
 
 #define MAX_TOTAL_ENT_LEAFS 128
 
@@ -92,6 +113,37 @@ typedef struct {
     traceType_t collisionType;
 } moveclip_t;
 
+/*
+============================================================================
+CLIP BROADPHASE
+
+ClipMoveToEntities sweeps the trace box against the absolute bounds of all
+candidates at once, four at a time when SSE is available.  Candidates the
+sweep can't reach before the current trace fraction are never clipped.
+============================================================================
+*/
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define SV_SIMD_CLIP 1
+#endif
+
+// candidate arrays are padded to a multiple of four
+#define MAX_CLIP_CANDIDATES ( MAX_GENTITIES + 4 )
+
+typedef struct {
+    float32 enterFrac;
+    sint    entityNum;
+} clipCandidate_t;
+
+typedef struct {
+    // absolute bounds grown by the size of the moving box, one axis per row
+    alignas(16) float32 mins[3][MAX_CLIP_CANDIDATES];
+    alignas(16) float32 maxs[3][MAX_CLIP_CANDIDATES];
+    alignas(16) float32 enterFrac[MAX_CLIP_CANDIDATES];
+    sint    entityNums[MAX_CLIP_CANDIDATES];
+    clipCandidate_t hits[MAX_CLIP_CANDIDATES];
+} clipBroadphase_t;
+
 // FIXME: Copied from cm_local.hpp
 #define BOX_MODEL_HANDLE 511
 
@@ -120,13 +172,21 @@ public:
     // is not solid
     static clipHandle_t ClipHandleForEntity(const sharedEntity_t *ent);
     static void SectorList_f(void);
-    static worldSector_t *CreateworldSector(sint depth, vec3_t mins,
-                                            vec3_t maxs);
+    static sint AllocWorldNode(void);
+    static void FreeWorldNode(sint nodeNum);
+    static sint BalanceWorldNode(sint nodeNum);
+    static void RefitWorldNodes(sint nodeNum);
+    static void InsertWorldLeaf(sint leaf);
+    static void RemoveWorldLeaf(sint leaf);
+    static void LinkWorldLeaf(svEntity_t *ent, const vec3_t absmin,
+                              const vec3_t absmax);
+    static void UnlinkWorldLeaf(svEntity_t *ent);
     static void ClearWorld(void);
-    static void AreaEntities_r(worldSector_t *node, areaParms_t *ap);
     static void ClipToEntity(trace_t *trace, const vec3_t start,
                              const vec3_t mins, const vec3_t maxs, const vec3_t end, sint entityNum,
                              sint contentmask, traceType_t type);
+    static void SweepClipCandidates(const moveclip_t *clip,
+                                    clipBroadphase_t *bp, sint count);
     static void ClipMoveToEntities(moveclip_t *clip);
 };
 
@@ -60,7 +60,7 @@ channel_t loop_channels[MAX_CHANNELS];
 sint numLoopChannels;
 
 static sint s_soundStarted;
-static bool s_soundMuted;
+static std::atomic<bool> s_soundMuted;
 
 dma_t       dma;
 
@@ -68,8 +68,8 @@ static sint listener_number;
 static vec3_t listener_origin;
 static vec3_t listener_axis[3];
 
-sint s_soundtime;       // sample PAIRS
-sint s_paintedtime;         // sample PAIRS
+std::atomic<sint> s_soundtime;       // sample PAIRS
+std::atomic<sint> s_paintedtime;         // sample PAIRS
 
 // MAX_SFX may be larger than MAX_SOUNDS because
 // of custom player sounds
@@ -83,7 +83,7 @@ static sfx_t *sfxHash[LOOP_HASH];
 static loopSound_t loopSounds[MAX_GENTITIES];
 static  channel_t *freelist = nullptr;
 
-sint s_rawend;
+std::atomic<sint> s_rawend;
 portable_samplepair_t s_rawsamples[MAX_RAW_SAMPLES];
 
 // ====================================================================
@@ -135,6 +135,8 @@ void S_SoundInfo_f(void) {
             common->Printf("No background file.\n");
         }
 
+        S_StreamInfo();
+        SND_CacheInfo();
     }
 
     common->Printf("----------------------\n");
@@ -182,6 +184,12 @@ void SOrig_Init(void) {
         s_soundtime = 0;
         s_paintedtime = 0;
 
+        S_InitMixer();
+
+        if(s_mixThread->integer) {
+            S_StartMixThread();
+        }
+
         SOrig_StopAllSounds();
 
         S_SoundInfo_f();
@@ -195,6 +203,11 @@ S_ChannelFree
 ================
 */
 void S_ChannelFree(channel_t *v) {
+    if(v->stream) {
+        S_CloseSfxStream(v->stream);
+        v->stream = 0;
+    }
+
     v->thesfx = nullptr;
     *(channel_t **)v = freelist;
     freelist = (channel_t *)v;
@@ -258,6 +271,8 @@ void SOrig_Shutdown(void) {
         return;
     }
 
+    S_StopMixThread();
+    S_CloseSfxStreams(nullptr);
     SNDDMA_Shutdown();
     SND_shutdown();
 
@@ -386,11 +401,10 @@ void S_DefaultSound(sfx_t *sfx) {
     sint i;
 
     sfx->soundLength = 512;
-    sfx->soundData = SND_malloc();
-    sfx->soundData->next = nullptr;
+    sfx->soundPCM = SND_mallocPCM(sfx->soundLength);
 
     for(i = 0 ; i < sfx->soundLength ; i++) {
-        sfx->soundData->sndChunk[i] = i;
+        sfx->soundPCM[i] = i;
     }
 }
 
@@ -473,7 +487,7 @@ sfxHandle_t SOrig_RegisterSound(pointer name, bool compressed) {
         return 0;
     }
 
-    if(sfx->soundData) {
+    if(S_SfxHasSamples(sfx)) {
         if(sfx->defaultSound) {
             common->Printf(S_COLOR_YELLOW
                            "WARNING: could not find %s - using default\n",
@@ -517,6 +531,24 @@ void S_memoryLoad(sfx_t    *sfx) {
 
 //=============================================================================
 
+/*
+=================
+S_TouchSfx
+
+Loads a sound that was paged out on its way to being played
+=================
+*/
+static void S_TouchSfx(sfx_t *sfx) {
+    if(sfx->inMemory) {
+        return;
+    }
+
+    sndCacheStats.reloads++;
+    S_memoryLoad(sfx);
+}
+
+//=============================================================================
+
 /*
 =================
 S_SpatializeOrigin
@@ -606,7 +638,7 @@ void SOrig_StartSound(vec3_t origin, sint entityNum, sint entchannel,
                       sfxHandle_t sfxHandle) {
     channel_t *ch;
     sfx_t *sfx;
-    sint i, oldest, chosen, time;
+    sint i, oldest, chosen, time, stream;
 
     if(!s_soundStarted || s_soundMuted) {
         return;
@@ -628,12 +660,14 @@ void SOrig_StartSound(vec3_t origin, sint entityNum, sint entchannel,
 
     sfx = &s_knownSfx[ sfxHandle ];
 
-    if(sfx->inMemory == false) {
-        S_memoryLoad(sfx);
+    if(sfx->inMemory) {
+        sndCacheStats.hits++;
     }
 
+    S_TouchSfx(sfx);
+
     if(s_show->integer == 1) {
-        common->Printf("%i : %s\n", s_paintedtime, sfx->soundName);
+        common->Printf("%i : %s\n", s_paintedtime.load(), sfx->soundName);
     }
 
     time = common->Milliseconds();
@@ -656,6 +690,17 @@ void SOrig_StartSound(vec3_t origin, sint entityNum, sint entchannel,
 
     sfx->lastTimeUsed = time;
 
+    // a streamed sound needs a decode ring before it gets a channel
+    stream = 0;
+
+    if(sfx->soundCompressionMethod == SND_COMPRESSION_STREAM) {
+        stream = S_OpenSfxStream(sfx, false);
+
+        if(!stream) {
+            return;
+        }
+    }
+
     ch = S_ChannelMalloc(); // entityNum, entchannel);
 
     if(!ch) {
@@ -695,6 +740,7 @@ void SOrig_StartSound(vec3_t origin, sint entityNum, sint entchannel,
 
                 if(chosen == -1) {
                     common->Printf("dropping sound\n");
+                    S_CloseSfxStream(stream);
                     return;
                 }
             }
@@ -704,6 +750,10 @@ void SOrig_StartSound(vec3_t origin, sint entityNum, sint entchannel,
         ch->allocTime = sfx->lastTimeUsed;
     }
 
+    if(ch->stream) {
+        S_CloseSfxStream(ch->stream);
+    }
+
     if(origin) {
         VectorCopy(origin, ch->origin);
         ch->fixed_origin = true;
@@ -720,6 +770,11 @@ void SOrig_StartSound(vec3_t origin, sint entityNum, sint entchannel,
         ch->master_vol;       // these will get calced at next spatialize
     ch->rightvol = ch->master_vol;      // unless the game isn't running
     ch->doppler = false;
+    ch->stream = stream;
+
+    if(S_MixThreadActive()) {
+        S_MixStartChannel(ch);
+    }
 }
 
 
@@ -759,6 +814,8 @@ void SOrig_ClearSoundBuffer(void) {
         return;
     }
 
+    S_CloseSfxStreams(nullptr);
+
     // stop looping sounds
     ::memset(loopSounds, 0, MAX_GENTITIES * sizeof(loopSound_t));
     ::memset(loop_channels, 0, MAX_CHANNELS * sizeof(channel_t));
@@ -766,6 +823,10 @@ void SOrig_ClearSoundBuffer(void) {
 
     S_ChannelSetup();
 
+    if(S_MixThreadActive()) {
+        S_MixClearChannels();
+    }
+
     s_rawend = 0;
 
     if(dma.samplebits == 8) {
@@ -871,9 +932,7 @@ void SOrig_AddLoopingSound(sint entityNum, const vec3_t origin,
 
     sfx = &s_knownSfx[ sfxHandle ];
 
-    if(sfx->inMemory == false) {
-        S_memoryLoad(sfx);
-    }
+    S_TouchSfx(sfx);
 
     if(!sfx->soundLength) {
         common->Error(ERR_DROP, "%s has length 0", sfx->soundName);
@@ -949,9 +1008,7 @@ void SOrig_AddRealLoopingSound(sint entityNum, const vec3_t origin,
 
     sfx = &s_knownSfx[ sfxHandle ];
 
-    if(sfx->inMemory == false) {
-        S_memoryLoad(sfx);
-    }
+    S_TouchSfx(sfx);
 
     if(!sfx->soundLength) {
         common->Error(ERR_DROP, "%s has length 0", sfx->soundName);
@@ -1059,12 +1116,21 @@ void S_AddLoopSounds(void) {
         ch->doppler = loop->doppler;
         ch->dopplerScale = loop->dopplerScale;
         ch->oldDopplerScale = loop->oldDopplerScale;
+        ch->stream = 0;
+
+        if(loop->sfx->soundCompressionMethod == SND_COMPRESSION_STREAM) {
+            ch->stream = S_LoopSfxStream(loop->sfx);
+        }
+
         numLoopChannels++;
 
         if(numLoopChannels == MAX_CHANNELS) {
-            return;
+            break;
         }
     }
+
+    // loop streams nothing played this frame are closed
+    S_ReleaseLoopStreams();
 }
 
 //=============================================================================
@@ -1118,7 +1184,7 @@ Music streaming
 */
 void SOrig_RawSamples(sint stream, sint samples, sint rate, sint width,
                       sint s_channels, const uchar8 *data, float32 volume, sint entityNum) {
-    sint i, src, dst, intVolume;
+    sint i, src, dst, intVolume, rawend;
     float32 scale;
 
     if(!s_soundStarted || s_soundMuted) {
@@ -1127,13 +1193,17 @@ void SOrig_RawSamples(sint stream, sint samples, sint rate, sint width,
 
     intVolume = 256 * volume;
 
-    if(s_rawend < s_soundtime) {
+    // the mixer may be reading the ring while this runs, so s_rawend is
+    // only moved once the new samples are in place
+    rawend = s_rawend;
+
+    if(rawend < s_soundtime) {
         if(developer->integer) {
-            common->Printf("S_RawSamples: resetting minimum: %i < %i\n", s_rawend,
-                           s_soundtime);
+            common->Printf("S_RawSamples: resetting minimum: %i < %i\n", rawend,
+                           s_soundtime.load());
         }
 
-        s_rawend = s_soundtime;
+        rawend = s_soundtime;
     }
 
     scale = static_cast<float32>(rate) / dma.speed;
@@ -1143,8 +1213,8 @@ void SOrig_RawSamples(sint stream, sint samples, sint rate, sint width,
         if(scale == 1.0) {
             // optimized case
             for(i = 0 ; i < samples ; i++) {
-                dst = s_rawend & (MAX_RAW_SAMPLES - 1);
-                s_rawend++;
+                dst = rawend & (MAX_RAW_SAMPLES - 1);
+                rawend++;
                 s_rawsamples[dst].left = (const_cast<schar16 *>
                                           (reinterpret_cast<const schar16 *>(data)))[i * 2] * intVolume;
                 s_rawsamples[dst].right = (const_cast<schar16 *>
@@ -1158,8 +1228,8 @@ void SOrig_RawSamples(sint stream, sint samples, sint rate, sint width,
                     break;
                 }
 
-                dst = s_rawend & (MAX_RAW_SAMPLES - 1);
-                s_rawend++;
+                dst = rawend & (MAX_RAW_SAMPLES - 1);
+                rawend++;
                 s_rawsamples[dst].left = (const_cast<schar16 *>
                                           (reinterpret_cast<const schar16 *>(data)))[src * 2] * intVolume;
                 s_rawsamples[dst].right = (const_cast<schar16 *>
@@ -1174,8 +1244,8 @@ void SOrig_RawSamples(sint stream, sint samples, sint rate, sint width,
                 break;
             }
 
-            dst = s_rawend & (MAX_RAW_SAMPLES - 1);
-            s_rawend++;
+            dst = rawend & (MAX_RAW_SAMPLES - 1);
+            rawend++;
             s_rawsamples[dst].left = (const_cast<schar16 *>
                                       (reinterpret_cast<const schar16 *>(data)))[src] * intVolume;
             s_rawsamples[dst].right = (const_cast<schar16 *>
@@ -1191,8 +1261,8 @@ void SOrig_RawSamples(sint stream, sint samples, sint rate, sint width,
                 break;
             }
 
-            dst = s_rawend & (MAX_RAW_SAMPLES - 1);
-            s_rawend++;
+            dst = rawend & (MAX_RAW_SAMPLES - 1);
+            rawend++;
             s_rawsamples[dst].left = (const_cast<valueType *>
                                       (reinterpret_cast<pointer>(data)))[src * 2] * intVolume;
             s_rawsamples[dst].right = (const_cast<valueType *>
@@ -1208,8 +1278,8 @@ void SOrig_RawSamples(sint stream, sint samples, sint rate, sint width,
                 break;
             }
 
-            dst = s_rawend & (MAX_RAW_SAMPLES - 1);
-            s_rawend++;
+            dst = rawend & (MAX_RAW_SAMPLES - 1);
+            rawend++;
             s_rawsamples[dst].left = (const_cast<uchar8 *>
                                       (reinterpret_cast<const uchar8 *>(data))[src] - 128) * intVolume;
             s_rawsamples[dst].right = (const_cast<uchar8 *>
@@ -1217,10 +1287,12 @@ void SOrig_RawSamples(sint stream, sint samples, sint rate, sint width,
         }
     }
 
-    if(s_rawend > s_soundtime + MAX_RAW_SAMPLES) {
+    s_rawend = rawend;
+
+    if(rawend > s_soundtime + MAX_RAW_SAMPLES) {
         if(developer->integer) {
-            common->Printf("S_RawSamples: overflowed %i > %i\n", s_rawend,
-                           s_soundtime);
+            common->Printf("S_RawSamples: overflowed %i > %i\n", rawend,
+                           s_soundtime.load());
         }
     }
 }
@@ -1253,7 +1325,7 @@ Change the volumes of all the playing sounds for changes in their positions
 */
 void SOrig_Respatialize(sint entityNum, const vec3_t head, vec3_t axis[3],
                         sint inwater) {
-    sint i;
+    sint i, left, right;
     channel_t *ch;
     vec3_t origin;
 
@@ -1275,6 +1347,9 @@ void SOrig_Respatialize(sint entityNum, const vec3_t head, vec3_t axis[3],
             continue;
         }
 
+        left = ch->leftvol;
+        right = ch->rightvol;
+
         // anything coming from the view entity will always be full volume
         if(ch->entnum == listener_number) {
             ch->leftvol = ch->master_vol;
@@ -1288,10 +1363,18 @@ void SOrig_Respatialize(sint entityNum, const vec3_t head, vec3_t axis[3],
 
             S_SpatializeOrigin(origin, ch->master_vol, &ch->leftvol, &ch->rightvol);
         }
+
+        if(S_MixThreadActive() && (ch->leftvol != left || ch->rightvol != right)) {
+            S_MixChannelVolume(ch);
+        }
     }
 
     // add loopsounds
     S_AddLoopSounds();
+
+    if(S_MixThreadActive()) {
+        S_MixLoopChannels();
+    }
 }
 
 
@@ -1351,6 +1434,9 @@ void SOrig_Update(void) {
         return;
     }
 
+    // free the channels the mixer thread is done with
+    S_MixDrainEvents();
+
     //
     // debugging output
     //
@@ -1366,14 +1452,21 @@ void SOrig_Update(void) {
             }
         }
 
-        common->Printf("----(%i)---- painted: %i\n", total, s_paintedtime);
+        common->Printf("----(%i)---- painted: %i\n", total, s_paintedtime.load());
     }
 
     // add raw data from streamed samples
     S_UpdateBackgroundTrack();
 
+    // decode ahead for the streamed sound effects
+    S_UpdateStreams();
+
     // mix some sound
-    S_Update_();
+    if(S_MixThreadActive()) {
+        S_MixThreadFrame();
+    } else {
+        S_Update_();
+    }
 }
 
 /*
@@ -1402,7 +1495,13 @@ void S_GetSoundtime(void) {
         if(s_paintedtime > 0x40000000) {
             buffers = 0;
             s_paintedtime = dma.fullsamples;
-            SOrig_StopAllSounds();
+
+            // the mixer thread can't touch the game side channels
+            if(S_MixThreadActive()) {
+                S_MixRestart();
+            } else {
+                SOrig_StopAllSounds();
+            }
         }
     }
 
@@ -1458,7 +1557,11 @@ void S_Update_(void) {
 
     // clear any sound effects that end before the current time,
     // and start any new sounds
-    S_ScanChannelStarts();
+    if(S_MixThreadActive()) {
+        S_MixScanChannels();
+    } else {
+        S_ScanChannelStarts();
+    }
 
     sane = thisTime - lastTime;
 
@@ -1488,7 +1591,11 @@ void S_Update_(void) {
 
     SNDDMA_BeginPainting();
 
-    S_PaintChannels(endtime);
+    if(S_MixThreadActive()) {
+        S_MixPaintChannels(endtime);
+    } else {
+        S_PaintChannels(endtime, s_channels, loop_channels, numLoopChannels);
+    }
 
     SNDDMA_Submit();
 
@@ -1563,12 +1670,13 @@ S_SoundList_f
 void S_SoundList_f(void) {
     sint i, size, total;
     sfx_t *sfx;
-    valueType type[4][16], mem[2][16];
+    valueType type[5][16], mem[2][16];
 
     strcpy(type[0], "16bit");
     strcpy(type[1], "adpcm");
     strcpy(type[2], "daub4");
     strcpy(type[3], "mulaw");
+    strcpy(type[4], "strm ");
     strcpy(mem[0], "paged out");
     strcpy(mem[1], "resident ");
     total = 0;
@@ -1680,7 +1788,7 @@ void S_UpdateBackgroundTrack(void) {
 
     // see how many samples should be copied into the raw buffer
     if(s_rawend < s_soundtime) {
-        s_rawend = s_soundtime;
+        s_rawend = s_soundtime.load();
     }
 
     while(s_rawend < s_soundtime + MAX_RAW_SAMPLES) {
@@ -1737,6 +1845,37 @@ void S_UpdateBackgroundTrack(void) {
     }
 }
 
+/*
+======================
+S_FreeSoundData
+======================
+*/
+static void S_FreeSoundData(sfx_t *sfx) {
+    sndBuffer *buffer, *nbuffer;
+
+    if(S_MixThreadActive()) {
+        S_MixForgetSfx(sfx);
+    }
+
+    S_CloseSfxStreams(sfx);
+
+    buffer = sfx->soundData;
+
+    while(buffer != nullptr) {
+        nbuffer = buffer->next;
+        SND_free(buffer);
+        buffer = nbuffer;
+    }
+
+    if(sfx->soundPCM) {
+        SND_freePCM(sfx->soundPCM);
+    }
+
+    sfx->inMemory = false;
+    sfx->soundData = nullptr;
+    sfx->soundPCM = nullptr;
+}
+
 /*
 ======================
 S_FreeOldestSound
@@ -1745,7 +1884,23 @@ S_FreeOldestSound
 bool S_FreeOldestSound(void) {
     sint i, oldest, used;
     sfx_t *sfx;
-    sndBuffer  *buffer, *nbuffer;
+    static bool playing[MAX_SFX];
+
+    // anything a channel or a loop still refers to stays resident, paging
+    // it out would only silence it or have it loaded again next frame
+    ::memset(playing, 0, s_numSfx * sizeof(bool));
+
+    for(i = 0; i < MAX_CHANNELS; i++) {
+        if(s_channels[i].thesfx) {
+            playing[ARRAY_INDEX(s_knownSfx, s_channels[i].thesfx)] = true;
+        }
+    }
+
+    for(i = 0; i < MAX_GENTITIES; i++) {
+        if(loopSounds[i].active && loopSounds[i].sfx) {
+            playing[ARRAY_INDEX(s_knownSfx, loopSounds[i].sfx)] = true;
+        }
+    }
 
     oldest = common->Milliseconds();
     used = 0;
@@ -1753,7 +1908,9 @@ bool S_FreeOldestSound(void) {
     for(i = 1 ; i < s_numSfx ; i++) {
         sfx = &s_knownSfx[i];
 
-        if(sfx->inMemory && sfx->lastTimeUsed < oldest) {
+        // streamed sounds hold no sound memory
+        if(sfx->inMemory && sfx->lastTimeUsed < oldest && !playing[i] &&
+                sfx->soundCompressionMethod != SND_COMPRESSION_STREAM) {
             used = i;
             oldest = sfx->lastTimeUsed;
         }
@@ -1770,16 +1927,7 @@ bool S_FreeOldestSound(void) {
         common->Printf("S_FreeOldestSound: freeing sound %s\n", sfx->soundName);
     }
 
-    buffer = sfx->soundData;
-
-    while(buffer != nullptr) {
-        nbuffer = buffer->next;
-        SND_free(buffer);
-        buffer = nbuffer;
-    }
-
-    sfx->inMemory = false;
-    sfx->soundData = nullptr;
+    S_FreeSoundData(sfx);
 
     return true;
 }
@@ -1833,7 +1981,7 @@ void idSoundSystemLocal::Reload(void) {
     soundSystem->StopAllSounds();
 
     for(sfx = s_knownSfx, i = 0; i < s_numSfx; i++, sfx++) {
-        sfx->inMemory = false;
+        S_FreeSoundData(sfx);
         S_memoryLoad(sfx);
     }
 }
@@ -37,6 +37,7 @@
 #define SND_CHUNK_SIZE          1024                    // samples
 #define SND_CHUNK_SIZE_FLOAT    (SND_CHUNK_SIZE/2)      // floats
 #define SND_CHUNK_SIZE_BYTE     (SND_CHUNK_SIZE*2)      // floats
+#define SND_COMPRESSION_STREAM  4                       // decoded from disk while playing
 
 typedef struct {
     sint left;  // the final values will be clamped to +/- 0x00ffff00 and shifted down
@@ -56,7 +57,8 @@ typedef struct sndBuffer_s {
 } sndBuffer;
 
 typedef struct sfx_s {
-    sndBuffer *soundData;
+    sndBuffer *soundData; // compressed formats only
+    schar16 *soundPCM; // uncompressed samples, stored contiguously
     bool defaultSound; // couldn't be loaded, so use buzz
     bool inMemory; // not in Memory
     bool soundCompressed; // not in Memory
@@ -68,6 +70,12 @@ typedef struct sfx_s {
     struct sfx_s *next;
 } sfx_t;
 
+// the mixer has something to paint from
+static ID_INLINE bool S_SfxHasSamples(const sfx_t *sfx) {
+    return sfx->soundData || sfx->soundPCM ||
+           sfx->soundCompressionMethod == SND_COMPRESSION_STREAM;
+}
+
 typedef struct {
     sint channels;
     sint samples; // mono samples in buffer
@@ -108,6 +116,7 @@ typedef struct {
     bool fixed_origin; // use origin instead of fetching entnum's origin
     sfx_t *thesfx; // sfx structure
     bool doppler;
+    sint stream; // 1 based sfx stream slot, 0 for sounds held in memory
 } channel_t;
 
 #define WAV_FORMAT_PCM      1
@@ -148,8 +157,10 @@ extern channel_t s_channels[MAX_CHANNELS];
 extern channel_t loop_channels[MAX_CHANNELS];
 extern sint numLoopChannels;
 
-extern sint s_paintedtime;
-extern sint s_rawend;
+// written by whichever thread mixes, see s_mixThread
+extern std::atomic<sint> s_soundtime;
+extern std::atomic<sint> s_paintedtime;
+extern std::atomic<sint> s_rawend;
 extern vec3_t listener_forward;
 extern vec3_t listener_right;
 extern vec3_t listener_up;
@@ -162,12 +173,59 @@ extern  portable_samplepair_t   s_rawsamples[MAX_RAW_SAMPLES];
 
 bool S_LoadSound(sfx_t *sfx);
 
+typedef struct {
+    sint64 peak;                // most bytes ever held
+    sint64 evictedBytes;
+    sint evictions;             // sounds paged out to stay in budget
+    sint reloads;               // plays that had to load a paged out sound
+    sint hits;                  // plays of a sound that was still resident
+} sndCacheStats_t;
+
+extern sndCacheStats_t sndCacheStats;
+
+void SND_CacheInfo(void);
 void SND_free(sndBuffer *v);
 sndBuffer *SND_malloc(void);
+schar16 *SND_mallocPCM(sint samples);
+void SND_freePCM(schar16 *samples);
 void SND_setup(void);
 void SND_shutdown(void);
 
-void S_PaintChannels(sint endtime);
+void S_InitMixer(void);
+void S_PaintChannels(sint endtime, channel_t *channels, channel_t *loops,
+                     sint numLoops);
+void S_Update_(void);
+void S_ChannelFree(channel_t *v);
+
+// mixer thread
+bool S_MixThreadActive(void);
+void S_StartMixThread(void);
+void S_StopMixThread(void);
+void S_MixStartChannel(channel_t *ch);
+void S_MixChannelVolume(channel_t *ch);
+void S_MixLoopChannels(void);
+void S_MixClearChannels(void);
+void S_MixForgetSfx(sfx_t *sfx);
+void S_MixForgetStream(sint stream);
+void S_MixScanChannels(void);
+void S_MixPaintChannels(sint endtime);
+void S_MixRestart(void);
+void S_MixDrainEvents(void);
+void S_MixThreadFrame(void);
+
+// streamed sounds
+sint S_OpenSfxStream(sfx_t *sfx, bool loop);
+void S_CloseSfxStream(sint stream);
+void S_CloseSfxStreams(const sfx_t *sfx);
+sint S_LoopSfxStream(sfx_t *sfx);
+void S_ReleaseLoopStreams(void);
+void S_UpdateStreams(void);
+void S_StreamPaintBegin(const channel_t *channels, const channel_t *loops,
+                        sint numLoops, sint paintedtime);
+sint S_StreamRun(sint stream, sint offset, sint count,
+                 const schar16 **samples);
+sint S_StreamLoopStart(sint stream);
+void S_StreamInfo(void);
 
 void S_memoryLoad(sfx_t *sfx);
 portable_samplepair_t *S_GetRawSamplePointer(void);
@@ -40,15 +40,75 @@ memory management
 ===============================================================================
 */
 
-static sndBuffer *buffer = nullptr;
 static sndBuffer *freelist = nullptr;
-static sint inUse = 0;
-static sint totalInUse = 0;
 
 schar16 *sfxScratchBuffer = nullptr;
 sfx_t *sfxScratchPointer = nullptr;
 sint    sfxScratchIndex = 0;
 
+// compressed sounds are built from chunks, which are carved out of blocks
+// that are only given back at shutdown
+#define SND_CHUNKS_PER_BLOCK    256
+
+typedef struct chunkBlock_s {
+    struct chunkBlock_s *next;
+    sint64 pad;
+} chunkBlock_t;
+
+static chunkBlock_t *chunkBlocks = nullptr;
+
+// uncompressed sounds get one contiguous block each, so the mixer never
+// has to follow a chunk list; the header keeps them all freeable at shutdown
+typedef struct pcmHeader_s {
+    struct pcmHeader_s *prev, *next;
+    sint64 size;
+    sint64 pad; // keeps the samples 16 byte aligned
+} pcmHeader_t;
+
+static pcmHeader_t pcmBlocks;
+
+// chunks and pcm blocks share one budget, S_FreeOldestSound pages out
+// the least recently used sound that isn't playing when it runs out
+static sint64 chunkInUse = 0;
+static sint64 pcmInUse = 0;
+static sint64 cacheBudget = 0;
+
+sndCacheStats_t sndCacheStats;
+
+/*
+===============
+SND_CacheReserve
+
+Pages out sounds until size more bytes fit the budget. When everything
+left is playing the budget is overrun instead of failing the load.
+===============
+*/
+static void SND_CacheReserve(sint64 size) {
+    sint64 used;
+
+    while(chunkInUse + pcmInUse + size > cacheBudget) {
+        used = chunkInUse + pcmInUse;
+
+        if(!S_FreeOldestSound()) {
+            break;
+        }
+
+        sndCacheStats.evictions++;
+        sndCacheStats.evictedBytes += used - (chunkInUse + pcmInUse);
+    }
+}
+
+/*
+===============
+SND_CachePeak
+===============
+*/
+static void SND_CachePeak(void) {
+    if(chunkInUse + pcmInUse > sndCacheStats.peak) {
+        sndCacheStats.peak = chunkInUse + pcmInUse;
+    }
+}
+
 /*
 ===============
 SND_free
@@ -57,7 +117,35 @@ SND_free
 void SND_free(sndBuffer *v) {
     *(sndBuffer **)v = freelist;
     freelist = (sndBuffer *)v;
-    inUse += sizeof(sndBuffer);
+    chunkInUse -= sizeof(sndBuffer);
+}
+
+/*
+===============
+SND_GrowChunks
+===============
+*/
+static void SND_GrowChunks(void) {
+    chunkBlock_t *block;
+    sndBuffer *chunks;
+    sint i;
+
+    block = static_cast<chunkBlock_t *>(::malloc(sizeof(chunkBlock_t) +
+                                        SND_CHUNKS_PER_BLOCK * sizeof(sndBuffer)));
+
+    if(!block) {
+        common->Error(ERR_FATAL, "SND_malloc: out of memory");
+    }
+
+    block->next = chunkBlocks;
+    chunkBlocks = block;
+
+    chunks = reinterpret_cast<sndBuffer *>(block + 1);
+
+    for(i = 0; i < SND_CHUNKS_PER_BLOCK; i++) {
+        *(sndBuffer **)&chunks[i] = freelist;
+        freelist = &chunks[i];
+    }
 }
 
 /*
@@ -67,15 +155,15 @@ SND_malloc
 */
 sndBuffer *SND_malloc(void) {
     sndBuffer *v;
-redo:
+
+    SND_CacheReserve(sizeof(sndBuffer));
 
     if(freelist == nullptr) {
-        S_FreeOldestSound();
-        goto redo;
+        SND_GrowChunks();
     }
 
-    inUse -= sizeof(sndBuffer);
-    totalInUse += sizeof(sndBuffer);
+    chunkInUse += sizeof(sndBuffer);
+    SND_CachePeak();
 
     v = freelist;
     freelist = *(sndBuffer **)freelist;
@@ -83,9 +171,79 @@ redo:
     return v;
 }
 
+/*
+===============
+SND_mallocPCM
+===============
+*/
+schar16 *SND_mallocPCM(sint samples) {
+    pcmHeader_t *block;
+    sint64 size;
+
+    size = static_cast<sint64>(samples) * sizeof(schar16);
+
+    SND_CacheReserve(size);
+
+    block = static_cast<pcmHeader_t *>(::malloc(sizeof(pcmHeader_t) + size));
+
+    if(!block) {
+        common->Error(ERR_FATAL, "SND_mallocPCM: failed on %i samples",
+                      samples);
+    }
+
+    block->size = size;
+    block->prev = &pcmBlocks;
+    block->next = pcmBlocks.next;
+    block->next->prev = block;
+    pcmBlocks.next = block;
+
+    pcmInUse += size;
+    SND_CachePeak();
+
+    return reinterpret_cast<schar16 *>(block + 1);
+}
+
+/*
+===============
+SND_freePCM
+===============
+*/
+void SND_freePCM(schar16 *samples) {
+    pcmHeader_t *block;
+
+    block = reinterpret_cast<pcmHeader_t *>(samples) - 1;
+    block->prev->next = block->next;
+    block->next->prev = block->prev;
+
+    pcmInUse -= block->size;
+
+    ::free(block);
+}
+
 void SND_shutdown(void) {
+    pcmHeader_t *block, *next;
+    chunkBlock_t *chunks, *nextChunks;
+
+    if(pcmBlocks.next) {
+        for(block = pcmBlocks.next; block != &pcmBlocks; block = next) {
+            next = block->next;
+            ::free(block);
+        }
+    }
+
+    pcmBlocks.next = pcmBlocks.prev = &pcmBlocks;
+    pcmInUse = 0;
+
+    for(chunks = chunkBlocks; chunks; chunks = nextChunks) {
+        nextChunks = chunks->next;
+        ::free(chunks);
+    }
+
+    chunkBlocks = nullptr;
+    freelist = nullptr;
+    chunkInUse = 0;
+
     free(sfxScratchBuffer);
-    free(buffer);
 }
 
 /*
@@ -94,33 +252,24 @@ SND_setup
 ===============
 */
 void SND_setup(void) {
-    sndBuffer *p, * q;
     convar_t *cv;
-    sint scs;
 
     cv = cvarSystem->Get("com_soundMegs", DEF_COMSOUNDMEGS,
                          CVAR_LATCH | CVAR_ARCHIVE,
                          "Sets the amount of memory (MB) to allocate for loaded sound files");
 
-    inUse = cv->integer * 1024 * 1024;
-    scs = inUse / sizeof(sndBuffer);
+    cacheBudget = static_cast<sint64>(cv->integer) * 1024 * 1024;
+
+    pcmBlocks.next = pcmBlocks.prev = &pcmBlocks;
+    pcmInUse = 0;
+    chunkInUse = 0;
+    ::memset(&sndCacheStats, 0, sizeof(sndCacheStats));
 
-    buffer = static_cast<sndBuffer *>(::malloc(scs * sizeof(sndBuffer)));
     // allocate the stack based hunk allocator
     sfxScratchBuffer = static_cast<schar16 *>(::malloc(SND_CHUNK_SIZE * sizeof(
                            schar16) * 4));
     sfxScratchPointer = nullptr;
 
-    p = buffer;
-    q = p + scs;
-
-    while(--q > p) {
-        *(sndBuffer **)q = q - 1;
-    }
-
-    *(sndBuffer **)q = nullptr;
-    freelist = p + scs - 1;
-
     common->Printf("Sound memory manager started\n");
 }
 
@@ -133,9 +282,9 @@ resample / decimate to the current source rate
 */
 static void ResampleSfx(sfx_t *sfx, sint inrate, sint inwidth,
                         uchar8 *data, bool compressed) {
-    sint outcount, srcsample, i, sample, samplefrac, fracstep, part;
+    sint outcount, srcsample, i, sample, samplefrac, fracstep;
     float32 stepscale;
-    sndBuffer  *chunk;
+    schar16 *out;
 
     stepscale = static_cast< float32>(inrate) /
                 dma.speed;   // this is usually 0.5, 1, or 2
@@ -145,7 +294,7 @@ static void ResampleSfx(sfx_t *sfx, sint inrate, sint inwidth,
 
     samplefrac = 0;
     fracstep = stepscale * 256;
-    chunk = sfx->soundData;
+    out = sfx->soundPCM = SND_mallocPCM(outcount);
 
     for(i = 0 ; i < outcount ; i++) {
         srcsample = samplefrac >> 8;
@@ -158,22 +307,7 @@ static void ResampleSfx(sfx_t *sfx, sint inrate, sint inwidth,
                                        8);
         }
 
-        part  = (i & (SND_CHUNK_SIZE - 1));
-
-        if(part == 0) {
-            sndBuffer  *newchunk;
-            newchunk = SND_malloc();
-
-            if(chunk == nullptr) {
-                sfx->soundData = newchunk;
-            } else {
-                chunk->next = newchunk;
-            }
-
-            chunk = newchunk;
-        }
-
-        chunk->sndChunk[part] = sample;
+        out[i] = sample;
     }
 }
 
@@ -226,21 +360,52 @@ bool S_LoadSound(sfx_t *sfx) {
     uchar8 *data;
     schar16 *samples;
     snd_info_t  info;
-    //sint      size;
+    snd_stream_t *stream;
+    float32 stepscale;
+    sint length;
+    idScratchScope scratch;
 
     // player specific sounds are never directly loaded
     if(sfx->soundName[0] == '*') {
         return false;
     }
 
-    // load it in
-    data = static_cast<uchar8 *>(soundSystemLocal.codec_load(sfx->soundName,
-                                 &info));
+    stream = soundSystemLocal.codec_open(sfx->soundName);
 
-    if(!data) {
+    if(!stream) {
         return false;
     }
 
+    info = stream->info;
+
+    // long sounds are decoded while they play, the header is enough here
+    if(s_streamSize->integer > 0) {
+        stepscale = static_cast<float32>(info.rate) / dma.speed;
+        length = info.samples / stepscale;
+
+        if(length * static_cast<sint>(sizeof(schar16)) >
+                s_streamSize->integer * 1024) {
+            soundSystemLocal.codec_close(stream);
+
+            sfx->soundCompressionMethod = SND_COMPRESSION_STREAM;
+            sfx->soundLength = length;
+            sfx->soundData = nullptr;
+            sfx->soundPCM = nullptr;
+            sfx->lastTimeUsed = common->Milliseconds() + 1;
+            return true;
+        }
+    }
+
+    // load it in from the stream that is open already
+    data = static_cast<uchar8 *>(scratch.Alloc(info.size));
+
+    if(soundSystemLocal.codec_read(stream, info.size, data) <= 0) {
+        soundSystemLocal.codec_close(stream);
+        return false;
+    }
+
+    soundSystemLocal.codec_close(stream);
+
     if(info.width == 1) {
         if(developer->integer) {
             common->Printf(S_COLOR_YELLOW "WARNING: %s is a 8 bit wav file\n",
@@ -255,8 +420,9 @@ bool S_LoadSound(sfx_t *sfx) {
         }
     }
 
-    samples = static_cast<schar16 *>(memorySystem->AllocateTempMemory(
-                                         info.samples * sizeof(schar16) * 2));
+    // only needed until the sound is encoded
+    samples = static_cast<schar16 *>(scratch.Alloc(info.samples * sizeof(
+                                         schar16) * 2));
 
     sfx->lastTimeUsed = common->Milliseconds() + 1;
 
@@ -290,21 +456,38 @@ bool S_LoadSound(sfx_t *sfx) {
         sfx->soundCompressionMethod = 0;
         sfx->soundLength = info.samples;
         sfx->soundData = nullptr;
+        sfx->soundPCM = nullptr;
         ResampleSfx(sfx, info.rate, info.width, data + info.dataofs, false);
     }
 
-    memorySystem->FreeTempMemory(samples);
-    memorySystem->FreeTempMemory(data);
-
     return true;
 }
 
+/*
+===============
+SND_CacheInfo
+===============
+*/
+void SND_CacheInfo(void) {
+    common->Printf("%5d KB of %d KB sound memory used "
+                   "(%d KB chunks, %d KB pcm), peak %d KB\n",
+                   static_cast<sint>((chunkInUse + pcmInUse) / 1024),
+                   static_cast<sint>(cacheBudget / 1024),
+                   static_cast<sint>(chunkInUse / 1024),
+                   static_cast<sint>(pcmInUse / 1024),
+                   static_cast<sint>(sndCacheStats.peak / 1024));
+    common->Printf("%5d sounds paged out (%d KB), %d paged back in, "
+                   "%d plays resident\n",
+                   sndCacheStats.evictions,
+                   static_cast<sint>(sndCacheStats.evictedBytes / 1024),
+                   sndCacheStats.reloads, sndCacheStats.hits);
+}
+
 /*
 ===============
 idSoundSystemLocal::DisplayFreeMemory
 ===============
 */
 void idSoundSystemLocal::DisplayFreeMemory(void) {
-    common->Printf("%d bytes free sound buffer memory, %d total used\n", inUse,
-                   totalInUse);
-}
\ No newline at end of file
+    SND_CacheInfo();
+}
@@ -38,6 +38,190 @@ sint     *snd_p;
 sint      snd_linear_count;
 schar16   *snd_out;
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SND_SIMD
+
+// AVX2 kernels are built without -mavx2 and only called after a cpu check
+#if defined(__GNUC__) || defined(__clang__)
+#define SND_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SND_TARGET_AVX2
+#endif
+#endif
+
+typedef void (*mixMono16_t)(portable_samplepair_t *samp,
+                            const schar16 *samples, sint count, sint leftvol, sint rightvol);
+
+static mixMono16_t snd_mixMono16;
+#ifdef SND_SIMD
+static bool snd_hasAVX2;
+#endif
+
+/*
+===============================================================================
+
+MIXING KERNELS
+
+Every kernel must give the same result as the scalar version, so that
+s_mixSIMD can be toggled while sounds are playing
+===============================================================================
+*/
+
+/*
+===============
+S_MixMono16
+
+Adds a run of contiguous 16 bit samples to the paint buffer
+===============
+*/
+static void S_MixMono16(portable_samplepair_t *samp, const schar16 *samples,
+                        sint count, sint leftvol, sint rightvol) {
+    sint i, data;
+
+    for(i = 0 ; i < count ; i++) {
+        data = samples[i];
+        samp[i].left += (data * leftvol) >> 8;
+        samp[i].right += (data * rightvol) >> 8;
+    }
+}
+
+#ifdef SND_SIMD
+/*
+===============
+S_MixMono16_SSE2
+
+SSE2 has no 32 bit multiply, so the volume is applied as a 16x16 multiply
+with both product halves recombined. Volumes of 32768 and up wrap to
+negative, which is undone by adding the sample back in at bit 16.
+===============
+*/
+static void S_MixMono16_SSE2(portable_samplepair_t *samp,
+                             const schar16 *samples, sint count, sint leftvol, sint rightvol) {
+    sint i;
+    __m128i s, slo, shi, plo, phi, l0, l1, r0, r1, out;
+    const __m128i lv = _mm_set1_epi16(static_cast<schar16>(leftvol));
+    const __m128i rv = _mm_set1_epi16(static_cast<schar16>(rightvol));
+    const __m128i lfix = _mm_set1_epi32(leftvol >= 32768 ? -1 : 0);
+    const __m128i rfix = _mm_set1_epi32(rightvol >= 32768 ? -1 : 0);
+    sint *dst = reinterpret_cast<sint *>(samp);
+
+    // the 16 bit trick only holds for volumes that fit in 16 bits
+    if(leftvol < 0 || leftvol > 65535 || rightvol < 0 || rightvol > 65535) {
+        S_MixMono16(samp, samples, count, leftvol, rightvol);
+        return;
+    }
+
+    for(i = 0 ; i + 8 <= count ; i += 8) {
+        s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + i));
+
+        // sign extended samples, pre shifted for the wrap fixup
+        slo = _mm_slli_epi32(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16), 16);
+        shi = _mm_slli_epi32(_mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16), 16);
+
+        plo = _mm_mullo_epi16(s, lv);
+        phi = _mm_mulhi_epi16(s, lv);
+        l0 = _mm_add_epi32(_mm_unpacklo_epi16(plo, phi), _mm_and_si128(slo, lfix));
+        l1 = _mm_add_epi32(_mm_unpackhi_epi16(plo, phi), _mm_and_si128(shi, lfix));
+        l0 = _mm_srai_epi32(l0, 8);
+        l1 = _mm_srai_epi32(l1, 8);
+
+        plo = _mm_mullo_epi16(s, rv);
+        phi = _mm_mulhi_epi16(s, rv);
+        r0 = _mm_add_epi32(_mm_unpacklo_epi16(plo, phi), _mm_and_si128(slo, rfix));
+        r1 = _mm_add_epi32(_mm_unpackhi_epi16(plo, phi), _mm_and_si128(shi, rfix));
+        r0 = _mm_srai_epi32(r0, 8);
+        r1 = _mm_srai_epi32(r1, 8);
+
+        out = _mm_loadu_si128(reinterpret_cast<__m128i *>(dst + i * 2));
+        out = _mm_add_epi32(out, _mm_unpacklo_epi32(l0, r0));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 2), out);
+
+        out = _mm_loadu_si128(reinterpret_cast<__m128i *>(dst + i * 2 + 4));
+        out = _mm_add_epi32(out, _mm_unpackhi_epi32(l0, r0));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 2 + 4), out);
+
+        out = _mm_loadu_si128(reinterpret_cast<__m128i *>(dst + i * 2 + 8));
+        out = _mm_add_epi32(out, _mm_unpacklo_epi32(l1, r1));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 2 + 8), out);
+
+        out = _mm_loadu_si128(reinterpret_cast<__m128i *>(dst + i * 2 + 12));
+        out = _mm_add_epi32(out, _mm_unpackhi_epi32(l1, r1));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 2 + 12), out);
+    }
+
+    S_MixMono16(samp + i, samples + i, count - i, leftvol, rightvol);
+}
+
+/*
+===============
+S_MixMono16_AVX2
+===============
+*/
+SND_TARGET_AVX2 static void S_MixMono16_AVX2(portable_samplepair_t *samp,
+        const schar16 *samples, sint count, sint leftvol, sint rightvol) {
+    sint i;
+    __m256i s, l, r, lo, hi, out;
+    const __m256i lv = _mm256_set1_epi32(leftvol);
+    const __m256i rv = _mm256_set1_epi32(rightvol);
+    sint *dst = reinterpret_cast<sint *>(samp);
+
+    for(i = 0 ; i + 8 <= count ; i += 8) {
+        s = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>
+                                  (samples + i)));
+        l = _mm256_srai_epi32(_mm256_mullo_epi32(s, lv), 8);
+        r = _mm256_srai_epi32(_mm256_mullo_epi32(s, rv), 8);
+
+        // unpack works per 128 bit lane, so swap the middle halves back
+        lo = _mm256_unpacklo_epi32(l, r);
+        hi = _mm256_unpackhi_epi32(l, r);
+
+        out = _mm256_loadu_si256(reinterpret_cast<__m256i *>(dst + i * 2));
+        out = _mm256_add_epi32(out, _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 2), out);
+
+        out = _mm256_loadu_si256(reinterpret_cast<__m256i *>(dst + i * 2 + 8));
+        out = _mm256_add_epi32(out, _mm256_permute2x128_si256(lo, hi, 0x31));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 2 + 8), out);
+    }
+
+    S_MixMono16(samp + i, samples + i, count - i, leftvol, rightvol);
+}
+#endif
+
+/*
+===============
+S_SelectMixKernels
+
+Checked every paint so s_mixSIMD takes effect right away
+===============
+*/
+static void S_SelectMixKernels(void) {
+    snd_mixMono16 = S_MixMono16;
+
+#ifdef SND_SIMD
+
+    if(s_mixSIMD->integer) {
+        snd_mixMono16 = snd_hasAVX2 ? S_MixMono16_AVX2 : S_MixMono16_SSE2;
+    }
+
+#endif
+}
+
+/*
+===============
+S_InitMixer
+===============
+*/
+void S_InitMixer(void) {
+#ifdef SND_SIMD
+    snd_hasAVX2 = SDL_HasAVX2() == SDL_TRUE;
+
+    common->Printf("sound mixer: %s\n", snd_hasAVX2 ? "AVX2" : "SSE2");
+#endif
+
+    S_SelectMixKernels();
+}
+
 /*
 ===============
 S_WriteLinearBlastStereo16
@@ -46,7 +230,27 @@ S_WriteLinearBlastStereo16
 void S_WriteLinearBlastStereo16(void) {
     sint i, val;
 
-    for(i = 0 ; i < snd_linear_count ; i += 2) {
+    i = 0;
+
+#ifdef SND_SIMD
+
+    // packs saturates to the same range the scalar code clamps to
+    if(s_mixSIMD->integer) {
+        __m128i a, b;
+
+        for(; i + 8 <= snd_linear_count ; i += 8) {
+            a = _mm_srai_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>
+                                               (snd_p + i)), 8);
+            b = _mm_srai_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>
+                                               (snd_p + i + 4)), 8);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(snd_out + i),
+                             _mm_packs_epi32(a, b));
+        }
+    }
+
+#endif
+
+    for(; i < snd_linear_count ; i += 2) {
         val = snd_p[i] >> 8;
 
         if(val > 0x7fff) {
@@ -219,55 +423,48 @@ CHANNEL MIXING
 /*
 ===============
 S_PaintChannelFrom16
+
+16 bit sounds are stored contiguously, so a run only breaks where
+an offset past the end of the sound wraps around to the start
 ===============
 */
 static void S_PaintChannelFrom16(channel_t *ch, const sfx_t *sc,
                                  sint count, sint sampleOffset, sint bufferOffset) {
-    sint data, aoff, boff, leftvol, rightvol, i, j;
+    sint aoff, boff, leftvol, rightvol, i, j, run, length;
     portable_samplepair_t *samp;
-    sndBuffer *chunk;
-    schar16 *samples;
+    const schar16 *samples;
     float32 ooff, fdata, fdiv, fleftvol, frightvol;
 
     samp = &paintbuffer[ bufferOffset ];
+    samples = sc->soundPCM;
+    length = sc->soundLength;
 
     if(ch->doppler) {
         sampleOffset = sampleOffset * ch->oldDopplerScale;
     }
 
-    chunk = sc->soundData;
-
-    while(sampleOffset >= SND_CHUNK_SIZE) {
-        chunk = chunk->next;
-        sampleOffset -= SND_CHUNK_SIZE;
-
-        if(!chunk) {
-            chunk = sc->soundData;
-        }
+    if(sampleOffset >= length) {
+        sampleOffset %= length;
     }
 
     if(!ch->doppler || ch->dopplerScale == 1.0f) {
         leftvol = ch->leftvol * snd_vol;
         rightvol = ch->rightvol * snd_vol;
-        samples = chunk->sndChunk;
 
-        for(i = 0 ; i < count ; i++) {
-            data  = samples[sampleOffset++];
-            samp[i].left += (data * leftvol) >> 8;
-            samp[i].right += (data * rightvol) >> 8;
+        while(count > 0) {
+            run = MIN(count, length - sampleOffset);
 
-            if(sampleOffset == SND_CHUNK_SIZE) {
-                chunk = chunk->next;
-                samples = chunk->sndChunk;
-                sampleOffset = 0;
-            }
+            snd_mixMono16(samp, samples + sampleOffset, run, leftvol, rightvol);
+
+            samp += run;
+            count -= run;
+            sampleOffset = 0;
         }
     } else {
         fleftvol = ch->leftvol * snd_vol;
         frightvol = ch->rightvol * snd_vol;
 
         ooff = sampleOffset;
-        samples = chunk->sndChunk;
 
         for(i = 0 ; i < count ; i++) {
 
@@ -277,18 +474,7 @@ static void S_PaintChannelFrom16(channel_t *ch, const sfx_t *sc,
             fdata = 0;
 
             for(j = aoff; j < boff; j++) {
-                if(j == SND_CHUNK_SIZE) {
-                    chunk = chunk->next;
-
-                    if(!chunk) {
-                        chunk = sc->soundData;
-                    }
-
-                    samples = chunk->sndChunk;
-                    ooff -= SND_CHUNK_SIZE;
-                }
-
-                fdata  += samples[j & (SND_CHUNK_SIZE - 1)];
+                fdata += samples[j < length ? j : j % length];
             }
 
             fdiv = 256 * (boff - aoff);
@@ -298,6 +484,39 @@ static void S_PaintChannelFrom16(channel_t *ch, const sfx_t *sc,
     }
 }
 
+/*
+===============
+S_PaintChannelFromStream
+
+Reads the channel's decode ring, whatever the decoder hasn't reached
+yet stays silent. Streamed sounds play without doppler.
+===============
+*/
+static void S_PaintChannelFromStream(channel_t *ch, sint count,
+                                     sint streamOffset, sint bufferOffset) {
+    sint leftvol, rightvol, run;
+    portable_samplepair_t *samp;
+    const schar16 *samples;
+
+    samp = &paintbuffer[ bufferOffset ];
+    leftvol = ch->leftvol * snd_vol;
+    rightvol = ch->rightvol * snd_vol;
+
+    while(count > 0) {
+        run = S_StreamRun(ch->stream, streamOffset, count, &samples);
+
+        if(!run) {
+            break;
+        }
+
+        snd_mixMono16(samp, samples, run, leftvol, rightvol);
+
+        samp += run;
+        count -= run;
+        streamOffset += run;
+    }
+}
+
 /*
 ===============
 S_PaintChannelFromWavelet
@@ -474,42 +693,51 @@ void S_PaintChannelFromMuLaw(channel_t *ch, sfx_t *sc, sint count,
 S_PaintChannels
 ===================
 */
-void S_PaintChannels(sint endtime) {
-    sint i, end, ltime, count, sampleOffset;
+void S_PaintChannels(sint endtime, channel_t *channels, channel_t *loops,
+                     sint numLoops) {
+    sint i, end, ltime, count, sampleOffset, paintedtime, rawend;
     channel_t *ch;
     sfx_t *sc;
 
     snd_vol = s_volume->value * 255;
 
+    S_SelectMixKernels();
+
+    S_StreamPaintBegin(channels, loops, numLoops, s_paintedtime);
+
     //common->Printf ("%i to %i\n", s_paintedtime, endtime);
     while(s_paintedtime < endtime) {
+        // the game thread may move s_rawend while this runs
+        paintedtime = s_paintedtime;
+        rawend = s_rawend;
+
         // if paintbuffer is smaller than DMA buffer
         // we may need to fill it multiple times
         end = endtime;
 
-        if(endtime - s_paintedtime > PAINTBUFFER_SIZE) {
-            end = s_paintedtime + PAINTBUFFER_SIZE;
+        if(endtime - paintedtime > PAINTBUFFER_SIZE) {
+            end = paintedtime + PAINTBUFFER_SIZE;
         }
 
         // clear the paint buffer to either music or zeros
-        if(s_rawend < s_paintedtime) {
-            if(s_rawend) {
+        if(rawend < paintedtime) {
+            if(rawend) {
                 //if (developer->integer) {
                 //common->Printf ("background sound underrun\n");
                 //}
             }
 
             ::memset(paintbuffer, 0,
-                     (end - s_paintedtime) * sizeof(portable_samplepair_t));
+                     (end - paintedtime) * sizeof(portable_samplepair_t));
         } else {
             // copy from the streaming sound source
             sint    s, stop;
 
-            stop = (end < s_rawend) ? end : s_rawend;
+            stop = (end < rawend) ? end : rawend;
 
-            for(i = s_paintedtime ; i < stop ; i++) {
+            for(i = paintedtime ; i < stop ; i++) {
                 s = i & (MAX_RAW_SAMPLES - 1);
-                paintbuffer[i - s_paintedtime] = s_rawsamples[s];
+                paintbuffer[i - paintedtime] = s_rawsamples[s];
             }
 
             //      if (i != end)
@@ -517,22 +745,27 @@ void S_PaintChannels(sint endtime) {
             //      else
             //          common->Printf ("full stream\n");
             for(; i < end ; i++) {
-                paintbuffer[i - s_paintedtime].left =
-                    paintbuffer[i - s_paintedtime].right = 0;
+                paintbuffer[i - paintedtime].left =
+                    paintbuffer[i - paintedtime].right = 0;
             }
         }
 
         // paint in the channels.
-        ch = s_channels;
+        ch = channels;
 
         for(i = 0; i < MAX_CHANNELS ; i++, ch++) {
             if(!ch->thesfx || (ch->leftvol < 0.25 && ch->rightvol < 0.25)) {
                 continue;
             }
 
-            ltime = s_paintedtime;
+            ltime = paintedtime;
             sc = ch->thesfx;
 
+            // the sound may have been paged out while it was still playing
+            if(!S_SfxHasSamples(sc)) {
+                continue;
+            }
+
             sampleOffset = ltime - ch->startSample;
             count = end - ltime;
 
@@ -543,31 +776,46 @@ void S_PaintChannels(sint endtime) {
             if(count > 0) {
                 if(sc->soundCompressionMethod == 1) {
                     S_PaintChannelFromADPCM(ch, sc, count, sampleOffset,
-                                            ltime - s_paintedtime);
+                                            ltime - paintedtime);
                 } else if(sc->soundCompressionMethod == 2) {
                     S_PaintChannelFromWavelet(ch, sc, count, sampleOffset,
-                                              ltime - s_paintedtime);
+                                              ltime - paintedtime);
                 } else if(sc->soundCompressionMethod == 3) {
                     S_PaintChannelFromMuLaw(ch, sc, count, sampleOffset,
-                                            ltime - s_paintedtime);
+                                            ltime - paintedtime);
+                } else if(sc->soundCompressionMethod == SND_COMPRESSION_STREAM) {
+                    if(ch->stream) {
+                        S_PaintChannelFromStream(ch, count, sampleOffset,
+                                                 ltime - paintedtime);
+                    }
                 } else {
-                    S_PaintChannelFrom16(ch, sc, count, sampleOffset, ltime - s_paintedtime);
+                    S_PaintChannelFrom16(ch, sc, count, sampleOffset, ltime - paintedtime);
                 }
             }
         }
 
         // paint in the looped channels.
-        ch = loop_channels;
+        ch = loops;
 
-        for(i = 0; i < numLoopChannels ; i++, ch++) {
+        for(i = 0; i < numLoops ; i++, ch++) {
             if(!ch->thesfx || (!ch->leftvol && !ch->rightvol)) {
                 continue;
             }
 
-            ltime = s_paintedtime;
+            ltime = paintedtime;
             sc = ch->thesfx;
 
-            if(sc->soundData == nullptr || sc->soundLength == 0) {
+            if(!S_SfxHasSamples(sc) || sc->soundLength == 0) {
+                continue;
+            }
+
+            // a loop stream runs on its own clock and wraps by itself
+            if(sc->soundCompressionMethod == SND_COMPRESSION_STREAM) {
+                if(ch->stream) {
+                    S_PaintChannelFromStream(ch, end - ltime,
+                                             ltime - S_StreamLoopStart(ch->stream), 0);
+                }
+
                 continue;
             }
 
@@ -586,15 +834,15 @@ void S_PaintChannels(sint endtime) {
                 if(count > 0) {
                     if(sc->soundCompressionMethod == 1) {
                         S_PaintChannelFromADPCM(ch, sc, count, sampleOffset,
-                                                ltime - s_paintedtime);
+                                                ltime - paintedtime);
                     } else if(sc->soundCompressionMethod == 2) {
                         S_PaintChannelFromWavelet(ch, sc, count, sampleOffset,
-                                                  ltime - s_paintedtime);
+                                                  ltime - paintedtime);
                     } else if(sc->soundCompressionMethod == 3) {
                         S_PaintChannelFromMuLaw(ch, sc, count, sampleOffset,
-                                                ltime - s_paintedtime);
+                                                ltime - paintedtime);
                     } else {
-                        S_PaintChannelFrom16(ch, sc, count, sampleOffset, ltime - s_paintedtime);
+                        S_PaintChannelFrom16(ch, sc, count, sampleOffset, ltime - paintedtime);
                     }
 
                     ltime += count;
@@ -0,0 +1,428 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Copyright(C) 2011 - 2023 Dusan Jocic <dusanjocic@msn.com>
+//
+// This file is part of OpenWolf.
+//
+// OpenWolf is free software; you can redistribute it
+// and / or modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the License,
+// or (at your option) any later version.
+//
+// OpenWolf is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with OpenWolf; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110 - 1301  USA
+//
+// -------------------------------------------------------------------------------------
+// File name:   sndSystem_stream.cpp
+// Created:     10/18/2026
+// Compilers:   Microsoft (R) C/C++ Optimizing Compiler Version 19.26.28806 for x64,
+//              gcc (Ubuntu 9.3.0-10ubuntu2) 9.3.0,
+//              AppleClang 9.0.0.9000039
+// Description: sound effects that are decoded from disk while they play
+// -------------------------------------------------------------------------------------
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include <framework/precompiled.hpp>
+
+/*
+===============================================================================
+
+Sounds bigger than s_streamSize are never resampled into sound memory.
+Every one shot channel playing one gets a stream of its own, and all loop
+channels of the same sound share one. A stream keeps its file open and
+decodes ahead into a ring of mono samples at the dma rate.
+
+Positions are counted in output samples from the start of the stream. A
+one shot channel reads at paint time - startSample, a loop channel at
+paint time - the loop start of its stream. The game thread decodes in
+S_UpdateStreams and is the only writer of a ring, the mixer only reads it
+and reports the oldest position it may still paint. With s_mixThread on,
+a stream is taken back from the mixer with mixLock held before it closes.
+
+===============================================================================
+*/
+
+#define MAX_SFX_STREAMS     16
+#define SFX_STREAM_SAMPLES  32768   // ring size, power of two
+#define SFX_STREAM_PREFILL  8192    // decoded before a channel starts
+#define SFX_STREAM_FRAMES   1024    // source frames per codec read
+
+typedef struct {
+    sfx_t *sfx;                 // nullptr when the slot is free
+    snd_stream_t *file;         // nullptr once a one shot reached its end
+    bool loop;
+    bool looped;                // in the loop set this frame
+    sint loopStart;             // sound time the loop stream started at
+    sint fracstep;              // source frames per output sample, 8.8 fixed
+    sint64 outSample;           // output samples written in this pass
+    sint64 srcSample;           // source frames read in this pass
+    std::atomic<sint> writePos;
+    std::atomic<sint> readPos;
+    schar16 ring[SFX_STREAM_SAMPLES];
+} sfxStream_t;
+
+static sfxStream_t sfxStreams[MAX_SFX_STREAMS];
+
+/*
+===============
+S_RewindStream
+
+The codecs can't seek, so a loop starts over by opening the file again
+===============
+*/
+static bool S_RewindStream(sfxStream_t *stream) {
+    soundSystemLocal.codec_close(stream->file);
+    stream->file = soundSystemLocal.codec_open(stream->sfx->soundName);
+    stream->outSample = 0;
+    stream->srcSample = 0;
+
+    return stream->file != nullptr;
+}
+
+/*
+===============
+S_FillStream
+
+Decodes until the ring holds target samples the mixer hasn't passed yet.
+Resampling matches ResampleSfx, a stereo file plays its first channel.
+===============
+*/
+static void S_FillStream(sfxStream_t *stream, sint target) {
+    schar16 raw[SFX_STREAM_FRAMES * 2];
+    const snd_info_t *info;
+    sint frameBytes, frames, maxOut, writePos, i, sample;
+
+    writePos = stream->writePos.load(std::memory_order_relaxed);
+
+    while(stream->file) {
+        info = &stream->file->info;
+        frameBytes = info->width * info->channels;
+
+        // never decode more than fits in front of the mixer
+        maxOut = (SFX_STREAM_FRAMES * 256) / stream->fracstep + 1;
+
+        if(writePos - stream->readPos.load(std::memory_order_acquire) + maxOut >
+                target) {
+            break;
+        }
+
+        frames = soundSystemLocal.codec_read(stream->file,
+                                             SFX_STREAM_FRAMES * frameBytes, raw) / frameBytes;
+
+        for(; stream->outSample < stream->sfx->soundLength;
+                stream->outSample++, writePos++) {
+            i = static_cast<sint>(((stream->outSample * stream->fracstep) >> 8) -
+                                  stream->srcSample);
+
+            if(i >= frames) {
+                break;
+            }
+
+            if(info->width == 2) {
+                sample = raw[i * info->channels];
+            } else {
+                sample = (reinterpret_cast<uchar8 *>(raw)[i * info->channels] - 128) *
+                         256;
+            }
+
+            stream->ring[writePos & (SFX_STREAM_SAMPLES - 1)] = sample;
+        }
+
+        stream->srcSample += frames;
+        stream->writePos.store(writePos, std::memory_order_release);
+
+        if(frames > 0 && stream->outSample < stream->sfx->soundLength) {
+            continue;
+        }
+
+        // end of the sound, an empty loop would spin forever
+        if(!stream->loop || !stream->outSample || !S_RewindStream(stream)) {
+            if(stream->file) {
+                soundSystemLocal.codec_close(stream->file);
+                stream->file = nullptr;
+            }
+        }
+    }
+}
+
+/*
+===============
+S_OpenSfxStream
+
+Returns the 1 based stream slot, or 0 when every slot is busy
+===============
+*/
+sint S_OpenSfxStream(sfx_t *sfx, bool loop) {
+    sint i;
+    sfxStream_t *stream;
+    float32 stepscale;
+
+    for(i = 0, stream = sfxStreams; i < MAX_SFX_STREAMS; i++, stream++) {
+        if(!stream->sfx) {
+            break;
+        }
+    }
+
+    if(i == MAX_SFX_STREAMS) {
+        if(developer->integer) {
+            common->Printf(S_COLOR_YELLOW "S_OpenSfxStream: no free stream for %s\n",
+                           sfx->soundName);
+        }
+
+        return 0;
+    }
+
+    stream->file = soundSystemLocal.codec_open(sfx->soundName);
+
+    if(!stream->file) {
+        return 0;
+    }
+
+    stepscale = static_cast<float32>(stream->file->info.rate) / dma.speed;
+
+    stream->sfx = sfx;
+    stream->loop = loop;
+    stream->looped = loop;
+    stream->loopStart = s_soundtime;
+    stream->fracstep = MAX(static_cast<sint>(stepscale * 256), 1);
+    stream->outSample = 0;
+    stream->srcSample = 0;
+    stream->writePos = 0;
+    stream->readPos = 0;
+
+    S_FillStream(stream, SFX_STREAM_PREFILL);
+
+    return i + 1;
+}
+
+/*
+===============
+S_CloseSfxStream
+
+The caller drops its reference to the stream
+===============
+*/
+void S_CloseSfxStream(sint stream) {
+    sfxStream_t *s;
+
+    if(stream < 1 || stream > MAX_SFX_STREAMS) {
+        return;
+    }
+
+    s = &sfxStreams[stream - 1];
+
+    if(!s->sfx) {
+        return;
+    }
+
+    if(S_MixThreadActive()) {
+        S_MixForgetStream(stream);
+    }
+
+    if(s->file) {
+        soundSystemLocal.codec_close(s->file);
+        s->file = nullptr;
+    }
+
+    s->sfx = nullptr;
+}
+
+/*
+===============
+S_CloseSfxStreams
+
+Closes every stream of sfx, or all of them for nullptr, and clears the
+channels that read from them
+===============
+*/
+void S_CloseSfxStreams(const sfx_t *sfx) {
+    sint i, j;
+    channel_t *ch;
+
+    for(i = 0; i < MAX_SFX_STREAMS; i++) {
+        if(!sfxStreams[i].sfx || (sfx && sfxStreams[i].sfx != sfx)) {
+            continue;
+        }
+
+        for(j = 0, ch = s_channels; j < MAX_CHANNELS; j++, ch++) {
+            if(ch->stream == i + 1) {
+                ch->stream = 0;
+            }
+        }
+
+        for(j = 0, ch = loop_channels; j < numLoopChannels; j++, ch++) {
+            if(ch->stream == i + 1) {
+                ch->stream = 0;
+            }
+        }
+
+        S_CloseSfxStream(i + 1);
+    }
+}
+
+/*
+===============
+S_LoopSfxStream
+
+The stream all loop channels of sfx read from this frame
+===============
+*/
+sint S_LoopSfxStream(sfx_t *sfx) {
+    sint i;
+
+    for(i = 0; i < MAX_SFX_STREAMS; i++) {
+        if(sfxStreams[i].sfx == sfx && sfxStreams[i].loop) {
+            sfxStreams[i].looped = true;
+            return i + 1;
+        }
+    }
+
+    return S_OpenSfxStream(sfx, true);
+}
+
+/*
+===============
+S_ReleaseLoopStreams
+
+Closes the loop streams no loop channel asked for since the last call
+===============
+*/
+void S_ReleaseLoopStreams(void) {
+    sint i;
+
+    for(i = 0; i < MAX_SFX_STREAMS; i++) {
+        if(!sfxStreams[i].sfx || !sfxStreams[i].loop) {
+            continue;
+        }
+
+        if(!sfxStreams[i].looped) {
+            S_CloseSfxStream(i + 1);
+        }
+
+        sfxStreams[i].looped = false;
+    }
+}
+
+/*
+===============
+S_UpdateStreams
+
+Game thread, once per S_Update before mixing
+===============
+*/
+void S_UpdateStreams(void) {
+    sint i;
+
+    for(i = 0; i < MAX_SFX_STREAMS; i++) {
+        if(sfxStreams[i].sfx && sfxStreams[i].file) {
+            S_FillStream(&sfxStreams[i], SFX_STREAM_SAMPLES);
+        }
+    }
+}
+
+/*
+===============
+S_StreamLoopStart
+===============
+*/
+sint S_StreamLoopStart(sint stream) {
+    return sfxStreams[stream - 1].loopStart;
+}
+
+/*
+===============
+S_StreamPaintBegin
+
+Every paint starts at or after the soundtime based start of the one
+before it, so nothing older than this is painted again and the decoder
+may write over it
+===============
+*/
+void S_StreamPaintBegin(const channel_t *channels, const channel_t *loops,
+                        sint numLoops, sint paintedtime) {
+    sint i, pos;
+    sfxStream_t *stream;
+
+    for(i = 0; i < MAX_CHANNELS + numLoops; i++) {
+        const channel_t *ch = i < MAX_CHANNELS ? &channels[i] :
+                              &loops[i - MAX_CHANNELS];
+
+        if(!ch->thesfx || !ch->stream) {
+            continue;
+        }
+
+        stream = &sfxStreams[ch->stream - 1];
+
+        if(i < MAX_CHANNELS) {
+            if(ch->startSample == START_SAMPLE_IMMEDIATE) {
+                continue;
+            }
+
+            pos = paintedtime - ch->startSample;
+        } else {
+            pos = paintedtime - stream->loopStart;
+        }
+
+        if(pos > stream->readPos.load(std::memory_order_relaxed)) {
+            stream->readPos.store(pos, std::memory_order_release);
+        }
+    }
+}
+
+/*
+===============
+S_StreamRun
+
+Points samples at the decoded run starting at offset and returns its
+length, 0 when the decoder hasn't got there yet
+===============
+*/
+sint S_StreamRun(sint stream, sint offset, sint count,
+                 const schar16 **samples) {
+    sfxStream_t *s;
+    sint writePos, index;
+
+    s = &sfxStreams[stream - 1];
+    writePos = s->writePos.load(std::memory_order_acquire);
+
+    if(offset < 0 || offset >= writePos ||
+            offset < writePos - SFX_STREAM_SAMPLES) {
+        return 0;
+    }
+
+    index = offset & (SFX_STREAM_SAMPLES - 1);
+    *samples = s->ring + index;
+
+    return MIN(MIN(count, writePos - offset), SFX_STREAM_SAMPLES - index);
+}
+
+/*
+===============
+S_StreamInfo
+
+s_info output
+===============
+*/
+void S_StreamInfo(void) {
+    sint i, active;
+
+    for(i = 0, active = 0; i < MAX_SFX_STREAMS; i++) {
+        if(sfxStreams[i].sfx) {
+            active++;
+        }
+    }
+
+    common->Printf("%5d of %d sound streams open\n", active, MAX_SFX_STREAMS);
+
+    for(i = 0; i < MAX_SFX_STREAMS; i++) {
+        if(sfxStreams[i].sfx) {
+            common->Printf("      %s%s\n", sfxStreams[i].sfx->soundName,
+                           sfxStreams[i].loop ? " (loop)" : "");
+        }
+    }
+}
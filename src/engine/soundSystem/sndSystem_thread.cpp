@@ -0,0 +1,586 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Copyright(C) 2011 - 2023 Dusan Jocic <dusanjocic@msn.com>
+//
+// This file is part of OpenWolf.
+//
+// OpenWolf is free software; you can redistribute it
+// and / or modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 2 of the License,
+// or (at your option) any later version.
+//
+// OpenWolf is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with OpenWolf; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110 - 1301  USA
+//
+// -------------------------------------------------------------------------------------
+// File name:   sndSystem_thread.cpp
+// Created:     10/18/2026
+// Compilers:   Microsoft (R) C/C++ Optimizing Compiler Version 19.26.28806 for x64,
+//              gcc (Ubuntu 9.3.0-10ubuntu2) 9.3.0,
+//              AppleClang 9.0.0.9000039
+// Description: optional mixer thread that paints the dma buffer outside the client frame
+// -------------------------------------------------------------------------------------
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include <framework/precompiled.hpp>
+
+/*
+===============================================================================
+
+The game thread keeps owning s_channels and the loop sounds. Every change
+the mixer has to know about goes through a single producer / single
+consumer command queue, and the mixer paints from its own copies. Finished
+channels come back through a second queue so the game can free them.
+
+The consumer side of the command queue and the producer side of the event
+queue are only touched with mixLock held. That lets the game thread step in
+for the mixer when the queue is full, when sample data is about to be freed
+and while a video is being recorded.
+
+===============================================================================
+*/
+
+#define MIX_THREAD_MSEC     4       // how often the mixer looks at the dma position
+#define MIX_COMMANDS        4096    // power of two
+#define MIX_EVENTS          1024    // power of two
+
+typedef enum {
+    MIXCMD_START,       // channel copied in, the mixer picks the start sample
+    MIXCMD_VOLUME,      // respatialized one shot channel
+    MIXCMD_LOOP,        // one loop channel of the next set
+    MIXCMD_LOOPS_DONE,  // the loop set is complete, swap it in
+    MIXCMD_CLEAR        // stop everything
+} mixCommandType_t;
+
+typedef struct {
+    mixCommandType_t type;
+    sint slot;
+    sint generation;
+    channel_t channel;
+} mixCommand_t;
+
+typedef enum {
+    MIXEVT_DONE,        // a one shot channel ran out
+    MIXEVT_RESTART      // the sample clock wrapped, stop all sounds
+} mixEventType_t;
+
+typedef struct {
+    mixEventType_t type;
+    sint slot;
+    sint generation;
+} mixEvent_t;
+
+typedef struct {
+    std::atomic<uint> head;
+    std::atomic<uint> tail;
+    mixCommand_t items[MIX_COMMANDS];
+} mixCommandQueue_t;
+
+typedef struct {
+    std::atomic<uint> head;
+    std::atomic<uint> tail;
+    mixEvent_t items[MIX_EVENTS];
+} mixEventQueue_t;
+
+static std::thread mixThread;
+static std::mutex mixLock;
+static std::atomic<bool> mixRunning;
+static std::atomic<bool> mixQuit;
+static std::atomic<bool> mixOnGameThread;
+
+static mixCommandQueue_t mixCommands;
+static mixEventQueue_t mixEvents;
+
+// game thread
+static sint gameGeneration[MAX_CHANNELS];
+static channel_t sentLoops[MAX_CHANNELS];
+static sint numSentLoops;
+
+// mixLock
+static channel_t mixChannels[MAX_CHANNELS];
+static sint mixGeneration[MAX_CHANNELS];
+static channel_t mixLoops[MAX_CHANNELS];
+static sint numMixLoops;
+static channel_t pendingLoops[MAX_CHANNELS];
+static sint numPendingLoops;
+
+/*
+===============
+S_MixPushCommand
+
+Game thread only
+===============
+*/
+static bool S_MixPushCommand(const mixCommand_t *cmd) {
+    uint head;
+
+    head = mixCommands.head.load(std::memory_order_relaxed);
+
+    if(head - mixCommands.tail.load(std::memory_order_acquire) ==
+            MIX_COMMANDS) {
+        return false;
+    }
+
+    mixCommands.items[head & (MIX_COMMANDS - 1)] = *cmd;
+    mixCommands.head.store(head + 1, std::memory_order_release);
+
+    return true;
+}
+
+/*
+===============
+S_MixPopCommand
+
+mixLock
+===============
+*/
+static bool S_MixPopCommand(mixCommand_t *cmd) {
+    uint tail;
+
+    tail = mixCommands.tail.load(std::memory_order_relaxed);
+
+    if(tail == mixCommands.head.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    *cmd = mixCommands.items[tail & (MIX_COMMANDS - 1)];
+    mixCommands.tail.store(tail + 1, std::memory_order_release);
+
+    return true;
+}
+
+/*
+===============
+S_MixPushEvent
+
+mixLock. Events are dropped when the game has not drained the queue in a
+long while; a dropped MIXEVT_DONE only keeps the channel allocated until
+the next sound buffer clear.
+===============
+*/
+static void S_MixPushEvent(mixEventType_t type, sint slot, sint generation) {
+    uint head;
+    mixEvent_t *evt;
+
+    head = mixEvents.head.load(std::memory_order_relaxed);
+
+    if(head - mixEvents.tail.load(std::memory_order_acquire) == MIX_EVENTS) {
+        return;
+    }
+
+    evt = &mixEvents.items[head & (MIX_EVENTS - 1)];
+    evt->type = type;
+    evt->slot = slot;
+    evt->generation = generation;
+    mixEvents.head.store(head + 1, std::memory_order_release);
+}
+
+/*
+===============
+S_MixApplyCommands
+
+mixLock
+===============
+*/
+static void S_MixApplyCommands(void) {
+    mixCommand_t cmd;
+    channel_t *ch;
+
+    while(S_MixPopCommand(&cmd)) {
+        switch(cmd.type) {
+            case MIXCMD_START:
+                mixChannels[cmd.slot] = cmd.channel;
+                mixGeneration[cmd.slot] = cmd.generation;
+                break;
+
+            case MIXCMD_VOLUME:
+                ch = &mixChannels[cmd.slot];
+
+                if(ch->thesfx && mixGeneration[cmd.slot] == cmd.generation) {
+                    ch->leftvol = cmd.channel.leftvol;
+                    ch->rightvol = cmd.channel.rightvol;
+                }
+
+                break;
+
+            case MIXCMD_LOOP:
+                if(numPendingLoops < MAX_CHANNELS) {
+                    pendingLoops[numPendingLoops++] = cmd.channel;
+                }
+
+                break;
+
+            case MIXCMD_LOOPS_DONE:
+                ::memcpy(mixLoops, pendingLoops, numPendingLoops * sizeof(channel_t));
+                numMixLoops = numPendingLoops;
+                numPendingLoops = 0;
+                break;
+
+            case MIXCMD_CLEAR:
+                ::memset(mixChannels, 0, sizeof(mixChannels));
+                numMixLoops = numPendingLoops = 0;
+                break;
+        }
+    }
+}
+
+/*
+===============
+S_MixThread
+===============
+*/
+static void S_MixThread(void) {
+    while(!mixQuit.load(std::memory_order_relaxed)) {
+        if(!mixOnGameThread.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(mixLock);
+
+            S_MixApplyCommands();
+            S_Update_();
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(MIX_THREAD_MSEC));
+    }
+}
+
+/*
+===============
+S_MixThreadActive
+===============
+*/
+bool S_MixThreadActive(void) {
+    return mixRunning.load(std::memory_order_relaxed);
+}
+
+/*
+===============
+S_StartMixThread
+===============
+*/
+void S_StartMixThread(void) {
+    if(S_MixThreadActive()) {
+        return;
+    }
+
+    mixCommands.head = mixCommands.tail = 0;
+    mixEvents.head = mixEvents.tail = 0;
+
+    ::memset(gameGeneration, 0, sizeof(gameGeneration));
+    ::memset(mixChannels, 0, sizeof(mixChannels));
+    ::memset(mixGeneration, 0, sizeof(mixGeneration));
+    numMixLoops = numPendingLoops = 0;
+    numSentLoops = -1;
+
+    mixQuit = false;
+    mixOnGameThread = false;
+    mixRunning = true;
+
+    mixThread = std::thread(S_MixThread);
+
+    common->Printf("sound mixer thread started\n");
+}
+
+/*
+===============
+S_StopMixThread
+===============
+*/
+void S_StopMixThread(void) {
+    if(!S_MixThreadActive()) {
+        return;
+    }
+
+    mixQuit = true;
+    mixThread.join();
+    mixRunning = false;
+}
+
+/*
+===============
+S_MixPush
+
+Game thread. A full queue is drained right here instead of waiting on
+the mixer.
+===============
+*/
+static void S_MixPush(const mixCommand_t *cmd) {
+    if(!S_MixPushCommand(cmd)) {
+        std::lock_guard<std::mutex> lock(mixLock);
+
+        S_MixApplyCommands();
+        S_MixPushCommand(cmd);
+    }
+}
+
+/*
+===============
+S_MixStartChannel
+===============
+*/
+void S_MixStartChannel(channel_t *ch) {
+    mixCommand_t cmd;
+    sint slot;
+
+    slot = ch - s_channels;
+
+    cmd.type = MIXCMD_START;
+    cmd.slot = slot;
+    cmd.generation = ++gameGeneration[slot];
+    cmd.channel = *ch;
+
+    S_MixPush(&cmd);
+}
+
+/*
+===============
+S_MixChannelVolume
+===============
+*/
+void S_MixChannelVolume(channel_t *ch) {
+    mixCommand_t cmd;
+    sint slot;
+
+    slot = ch - s_channels;
+
+    cmd.type = MIXCMD_VOLUME;
+    cmd.slot = slot;
+    cmd.generation = gameGeneration[slot];
+    cmd.channel.leftvol = ch->leftvol;
+    cmd.channel.rightvol = ch->rightvol;
+
+    S_MixPush(&cmd);
+}
+
+/*
+===============
+S_MixLoopChannels
+
+Resends the loop set only when it changed since the last frame. Sounds
+that are paged out are left out, so the mixer never holds an sfx
+without sample data.
+===============
+*/
+void S_MixLoopChannels(void) {
+    sint i, numLoops;
+    channel_t loops[MAX_CHANNELS];
+    mixCommand_t cmd;
+
+    for(i = 0, numLoops = 0; i < numLoopChannels; i++) {
+        if(S_SfxHasSamples(loop_channels[i].thesfx)) {
+            loops[numLoops++] = loop_channels[i];
+        }
+    }
+
+    if(numLoops == numSentLoops &&
+            !::memcmp(loops, sentLoops, numLoops * sizeof(channel_t))) {
+        return;
+    }
+
+    ::memcpy(sentLoops, loops, numLoops * sizeof(channel_t));
+    numSentLoops = numLoops;
+
+    cmd.type = MIXCMD_LOOP;
+    cmd.slot = cmd.generation = 0;
+
+    for(i = 0; i < numLoops; i++) {
+        cmd.channel = loops[i];
+        S_MixPush(&cmd);
+    }
+
+    cmd.type = MIXCMD_LOOPS_DONE;
+    S_MixPush(&cmd);
+}
+
+/*
+===============
+S_MixClearChannels
+===============
+*/
+void S_MixClearChannels(void) {
+    mixCommand_t cmd;
+
+    cmd.type = MIXCMD_CLEAR;
+    cmd.slot = cmd.generation = 0;
+    numSentLoops = -1;
+
+    S_MixPush(&cmd);
+}
+
+/*
+===============
+S_MixForgetSfx
+
+Called before the sample data of a sound is freed. Anything the mixer
+still plays from it is stopped with the lock held.
+===============
+*/
+void S_MixForgetSfx(sfx_t *sfx) {
+    sint i;
+
+    std::lock_guard<std::mutex> lock(mixLock);
+
+    S_MixApplyCommands();
+
+    for(i = 0; i < MAX_CHANNELS; i++) {
+        if(mixChannels[i].thesfx == sfx) {
+            mixChannels[i].thesfx = nullptr;
+            S_MixPushEvent(MIXEVT_DONE, i, mixGeneration[i]);
+        }
+    }
+
+    for(i = 0; i < numMixLoops; i++) {
+        if(mixLoops[i].thesfx == sfx) {
+            mixLoops[i].thesfx = nullptr;
+        }
+    }
+
+    // the loop set may have held this sound, send it again next frame
+    numSentLoops = -1;
+}
+
+/*
+===============
+S_MixForgetStream
+
+Called before a sound stream closes. The game side has already let go
+of the channels reading it, so nothing is reported back.
+===============
+*/
+void S_MixForgetStream(sint stream) {
+    sint i;
+
+    std::lock_guard<std::mutex> lock(mixLock);
+
+    S_MixApplyCommands();
+
+    for(i = 0; i < MAX_CHANNELS; i++) {
+        if(mixChannels[i].stream == stream) {
+            mixChannels[i].stream = 0;
+        }
+    }
+
+    for(i = 0; i < numMixLoops; i++) {
+        if(mixLoops[i].stream == stream) {
+            mixLoops[i].stream = 0;
+        }
+    }
+
+    numSentLoops = -1;
+}
+
+/*
+===============
+S_MixScanChannels
+
+S_ScanChannelStarts for the mixer copies, mixLock
+===============
+*/
+void S_MixScanChannels(void) {
+    sint i;
+    channel_t *ch;
+
+    for(i = 0, ch = mixChannels; i < MAX_CHANNELS; i++, ch++) {
+        if(!ch->thesfx) {
+            continue;
+        }
+
+        if(ch->startSample == START_SAMPLE_IMMEDIATE) {
+            ch->startSample = s_paintedtime;
+            continue;
+        }
+
+        if(ch->startSample + ch->thesfx->soundLength <= s_paintedtime) {
+            ch->thesfx = nullptr;
+            S_MixPushEvent(MIXEVT_DONE, i, mixGeneration[i]);
+        }
+    }
+}
+
+/*
+===============
+S_MixPaintChannels
+
+mixLock
+===============
+*/
+void S_MixPaintChannels(sint endtime) {
+    S_PaintChannels(endtime, mixChannels, mixLoops, numMixLoops);
+}
+
+/*
+===============
+S_MixRestart
+
+The sample clock wrapped while mixing, mixLock
+===============
+*/
+void S_MixRestart(void) {
+    ::memset(mixChannels, 0, sizeof(mixChannels));
+    numMixLoops = 0;
+
+    S_MixPushEvent(MIXEVT_RESTART, 0, 0);
+}
+
+/*
+===============
+S_MixDrainEvents
+
+Game thread, once per S_Update
+===============
+*/
+void S_MixDrainEvents(void) {
+    uint tail;
+    mixEvent_t evt;
+
+    if(!S_MixThreadActive()) {
+        return;
+    }
+
+    for(;;) {
+        tail = mixEvents.tail.load(std::memory_order_relaxed);
+
+        if(tail == mixEvents.head.load(std::memory_order_acquire)) {
+            break;
+        }
+
+        evt = mixEvents.items[tail & (MIX_EVENTS - 1)];
+        mixEvents.tail.store(tail + 1, std::memory_order_release);
+
+        if(evt.type == MIXEVT_RESTART) {
+            SOrig_StopAllSounds();
+            continue;
+        }
+
+        // the slot may have been given to a newer sound since
+        if(gameGeneration[evt.slot] == evt.generation &&
+                s_channels[evt.slot].thesfx) {
+            S_ChannelFree(&s_channels[evt.slot]);
+        }
+    }
+}
+
+/*
+===============
+S_MixThreadFrame
+
+Game thread. Video capture needs the audio in step with each frame, so
+while recording the mixer sits out and the game thread mixes instead.
+===============
+*/
+void S_MixThreadFrame(void) {
+    bool recording;
+
+    recording = clientAVISystem->VideoRecording();
+    mixOnGameThread.store(recording, std::memory_order_relaxed);
+
+    if(recording) {
+        std::lock_guard<std::mutex> lock(mixLock);
+
+        S_MixApplyCommands();
+        S_Update_();
+    }
+}